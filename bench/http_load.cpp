@@ -0,0 +1,261 @@
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <stdexcept>
+
+#ifdef linux
+#include <sys/socket.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <unistd.h>
+#endif // linux
+
+namespace bench {
+
+	class LoadArgs {
+	public:
+		std::string host = "127.0.0.1";
+		std::string port;
+		std::string path = "/";
+		size_t connections = 16;
+		double duration = 5;
+
+		LoadArgs(int argc, const char* argv[]) {
+			for (int i = 1; i < argc; ++i) {
+				std::string arg = argv[i];
+				auto next = [&]() {
+					if (++i >= argc) {
+						throw std::runtime_error("expected value after " + arg);
+					}
+					return std::string(argv[i]);
+					};
+
+				if (arg == "--host") {
+					host = next();
+				}
+				else if (arg == "--port") {
+					port = next();
+				}
+				else if (arg == "--path") {
+					path = next();
+				}
+				else if (arg == "--connections") {
+					connections = std::stoull(next());
+				}
+				else if (arg == "--duration") {
+					duration = std::stod(next());
+				}
+				else {
+					throw std::runtime_error("unknown parameter " + arg);
+				}
+			}
+
+			if (port.empty()) {
+				throw std::runtime_error("usage: flexa_http_load --port <port> [--host <host>] [--path <path>] "
+					"[--connections <n>] [--duration <seconds>]");
+			}
+			if (connections == 0) {
+				connections = 1;
+			}
+		}
+	};
+
+	struct ConnectionResult {
+		// nanoseconds from sending each request to receiving its whole response
+		std::vector<int64_t> latencies_ns;
+		size_t errors = 0;
+	};
+
+	/*
+		Keeps one HTTP/1.1 connection per thread busy with GET requests for the
+		whole duration, a new request being sent as soon as the previous response
+		was read, and reports the requests per second and the latency percentiles.
+	*/
+	class HttpLoad {
+	private:
+		LoadArgs args;
+		std::string request;
+
+	public:
+		HttpLoad(const LoadArgs& args) : args(args) {
+			request = "GET " + args.path + " HTTP/1.1\r\nHost: " + args.host + ":" + args.port + "\r\n\r\n";
+		}
+
+		int run() {
+			std::vector<ConnectionResult> results(args.connections);
+			std::vector<std::thread> threads;
+			std::atomic<bool> stop = false;
+
+			auto start = std::chrono::steady_clock::now();
+			for (size_t i = 0; i < args.connections; ++i) {
+				threads.emplace_back([this, &stop, &result = results[i]]() { drive(stop, result); });
+			}
+
+			std::this_thread::sleep_for(std::chrono::duration<double>(args.duration));
+			stop = true;
+			for (auto& thread : threads) {
+				thread.join();
+			}
+			double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+			std::vector<int64_t> latencies;
+			size_t errors = 0;
+			for (const auto& result : results) {
+				latencies.insert(latencies.end(), result.latencies_ns.begin(), result.latencies_ns.end());
+				errors += result.errors;
+			}
+			std::sort(latencies.begin(), latencies.end());
+
+			auto percentile = [&latencies](double p) {
+				if (latencies.empty()) {
+					return 0.0;
+				}
+				auto index = std::min(latencies.size() - 1, size_t(p * double(latencies.size())));
+				return double(latencies[index]) / 1e6;
+				};
+
+			std::cout << std::fixed << std::setprecision(2)
+				<< "connections " << args.connections << ", " << elapsed << " s\n"
+				<< "requests    " << latencies.size() << " (" << errors << " errors)\n"
+				<< "rps         " << double(latencies.size()) / elapsed << "\n"
+				<< "latency ms  p50 " << percentile(0.5) << "  p90 " << percentile(0.9)
+				<< "  p99 " << percentile(0.99) << "  max " << percentile(1) << std::endl;
+
+			return errors ? EXIT_FAILURE : EXIT_SUCCESS;
+		}
+
+	private:
+#ifdef linux
+
+		int connect_server() {
+			addrinfo hints{};
+			addrinfo* result = nullptr;
+			hints.ai_family = AF_UNSPEC;
+			hints.ai_socktype = SOCK_STREAM;
+			if (getaddrinfo(args.host.c_str(), args.port.c_str(), &hints, &result) != 0) {
+				return -1;
+			}
+
+			int sock = -1;
+			for (auto address = result; address && sock < 0; address = address->ai_next) {
+				sock = socket(address->ai_family, address->ai_socktype, address->ai_protocol);
+				if (sock >= 0 && connect(sock, address->ai_addr, address->ai_addrlen) != 0) {
+					close(sock);
+					sock = -1;
+				}
+			}
+			freeaddrinfo(result);
+
+			if (sock >= 0) {
+				int no_delay = 1;
+				setsockopt(sock, IPPROTO_TCP, TCP_NODELAY, &no_delay, sizeof(no_delay));
+			}
+			return sock;
+		}
+
+		// reads one response with a Content-Length, false if the connection failed
+		static bool read_response(int sock, std::string& buffer, bool& keep_alive) {
+			size_t head_end;
+			while ((head_end = buffer.find("\r\n\r\n")) == std::string::npos) {
+				if (!receive(sock, buffer)) {
+					return false;
+				}
+			}
+
+			std::string head = buffer.substr(0, head_end);
+			std::transform(head.begin(), head.end(), head.begin(), ::tolower);
+			keep_alive = head.find("\r\nconnection: close") == std::string::npos;
+
+			size_t length = 0;
+			auto length_start = head.find("\r\ncontent-length:");
+			if (length_start != std::string::npos) {
+				length = std::stoull(head.substr(length_start + 17));
+			}
+
+			while (buffer.size() < head_end + 4 + length) {
+				if (!receive(sock, buffer)) {
+					return false;
+				}
+			}
+			buffer.erase(0, head_end + 4 + length);
+			return true;
+		}
+
+		static bool receive(int sock, std::string& buffer) {
+			char data[16384];
+			auto count = recv(sock, data, sizeof(data), 0);
+			if (count <= 0) {
+				return false;
+			}
+			buffer.append(data, size_t(count));
+			return true;
+		}
+
+		void drive(const std::atomic<bool>& stop, ConnectionResult& result) {
+			int sock = -1;
+			std::string buffer;
+
+			while (!stop) {
+				// a connection closed by the server is opened again
+				if (sock < 0) {
+					sock = connect_server();
+					buffer.clear();
+					if (sock < 0) {
+						++result.errors;
+						std::this_thread::sleep_for(std::chrono::milliseconds(10));
+						continue;
+					}
+				}
+
+				auto start = std::chrono::steady_clock::now();
+				bool keep_alive = true;
+				if (send(sock, request.data(), request.size(), MSG_NOSIGNAL) != ssize_t(request.size())
+					|| !read_response(sock, buffer, keep_alive)) {
+					++result.errors;
+					close(sock);
+					sock = -1;
+					continue;
+				}
+				result.latencies_ns.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(
+					std::chrono::steady_clock::now() - start).count());
+
+				if (!keep_alive) {
+					close(sock);
+					sock = -1;
+				}
+			}
+
+			if (sock >= 0) {
+				close(sock);
+			}
+		}
+
+#else
+
+		void drive(const std::atomic<bool>&, ConnectionResult& result) {
+			++result.errors;
+		}
+
+#endif // linux
+
+	};
+
+}
+
+int main(int argc, const char* argv[]) {
+	try {
+		bench::HttpLoad load(bench::LoadArgs(argc, argv));
+		return load.run();
+	}
+	catch (const std::exception& ex) {
+		std::cerr << ex.what() << std::endl;
+		return EXIT_FAILURE;
+	}
+}
@@ -0,0 +1,369 @@
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <memory>
+#include <functional>
+#include <algorithm>
+#include <chrono>
+#include <stdexcept>
+
+#include "lexer.hpp"
+#include "parser.hpp"
+#include "operand.hpp"
+#include "types.hpp"
+#include "gc.hpp"
+#include "scope_manager.hpp"
+
+using namespace core;
+using namespace core::parser;
+using namespace core::runtime;
+
+namespace bench {
+
+	// keeps the compiler from discarding a computed value
+	template <typename T>
+	inline void do_not_optimize(const T& value) {
+#if defined(__GNUC__) || defined(__clang__)
+		asm volatile("" : : "g"(&value) : "memory");
+#else
+		static volatile const void* sink;
+		sink = &value;
+#endif // __GNUC__ || __clang__
+	}
+
+	class MicroState {
+	private:
+		std::chrono::steady_clock::time_point start;
+		size_t remaining;
+		bool started = false;
+
+	public:
+		const size_t iterations;
+		int64_t elapsed_ns = 0;
+		// bytes handled per iteration, used to report throughput
+		size_t bytes_per_iteration = 0;
+		// items handled per iteration, used to report throughput
+		size_t items_per_iteration = 0;
+
+		MicroState(size_t iterations) : remaining(iterations), iterations(iterations) {}
+
+		bool keep_running() {
+			if (!started) {
+				started = true;
+				start = std::chrono::steady_clock::now();
+			}
+			if (remaining == 0) {
+				elapsed_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+				return false;
+			}
+			--remaining;
+			return true;
+		}
+	};
+
+	struct Microbenchmark {
+		std::string name;
+		std::function<void(MicroState&)> function;
+	};
+
+	class MicroArgs {
+	public:
+		std::string filter;
+		// minimum measured time of each benchmark in milliseconds
+		int64_t min_time = 200;
+
+		MicroArgs(int argc, const char* argv[]) {
+			for (int i = 1; i < argc; ++i) {
+				std::string arg = argv[i];
+				auto next = [&]() {
+					if (++i >= argc) {
+						throw std::runtime_error("expected value after " + arg);
+					}
+					return std::string(argv[i]);
+					};
+
+				if (arg == "--filter") {
+					filter = next();
+				}
+				else if (arg == "--min-time") {
+					min_time = std::stoll(next());
+				}
+				else {
+					throw std::runtime_error("usage: flexa_microbench [--filter <name>] [--min-time <ms>]");
+				}
+			}
+		}
+	};
+
+	class MicroRunner {
+	private:
+		MicroArgs args;
+		std::vector<Microbenchmark> benchmarks;
+
+	public:
+		MicroRunner(const MicroArgs& args) : args(args) {}
+
+		void add(const std::string& name, const std::function<void(MicroState&)>& function) {
+			benchmarks.push_back(Microbenchmark{ name, function });
+		}
+
+		// grows the iteration count until a run takes at least min_time
+		MicroState measure(const Microbenchmark& benchmark) {
+			const int64_t min_ns = args.min_time * 1000000;
+			size_t iterations = 1;
+
+			while (true) {
+				MicroState state(iterations);
+				benchmark.function(state);
+
+				if (state.elapsed_ns >= min_ns || iterations >= 1000000000) {
+					return state;
+				}
+
+				double multiplier = state.elapsed_ns > 0 ? double(min_ns) * 1.4 / double(state.elapsed_ns) : 10.0;
+				multiplier = std::min(std::max(multiplier, 1.5), 10.0);
+				iterations = size_t(double(iterations) * multiplier) + 1;
+			}
+		}
+
+		int run() {
+			std::cout << std::left << std::setw(40) << "benchmark" << std::right
+				<< std::setw(14) << "ns/op" << std::setw(14) << "iterations"
+				<< std::setw(16) << "throughput" << std::endl;
+
+			for (const auto& benchmark : benchmarks) {
+				if (!args.filter.empty() && benchmark.name.find(args.filter) == std::string::npos) {
+					continue;
+				}
+
+				auto state = measure(benchmark);
+				double ns_per_op = double(state.elapsed_ns) / double(state.iterations);
+				double seconds = double(state.elapsed_ns) / 1000000000.0;
+
+				std::stringstream ss;
+				ss << std::fixed << std::setprecision(2);
+				if (state.bytes_per_iteration) {
+					ss << double(state.bytes_per_iteration * state.iterations) / seconds / (1024.0 * 1024.0) << "MB/s";
+				}
+				else if (state.items_per_iteration) {
+					ss << double(state.items_per_iteration * state.iterations) / seconds / 1000000.0 << "M/s";
+				}
+
+				std::cout << std::left << std::setw(40) << benchmark.name << std::right << std::fixed << std::setprecision(2)
+					<< std::setw(14) << ns_per_op << std::setw(14) << state.iterations
+					<< std::setw(16) << ss.str() << std::endl;
+			}
+
+			return EXIT_SUCCESS;
+		}
+
+	};
+
+	std::string generate_source(size_t functions) {
+		std::string source;
+		for (size_t i = 0; i < functions; ++i) {
+			auto id = std::to_string(i);
+			source += "// generated function " + id + "\n"
+				"fun f" + id + "(a: int, b: float, s: string): float {\n"
+				"\tvar arr: int[] = {1, 2, 3, 4};\n"
+				"\tfor (var i = 0; i < 10; i++) {\n"
+				"\t\tif (a > i and s != \"text " + id + "\") {\n"
+				"\t\t\ta += arr[i % 4] * 2;\n"
+				"\t\t}\n"
+				"\t}\n"
+				"\treturn a / b + 3.14;\n"
+				"}\n\n";
+		}
+		return source;
+	}
+
+	void register_lexer(MicroRunner& runner) {
+		for (size_t functions : { 100, 1000 }) {
+			runner.add("lexer/tokenize/" + std::to_string(functions), [functions](MicroState& state) {
+				auto source = generate_source(functions);
+				state.bytes_per_iteration = source.size();
+				while (state.keep_running()) {
+					// tokens are produced on demand, so drains the lexer
+					Lexer lexer("bench", source);
+					for (auto token = lexer.next_token(); token.type != TK_EOF; token = lexer.next_token()) {
+						do_not_optimize(token);
+					}
+				}
+				});
+		}
+	}
+
+	void register_parser(MicroRunner& runner) {
+		for (size_t functions : { 100, 1000 }) {
+			runner.add("parser/parse_module/" + std::to_string(functions), [functions](MicroState& state) {
+				auto source = generate_source(functions);
+				Lexer lexer("bench", source);
+				state.bytes_per_iteration = source.size();
+				while (state.keep_running()) {
+					lexer.set_current_token(0);
+					Parser parser("bench", &lexer);
+					auto module = parser.parse_module();
+					do_not_optimize(module);
+				}
+				});
+		}
+	}
+
+	void register_operand(MicroRunner& runner) {
+		for (size_t size : { 8, 256 }) {
+			runner.add("operand/get_vector_operand/" + std::to_string(size), [size](MicroState& state) {
+				std::vector<Operand> values;
+				for (size_t i = 0; i < size; ++i) {
+					values.emplace_back(flx_int(i));
+				}
+				Operand operand(values);
+				state.items_per_iteration = size;
+				while (state.keep_running()) {
+					auto result = operand.get_vector_operand();
+					do_not_optimize(result);
+				}
+				});
+		}
+	}
+
+	void register_operations(MicroRunner& runner) {
+		struct OperationCase {
+			std::string name;
+			std::string op;
+			std::function<RuntimeValue()> lval;
+			std::function<RuntimeValue()> rval;
+		};
+
+		std::vector<OperationCase> cases = {
+			{ "int+int", "+", [] { return RuntimeValue(flx_int(40)); }, [] { return RuntimeValue(flx_int(2)); } },
+			{ "int<int", "<", [] { return RuntimeValue(flx_int(40)); }, [] { return RuntimeValue(flx_int(2)); } },
+			{ "int==int", "==", [] { return RuntimeValue(flx_int(40)); }, [] { return RuntimeValue(flx_int(2)); } },
+			{ "int*float", "*", [] { return RuntimeValue(flx_int(40)); }, [] { return RuntimeValue(flx_float(2.5)); } },
+			{ "float*float", "*", [] { return RuntimeValue(flx_float(4.5)); }, [] { return RuntimeValue(flx_float(2.5)); } },
+			{ "float<float", "<", [] { return RuntimeValue(flx_float(4.5)); }, [] { return RuntimeValue(flx_float(2.5)); } },
+			{ "string+string", "+", [] { return RuntimeValue(flx_string("hello ")); }, [] { return RuntimeValue(flx_string("world")); } },
+			{ "string==string", "==", [] { return RuntimeValue(flx_string("hello")); }, [] { return RuntimeValue(flx_string("world")); } },
+			{ "string+char", "+", [] { return RuntimeValue(flx_string("hello")); }, [] { return RuntimeValue(flx_char('!')); } },
+			{ "bool and bool", "and", [] { return RuntimeValue(flx_bool(true)); }, [] { return RuntimeValue(flx_bool(false)); } },
+		};
+
+		for (const auto& operation : cases) {
+			runner.add("runtime/do_operation/" + operation.name, [operation](MicroState& state) {
+				auto lval = operation.lval();
+				auto rval = operation.rval();
+				while (state.keep_running()) {
+					auto result = RuntimeOperations::do_operation(operation.op, &lval, &rval);
+					do_not_optimize(result);
+					delete result;
+				}
+				});
+		}
+	}
+
+	void register_gc(MicroRunner& runner) {
+		for (size_t objects : { 1000, 10000, 100000 }) {
+			runner.add("gc/collect/" + std::to_string(objects), [objects](MicroState& state) {
+				GarbageCollector gc;
+				gc.enable = false;
+
+				auto live = std::make_shared<std::vector<RuntimeValue*>>();
+				for (size_t i = 0; i < objects; ++i) {
+					live->push_back(dynamic_cast<RuntimeValue*>(gc.allocate(new RuntimeValue(flx_int(i)))));
+				}
+				gc.add_root_container(live);
+
+				state.items_per_iteration = objects;
+				while (state.keep_running()) {
+					gc.collect();
+				}
+				});
+		}
+	}
+
+	void register_scope_manager(MicroRunner& runner) {
+		for (size_t depth : { 1, 16, 64 }) {
+			runner.add("scope/get_inner_most_variable_scope/" + std::to_string(depth), [depth](MicroState& state) {
+				const size_t nested_scopes = 8;
+				ScopeManager scope_manager;
+
+				// the module scope chain is searched first, then every included
+				// namespace, the variable lives at the global scope of the last one
+				for (size_t i = 0; i < nested_scopes; ++i) {
+					scope_manager.push_scope(std::make_shared<Scope>("main", "main"));
+				}
+				for (size_t i = 0; i < depth; ++i) {
+					auto name_space = "ns" + std::to_string(i);
+					scope_manager.module_included_name_spaces["main"].push_back(name_space);
+					for (size_t j = 0; j < nested_scopes; ++j) {
+						scope_manager.push_scope(std::make_shared<Scope>(name_space, name_space + "_module"));
+					}
+				}
+				auto last_name_space = "ns" + std::to_string(depth - 1);
+				scope_manager.global_module_scopes[last_name_space].front()->declare_variable(
+					"target", std::make_shared<Variable>("target", TypeDefinition(Type::T_INT)));
+
+				while (state.keep_running()) {
+					auto scope = scope_manager.get_inner_most_variable_scope("main", "main", "", "target");
+					do_not_optimize(scope);
+				}
+				});
+		}
+	}
+
+	void register_array(MicroRunner& runner) {
+		for (flx_int size : { 16, 1024, 65536 }) {
+			runner.add("array/resize/" + std::to_string(size), [size](MicroState& state) {
+				flx_array arr(size);
+				for (flx_int i = 0; i < size; ++i) {
+					arr[i] = nullptr;
+				}
+				bool grow = true;
+				state.items_per_iteration = size_t(size);
+				while (state.keep_running()) {
+					arr.resize(grow ? size * 2 : size);
+					grow = !grow;
+					do_not_optimize(arr);
+				}
+				});
+
+			runner.add("array/append/" + std::to_string(size), [size](MicroState& state) {
+				flx_array arr(size);
+				flx_array other(size);
+				for (flx_int i = 0; i < size; ++i) {
+					arr[i] = nullptr;
+					other[i] = nullptr;
+				}
+				state.items_per_iteration = size_t(size * 2);
+				while (state.keep_running()) {
+					// copies share the data, append always builds a new buffer
+					flx_array result = arr;
+					result.append(other);
+					do_not_optimize(result);
+				}
+				});
+		}
+	}
+
+}
+
+int main(int argc, const char* argv[]) {
+	try {
+		bench::MicroRunner runner(bench::MicroArgs(argc, argv));
+
+		bench::register_lexer(runner);
+		bench::register_parser(runner);
+		bench::register_operand(runner);
+		bench::register_operations(runner);
+		bench::register_gc(runner);
+		bench::register_scope_manager(runner);
+		bench::register_array(runner);
+
+		return runner.run();
+	}
+	catch (const std::exception& ex) {
+		std::cerr << ex.what() << std::endl;
+		return EXIT_FAILURE;
+	}
+}
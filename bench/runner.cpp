@@ -0,0 +1,303 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <chrono>
+#include <filesystem>
+#include <stdexcept>
+
+#ifdef linux
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/wait.h>
+#include <sys/resource.h>
+#endif // linux
+
+namespace bench {
+
+	struct RunResult {
+		int exit_code = 0;
+		int64_t wall_ns = 0;
+		// peak resident set size in kilobytes, 0 when not available
+		int64_t peak_rss_kb = 0;
+	};
+
+	struct BenchmarkResult {
+		std::string name;
+		std::vector<int64_t> wall_ns;
+		int64_t peak_rss_kb = 0;
+		int64_t instructions = -1;
+		bool failed = false;
+	};
+
+	class BenchArgs {
+	public:
+		std::string flexa_path;
+		std::string bench_dir;
+		std::string out_path;
+		std::string filter;
+		size_t warmup = 1;
+		size_t runs = 5;
+
+		BenchArgs(int argc, const char* argv[]) {
+			for (int i = 1; i < argc; ++i) {
+				std::string arg = argv[i];
+				auto next = [&]() {
+					if (++i >= argc) {
+						throw std::runtime_error("expected value after " + arg);
+					}
+					return std::string(argv[i]);
+					};
+
+				if (arg == "--flexa") {
+					flexa_path = next();
+				}
+				else if (arg == "--dir") {
+					bench_dir = next();
+				}
+				else if (arg == "--out") {
+					out_path = next();
+				}
+				else if (arg == "--filter") {
+					filter = next();
+				}
+				else if (arg == "--warmup") {
+					warmup = std::stoull(next());
+				}
+				else if (arg == "--runs") {
+					runs = std::stoull(next());
+				}
+				else {
+					throw std::runtime_error("unknown parameter " + arg);
+				}
+			}
+
+			if (flexa_path.empty() || bench_dir.empty()) {
+				throw std::runtime_error("usage: flexa_bench --flexa <path> --dir <bench dir> [--out <json>] "
+					"[--filter <name>] [--warmup <n>] [--runs <n>]");
+			}
+			if (runs == 0) {
+				runs = 1;
+			}
+		}
+	};
+
+	class BenchRunner {
+	private:
+		BenchArgs args;
+
+	public:
+		BenchRunner(const BenchArgs& args) : args(args) {}
+
+		RunResult run_once(const std::string& main_file, const std::vector<std::string>& extra_args = {}) {
+			std::vector<std::string> cmd = { args.flexa_path };
+			cmd.insert(cmd.end(), extra_args.begin(), extra_args.end());
+			cmd.insert(cmd.end(), { "-w", args.bench_dir, "-m", main_file });
+
+			RunResult result;
+			auto start = std::chrono::steady_clock::now();
+
+#ifdef linux
+
+			pid_t pid = fork();
+			if (pid < 0) {
+				throw std::runtime_error("fork failed");
+			}
+			if (pid == 0) {
+				int devnull = open("/dev/null", O_WRONLY);
+				if (devnull >= 0) {
+					dup2(devnull, STDOUT_FILENO);
+					close(devnull);
+				}
+				std::vector<char*> argv;
+				for (auto& arg : cmd) {
+					argv.push_back(arg.data());
+				}
+				argv.push_back(nullptr);
+				execv(argv[0], argv.data());
+				_exit(127);
+			}
+
+			int status = 0;
+			struct rusage usage {};
+			wait4(pid, &status, 0, &usage);
+
+			result.exit_code = WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+			result.peak_rss_kb = usage.ru_maxrss;
+
+#else
+
+			std::string command;
+			for (const auto& arg : cmd) {
+				command += "\"" + arg + "\" ";
+			}
+			result.exit_code = std::system((command + "> NUL").c_str());
+
+#endif // linux
+
+			result.wall_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+
+			return result;
+		}
+
+		int64_t count_instructions(const std::string& main_file) {
+			auto stats_path = (std::filesystem::temp_directory_path() / ("flexa_bench_" + main_file + ".json")).string();
+
+			if (run_once(main_file, { "--stats-json", stats_path }).exit_code != 0) {
+				return -1;
+			}
+
+			std::ifstream file(stats_path);
+			std::stringstream ss;
+			ss << file.rdbuf();
+			file.close();
+			std::filesystem::remove(stats_path);
+
+			auto content = ss.str();
+			const std::string key = "\"total_instructions\":";
+			auto pos = content.find(key);
+			if (pos == std::string::npos) {
+				return -1;
+			}
+			return std::stoll(content.substr(pos + key.size()));
+		}
+
+		BenchmarkResult run_benchmark(const std::string& main_file) {
+			BenchmarkResult result;
+			result.name = std::filesystem::path(main_file).stem().string();
+
+			for (size_t i = 0; i < args.warmup; ++i) {
+				if (run_once(main_file).exit_code != 0) {
+					result.failed = true;
+					return result;
+				}
+			}
+
+			for (size_t i = 0; i < args.runs; ++i) {
+				auto run = run_once(main_file);
+				if (run.exit_code != 0) {
+					result.failed = true;
+					return result;
+				}
+				result.wall_ns.push_back(run.wall_ns);
+				result.peak_rss_kb = std::max(result.peak_rss_kb, run.peak_rss_kb);
+			}
+
+			result.instructions = count_instructions(main_file);
+
+			return result;
+		}
+
+		std::vector<std::string> find_benchmarks() {
+			std::vector<std::string> files;
+			for (const auto& entry : std::filesystem::directory_iterator(args.bench_dir)) {
+				if (entry.path().extension() != ".flx") {
+					continue;
+				}
+				auto file_name = entry.path().filename().string();
+				if (!args.filter.empty() && file_name.find(args.filter) == std::string::npos) {
+					continue;
+				}
+				files.push_back(file_name);
+			}
+			std::sort(files.begin(), files.end());
+			return files;
+		}
+
+		static int64_t percentile(std::vector<int64_t> values, double p) {
+			if (values.empty()) {
+				return 0;
+			}
+			std::sort(values.begin(), values.end());
+			// nearest rank
+			auto rank = size_t(std::max(1.0, std::ceil(p / 100.0 * double(values.size()))));
+			return values[std::min(rank, values.size()) - 1];
+		}
+
+		static double to_ms(int64_t ns) {
+			return double(ns) / 1000000.0;
+		}
+
+		void write_json(const std::vector<BenchmarkResult>& results) {
+			std::ofstream file(args.out_path);
+			if (!file) {
+				throw std::runtime_error("could not write \"" + args.out_path + "\"");
+			}
+
+			file << std::fixed << std::setprecision(3);
+			file << "{" << std::endl;
+			file << "  \"warmup\": " << args.warmup << "," << std::endl;
+			file << "  \"runs\": " << args.runs << "," << std::endl;
+			file << "  \"benchmarks\": [";
+			for (size_t i = 0; i < results.size(); ++i) {
+				const auto& result = results[i];
+				file << (i ? "," : "") << std::endl;
+				file << "    {" << std::endl;
+				file << "      \"name\": \"" << result.name << "\"," << std::endl;
+				file << "      \"failed\": " << (result.failed ? "true" : "false") << "," << std::endl;
+				file << "      \"median_ms\": " << to_ms(percentile(result.wall_ns, 50)) << "," << std::endl;
+				file << "      \"p95_ms\": " << to_ms(percentile(result.wall_ns, 95)) << "," << std::endl;
+				file << "      \"samples_ms\": [";
+				for (size_t j = 0; j < result.wall_ns.size(); ++j) {
+					file << (j ? ", " : "") << to_ms(result.wall_ns[j]);
+				}
+				file << "]," << std::endl;
+				file << "      \"instructions\": " << result.instructions << "," << std::endl;
+				file << "      \"peak_rss_kb\": " << result.peak_rss_kb << std::endl;
+				file << "    }";
+			}
+			file << std::endl << "  ]" << std::endl;
+			file << "}" << std::endl;
+		}
+
+		int run() {
+			std::vector<BenchmarkResult> results;
+			bool failed = false;
+
+			std::cout << std::left << std::setw(16) << "benchmark" << std::right
+				<< std::setw(12) << "median(ms)" << std::setw(12) << "p95(ms)"
+				<< std::setw(16) << "instructions" << std::setw(14) << "peak rss(kb)" << std::endl;
+
+			for (const auto& main_file : find_benchmarks()) {
+				auto result = run_benchmark(main_file);
+				failed = failed || result.failed;
+
+				std::cout << std::left << std::setw(16) << result.name << std::right << std::fixed << std::setprecision(2);
+				if (result.failed) {
+					std::cout << std::setw(12) << "failed" << std::endl;
+				}
+				else {
+					std::cout << std::setw(12) << to_ms(percentile(result.wall_ns, 50))
+						<< std::setw(12) << to_ms(percentile(result.wall_ns, 95))
+						<< std::setw(16) << result.instructions
+						<< std::setw(14) << result.peak_rss_kb << std::endl;
+				}
+
+				results.push_back(result);
+			}
+
+			if (!args.out_path.empty()) {
+				write_json(results);
+			}
+
+			return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+		}
+
+	};
+
+}
+
+int main(int argc, const char* argv[]) {
+	try {
+		bench::BenchRunner runner(bench::BenchArgs(argc, argv));
+		return runner.run();
+	}
+	catch (const std::exception& ex) {
+		std::cerr << ex.what() << std::endl;
+		return EXIT_FAILURE;
+	}
+}
@@ -62,7 +62,7 @@ ASTDeclarationNode::ASTDeclarationNode(
 	: ASTStatementNode(row, col),
 	TypeDefinition(type, dim, type_name_space, type_name),
 	identifier(identifier),
-	expr(expr),
+	expr(std::move(expr)),
 	is_const(is_const),
 	is_constexpr(is_constexpr) {
 }
@@ -79,11 +79,11 @@ ASTUnpackedDeclarationNode::ASTUnpackedDeclarationNode(
 	: ASTStatementNode(row, col),
 	TypeDefinition(type, dim, type_name_space, type_name),
 	declarations(declarations),
-	expr(expr) {
+	expr(std::move(expr)) {
 }
 
 ASTReturnNode::ASTReturnNode(std::shared_ptr<ASTExprNode> expr, size_t row, size_t col)
-	: ASTStatementNode(row, col), expr(expr) {
+	: ASTStatementNode(row, col), expr(std::move(expr)) {
 }
 
 ASTBlockNode::ASTBlockNode(const std::vector<std::shared_ptr<ASTNode>>& statements, size_t row, size_t col)
@@ -99,7 +99,7 @@ ASTBreakNode::ASTBreakNode(size_t row, size_t col)
 }
 
 ASTExitNode::ASTExitNode(std::shared_ptr<ASTExprNode> exit_code, size_t row, size_t col)
-	: ASTStatementNode(row, col), exit_code(exit_code) {
+	: ASTStatementNode(row, col), exit_code(std::move(exit_code)) {
 }
 
 ASTSwitchNode::ASTSwitchNode(
@@ -110,7 +110,7 @@ ASTSwitchNode::ASTSwitchNode(
 	size_t row, size_t col
 )
 	: ASTStatementNode(row, col),
-	condition(condition),
+	condition(std::move(condition)),
 	statements(statements),
 	case_blocks(case_blocks),
 	default_block(default_block) {
@@ -124,10 +124,10 @@ ASTIfNode::ASTIfNode(
 	size_t row, size_t col
 )
 	: ASTStatementNode(row, col),
-	condition(condition),
-	if_block(if_block),
+	condition(std::move(condition)),
+	if_block(std::move(if_block)),
 	else_ifs(else_ifs),
-	else_block(else_block) {
+	else_block(std::move(else_block)) {
 }
 
 ASTElseIfNode::ASTElseIfNode(
@@ -136,8 +136,8 @@ ASTElseIfNode::ASTElseIfNode(
 	size_t row, size_t col
 )
 	: ASTStatementNode(row, col),
-	condition(condition),
-	block(block) {
+	condition(std::move(condition)),
+	block(std::move(block)) {
 }
 
 ASTEnumNode::ASTEnumNode(const std::vector<std::string>& identifiers, size_t row, size_t col)
@@ -151,13 +151,13 @@ ASTTryCatchNode::ASTTryCatchNode(
 	size_t row, size_t col
 )
 	: ASTStatementNode(row, col),
-	decl(decl),
-	try_block(try_block),
-	catch_block(catch_block) {
+	decl(std::move(decl)),
+	try_block(std::move(try_block)),
+	catch_block(std::move(catch_block)) {
 }
 
 ASTThrowNode::ASTThrowNode(std::shared_ptr<ASTExprNode> error, size_t row, size_t col)
-	: ASTStatementNode(row, col), error(error) {
+	: ASTStatementNode(row, col), error(std::move(error)) {
 }
 
 ASTEllipsisNode::ASTEllipsisNode(size_t row, size_t col)
@@ -171,7 +171,7 @@ ASTForNode::ASTForNode(
 )
 	: ASTStatementNode(row, col),
 	expressions(expressions),
-	block(block) {
+	block(std::move(block)) {
 }
 
 ASTForEachNode::ASTForEachNode(
@@ -181,9 +181,9 @@ ASTForEachNode::ASTForEachNode(
 	size_t row, size_t col
 )
 	: ASTStatementNode(row, col),
-	itdecl(itdecl),
-	collection(collection),
-	block(block) {
+	itdecl(std::move(itdecl)),
+	collection(std::move(collection)),
+	block(std::move(block)) {
 }
 
 ASTWhileNode::ASTWhileNode(
@@ -192,8 +192,8 @@ ASTWhileNode::ASTWhileNode(
 	size_t row, size_t col
 )
 	: ASTStatementNode(row, col),
-	condition(condition),
-	block(block) {
+	condition(std::move(condition)),
+	block(std::move(block)) {
 }
 
 ASTDoWhileNode::ASTDoWhileNode(
@@ -228,7 +228,7 @@ ASTFunctionDefinitionNode::ASTFunctionDefinitionNode(
 	TypeDefinition(type, dim, type_name_space, type_name),
 	identifier(identifier),
 	parameters(parameters),
-	block(block) {
+	block(std::move(block)) {
 }
 
 ASTClassDefinitionNode::ASTClassDefinitionNode(
@@ -279,8 +279,8 @@ ASTBinaryExprNode::ASTBinaryExprNode(
 )
 	: ASTExprNode(row, col),
 	op(op),
-	left(left),
-	right(right) {
+	left(std::move(left)),
+	right(std::move(right)) {
 }
 
 ASTUnaryExprNode::ASTUnaryExprNode(
@@ -290,7 +290,7 @@ ASTUnaryExprNode::ASTUnaryExprNode(
 )
 	: ASTExprNode(row, col),
 	unary_op(unary_op),
-	expr(expr) {
+	expr(std::move(expr)) {
 }
 
 ASTIdentifierNode::ASTIdentifierNode(
@@ -311,9 +311,9 @@ ASTTernaryNode::ASTTernaryNode(
 	size_t row, size_t col
 )
 	: ASTExprNode(row, col),
-	condition(condition),
-	value_if_true(value_if_true),
-	value_if_false(value_if_false) {
+	condition(std::move(condition)),
+	value_if_true(std::move(value_if_true)),
+	value_if_false(std::move(value_if_false)) {
 }
 
 ASTFunctionCallNode::ASTFunctionCallNode(
@@ -328,13 +328,13 @@ ASTFunctionCallNode::ASTFunctionCallNode(
 	access_name_space(access_name_space),
 	identifier_vector(identifier_vector),
 	parameters(parameters),
-	expression_identifier_vector(expression_identifier_vector),
-	expression_call(expression_call),
+	expression_identifier_vector(std::move(expression_identifier_vector)),
+	expression_call(std::move(expression_call)),
 	identifier(identifier_vector[0].identifier) {
 }
 
 ASTTypeCastNode::ASTTypeCastNode(Type type, std::shared_ptr<ASTExprNode> expr, size_t row, size_t col)
-	: ASTExprNode(row, col), type(type), expr(expr) {
+	: ASTExprNode(row, col), type(type), expr(std::move(expr)) {
 }
 
 ASTTypeNode::ASTTypeNode(TypeDefinition type, size_t row, size_t col)
@@ -342,7 +342,7 @@ ASTTypeNode::ASTTypeNode(TypeDefinition type, size_t row, size_t col)
 }
 
 ASTCallOperatorNode::ASTCallOperatorNode(std::shared_ptr<ASTExprNode> expr, size_t row, size_t col)
-	: ASTExprNode(row, col), expr(expr) {
+	: ASTExprNode(row, col), expr(std::move(expr)) {
 }
 
 ASTTypeOfNode::ASTTypeOfNode(std::shared_ptr<ASTExprNode> expr, size_t row, size_t col)
@@ -370,7 +370,7 @@ ASTIsAnyNode::ASTIsAnyNode(std::shared_ptr<ASTExprNode> expr, size_t row, size_t
 }
 
 ASTLambdaFunctionNode::ASTLambdaFunctionNode(std::shared_ptr<ASTFunctionDefinitionNode> fun, size_t row, size_t col)
-	: ASTExprNode(row, col), fun(fun) {
+	: ASTExprNode(row, col), fun(std::move(fun)) {
 }
 
 ASTInstructionNode::ASTInstructionNode(OpCode opcode, Operand operand, size_t row, size_t col)
@@ -394,7 +394,7 @@ void ASTLiteralNode<flx_bool>::accept(Visitor* v) {
 		this->row,
 		this->col
 	));
-	v->visit(std::dynamic_pointer_cast<ASTLiteralNode<flx_bool>>(shared_from_this()));
+	v->visit(std::static_pointer_cast<ASTLiteralNode<flx_bool>>(shared_from_this()));
 	v->current_debug_info_stack.pop();
 }
 
@@ -411,7 +411,7 @@ void ASTLiteralNode<flx_int>::accept(Visitor* v) {
 		this->row,
 		this->col
 	));
-	v->visit(std::dynamic_pointer_cast<ASTLiteralNode<flx_int>>(shared_from_this()));
+	v->visit(std::static_pointer_cast<ASTLiteralNode<flx_int>>(shared_from_this()));
 	v->current_debug_info_stack.pop();
 }
 
@@ -428,7 +428,7 @@ void ASTLiteralNode<flx_float>::accept(Visitor* v) {
 		this->row,
 		this->col
 	));
-	v->visit(std::dynamic_pointer_cast<ASTLiteralNode<flx_float>>(shared_from_this()));
+	v->visit(std::static_pointer_cast<ASTLiteralNode<flx_float>>(shared_from_this()));
 	v->current_debug_info_stack.pop();
 }
 
@@ -445,7 +445,7 @@ void ASTLiteralNode<flx_char>::accept(Visitor* v) {
 		this->row,
 		this->col
 	));
-	v->visit(std::dynamic_pointer_cast<ASTLiteralNode<flx_char>>(shared_from_this()));
+	v->visit(std::static_pointer_cast<ASTLiteralNode<flx_char>>(shared_from_this()));
 	v->current_debug_info_stack.pop();
 }
 
@@ -462,7 +462,7 @@ void ASTLiteralNode<flx_string>::accept(Visitor* v) {
 		this->row,
 		this->col
 	));
-	v->visit(std::dynamic_pointer_cast<ASTLiteralNode<flx_string>>(shared_from_this()));
+	v->visit(std::static_pointer_cast<ASTLiteralNode<flx_string>>(shared_from_this()));
 	v->current_debug_info_stack.pop();
 }
 
@@ -476,7 +476,7 @@ void ASTArrayConstructorNode::accept(Visitor* v) {
 		this->row,
 		this->col
 	));
-	v->visit(std::dynamic_pointer_cast<ASTArrayConstructorNode>(shared_from_this()));
+	v->visit(std::static_pointer_cast<ASTArrayConstructorNode>(shared_from_this()));
 	v->current_debug_info_stack.pop();
 }
 
@@ -490,7 +490,7 @@ void ASTStructConstructorNode::accept(Visitor* v) {
 		this->row,
 		this->col
 	));
-	v->visit(std::dynamic_pointer_cast<ASTStructConstructorNode>(shared_from_this()));
+	v->visit(std::static_pointer_cast<ASTStructConstructorNode>(shared_from_this()));
 	v->current_debug_info_stack.pop();
 }
 
@@ -504,7 +504,7 @@ void ASTBinaryExprNode::accept(Visitor* v) {
 		this->row,
 		this->col
 	));
-	v->visit(std::dynamic_pointer_cast<ASTBinaryExprNode>(shared_from_this()));
+	v->visit(std::static_pointer_cast<ASTBinaryExprNode>(shared_from_this()));
 	v->current_debug_info_stack.pop();
 }
 
@@ -518,7 +518,7 @@ void ASTFunctionCallNode::accept(Visitor* v) {
 		this->row,
 		this->col
 	));
-	v->visit(std::dynamic_pointer_cast<ASTFunctionCallNode>(shared_from_this()));
+	v->visit(std::static_pointer_cast<ASTFunctionCallNode>(shared_from_this()));
 	v->current_debug_info_stack.pop();
 }
 
@@ -532,7 +532,7 @@ void ASTIdentifierNode::accept(Visitor* v) {
 		this->row,
 		this->col
 	));
-	v->visit(std::dynamic_pointer_cast<ASTIdentifierNode>(shared_from_this()));
+	v->visit(std::static_pointer_cast<ASTIdentifierNode>(shared_from_this()));
 	v->current_debug_info_stack.pop();
 }
 
@@ -546,7 +546,7 @@ void ASTTypeOfNode::accept(Visitor* v) {
 		this->row,
 		this->col
 	));
-	v->visit(std::dynamic_pointer_cast<ASTTypeOfNode>(shared_from_this()));
+	v->visit(std::static_pointer_cast<ASTTypeOfNode>(shared_from_this()));
 	v->current_debug_info_stack.pop();
 }
 
@@ -560,7 +560,7 @@ void ASTTypeIdNode::accept(Visitor* v) {
 		this->row,
 		this->col
 	));
-	v->visit(std::dynamic_pointer_cast<ASTTypeIdNode>(shared_from_this()));
+	v->visit(std::static_pointer_cast<ASTTypeIdNode>(shared_from_this()));
 	v->current_debug_info_stack.pop();
 }
 
@@ -574,7 +574,7 @@ void ASTRefIdNode::accept(Visitor* v) {
 		this->row,
 		this->col
 	));
-	v->visit(std::dynamic_pointer_cast<ASTRefIdNode>(shared_from_this()));
+	v->visit(std::static_pointer_cast<ASTRefIdNode>(shared_from_this()));
 	v->current_debug_info_stack.pop();
 }
 
@@ -588,7 +588,7 @@ void ASTIsStructNode::accept(Visitor* v) {
 		this->row,
 		this->col
 	));
-	v->visit(std::dynamic_pointer_cast<ASTIsStructNode>(shared_from_this()));
+	v->visit(std::static_pointer_cast<ASTIsStructNode>(shared_from_this()));
 	v->current_debug_info_stack.pop();
 }
 
@@ -602,7 +602,7 @@ void ASTIsArrayNode::accept(Visitor* v) {
 		this->row,
 		this->col
 	));
-	v->visit(std::dynamic_pointer_cast<ASTIsArrayNode>(shared_from_this()));
+	v->visit(std::static_pointer_cast<ASTIsArrayNode>(shared_from_this()));
 	v->current_debug_info_stack.pop();
 }
 
@@ -616,7 +616,7 @@ void ASTIsAnyNode::accept(Visitor* v) {
 		this->row,
 		this->col
 	));
-	v->visit(std::dynamic_pointer_cast<ASTIsAnyNode>(shared_from_this()));
+	v->visit(std::static_pointer_cast<ASTIsAnyNode>(shared_from_this()));
 	v->current_debug_info_stack.pop();
 }
 
@@ -630,7 +630,7 @@ void ASTUnaryExprNode::accept(Visitor* v) {
 		this->row,
 		this->col
 	));
-	v->visit(std::dynamic_pointer_cast<ASTUnaryExprNode>(shared_from_this()));
+	v->visit(std::static_pointer_cast<ASTUnaryExprNode>(shared_from_this()));
 	v->current_debug_info_stack.pop();
 }
 
@@ -644,7 +644,7 @@ void ASTTernaryNode::accept(Visitor* v) {
 		this->row,
 		this->col
 	));
-	v->visit(std::dynamic_pointer_cast<ASTTernaryNode>(shared_from_this()));
+	v->visit(std::static_pointer_cast<ASTTernaryNode>(shared_from_this()));
 	v->current_debug_info_stack.pop();
 }
 
@@ -658,7 +658,7 @@ void ASTTypeCastNode::accept(Visitor* v) {
 		this->row,
 		this->col
 	));
-	v->visit(std::dynamic_pointer_cast<ASTTypeCastNode>(shared_from_this()));
+	v->visit(std::static_pointer_cast<ASTTypeCastNode>(shared_from_this()));
 	v->current_debug_info_stack.pop();
 }
 
@@ -672,7 +672,7 @@ void ASTTypeNode::accept(Visitor* v) {
 		this->row,
 		this->col
 	));
-	v->visit(std::dynamic_pointer_cast<ASTTypeNode>(shared_from_this()));
+	v->visit(std::static_pointer_cast<ASTTypeNode>(shared_from_this()));
 	v->current_debug_info_stack.pop();
 }
 
@@ -686,7 +686,7 @@ void ASTNullNode::accept(Visitor* v) {
 		this->row,
 		this->col
 	));
-	v->visit(std::dynamic_pointer_cast<ASTNullNode>(shared_from_this()));
+	v->visit(std::static_pointer_cast<ASTNullNode>(shared_from_this()));
 	v->current_debug_info_stack.pop();
 }
 
@@ -700,7 +700,7 @@ void ASTThisNode::accept(Visitor* v) {
 		this->row,
 		this->col
 	));
-	v->visit(std::dynamic_pointer_cast<ASTThisNode>(shared_from_this()));
+	v->visit(std::static_pointer_cast<ASTThisNode>(shared_from_this()));
 	v->current_debug_info_stack.pop();
 }
 
@@ -714,7 +714,7 @@ void ASTLambdaFunctionNode::accept(Visitor* v) {
 		this->row,
 		this->col
 	));
-	v->visit(std::dynamic_pointer_cast<ASTLambdaFunctionNode>(shared_from_this()));
+	v->visit(std::static_pointer_cast<ASTLambdaFunctionNode>(shared_from_this()));
 	v->current_debug_info_stack.pop();
 }
 
@@ -728,7 +728,7 @@ void ASTInstructionNode::accept(Visitor* v) {
 		this->row,
 		this->col
 	));
-	v->visit(std::dynamic_pointer_cast<ASTInstructionNode>(shared_from_this()));
+	v->visit(std::static_pointer_cast<ASTInstructionNode>(shared_from_this()));
 	v->current_debug_info_stack.pop();
 }
 
@@ -742,7 +742,7 @@ void ASTValueNode::accept(Visitor* v) {
 		this->row,
 		this->col
 	));
-	v->visit(std::dynamic_pointer_cast<ASTValueNode>(shared_from_this()));
+	v->visit(std::static_pointer_cast<ASTValueNode>(shared_from_this()));
 	v->current_debug_info_stack.pop();
 }
 
@@ -756,7 +756,7 @@ void ASTDeclarationNode::accept(Visitor* v) {
 		this->row,
 		this->col
 	));
-	v->visit(std::dynamic_pointer_cast<ASTDeclarationNode>(shared_from_this()));
+	v->visit(std::static_pointer_cast<ASTDeclarationNode>(shared_from_this()));
 	v->current_debug_info_stack.pop();
 }
 
@@ -770,7 +770,7 @@ void ASTUnpackedDeclarationNode::accept(Visitor* v) {
 		this->row,
 		this->col
 	));
-	v->visit(std::dynamic_pointer_cast<ASTUnpackedDeclarationNode>(shared_from_this()));
+	v->visit(std::static_pointer_cast<ASTUnpackedDeclarationNode>(shared_from_this()));
 	v->current_debug_info_stack.pop();
 }
 
@@ -784,7 +784,7 @@ void ASTIncludeNamespaceNode::accept(Visitor* v) {
 		this->row,
 		this->col
 	));
-	v->visit(std::dynamic_pointer_cast<ASTIncludeNamespaceNode>(shared_from_this()));
+	v->visit(std::static_pointer_cast<ASTIncludeNamespaceNode>(shared_from_this()));
 	v->current_debug_info_stack.pop();
 }
 
@@ -798,7 +798,7 @@ void ASTExcludeNamespaceNode::accept(Visitor* v) {
 		this->row,
 		this->col
 	));
-	v->visit(std::dynamic_pointer_cast<ASTExcludeNamespaceNode>(shared_from_this()));
+	v->visit(std::static_pointer_cast<ASTExcludeNamespaceNode>(shared_from_this()));
 	v->current_debug_info_stack.pop();
 }
 
@@ -812,7 +812,7 @@ void ASTReturnNode::accept(Visitor* v) {
 		this->row,
 		this->col
 	));
-	v->visit(std::dynamic_pointer_cast<ASTReturnNode>(shared_from_this()));
+	v->visit(std::static_pointer_cast<ASTReturnNode>(shared_from_this()));
 	v->current_debug_info_stack.pop();
 }
 
@@ -826,7 +826,7 @@ void ASTExitNode::accept(Visitor* v) {
 		this->row,
 		this->col
 	));
-	v->visit(std::dynamic_pointer_cast<ASTExitNode>(shared_from_this()));
+	v->visit(std::static_pointer_cast<ASTExitNode>(shared_from_this()));
 	v->current_debug_info_stack.pop();
 }
 
@@ -840,7 +840,7 @@ void ASTBlockNode::accept(Visitor* v) {
 		this->row,
 		this->col
 	));
-	v->visit(std::dynamic_pointer_cast<ASTBlockNode>(shared_from_this()));
+	v->visit(std::static_pointer_cast<ASTBlockNode>(shared_from_this()));
 	v->current_debug_info_stack.pop();
 }
 
@@ -854,7 +854,7 @@ void ASTContinueNode::accept(Visitor* v) {
 		this->row,
 		this->col
 	));
-	v->visit(std::dynamic_pointer_cast<ASTContinueNode>(shared_from_this()));
+	v->visit(std::static_pointer_cast<ASTContinueNode>(shared_from_this()));
 	v->current_debug_info_stack.pop();
 }
 
@@ -868,7 +868,7 @@ void ASTBreakNode::accept(Visitor* v) {
 		this->row,
 		this->col
 	));
-	v->visit(std::dynamic_pointer_cast<ASTBreakNode>(shared_from_this()));
+	v->visit(std::static_pointer_cast<ASTBreakNode>(shared_from_this()));
 	v->current_debug_info_stack.pop();
 }
 
@@ -882,7 +882,7 @@ void ASTSwitchNode::accept(Visitor* v) {
 		this->row,
 		this->col
 	));
-	v->visit(std::dynamic_pointer_cast<ASTSwitchNode>(shared_from_this()));
+	v->visit(std::static_pointer_cast<ASTSwitchNode>(shared_from_this()));
 	v->current_debug_info_stack.pop();
 }
 
@@ -896,7 +896,7 @@ void ASTEnumNode::accept(Visitor* v) {
 		this->row,
 		this->col
 	));
-	v->visit(std::dynamic_pointer_cast<ASTEnumNode>(shared_from_this()));
+	v->visit(std::static_pointer_cast<ASTEnumNode>(shared_from_this()));
 	v->current_debug_info_stack.pop();
 }
 
@@ -910,7 +910,7 @@ void ASTTryCatchNode::accept(Visitor* v) {
 		this->row,
 		this->col
 	));
-	v->visit(std::dynamic_pointer_cast<ASTTryCatchNode>(shared_from_this()));
+	v->visit(std::static_pointer_cast<ASTTryCatchNode>(shared_from_this()));
 	v->current_debug_info_stack.pop();
 }
 
@@ -924,7 +924,7 @@ void ASTThrowNode::accept(Visitor* v) {
 		this->row,
 		this->col
 	));
-	v->visit(std::dynamic_pointer_cast<ASTThrowNode>(shared_from_this()));
+	v->visit(std::static_pointer_cast<ASTThrowNode>(shared_from_this()));
 	v->current_debug_info_stack.pop();
 }
 
@@ -938,7 +938,7 @@ void ASTEllipsisNode::accept(Visitor* v) {
 		this->row,
 		this->col
 	));
-	v->visit(std::dynamic_pointer_cast<ASTEllipsisNode>(shared_from_this()));
+	v->visit(std::static_pointer_cast<ASTEllipsisNode>(shared_from_this()));
 	v->current_debug_info_stack.pop();
 }
 
@@ -952,7 +952,7 @@ void ASTElseIfNode::accept(Visitor* v) {
 		this->row,
 		this->col
 	));
-	v->visit(std::dynamic_pointer_cast<ASTElseIfNode>(shared_from_this()));
+	v->visit(std::static_pointer_cast<ASTElseIfNode>(shared_from_this()));
 	v->current_debug_info_stack.pop();
 }
 
@@ -966,7 +966,7 @@ void ASTIfNode::accept(Visitor* v) {
 		this->row,
 		this->col
 	));
-	v->visit(std::dynamic_pointer_cast<ASTIfNode>(shared_from_this()));
+	v->visit(std::static_pointer_cast<ASTIfNode>(shared_from_this()));
 	v->current_debug_info_stack.pop();
 }
 
@@ -980,7 +980,7 @@ void ASTForNode::accept(Visitor* v) {
 		this->row,
 		this->col
 	));
-	v->visit(std::dynamic_pointer_cast<ASTForNode>(shared_from_this()));
+	v->visit(std::static_pointer_cast<ASTForNode>(shared_from_this()));
 	v->current_debug_info_stack.pop();
 }
 
@@ -994,7 +994,7 @@ void ASTForEachNode::accept(Visitor* v) {
 		this->row,
 		this->col
 	));
-	v->visit(std::dynamic_pointer_cast<ASTForEachNode>(shared_from_this()));
+	v->visit(std::static_pointer_cast<ASTForEachNode>(shared_from_this()));
 	v->current_debug_info_stack.pop();
 }
 
@@ -1008,7 +1008,7 @@ void ASTWhileNode::accept(Visitor* v) {
 		this->row,
 		this->col
 	));
-	v->visit(std::dynamic_pointer_cast<ASTWhileNode>(shared_from_this()));
+	v->visit(std::static_pointer_cast<ASTWhileNode>(shared_from_this()));
 	v->current_debug_info_stack.pop();
 }
 
@@ -1022,7 +1022,7 @@ void ASTDoWhileNode::accept(Visitor* v) {
 		this->row,
 		this->col
 	));
-	v->visit(std::dynamic_pointer_cast<ASTDoWhileNode>(shared_from_this()));
+	v->visit(std::static_pointer_cast<ASTDoWhileNode>(shared_from_this()));
 	v->current_debug_info_stack.pop();
 }
 
@@ -1036,7 +1036,7 @@ void ASTFunctionDefinitionNode::accept(Visitor* v) {
 		this->row,
 		this->col
 	));
-	v->visit(std::dynamic_pointer_cast<ASTFunctionDefinitionNode>(shared_from_this()));
+	v->visit(std::static_pointer_cast<ASTFunctionDefinitionNode>(shared_from_this()));
 	v->current_debug_info_stack.pop();
 }
 
@@ -1050,7 +1050,7 @@ void ASTClassDefinitionNode::accept(Visitor* v) {
 		this->row,
 		this->col
 	));
-	v->visit(std::dynamic_pointer_cast<ASTClassDefinitionNode>(shared_from_this()));
+	v->visit(std::static_pointer_cast<ASTClassDefinitionNode>(shared_from_this()));
 	v->current_debug_info_stack.pop();
 }
 
@@ -1064,7 +1064,7 @@ void ASTStructDefinitionNode::accept(Visitor* v) {
 		this->row,
 		this->col
 	));
-	v->visit(std::dynamic_pointer_cast<ASTStructDefinitionNode>(shared_from_this()));
+	v->visit(std::static_pointer_cast<ASTStructDefinitionNode>(shared_from_this()));
 	v->current_debug_info_stack.pop();
 }
 
@@ -1078,7 +1078,7 @@ void ASTUsingNode::accept(Visitor* v) {
 		this->row,
 		this->col
 	));
-	v->visit(std::dynamic_pointer_cast<ASTUsingNode>(shared_from_this()));
+	v->visit(std::static_pointer_cast<ASTUsingNode>(shared_from_this()));
 	v->current_debug_info_stack.pop();
 }
 
@@ -1092,6 +1092,6 @@ void ASTModuleNode::accept(Visitor* v) {
 		this->row,
 		this->col
 	));
-	v->visit(std::dynamic_pointer_cast<ASTModuleNode>(shared_from_this()));
+	v->visit(std::static_pointer_cast<ASTModuleNode>(shared_from_this()));
 	v->current_debug_info_stack.pop();
 }
@@ -0,0 +1,34 @@
+#include "ast_arena.hpp"
+
+#include <cstdint>
+
+using namespace core;
+
+void* ASTArena::allocate(size_t size, size_t alignment) {
+	auto padding = (alignment - reinterpret_cast<uintptr_t>(current) % alignment) % alignment;
+
+	if (!current || padding + size > remaining) {
+		// oversized requests get a block of their own
+		auto block_size = size + alignment > BLOCK_SIZE ? size + alignment : BLOCK_SIZE;
+		blocks.emplace_back(new std::byte[block_size]);
+		current = blocks.back().get();
+		remaining = block_size;
+		reserved += block_size;
+		padding = (alignment - reinterpret_cast<uintptr_t>(current) % alignment) % alignment;
+	}
+
+	auto ptr = current + padding;
+	current = ptr + size;
+	remaining -= padding + size;
+	allocated += size;
+
+	return ptr;
+}
+
+size_t ASTArena::get_allocated_bytes() const {
+	return allocated;
+}
+
+size_t ASTArena::get_reserved_bytes() const {
+	return reserved;
+}
@@ -0,0 +1,65 @@
+#ifndef AST_ARENA_HPP
+#define AST_ARENA_HPP
+
+#include <cstddef>
+#include <vector>
+#include <memory>
+
+namespace core {
+
+	/*
+		Bump allocator for the nodes of a parsed module.
+		Nodes are never freed one by one, the blocks are released at once
+		when the last node allocated from the arena is destroyed.
+	*/
+	class ASTArena {
+	public:
+		static const size_t BLOCK_SIZE = 64 * 1024;
+
+	private:
+		std::vector<std::unique_ptr<std::byte[]>> blocks;
+		std::byte* current = nullptr;
+		size_t remaining = 0;
+		size_t allocated = 0;
+		size_t reserved = 0;
+
+	public:
+		void* allocate(size_t size, size_t alignment);
+
+		size_t get_allocated_bytes() const;
+		size_t get_reserved_bytes() const;
+	};
+
+	template <typename T>
+	class ASTArenaAllocator {
+	public:
+		using value_type = T;
+
+		// the allocator keeps the arena alive while any node uses it
+		std::shared_ptr<ASTArena> arena;
+
+		ASTArenaAllocator(std::shared_ptr<ASTArena> arena) : arena(std::move(arena)) {}
+
+		template <typename U>
+		ASTArenaAllocator(const ASTArenaAllocator<U>& other) : arena(other.arena) {}
+
+		T* allocate(size_t n) {
+			return static_cast<T*>(arena->allocate(n * sizeof(T), alignof(T)));
+		}
+
+		void deallocate(T*, size_t) {}
+
+		template <typename U>
+		bool operator==(const ASTArenaAllocator<U>& other) const {
+			return arena == other.arena;
+		}
+
+		template <typename U>
+		bool operator!=(const ASTArenaAllocator<U>& other) const {
+			return arena != other.arena;
+		}
+	};
+
+}
+
+#endif // !AST_ARENA_HPP
@@ -0,0 +1,412 @@
+#include "async_file_io.hpp"
+
+#include <fstream>
+#include <sstream>
+#include <filesystem>
+#include <algorithm>
+#include <cstring>
+
+#ifdef linux
+
+#include <linux/io_uring.h>
+#include <sys/syscall.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+
+#endif // linux
+
+using namespace core;
+using namespace core::runtime;
+
+static AsyncFileIo::Result read_file_sync(const std::string& path) {
+	AsyncFileIo::Result result;
+
+	std::ifstream file(path, std::ios::binary);
+	if (!file.is_open()) {
+		result.error = "cannot open '" + path + "' to read";
+		return result;
+	}
+
+	std::stringstream buffer;
+	buffer << file.rdbuf();
+	if (file.bad()) {
+		result.error = "cannot read '" + path + "'";
+		return result;
+	}
+	result.data = buffer.str();
+
+	return result;
+}
+
+static AsyncFileIo::Result write_file_sync(const std::string& path, const std::string& data, bool append) {
+	AsyncFileIo::Result result;
+
+	std::ofstream file(path, std::ios::binary | (append ? std::ios::app : std::ios::trunc));
+	if (!file.is_open()) {
+		result.error = "cannot open '" + path + "' to write";
+		return result;
+	}
+
+	file.write(data.data(), std::streamsize(data.size()));
+	file.flush();
+	if (!file) {
+		result.error = "cannot write to '" + path + "'";
+	}
+
+	return result;
+}
+
+#ifdef linux
+
+static constexpr unsigned RING_ENTRIES = 256;
+static constexpr size_t MIN_READ_SIZE = 65536;
+static constexpr size_t MAX_READ_SIZE = 4 << 20;
+
+struct AsyncFileIo::Ring {
+	int fd = -1;
+	unsigned entries = 0;
+
+	void* rings = MAP_FAILED;
+	size_t rings_size = 0;
+	io_uring_sqe* sqes = static_cast<io_uring_sqe*>(MAP_FAILED);
+	size_t sqes_size = 0;
+
+	unsigned* sq_tail = nullptr;
+	unsigned* sq_mask = nullptr;
+	unsigned* sq_array = nullptr;
+	unsigned* cq_head = nullptr;
+	unsigned* cq_tail = nullptr;
+	unsigned* cq_mask = nullptr;
+	io_uring_cqe* cqes = nullptr;
+
+	~Ring() {
+		if (sqes != MAP_FAILED) {
+			munmap(sqes, sqes_size);
+		}
+		if (rings != MAP_FAILED) {
+			munmap(rings, rings_size);
+		}
+		if (fd >= 0) {
+			close(fd);
+		}
+	}
+
+	// null when the kernel has no io_uring or misses an operation we use
+	static std::unique_ptr<Ring> create() {
+		auto ring = std::make_unique<Ring>();
+
+		io_uring_params params{};
+		ring->fd = int(syscall(__NR_io_uring_setup, RING_ENTRIES, &params));
+		if (ring->fd < 0 || !(params.features & IORING_FEAT_SINGLE_MMAP)) {
+			return nullptr;
+		}
+
+		std::vector<char> probe_buffer(sizeof(io_uring_probe) + 256 * sizeof(io_uring_probe_op));
+		auto probe = reinterpret_cast<io_uring_probe*>(probe_buffer.data());
+		if (syscall(__NR_io_uring_register, ring->fd, IORING_REGISTER_PROBE, probe, 256) < 0) {
+			return nullptr;
+		}
+		for (auto op : { IORING_OP_OPENAT, IORING_OP_READ, IORING_OP_WRITE, IORING_OP_NOP }) {
+			if (op >= probe->ops_len || !(probe->ops[op].flags & IO_URING_OP_SUPPORTED)) {
+				return nullptr;
+			}
+		}
+
+		ring->entries = params.sq_entries;
+		ring->rings_size = std::max(params.sq_off.array + params.sq_entries * sizeof(unsigned),
+			params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe));
+		ring->rings = mmap(nullptr, ring->rings_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_SQ_RING);
+		ring->sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+		ring->sqes = static_cast<io_uring_sqe*>(mmap(nullptr, ring->sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_SQES));
+		if (ring->rings == MAP_FAILED || ring->sqes == MAP_FAILED) {
+			return nullptr;
+		}
+
+		auto base = static_cast<char*>(ring->rings);
+		ring->sq_tail = reinterpret_cast<unsigned*>(base + params.sq_off.tail);
+		ring->sq_mask = reinterpret_cast<unsigned*>(base + params.sq_off.ring_mask);
+		ring->sq_array = reinterpret_cast<unsigned*>(base + params.sq_off.array);
+		ring->cq_head = reinterpret_cast<unsigned*>(base + params.cq_off.head);
+		ring->cq_tail = reinterpret_cast<unsigned*>(base + params.cq_off.tail);
+		ring->cq_mask = reinterpret_cast<unsigned*>(base + params.cq_off.ring_mask);
+		ring->cqes = reinterpret_cast<io_uring_cqe*>(base + params.cq_off.cqes);
+
+		return ring;
+	}
+
+	// the kernel consumes the entry at once, so the queue never fills up
+	void push(const io_uring_sqe& sqe) {
+		auto tail = *sq_tail;
+		auto index = tail & *sq_mask;
+		sqes[index] = sqe;
+		sq_array[index] = index;
+		__atomic_store_n(sq_tail, tail + 1, __ATOMIC_RELEASE);
+
+		while (syscall(__NR_io_uring_enter, fd, 1, 0, 0, nullptr, 0) < 0 && errno == EINTR) {}
+	}
+};
+
+struct AsyncFileIo::Operation {
+	enum class Stage {
+		OPEN,
+		TRANSFER
+	};
+
+	bool writer = false;
+	bool append = false;
+	Stage stage = Stage::OPEN;
+	std::string path;
+	// what is read, or what is left to write past done
+	std::string data;
+	size_t done = 0;
+	int fd = -1;
+	Callback callback;
+};
+
+#endif // linux
+
+AsyncFileIo::AsyncFileIo()
+	: pool(POOL_SIZE) {
+#ifdef linux
+	ring = Ring::create();
+	if (ring) {
+		completer = std::thread(&AsyncFileIo::complete, this);
+	}
+#endif // linux
+}
+
+AsyncFileIo::~AsyncFileIo() {
+	pool.wait();
+
+#ifdef linux
+	if (ring) {
+		std::unique_lock<std::mutex> lock(mutex);
+		finished.wait(lock, [this]() { return in_flight == 0 && waiting.empty(); });
+
+		// a nop without an operation stops the completer
+		io_uring_sqe sqe{};
+		sqe.opcode = IORING_OP_NOP;
+		ring->push(sqe);
+		lock.unlock();
+
+		completer.join();
+	}
+#endif // linux
+}
+
+bool AsyncFileIo::uses_io_uring() const {
+#ifdef linux
+	return ring != nullptr;
+#else
+	return false;
+#endif // linux
+}
+
+void AsyncFileIo::read_file(const std::string& path, Callback callback) {
+#ifdef linux
+	if (ring) {
+		auto operation = new Operation();
+		operation->path = path;
+		operation->callback = std::move(callback);
+
+		std::lock_guard<std::mutex> lock(mutex);
+		submit(operation);
+		return;
+	}
+#endif // linux
+
+	pool.submit([path, callback = std::move(callback)]() {
+		callback(read_file_sync(path));
+		});
+}
+
+void AsyncFileIo::write_file(const std::string& path, std::string data, bool append, Callback callback) {
+#ifdef linux
+	if (ring) {
+		auto operation = new Operation();
+		operation->writer = true;
+		operation->append = append;
+		operation->path = path;
+		operation->data = std::move(data);
+		operation->callback = std::move(callback);
+
+		std::lock_guard<std::mutex> lock(mutex);
+		submit(operation);
+		return;
+	}
+#endif // linux
+
+	pool.submit([path, data = std::move(data), append, callback = std::move(callback)]() {
+		callback(write_file_sync(path, data, append));
+		});
+}
+
+void AsyncFileIo::list_dir(const std::string& path, Callback callback) {
+	// there is no io_uring operation reading directories
+	pool.submit([path, callback = std::move(callback)]() {
+		Result result;
+		std::error_code error;
+		for (std::filesystem::directory_iterator it(path, error), end; !error && it != end; it.increment(error)) {
+			result.entries.push_back(it->path().filename().string());
+		}
+		if (error) {
+			result.entries.clear();
+			result.error = "cannot list '" + path + "'";
+		}
+		callback(std::move(result));
+		});
+}
+
+void AsyncFileIo::delete_path(const std::string& path, Callback callback) {
+	pool.submit([path, callback = std::move(callback)]() {
+		Result result;
+		std::error_code error;
+		std::filesystem::remove_all(path, error);
+		if (error) {
+			result.error = "cannot delete '" + path + "'";
+		}
+		callback(std::move(result));
+		});
+}
+
+#ifdef linux
+
+void AsyncFileIo::submit(Operation* operation) {
+	if (in_flight >= ring->entries) {
+		waiting.push_back(operation);
+		return;
+	}
+
+	io_uring_sqe sqe{};
+	sqe.user_data = reinterpret_cast<uint64_t>(operation);
+
+	if (operation->stage == Operation::Stage::OPEN) {
+		sqe.opcode = IORING_OP_OPENAT;
+		sqe.fd = AT_FDCWD;
+		sqe.addr = reinterpret_cast<uint64_t>(operation->path.c_str());
+		sqe.len = 0644;
+		sqe.open_flags = O_CLOEXEC | (operation->writer ? O_WRONLY | O_CREAT | (operation->append ? O_APPEND : O_TRUNC) : O_RDONLY);
+	}
+	else if (operation->writer) {
+		// an offset of -1 writes at the end of a file opened to append
+		sqe.opcode = IORING_OP_WRITE;
+		sqe.fd = operation->fd;
+		sqe.addr = reinterpret_cast<uint64_t>(operation->data.data() + operation->done);
+		sqe.len = unsigned(std::min(operation->data.size() - operation->done, size_t(1) << 30));
+		sqe.off = operation->append ? uint64_t(-1) : uint64_t(operation->done);
+	}
+	else {
+		// reads grow with the file, a small file is read at once
+		auto size = std::clamp(operation->done, MIN_READ_SIZE, MAX_READ_SIZE);
+		operation->data.resize(operation->done + size);
+		sqe.opcode = IORING_OP_READ;
+		sqe.fd = operation->fd;
+		sqe.addr = reinterpret_cast<uint64_t>(operation->data.data() + operation->done);
+		sqe.len = unsigned(size);
+		sqe.off = uint64_t(operation->done);
+	}
+
+	++in_flight;
+	ring->push(sqe);
+}
+
+void AsyncFileIo::advance(Operation* operation, int result) {
+	if (result == -EINTR || result == -EAGAIN) {
+		std::lock_guard<std::mutex> lock(mutex);
+		submit(operation);
+		return;
+	}
+
+	if (result < 0) {
+		if (operation->stage == Operation::Stage::OPEN) {
+			finish(operation, "cannot open '" + operation->path + "' to " + (operation->writer ? "write" : "read"));
+		}
+		else {
+			finish(operation, operation->writer ? "cannot write to '" + operation->path + "'" : "cannot read '" + operation->path + "'");
+		}
+		return;
+	}
+
+	if (operation->stage == Operation::Stage::OPEN) {
+		operation->fd = result;
+		operation->stage = Operation::Stage::TRANSFER;
+		if (operation->writer && operation->data.empty()) {
+			finish(operation, "");
+			return;
+		}
+	}
+	else if (operation->writer) {
+		operation->done += size_t(result);
+		if (operation->done == operation->data.size()) {
+			finish(operation, "");
+			return;
+		}
+	}
+	else if (result == 0) {
+		operation->data.resize(operation->done);
+		finish(operation, "");
+		return;
+	}
+	else {
+		operation->done += size_t(result);
+	}
+
+	std::lock_guard<std::mutex> lock(mutex);
+	submit(operation);
+}
+
+void AsyncFileIo::finish(Operation* operation, const std::string& error) {
+	if (operation->fd >= 0) {
+		close(operation->fd);
+	}
+
+	Result result;
+	result.error = error;
+	if (!operation->writer && error.empty()) {
+		result.data = std::move(operation->data);
+	}
+
+	operation->callback(std::move(result));
+	delete operation;
+}
+
+void AsyncFileIo::complete() {
+	while (true) {
+		if (syscall(__NR_io_uring_enter, ring->fd, 0, 1, IORING_ENTER_GETEVENTS, nullptr, 0) < 0 && errno != EINTR) {
+			return;
+		}
+
+		auto head = *ring->cq_head;
+		auto tail = __atomic_load_n(ring->cq_tail, __ATOMIC_ACQUIRE);
+		while (head != tail) {
+			auto cqe = ring->cqes[head & *ring->cq_mask];
+			__atomic_store_n(ring->cq_head, ++head, __ATOMIC_RELEASE);
+
+			if (!cqe.user_data) {
+				return;
+			}
+
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				--in_flight;
+			}
+
+			advance(reinterpret_cast<Operation*>(cqe.user_data), cqe.res);
+
+			// the room left by finished operations goes to the waiting ones
+			std::lock_guard<std::mutex> lock(mutex);
+			while (!waiting.empty() && in_flight < ring->entries) {
+				auto operation = waiting.front();
+				waiting.pop_front();
+				submit(operation);
+			}
+			if (in_flight == 0 && waiting.empty()) {
+				finished.notify_all();
+			}
+		}
+	}
+}
+
+#endif // linux
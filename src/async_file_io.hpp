@@ -0,0 +1,84 @@
+#ifndef ASYNC_FILE_IO_HPP
+#define ASYNC_FILE_IO_HPP
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+#include "thread_pool.hpp"
+
+namespace core {
+
+	namespace runtime {
+
+		/*
+			File operations running outside the vm. Reads and writes of whole files
+			are submitted to an io_uring on Linux, where the kernel overlaps them,
+			and fall back to a small pool of I/O threads where it is unavailable;
+			listing and deleting always run on the pool. The callback of an
+			operation is called on the thread completing it.
+		*/
+		class AsyncFileIo {
+		public:
+			struct Result {
+				std::string data;
+				std::vector<std::string> entries;
+				// empty on success
+				std::string error;
+			};
+
+			typedef std::function<void(Result)> Callback;
+
+		private:
+			static constexpr size_t POOL_SIZE = 4;
+
+			utils::ThreadPool pool;
+
+#ifdef linux
+			struct Ring;
+			struct Operation;
+
+			std::unique_ptr<Ring> ring;
+			std::thread completer;
+
+			std::mutex mutex;
+			std::condition_variable finished;
+			// submitted to the ring, bounded by the size of its completion queue
+			size_t in_flight = 0;
+			// waiting for room in the ring
+			std::deque<Operation*> waiting;
+#endif // linux
+
+		public:
+			AsyncFileIo();
+			// waits for the operations still running
+			~AsyncFileIo();
+
+			bool uses_io_uring() const;
+
+			void read_file(const std::string& path, Callback callback);
+			void write_file(const std::string& path, std::string data, bool append, Callback callback);
+			void list_dir(const std::string& path, Callback callback);
+			void delete_path(const std::string& path, Callback callback);
+
+		private:
+#ifdef linux
+			// queues the next step of the operation, called with the lock held
+			void submit(Operation* operation);
+			// advances the operation with the result of its last step
+			void advance(Operation* operation, int result);
+			void finish(Operation* operation, const std::string& error);
+			void complete();
+#endif // linux
+		};
+
+	}
+
+}
+
+#endif // !ASYNC_FILE_IO_HPP
@@ -0,0 +1,347 @@
+#include "async_socket.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+#ifdef linux
+
+#include <sys/socket.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+
+#elif defined(_WIN32)
+
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#pragma comment(lib, "ws2_32.lib")
+
+#endif // linux
+
+#include "vm.hpp"
+#include "vm_scheduler.hpp"
+
+using namespace core;
+using namespace core::runtime;
+
+static constexpr size_t RECEIVE_SIZE = 65536;
+
+static VmScheduler* get_scheduler(VirtualMachine* vm) {
+	if (!vm->scheduler) {
+		vm->scheduler = std::make_shared<VmScheduler>(vm);
+	}
+	return vm->scheduler.get();
+}
+
+static void close_socket(EventLoop::socket_t sock) {
+#ifdef linux
+	::close(sock);
+#elif defined(_WIN32)
+	closesocket(sock);
+#endif // linux
+}
+
+static bool would_block() {
+#ifdef linux
+	return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINPROGRESS;
+#elif defined(_WIN32)
+	return WSAGetLastError() == WSAEWOULDBLOCK;
+#endif // linux
+}
+
+static void set_non_blocking(EventLoop::socket_t sock) {
+#ifdef linux
+	fcntl(sock, F_SETFL, fcntl(sock, F_GETFL, 0) | O_NONBLOCK);
+#elif defined(_WIN32)
+	u_long non_blocking = 1;
+	ioctlsocket(sock, FIONBIO, &non_blocking);
+#endif // linux
+}
+
+static void set_no_delay(EventLoop::socket_t sock) {
+	int no_delay = 1;
+	setsockopt(sock, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<const char*>(&no_delay), sizeof(no_delay));
+}
+
+static std::pair<std::string, flx_int> get_address(const sockaddr* address, socklen_t length) {
+	char host[NI_MAXHOST];
+	char service[NI_MAXSERV];
+	if (getnameinfo(address, length, host, sizeof(host), service, sizeof(service), NI_NUMERICHOST | NI_NUMERICSERV) != 0) {
+		return { "", 0 };
+	}
+	return { host, std::stoll(service) };
+}
+
+AsyncSocket::AsyncSocket(EventLoop::socket_t sock)
+	: sock(sock) {}
+
+AsyncSocket::~AsyncSocket() {
+	close_socket(sock);
+}
+
+AsyncSocket::time_point AsyncSocket::get_deadline(flx_int timeout) {
+	return timeout > 0 ? std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout) : time_point::max();
+}
+
+std::shared_ptr<AsyncSocket> AsyncSocket::listen(const std::string& host, flx_int port, flx_int backlog) {
+	addrinfo hints{};
+	addrinfo* result = nullptr;
+	hints.ai_family = AF_UNSPEC;
+	hints.ai_socktype = SOCK_STREAM;
+	hints.ai_flags = AI_PASSIVE;
+
+	if (getaddrinfo(host.empty() ? nullptr : host.c_str(), std::to_string(port).c_str(), &hints, &result) != 0) {
+		throw std::runtime_error("cannot resolve '" + host + "'");
+	}
+
+	auto sock = EventLoop::NO_SOCKET;
+	for (auto address = result; address; address = address->ai_next) {
+		sock = socket(address->ai_family, address->ai_socktype, address->ai_protocol);
+		if (sock == EventLoop::NO_SOCKET) {
+			continue;
+		}
+
+		int reuse = 1;
+		setsockopt(sock, SOL_SOCKET, SO_REUSEADDR, reinterpret_cast<const char*>(&reuse), sizeof(reuse));
+
+		if (bind(sock, address->ai_addr, int(address->ai_addrlen)) == 0
+			&& ::listen(sock, backlog > 0 ? int(backlog) : SOMAXCONN) == 0) {
+			break;
+		}
+
+		close_socket(sock);
+		sock = EventLoop::NO_SOCKET;
+	}
+	freeaddrinfo(result);
+
+	if (sock == EventLoop::NO_SOCKET) {
+		throw std::runtime_error("cannot listen on '" + host + ":" + std::to_string(port) + "'");
+	}
+
+	set_non_blocking(sock);
+
+	return std::make_shared<AsyncSocket>(sock);
+}
+
+std::shared_ptr<AsyncSocket> AsyncSocket::connect(VirtualMachine* vm, const std::string& host, flx_int port, time_point deadline) {
+	addrinfo hints{};
+	addrinfo* result = nullptr;
+	hints.ai_family = AF_UNSPEC;
+	hints.ai_socktype = SOCK_STREAM;
+
+	// resolving cannot be waited for on the event loop
+	int resolved;
+	vm->run_blocking([&]() {
+		resolved = getaddrinfo(host.c_str(), std::to_string(port).c_str(), &hints, &result);
+		});
+	if (resolved != 0) {
+		throw std::runtime_error("cannot resolve '" + host + "'");
+	}
+
+	std::shared_ptr<AsyncSocket> connection;
+	try {
+		for (auto address = result; address && !connection; address = address->ai_next) {
+			auto sock = socket(address->ai_family, address->ai_socktype, address->ai_protocol);
+			if (sock == EventLoop::NO_SOCKET) {
+				continue;
+			}
+			set_non_blocking(sock);
+
+			// owned from here, so it is closed if the wait fails
+			auto candidate = std::make_shared<AsyncSocket>(sock);
+
+			bool connected = ::connect(sock, address->ai_addr, int(address->ai_addrlen)) == 0;
+			if (!connected && would_block()) {
+				candidate->wait(vm, EventLoop::WRITABLE, deadline);
+
+				int error = 0;
+				socklen_t length = sizeof(error);
+				getsockopt(sock, SOL_SOCKET, SO_ERROR, reinterpret_cast<char*>(&error), &length);
+				connected = error == 0;
+			}
+			if (connected) {
+				connection = candidate;
+			}
+		}
+	}
+	catch (...) {
+		freeaddrinfo(result);
+		throw;
+	}
+	freeaddrinfo(result);
+
+	if (!connection) {
+		throw std::runtime_error("cannot connect to '" + host + ":" + std::to_string(port) + "'");
+	}
+
+	set_no_delay(connection->sock);
+
+	return connection;
+}
+
+std::shared_ptr<AsyncSocket> AsyncSocket::accept(VirtualMachine* vm, time_point deadline) {
+	while (true) {
+		auto sock = ::accept(this->sock, nullptr, nullptr);
+
+		if (sock != EventLoop::NO_SOCKET) {
+			set_non_blocking(sock);
+			set_no_delay(sock);
+			return std::make_shared<AsyncSocket>(sock);
+		}
+
+		if (closed) {
+			return nullptr;
+		}
+		if (!would_block()) {
+			throw std::runtime_error("cannot accept connections");
+		}
+
+		try {
+			wait(vm, EventLoop::READABLE, deadline);
+		}
+		catch (const std::runtime_error&) {
+			if (closed) {
+				return nullptr;
+			}
+			throw;
+		}
+	}
+}
+
+std::string AsyncSocket::read(VirtualMachine* vm, size_t size, time_point deadline) {
+	if (begin == buffer.size() && !receive(vm, deadline)) {
+		return "";
+	}
+
+	auto count = std::min(size, buffer.size() - begin);
+	auto data = buffer.substr(begin, count);
+	begin += count;
+	return data;
+}
+
+std::string AsyncSocket::read_exact(VirtualMachine* vm, size_t size, time_point deadline) {
+	while (buffer.size() - begin < size) {
+		if (!receive(vm, deadline)) {
+			throw std::runtime_error("connection closed before the end of the data");
+		}
+	}
+
+	auto data = buffer.substr(begin, size);
+	begin += size;
+	return data;
+}
+
+bool AsyncSocket::read_line(VirtualMachine* vm, std::string& line, time_point deadline, size_t max_size) {
+	// relative to begin, which receive moves when it drops what was read
+	size_t searched = 0;
+	while (true) {
+		auto line_end = buffer.find('\n', begin + searched);
+		if (line_end != std::string::npos) {
+			auto end = line_end > begin && buffer[line_end - 1] == '\r' ? line_end - 1 : line_end;
+			line = buffer.substr(begin, end - begin);
+			begin = line_end + 1;
+			return true;
+		}
+		if (buffer.size() - begin > max_size) {
+			throw std::runtime_error("line is too long");
+		}
+
+		searched = buffer.size() - begin;
+		if (!receive(vm, deadline)) {
+			// the last line may have no line break
+			line = buffer.substr(begin);
+			begin = buffer.size();
+			return !line.empty();
+		}
+	}
+}
+
+void AsyncSocket::write(VirtualMachine* vm, std::string_view data, time_point deadline) {
+	size_t sent = 0;
+	while (sent < data.size()) {
+#ifdef linux
+		auto count = send(sock, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+#elif defined(_WIN32)
+		auto count = send(sock, data.data() + sent, int(data.size() - sent), 0);
+#endif // linux
+		if (count >= 0) {
+			sent += size_t(count);
+		}
+		else if (would_block()) {
+			wait(vm, EventLoop::WRITABLE, deadline);
+		}
+		else {
+			throw std::runtime_error("connection failed while writing");
+		}
+	}
+}
+
+void AsyncSocket::close(VirtualMachine* vm) {
+	closed = true;
+	if (vm->scheduler) {
+		vm->scheduler->cancel_io(sock);
+	}
+}
+
+std::pair<std::string, flx_int> AsyncSocket::get_local_address() {
+	sockaddr_storage address{};
+	socklen_t length = sizeof(address);
+	getsockname(sock, reinterpret_cast<sockaddr*>(&address), &length);
+	return get_address(reinterpret_cast<sockaddr*>(&address), length);
+}
+
+std::pair<std::string, flx_int> AsyncSocket::get_peer_address() {
+	sockaddr_storage address{};
+	socklen_t length = sizeof(address);
+	getpeername(sock, reinterpret_cast<sockaddr*>(&address), &length);
+	return get_address(reinterpret_cast<sockaddr*>(&address), length);
+}
+
+bool AsyncSocket::receive(VirtualMachine* vm, time_point deadline) {
+	// drops what was read before growing the buffer
+	if (begin > 0) {
+		buffer.erase(0, begin);
+		begin = 0;
+	}
+
+	while (true) {
+		auto size = buffer.size();
+		buffer.resize(size + RECEIVE_SIZE);
+		auto received = recv(sock, buffer.data() + size, int(RECEIVE_SIZE), 0);
+		buffer.resize(size + std::max(received, decltype(received)(0)));
+
+		if (received >= 0) {
+			return received > 0;
+		}
+		if (!would_block()) {
+			throw std::runtime_error("connection failed while reading");
+		}
+		wait(vm, EventLoop::READABLE, deadline);
+	}
+}
+
+void AsyncSocket::wait(VirtualMachine* vm, uint32_t events, time_point deadline) {
+	// closed by another task while this one was not waiting
+	if (closed) {
+		throw std::runtime_error("socket was closed");
+	}
+
+	flx_int timeout = 0;
+	if (deadline != time_point::max()) {
+		timeout = flx_int(std::chrono::ceil<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now()).count());
+		if (timeout <= 0) {
+			throw std::runtime_error("timed out");
+		}
+	}
+
+	auto ready = get_scheduler(vm)->wait_io(sock, events, timeout);
+	if (ready == EventLoop::TIMED_OUT) {
+		throw std::runtime_error("timed out");
+	}
+	if (ready == EventLoop::CANCELLED) {
+		throw std::runtime_error("socket was closed");
+	}
+}
@@ -0,0 +1,72 @@
+#ifndef ASYNC_SOCKET_HPP
+#define ASYNC_SOCKET_HPP
+
+#include <string>
+#include <string_view>
+#include <memory>
+#include <chrono>
+#include <utility>
+
+#include "vm_event_loop.hpp"
+#include "types.hpp"
+
+namespace core {
+
+	namespace runtime {
+
+		class VirtualMachine;
+
+		/*
+			Non blocking TCP socket of a vm. An operation that cannot complete
+			suspends the running task on the event loop of the scheduler until the
+			socket is ready, failing with "timed out" once its deadline passed.
+		*/
+		class AsyncSocket {
+		public:
+			typedef std::chrono::steady_clock::time_point time_point;
+
+			EventLoop::socket_t sock;
+			bool closed = false;
+
+		private:
+			// bytes received past the ones read so far
+			std::string buffer;
+			size_t begin = 0;
+
+		public:
+			explicit AsyncSocket(EventLoop::socket_t sock);
+			~AsyncSocket();
+
+			// a timeout of zero or less never expires
+			static time_point get_deadline(flx_int timeout);
+
+			// an empty host listens on every address, port zero is chosen by the system
+			static std::shared_ptr<AsyncSocket> listen(const std::string& host, flx_int port, flx_int backlog);
+			static std::shared_ptr<AsyncSocket> connect(VirtualMachine* vm, const std::string& host, flx_int port, time_point deadline);
+
+			// null once the listener was closed
+			std::shared_ptr<AsyncSocket> accept(VirtualMachine* vm, time_point deadline);
+			// at most size bytes, empty once the peer closed
+			std::string read(VirtualMachine* vm, size_t size, time_point deadline);
+			// exactly size bytes, fails if the peer closes before
+			std::string read_exact(VirtualMachine* vm, size_t size, time_point deadline);
+			// without "\n" or "\r\n", false once the peer closed and nothing is left
+			bool read_line(VirtualMachine* vm, std::string& line, time_point deadline, size_t max_size);
+			void write(VirtualMachine* vm, std::string_view data, time_point deadline);
+			// wakes the task waiting for the socket, it is closed once released
+			void close(VirtualMachine* vm);
+
+			std::pair<std::string, flx_int> get_local_address();
+			std::pair<std::string, flx_int> get_peer_address();
+
+		private:
+			// appends what was received to the buffer, false once the peer closed
+			bool receive(VirtualMachine* vm, time_point deadline);
+			void wait(VirtualMachine* vm, uint32_t events, time_point deadline);
+		};
+
+	}
+
+}
+
+#endif // !ASYNC_SOCKET_HPP
@@ -29,7 +29,39 @@ void Compiler::start() {
 	add_instruction(OpCode::OP_HALT);
 }
 
-void Compiler::visit(std::shared_ptr<ASTModuleNode> astnode) {
+size_t Compiler::start_segment(
+	std::shared_ptr<ASTModuleNode> module,
+	const std::map<std::string, std::shared_ptr<ASTModuleNode>>& modules
+) {
+	this->modules = modules;
+	main_module = module;
+	current_module_stack = std::stack<std::shared_ptr<ASTModuleNode>>();
+	current_module_stack.push(module);
+
+	segment_start = pointer;
+	bytecode_program.clear();
+	single_expression_state = false;
+
+	try {
+		start();
+	}
+	catch (...) {
+		// discards the partial segment, so the next one starts at the same pc
+		pointer = segment_start;
+		bytecode_program.clear();
+		end_pointers = std::stack<std::vector<size_t>>();
+		start_pointers = std::stack<std::vector<size_t>>();
+		if_end_pointers = std::stack<std::vector<size_t>>();
+		current_this_name = std::stack<std::pair<std::string, std::string>>();
+		scope_unwind_stack = std::stack<size_t>();
+		current_debug_info_stack = std::stack<DebugInfo>();
+		throw;
+	}
+
+	return segment_start;
+}
+
+void Compiler::visit(const std::shared_ptr<ASTModuleNode>& astnode) {
 	current_this_name.push(std::make_pair("module", astnode->name));
 	vm_debug.add_module(astnode->name);
 
@@ -48,13 +80,13 @@ void Compiler::visit(std::shared_ptr<ASTModuleNode> astnode) {
 
 }
 
-void Compiler::visit(std::shared_ptr<ASTUsingNode> astnode) {
+void Compiler::visit(const std::shared_ptr<ASTUsingNode>& astnode) {
 	std::string libname = utils::StringUtils::join(astnode->library, ".");
 	auto& module = modules[libname];
 	vm_debug.add_module(module->name);
 	vm_debug.add_namespace(module->name_space);
 
-	if (Constants::CORE_LIBS.find(libname) != Constants::CORE_LIBS.end()) {
+	if (Constants::find_native_lib(libname, host_libs.get())) {
 		add_instruction(OpCode::OP_BUILTIN_LIB, flx_string(libname));
 	}
 
@@ -80,21 +112,21 @@ void Compiler::visit(std::shared_ptr<ASTUsingNode> astnode) {
 
 }
 
-void Compiler::visit(std::shared_ptr<ASTIncludeNamespaceNode> astnode) {
+void Compiler::visit(const std::shared_ptr<ASTIncludeNamespaceNode>& astnode) {
 	add_instruction(OpCode::OP_INCLUDE_NAMESPACE, std::vector<Operand> {
 		Operand(current_module_stack.top()->name),
 		Operand(astnode->name_space)
 	});
 }
 
-void Compiler::visit(std::shared_ptr<ASTExcludeNamespaceNode> astnode) {
+void Compiler::visit(const std::shared_ptr<ASTExcludeNamespaceNode>& astnode) {
 	add_instruction(OpCode::OP_EXCLUDE_NAMESPACE, std::vector<Operand> {
 		Operand(current_module_stack.top()->name),
 		Operand(astnode->name_space)
 	});
 }
 
-void Compiler::visit(std::shared_ptr<ASTEnumNode> astnode) {
+void Compiler::visit(const std::shared_ptr<ASTEnumNode>& astnode) {
 	for (size_t i = 0; i < astnode->identifiers.size(); ++i) {
 		add_instruction(OpCode::OP_PUSH_INT, flx_int(i));
 
@@ -106,7 +138,7 @@ void Compiler::visit(std::shared_ptr<ASTEnumNode> astnode) {
 	}
 }
 
-void Compiler::visit(std::shared_ptr<ASTDeclarationNode> astnode) {
+void Compiler::visit(const std::shared_ptr<ASTDeclarationNode>& astnode) {
 	if (astnode->expr) {
 		astnode->expr->accept(this);
 	}
@@ -126,13 +158,13 @@ void Compiler::visit(std::shared_ptr<ASTDeclarationNode> astnode) {
 
 }
 
-void Compiler::visit(std::shared_ptr<ASTUnpackedDeclarationNode> astnode) {
+void Compiler::visit(const std::shared_ptr<ASTUnpackedDeclarationNode>& astnode) {
 	for (const auto& declaration : astnode->declarations) {
 		declaration->accept(this);
 	}
 }
 
-void Compiler::visit(std::shared_ptr<ASTReturnNode> astnode) {
+void Compiler::visit(const std::shared_ptr<ASTReturnNode>& astnode) {
 	if (astnode->expr) {
 		astnode->expr->accept(this);
 	}
@@ -143,7 +175,7 @@ void Compiler::visit(std::shared_ptr<ASTReturnNode> astnode) {
 	add_instruction(OpCode::OP_RETURN);
 }
 
-void Compiler::visit(std::shared_ptr<ASTFunctionCallNode> astnode) {
+void Compiler::visit(const std::shared_ptr<ASTFunctionCallNode>& astnode) {
 	bool self_call = astnode->identifier_vector.size() > 1 && astnode->identifier_vector[0].identifier == "self";
 	
 	for (const auto& param : astnode->parameters) {
@@ -189,7 +221,7 @@ void Compiler::visit(std::shared_ptr<ASTFunctionCallNode> astnode) {
 
 }
 
-void Compiler::visit(std::shared_ptr<ASTFunctionDefinitionNode> astnode) {
+void Compiler::visit(const std::shared_ptr<ASTFunctionDefinitionNode>& astnode) {
 	current_this_name.push(std::make_pair("function", astnode->identifier));
 
 	// function will be defined here
@@ -243,7 +275,7 @@ void Compiler::visit(std::shared_ptr<ASTFunctionDefinitionNode> astnode) {
 	current_this_name.pop();
 }
 
-void Compiler::visit(std::shared_ptr<ASTLambdaFunctionNode> astnode) {
+void Compiler::visit(const std::shared_ptr<ASTLambdaFunctionNode>& astnode) {
 	astnode->fun->accept(this);
 	add_instruction(OpCode::OP_PUSH_FUNCTION, std::vector<Operand> {
 		Operand(current_module_stack.top()->name_space),
@@ -251,7 +283,7 @@ void Compiler::visit(std::shared_ptr<ASTLambdaFunctionNode> astnode) {
 	});
 }
 
-void Compiler::visit(std::shared_ptr<ASTBlockNode> astnode) {
+void Compiler::visit(const std::shared_ptr<ASTBlockNode>& astnode) {
 	push_scope();
 	for (const auto& statement : astnode->statements) {
 		statement->accept(this);
@@ -260,22 +292,22 @@ void Compiler::visit(std::shared_ptr<ASTBlockNode> astnode) {
 	pop_scope();
 }
 
-void Compiler::visit(std::shared_ptr<ASTExitNode> astnode) {
+void Compiler::visit(const std::shared_ptr<ASTExitNode>& astnode) {
 	astnode->exit_code->accept(this);
 	add_instruction(OpCode::OP_HALT);
 }
 
-void Compiler::visit(std::shared_ptr<ASTContinueNode>) {
+void Compiler::visit(const std::shared_ptr<ASTContinueNode>&) {
 	add_instruction(OpCode::OP_UNWIND);
 	start_pointers.top().push_back(add_instruction(OpCode::OP_JUMP, size_t(0)));
 }
 
-void Compiler::visit(std::shared_ptr<ASTBreakNode>) {
+void Compiler::visit(const std::shared_ptr<ASTBreakNode>&) {
 	add_instruction(OpCode::OP_UNWIND);
 	end_pointers.top().push_back(add_instruction(OpCode::OP_JUMP, size_t(0)));
 }
 
-void Compiler::visit(std::shared_ptr<ASTSwitchNode> astnode) {
+void Compiler::visit(const std::shared_ptr<ASTSwitchNode>& astnode) {
 	push_scope();
 
 	open_end_pointers();
@@ -318,7 +350,7 @@ void Compiler::visit(std::shared_ptr<ASTSwitchNode> astnode) {
 	pop_scope();
 }
 
-void Compiler::visit(std::shared_ptr<ASTElseIfNode> astnode) {
+void Compiler::visit(const std::shared_ptr<ASTElseIfNode>& astnode) {
 	astnode->condition->accept(this);
 
 	auto ip = add_instruction(OpCode::OP_JUMP_IF_FALSE, size_t(0));
@@ -330,7 +362,7 @@ void Compiler::visit(std::shared_ptr<ASTElseIfNode> astnode) {
 	replace_operand(ip, size_t(pointer));
 }
 
-void Compiler::visit(std::shared_ptr<ASTIfNode> astnode) {
+void Compiler::visit(const std::shared_ptr<ASTIfNode>& astnode) {
 	open_if_end_pointers();
 
 	astnode->condition->accept(this);
@@ -355,7 +387,7 @@ void Compiler::visit(std::shared_ptr<ASTIfNode> astnode) {
 
 }
 
-void Compiler::visit(std::shared_ptr<ASTForNode> astnode) {
+void Compiler::visit(const std::shared_ptr<ASTForNode>& astnode) {
 	push_scope();
 
 	open_end_pointers();
@@ -402,7 +434,7 @@ void Compiler::visit(std::shared_ptr<ASTForNode> astnode) {
 	pop_scope();
 }
 
-void Compiler::visit(std::shared_ptr<ASTInstructionNode> astnode) {
+void Compiler::visit(const std::shared_ptr<ASTInstructionNode>& astnode) {
 	switch (astnode->operand.type)
 	{
 	case OperandType::OT_RAW:
@@ -435,7 +467,7 @@ void Compiler::visit(std::shared_ptr<ASTInstructionNode> astnode) {
 	}
 }
 
-void Compiler::visit(std::shared_ptr<ASTForEachNode> astnode) {
+void Compiler::visit(const std::shared_ptr<ASTForEachNode>& astnode) {
 	push_scope();
 
 	open_end_pointers();
@@ -498,7 +530,7 @@ void Compiler::visit(std::shared_ptr<ASTForEachNode> astnode) {
 	pop_scope();
 }
 
-void Compiler::visit(std::shared_ptr<ASTTryCatchNode> astnode) {
+void Compiler::visit(const std::shared_ptr<ASTTryCatchNode>& astnode) {
 	auto tryip = add_instruction(OpCode::OP_TRY, size_t(0));
 
 	add_instruction(OpCode::OP_PUSH_DEEP);
@@ -582,14 +614,14 @@ void Compiler::visit(std::shared_ptr<ASTTryCatchNode> astnode) {
 
 }
 
-void Compiler::visit(std::shared_ptr<ASTThrowNode> astnode) {
+void Compiler::visit(const std::shared_ptr<ASTThrowNode>& astnode) {
 	astnode->error->accept(this);
 	add_instruction(OpCode::OP_THROW);
 }
 
-void Compiler::visit(std::shared_ptr<ASTEllipsisNode>) {}
+void Compiler::visit(const std::shared_ptr<ASTEllipsisNode>&) {}
 
-void Compiler::visit(std::shared_ptr<ASTWhileNode> astnode) {
+void Compiler::visit(const std::shared_ptr<ASTWhileNode>& astnode) {
 	open_end_pointers();
 	open_start_pointers();
 
@@ -613,7 +645,7 @@ void Compiler::visit(std::shared_ptr<ASTWhileNode> astnode) {
 	add_instruction(OpCode::OP_POP_DEEP);
 }
 
-void Compiler::visit(std::shared_ptr<ASTDoWhileNode> astnode) {
+void Compiler::visit(const std::shared_ptr<ASTDoWhileNode>& astnode) {
 	open_end_pointers();
 	open_start_pointers();
 
@@ -635,7 +667,7 @@ void Compiler::visit(std::shared_ptr<ASTDoWhileNode> astnode) {
 	add_instruction(OpCode::OP_POP_DEEP);
 }
 
-void Compiler::visit(std::shared_ptr<ASTStructDefinitionNode> astnode) {
+void Compiler::visit(const std::shared_ptr<ASTStructDefinitionNode>& astnode) {
 	add_instruction(OpCode::OP_STRUCT_START, flx_string(astnode->identifier));
 
 	for (const auto& var : astnode->variables) {
@@ -646,7 +678,7 @@ void Compiler::visit(std::shared_ptr<ASTStructDefinitionNode> astnode) {
 	add_instruction(OpCode::OP_STRUCT_END, current_module_stack.top()->name_space);
 }
 
-void Compiler::visit(std::shared_ptr<ASTClassDefinitionNode> astnode) {
+void Compiler::visit(const std::shared_ptr<ASTClassDefinitionNode>& astnode) {
 	current_this_name.push(std::make_pair("class", astnode->identifier));
 
 	// here we will create a temporary namespace to store class variables and functions
@@ -671,29 +703,29 @@ void Compiler::visit(std::shared_ptr<ASTClassDefinitionNode> astnode) {
 	current_this_name.pop();
 }
 
-void Compiler::visit(std::shared_ptr<ASTValueNode>) {}
+void Compiler::visit(const std::shared_ptr<ASTValueNode>&) {}
 
-void Compiler::visit(std::shared_ptr<ASTLiteralNode<flx_bool>> astnode) {
+void Compiler::visit(const std::shared_ptr<ASTLiteralNode<flx_bool>>& astnode) {
 	add_instruction(OpCode::OP_PUSH_BOOL, flx_bool(astnode->value));
 }
 
-void Compiler::visit(std::shared_ptr<ASTLiteralNode<flx_int>> astnode) {
+void Compiler::visit(const std::shared_ptr<ASTLiteralNode<flx_int>>& astnode) {
 	add_instruction(OpCode::OP_PUSH_INT, flx_int(astnode->value));
 }
 
-void Compiler::visit(std::shared_ptr<ASTLiteralNode<flx_float>> astnode) {
+void Compiler::visit(const std::shared_ptr<ASTLiteralNode<flx_float>>& astnode) {
 	add_instruction(OpCode::OP_PUSH_FLOAT, flx_float(astnode->value));
 }
 
-void Compiler::visit(std::shared_ptr<ASTLiteralNode<flx_char>> astnode) {
+void Compiler::visit(const std::shared_ptr<ASTLiteralNode<flx_char>>& astnode) {
 	add_instruction(OpCode::OP_PUSH_CHAR, flx_char(astnode->value));
 }
 
-void Compiler::visit(std::shared_ptr<ASTLiteralNode<flx_string>> astnode) {
+void Compiler::visit(const std::shared_ptr<ASTLiteralNode<flx_string>>& astnode) {
 	add_instruction(OpCode::OP_PUSH_STRING, flx_string(astnode->value));
 }
 
-void Compiler::visit(std::shared_ptr<ASTArrayConstructorNode> astnode) {
+void Compiler::visit(const std::shared_ptr<ASTArrayConstructorNode>& astnode) {
 	auto size = astnode->values.size();
 
 	type_definition_operations(*astnode);
@@ -707,7 +739,7 @@ void Compiler::visit(std::shared_ptr<ASTArrayConstructorNode> astnode) {
 	add_instruction(OpCode::OP_PUSH_ARRAY);
 }
 
-void Compiler::visit(std::shared_ptr<ASTStructConstructorNode> astnode) {
+void Compiler::visit(const std::shared_ptr<ASTStructConstructorNode>& astnode) {
 	add_instruction(OpCode::OP_INIT_STRUCT, std::vector<Operand>{
 		Operand(current_module_stack.top()->name_space),
 		Operand(current_module_stack.top()->name),
@@ -727,7 +759,7 @@ void Compiler::visit(std::shared_ptr<ASTStructConstructorNode> astnode) {
 	add_instruction(OpCode::OP_PUSH_STRUCT);
 }
 
-void Compiler::visit(std::shared_ptr<ASTIdentifierNode> astnode) {
+void Compiler::visit(const std::shared_ptr<ASTIdentifierNode>& astnode) {
 	auto identifier = astnode->identifier;
 	auto identifier_vector = astnode->identifier_vector;
 
@@ -749,7 +781,7 @@ void Compiler::visit(std::shared_ptr<ASTIdentifierNode> astnode) {
 	}
 }
 
-void Compiler::visit(std::shared_ptr<ASTBinaryExprNode> astnode) {
+void Compiler::visit(const std::shared_ptr<ASTBinaryExprNode>& astnode) {
 	add_instruction(OpCode::OP_PUSH_VAR_REF, flx_bool(Token::is_assignment_op(astnode->op)));
 	astnode->left->accept(this);
 	add_instruction(OpCode::OP_POP_VAR_REF);
@@ -775,7 +807,7 @@ void Compiler::visit(std::shared_ptr<ASTBinaryExprNode> astnode) {
 	}
 }
 
-void Compiler::visit(std::shared_ptr<ASTUnaryExprNode> astnode) {
+void Compiler::visit(const std::shared_ptr<ASTUnaryExprNode>& astnode) {
 	auto op = OpCode::OP_RES;
 	if (astnode->unary_op == "-") {
 		op = OpCode::OP_UNARY_SUB;
@@ -798,7 +830,7 @@ void Compiler::visit(std::shared_ptr<ASTUnaryExprNode> astnode) {
 	add_instruction(op);
 }
 
-void Compiler::visit(std::shared_ptr<ASTTernaryNode> astnode) {
+void Compiler::visit(const std::shared_ptr<ASTTernaryNode>& astnode) {
 	astnode->condition->accept(this);
 	size_t skip_false = add_instruction(OpCode::OP_JUMP_IF_FALSE, size_t(0));
 	astnode->value_if_true->accept(this);
@@ -808,21 +840,21 @@ void Compiler::visit(std::shared_ptr<ASTTernaryNode> astnode) {
 	replace_operand(skip_end, size_t(pointer));
 }
 
-void Compiler::visit(std::shared_ptr<ASTTypeCastNode> astnode) {
+void Compiler::visit(const std::shared_ptr<ASTTypeCastNode>& astnode) {
 	astnode->expr->accept(this);
 	add_instruction(OpCode::OP_TYPE_PARSE, uint8_t(astnode->type));
 }
 
-void Compiler::visit(std::shared_ptr<ASTTypeNode> astnode) {
+void Compiler::visit(const std::shared_ptr<ASTTypeNode>& astnode) {
 	type_definition_operations(astnode->type);
 	add_instruction(OpCode::OP_PUSH_TYPE);
 }
 
-void Compiler::visit(std::shared_ptr<ASTNullNode>) {
+void Compiler::visit(const std::shared_ptr<ASTNullNode>&) {
 	add_instruction(OpCode::OP_PUSH_VOID);
 }
 
-void Compiler::visit(std::shared_ptr<ASTThisNode> astnode) {
+void Compiler::visit(const std::shared_ptr<ASTThisNode>& astnode) {
 	std::make_shared<ASTStructConstructorNode>(
 		Constants::DEFAULT_NAMESPACE,
 		Constants::BUILTIN_STRUCT_NAMES[BuiltinStructs::BS_CONTEXT],
@@ -842,35 +874,35 @@ void Compiler::visit(std::shared_ptr<ASTThisNode> astnode) {
 	}
 }
 
-void Compiler::visit(std::shared_ptr<ASTTypeOfNode> astnode) {
+void Compiler::visit(const std::shared_ptr<ASTTypeOfNode>& astnode) {
 	astnode->expr->accept(this);
 
 	add_instruction(OpCode::OP_TYPEOF);
 }
 
-void Compiler::visit(std::shared_ptr<ASTTypeIdNode> astnode) {
+void Compiler::visit(const std::shared_ptr<ASTTypeIdNode>& astnode) {
 	astnode->expr->accept(this);
 
 	add_instruction(OpCode::OP_TYPEID);
 }
 
-void Compiler::visit(std::shared_ptr<ASTRefIdNode> astnode) {
+void Compiler::visit(const std::shared_ptr<ASTRefIdNode>& astnode) {
 	astnode->expr->accept(this);
 
 	add_instruction(OpCode::OP_REFID);
 }
 
-void Compiler::visit(std::shared_ptr<ASTIsStructNode> astnode) {
+void Compiler::visit(const std::shared_ptr<ASTIsStructNode>& astnode) {
 	astnode->expr->accept(this);
 	add_instruction(OpCode::OP_IS_STRUCT);
 }
 
-void Compiler::visit(std::shared_ptr<ASTIsArrayNode> astnode) {
+void Compiler::visit(const std::shared_ptr<ASTIsArrayNode>& astnode) {
 	astnode->expr->accept(this);
 	add_instruction(OpCode::OP_IS_ARRAY);
 }
 
-void Compiler::visit(std::shared_ptr<ASTIsAnyNode> astnode) {
+void Compiler::visit(const std::shared_ptr<ASTIsAnyNode>& astnode) {
 	astnode->expr->accept(this);
 	add_instruction(OpCode::OP_IS_ANY);
 }
@@ -935,28 +967,24 @@ void Compiler::remove_unused_constant(std::shared_ptr<ASTNode> astnode) {
 
 void Compiler::set_debug_info() {
 	if (current_debug_info_stack.empty()) {
-		vm_debug.debug_info_table[pointer] = std::vector<Operand>{
-			Operand(vm_debug.index_of_namespace(current_module_stack.top()->name_space)),
-			Operand(vm_debug.index_of_module(current_module_stack.top()->name)),
-			Operand(vm_debug.index_of_ast_type("<program>")),
-			Operand(size_t(0)),
-			Operand(flx_string("")),
-			Operand(size_t(0)),
-			Operand(size_t(0))
-		};
+		DebugEntry entry;
+		entry.name_space = vm_debug.index_of_namespace(current_module_stack.top()->name_space);
+		entry.module = vm_debug.index_of_module(current_module_stack.top()->name);
+		entry.ast_type = vm_debug.index_of_ast_type("<program>");
+		vm_debug.set_debug_entry(pointer, std::move(entry));
 		return;
 	}
 
 	const auto& debug_info = current_debug_info_stack.top();
-	vm_debug.debug_info_table[pointer] = std::vector<Operand>{
-		Operand(vm_debug.index_of_namespace(debug_info.module_name_space)),
-		Operand(vm_debug.index_of_module(debug_info.module_name)),
-		Operand(vm_debug.index_of_ast_type(debug_info.ast_type)),
-		Operand(vm_debug.index_of_namespace(debug_info.access_name_space)),
-		Operand(debug_info.identifier),
-		Operand(debug_info.row),
-		Operand(debug_info.col)
-	};
+	vm_debug.set_debug_entry(pointer, DebugEntry{
+		vm_debug.index_of_namespace(debug_info.module_name_space),
+		vm_debug.index_of_module(debug_info.module_name),
+		vm_debug.index_of_ast_type(debug_info.ast_type),
+		vm_debug.index_of_namespace(debug_info.access_name_space),
+		debug_info.identifier,
+		debug_info.row,
+		debug_info.col
+	});
 }
 
 template <typename T>
@@ -978,7 +1006,7 @@ size_t Compiler::add_instruction(OpCode opcode) {
 
 template <typename T>
 void Compiler::replace_operand(size_t pos, T operand) {
-	bytecode_program[pos].operand = Operand(operand);
+	bytecode_program[pos - segment_start].operand = Operand(operand);
 }
 
 void Compiler::open_start_pointers() {
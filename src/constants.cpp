@@ -11,6 +11,10 @@
 #include "md_http.hpp"
 #include "md_sys.hpp"
 #include "md_os.hpp"
+#include "md_threads.hpp"
+#include "md_async.hpp"
+#include "md_net.hpp"
+#include "md_json.hpp"
 
 using namespace core;
 
@@ -52,7 +56,8 @@ std::array<std::string, BuiltinFuncs::BF_SIZE> const Constants::BUILTIN_FUNCTION
 	"len",
 	"len",
 	"sleep",
-	"system"
+	"system",
+	"flush"
 };
 std::shared_ptr<modules::Module> const Constants::BUILTIN_FUNCTIONS = std::shared_ptr<modules::ModuleBuiltin>(new modules::ModuleBuiltin());
 
@@ -87,7 +92,11 @@ std::array<std::string, CoreLibs::CL_SIZE> const Constants::CORE_LIB_NAMES = {
 	"flx.core.sound",
 	"flx.core.HTTP",
 	"flx.core.sys",
-	"flx.core.os"
+	"flx.core.os",
+	"flx.core.threads",
+	"flx.core.async",
+	"flx.core.net",
+	"flx.core.JSON"
 };
 
 std::unordered_map<std::string, std::shared_ptr<modules::Module>> const Constants::CORE_LIBS = {
@@ -100,5 +109,23 @@ std::unordered_map<std::string, std::shared_ptr<modules::Module>> const Constant
 	{CORE_LIB_NAMES[CoreLibs::CL_SOUND], std::shared_ptr<modules::ModuleSound>(new modules::ModuleSound())},
 	{CORE_LIB_NAMES[CoreLibs::CL_HTTP], std::shared_ptr<modules::ModuleHTTP>(new modules::ModuleHTTP())},
 	{CORE_LIB_NAMES[CoreLibs::CL_SYS], std::shared_ptr<modules::ModuleSys>(new modules::ModuleSys())},
-	{CORE_LIB_NAMES[CoreLibs::CL_OS], std::shared_ptr<modules::ModuleOS>(new modules::ModuleOS())}
+	{CORE_LIB_NAMES[CoreLibs::CL_OS], std::shared_ptr<modules::ModuleOS>(new modules::ModuleOS())},
+	{CORE_LIB_NAMES[CoreLibs::CL_THREADS], std::shared_ptr<modules::ModuleThreads>(new modules::ModuleThreads())},
+	{CORE_LIB_NAMES[CoreLibs::CL_ASYNC], std::shared_ptr<modules::ModuleAsync>(new modules::ModuleAsync())},
+	{CORE_LIB_NAMES[CoreLibs::CL_NET], std::shared_ptr<modules::ModuleNet>(new modules::ModuleNet())},
+	{CORE_LIB_NAMES[CoreLibs::CL_JSON], std::shared_ptr<modules::ModuleJSON>(new modules::ModuleJSON())}
 };
+
+std::shared_ptr<modules::Module> Constants::find_native_lib(const std::string& libname, const modules::NativeLibs* host_libs) {
+	auto it = CORE_LIBS.find(libname);
+	if (it != CORE_LIBS.end()) {
+		return it->second;
+	}
+	if (host_libs) {
+		it = host_libs->find(libname);
+		if (it != host_libs->end()) {
+			return it->second;
+		}
+	}
+	return nullptr;
+}
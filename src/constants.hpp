@@ -46,6 +46,7 @@ namespace core {
 		BF_LENS,
 		BF_SLEEP,
 		BF_SYSTEM,
+		BF_FLUSH,
 		BF_SIZE
 	};
 
@@ -60,6 +61,10 @@ namespace core {
 		CL_HTTP,
 		CL_SYS,
 		CL_OS,
+		CL_THREADS,
+		CL_ASYNC,
+		CL_NET,
+		CL_JSON,
 		CL_SIZE
 	};
 
@@ -86,6 +91,8 @@ namespace core {
 		std::vector<std::string> static const STD_LIB_NAMES;
 		std::array<std::string, CoreLibs::CL_SIZE> static const CORE_LIB_NAMES;
 		std::unordered_map<std::string, std::shared_ptr<modules::Module>> static const CORE_LIBS;
+		// core library or host module implementing the lib natively, nullptr if none
+		static std::shared_ptr<modules::Module> find_native_lib(const std::string& libname, const modules::NativeLibs* host_libs);
 
 	};
 
@@ -0,0 +1,362 @@
+#include "dir_walker.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+#include <cctype>
+
+#ifdef linux
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <fcntl.h>
+#include <unistd.h>
+#else
+#include <filesystem>
+#include <chrono>
+#endif // linux
+
+using namespace utils;
+
+DirWalker::DirWalker(const std::string& root, const WalkFilter& filter, size_t threads)
+	: root(root), filter(filter) {
+	for (auto& extension : this->filter.extensions) {
+		if (!extension.empty() && extension[0] == '.') {
+			extension.erase(0, 1);
+		}
+		std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+	}
+
+	while (this->root.size() > 1 && (this->root.back() == '/' || this->root.back() == '\\')) {
+		this->root.pop_back();
+	}
+
+#ifdef linux
+	struct stat info;
+	if (stat(this->root.c_str(), &info) != 0 || !S_ISDIR(info.st_mode)) {
+		throw std::runtime_error("'" + root + "' is not a directory");
+	}
+	visited.emplace(uint64_t(info.st_dev), uint64_t(info.st_ino));
+#else
+	std::error_code error;
+	if (!std::filesystem::is_directory(this->root, error)) {
+		throw std::runtime_error("'" + root + "' is not a directory");
+	}
+	auto canonical = std::filesystem::weakly_canonical(this->root, error);
+	visited_paths.insert(error ? this->root : canonical.string());
+#endif // linux
+
+	// reading directories waits on the disk more than on the cpu
+	if (threads == 0) {
+		threads = std::max<size_t>(4, std::thread::hardware_concurrency());
+	}
+
+	directories.emplace_back(this->root, 1);
+	pending = 1;
+
+	for (size_t i = 0; i < threads; ++i) {
+		workers.emplace_back(&DirWalker::worker_loop, this);
+	}
+}
+
+DirWalker::~DirWalker() {
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopping = true;
+	}
+	work_available.notify_all();
+	room_available.notify_all();
+
+	for (auto& worker : workers) {
+		worker.join();
+	}
+}
+
+std::vector<WalkEntry> DirWalker::next(size_t max) {
+	std::unique_lock<std::mutex> lock(mutex);
+
+	entries_available.wait(lock, [this]() { return !entries.empty() || pending == 0; });
+
+	size_t count = std::min(max, entries.size());
+	std::vector<WalkEntry> batch(std::make_move_iterator(entries.begin()),
+		std::make_move_iterator(entries.begin() + count));
+	entries.erase(entries.begin(), entries.begin() + count);
+	lock.unlock();
+
+	room_available.notify_all();
+
+	return batch;
+}
+
+void DirWalker::worker_loop() {
+	std::unique_lock<std::mutex> lock(mutex);
+
+	while (true) {
+		work_available.wait(lock, [this]() { return stopping || !directories.empty() || pending == 0; });
+		if (stopping || directories.empty()) {
+			return;
+		}
+
+		// the deepest directory first keeps the stack small on wide trees
+		auto [path, depth] = std::move(directories.back());
+		directories.pop_back();
+		lock.unlock();
+
+		read_directory(path, depth);
+
+		lock.lock();
+		if (--pending == 0) {
+			work_available.notify_all();
+			entries_available.notify_all();
+		}
+	}
+}
+
+void DirWalker::read_directory(const std::string& path, int64_t depth) {
+	std::vector<WalkEntry> found;
+	std::vector<std::pair<std::string, int64_t>> subdirectories;
+	std::string prefix = path.back() == '/' ? path : path + "/";
+
+#ifdef linux
+	int dir = open(path.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+	if (dir < 0) {
+		return;
+	}
+
+	struct linux_dirent64 {
+		uint64_t d_ino;
+		int64_t d_off;
+		unsigned short d_reclen;
+		unsigned char d_type;
+		char d_name[];
+	};
+
+	// one call reads hundreds of names, where readdir would copy them one by one
+	alignas(linux_dirent64) char buffer[65536];
+	long count;
+	while ((count = syscall(SYS_getdents64, dir, buffer, sizeof(buffer))) > 0) {
+		for (long offset = 0; offset < count;) {
+			auto dirent = reinterpret_cast<linux_dirent64*>(buffer + offset);
+			offset += dirent->d_reclen;
+
+			std::string name = dirent->d_name;
+			if (name == "." || name == "..") {
+				continue;
+			}
+
+			struct stat info;
+			if (fstatat(dir, dirent->d_name, &info, AT_SYMLINK_NOFOLLOW) != 0) {
+				continue;
+			}
+			bool link = S_ISLNK(info.st_mode);
+			if (link && filter.follow_links && fstatat(dir, dirent->d_name, &info, 0) != 0) {
+				continue;
+			}
+
+			WalkEntry entry;
+			entry.path = prefix + name;
+			entry.name = std::move(name);
+			entry.is_dir = S_ISDIR(info.st_mode);
+			entry.size = entry.is_dir ? 0 : int64_t(info.st_size);
+			entry.modified = int64_t(info.st_mtime);
+
+			add_entry(std::move(entry), depth, uint64_t(info.st_dev), uint64_t(info.st_ino), std::string(), found, subdirectories);
+		}
+	}
+	close(dir);
+#else
+	std::error_code error;
+	std::filesystem::directory_iterator it(path, error);
+	if (error) {
+		return;
+	}
+
+	for (; it != std::filesystem::directory_iterator(); it.increment(error)) {
+		if (error) {
+			break;
+		}
+
+		bool link = it->is_symlink(error);
+		auto status = filter.follow_links ? it->status(error) : it->symlink_status(error);
+		if (error) {
+			continue;
+		}
+
+		WalkEntry entry;
+		entry.path = prefix + it->path().filename().string();
+		entry.name = it->path().filename().string();
+		entry.is_dir = std::filesystem::is_directory(status);
+		entry.size = entry.is_dir || (link && !filter.follow_links) ? 0 : int64_t(it->file_size(error));
+		auto modified = it->last_write_time(error);
+		entry.modified = std::chrono::duration_cast<std::chrono::seconds>(
+			modified - std::filesystem::file_time_type::clock::now() + std::chrono::system_clock::now().time_since_epoch()
+		).count();
+
+		// there are no inodes to tell a directory reached again through a link, a
+		// link without a canonical path is not walked since it could lead back up
+		std::string canonical;
+		if (entry.is_dir) {
+			auto canonical_path = std::filesystem::weakly_canonical(it->path(), error);
+			canonical = !error ? canonical_path.string() : link ? "" : entry.path;
+		}
+
+		add_entry(std::move(entry), depth, 0, 0, canonical, found, subdirectories);
+	}
+#endif // linux
+
+	if (found.empty() && subdirectories.empty()) {
+		return;
+	}
+
+	std::unique_lock<std::mutex> lock(mutex);
+
+	if (!subdirectories.empty()) {
+		pending += subdirectories.size();
+		for (auto& subdirectory : subdirectories) {
+			directories.push_back(std::move(subdirectory));
+		}
+		work_available.notify_all();
+	}
+
+	if (!found.empty()) {
+		room_available.wait(lock, [this]() { return stopping || entries.size() < MAX_QUEUED; });
+		if (stopping) {
+			return;
+		}
+		for (auto& entry : found) {
+			entries.push_back(std::move(entry));
+		}
+		entries_available.notify_all();
+	}
+}
+
+void DirWalker::add_entry(WalkEntry entry, int64_t depth, [[maybe_unused]] uint64_t device, [[maybe_unused]] uint64_t inode,
+	[[maybe_unused]] const std::string& canonical,
+	std::vector<WalkEntry>& found, std::vector<std::pair<std::string, int64_t>>& subdirectories) {
+	if (entry.is_dir && (filter.max_depth <= 0 || depth < filter.max_depth)) {
+		bool walk = false;
+		// a directory reached both through a link and its own path is walked once,
+		// whichever of them is read first
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+#ifdef linux
+			walk = visited.emplace(device, inode).second;
+#else
+			walk = !canonical.empty() && visited_paths.insert(canonical).second;
+#endif // linux
+		}
+		if (walk) {
+			subdirectories.emplace_back(entry.path, depth + 1);
+		}
+	}
+
+	if (matches(entry)) {
+		found.push_back(std::move(entry));
+	}
+}
+
+bool DirWalker::matches(const WalkEntry& entry) const {
+	if (entry.is_dir && !filter.include_dirs) {
+		return false;
+	}
+	if (!filter.pattern.empty() && !glob_match(filter.pattern, entry.name)) {
+		return false;
+	}
+	if (filter.modified_after >= 0 && entry.modified < filter.modified_after) {
+		return false;
+	}
+	if (filter.modified_before >= 0 && entry.modified >= filter.modified_before) {
+		return false;
+	}
+	if (entry.is_dir) {
+		return true;
+	}
+	if (filter.min_size >= 0 && entry.size < filter.min_size) {
+		return false;
+	}
+	if (filter.max_size >= 0 && entry.size > filter.max_size) {
+		return false;
+	}
+	if (!filter.extensions.empty()) {
+		auto dot = entry.name.rfind('.');
+		if (dot == std::string::npos || dot == 0) {
+			return false;
+		}
+		std::string extension = entry.name.substr(dot + 1);
+		std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+		if (std::find(filter.extensions.begin(), filter.extensions.end(), extension) == filter.extensions.end()) {
+			return false;
+		}
+	}
+	return true;
+}
+
+bool DirWalker::glob_match(const std::string& pattern, const std::string& name) {
+	size_t p = 0;
+	size_t n = 0;
+	// where to resume after the last star, matching one more character with it
+	size_t star = std::string::npos;
+	size_t star_n = 0;
+
+	while (n < name.size()) {
+		if (p < pattern.size() && pattern[p] == '*') {
+			star = p++;
+			star_n = n;
+			continue;
+		}
+
+		if (p < pattern.size()) {
+			if (pattern[p] == '?') {
+				++p;
+				++n;
+				continue;
+			}
+
+			if (pattern[p] == '[') {
+				size_t i = p + 1;
+				bool negate = i < pattern.size() && (pattern[i] == '!' || pattern[i] == '^');
+				if (negate) {
+					++i;
+				}
+				bool found = false;
+				size_t start = i;
+				for (; i < pattern.size() && (pattern[i] != ']' || i == start); ++i) {
+					if (i + 2 < pattern.size() && pattern[i + 1] == '-' && pattern[i + 2] != ']') {
+						found = found || (name[n] >= pattern[i] && name[n] <= pattern[i + 2]);
+						i += 2;
+					}
+					else {
+						found = found || name[n] == pattern[i];
+					}
+				}
+				// an unclosed class is an ordinary character
+				if (i >= pattern.size()) {
+					if (name[n] == '[') {
+						++p;
+						++n;
+						continue;
+					}
+				}
+				else if (found != negate) {
+					p = i + 1;
+					++n;
+					continue;
+				}
+			}
+			else if (pattern[p] == name[n]) {
+				++p;
+				++n;
+				continue;
+			}
+		}
+
+		if (star == std::string::npos) {
+			return false;
+		}
+		p = star + 1;
+		n = ++star_n;
+	}
+
+	while (p < pattern.size() && pattern[p] == '*') {
+		++p;
+	}
+	return p == pattern.size();
+}
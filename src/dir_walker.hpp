@@ -0,0 +1,92 @@
+#ifndef DIR_WALKER_HPP
+#define DIR_WALKER_HPP
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <set>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <cstdint>
+
+namespace utils {
+
+	struct WalkFilter {
+		// glob on the name of the entry, with *, ? and [...] classes
+		std::string pattern;
+		// extensions of the files without the dot, compared ignoring case
+		std::vector<std::string> extensions;
+		// limits of the files, -1 when not set
+		int64_t min_size = -1;
+		int64_t max_size = -1;
+		// unix timestamps in seconds, -1 when not set
+		int64_t modified_after = -1;
+		int64_t modified_before = -1;
+		// entries of the root are at depth 1, 0 walks the whole tree
+		int64_t max_depth = 0;
+		bool include_dirs = false;
+		bool follow_links = false;
+	};
+
+	struct WalkEntry {
+		std::string path;
+		std::string name;
+		bool is_dir = false;
+		int64_t size = 0;
+		int64_t modified = 0;
+	};
+
+	/*
+		Walks a directory tree on a few threads sharing a stack of directories
+		to read, so the reads and stats of several directories overlap. The
+		entries passing the filter are queued until taken by next, and the
+		walkers wait while too many entries are queued. Directories that cannot
+		be read are skipped.
+	*/
+	class DirWalker {
+	private:
+		static constexpr size_t MAX_QUEUED = 65536;
+
+		std::string root;
+		WalkFilter filter;
+
+		std::vector<std::thread> workers;
+		std::mutex mutex;
+		std::condition_variable work_available;
+		std::condition_variable entries_available;
+		std::condition_variable room_available;
+
+		std::vector<std::pair<std::string, int64_t>> directories;
+		// directories queued or being read, the walk is over at zero
+		size_t pending = 0;
+		std::deque<WalkEntry> entries;
+		// device and inode of the directories walked, so each one is walked once
+		std::set<std::pair<uint64_t, uint64_t>> visited;
+		// canonical paths of the directories walked where there are no inodes
+		std::set<std::string> visited_paths;
+		bool stopping = false;
+
+	public:
+		// a size of 0 picks the number of threads
+		DirWalker(const std::string& root, const WalkFilter& filter, size_t threads = 0);
+		~DirWalker();
+
+		// waits for at most max entries, empty once the walk is over
+		std::vector<WalkEntry> next(size_t max);
+
+		static bool glob_match(const std::string& pattern, const std::string& name);
+
+	private:
+		void worker_loop();
+		void read_directory(const std::string& path, int64_t depth);
+		// queues the entry if it passes the filter and the directory to walk, a
+		// directory is known by its device and inode or else by its canonical path
+		void add_entry(WalkEntry entry, int64_t depth, uint64_t device, uint64_t inode, const std::string& canonical,
+			std::vector<WalkEntry>& found, std::vector<std::pair<std::string, int64_t>>& subdirectories);
+		bool matches(const WalkEntry& entry) const;
+	};
+
+}
+
+#endif // !DIR_WALKER_HPP
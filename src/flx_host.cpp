@@ -0,0 +1,61 @@
+#include "flx_host.hpp"
+
+#include <algorithm>
+
+using namespace interpreter;
+using namespace core;
+using namespace core::runtime;
+
+FlexaContext::FlexaContext(std::shared_ptr<const FlexaProgram> program)
+	: program(program),
+	vm(std::make_shared<Scope>(program->name_space, program->name), program->vm_debug, program->bytecode_program) {
+	vm.host_libs = program->host_libs;
+	vm.run();
+}
+
+RuntimeValue* FlexaContext::call(const std::string& identifier, const std::vector<RuntimeValue*>& arguments, const std::string& name_space) {
+	return vm.call(program->name_space, program->name, name_space, identifier, arguments);
+}
+
+RuntimeValue* FlexaContext::make_array(const std::vector<RuntimeValue*>& values) {
+	flx_array arr = flx_array(values.size());
+
+	for (size_t i = 0; i < values.size(); ++i) {
+		arr[i] = values[i];
+	}
+
+	return vm.allocate_value(new RuntimeValue(arr, Type::T_ANY, std::vector<size_t>{ values.size() }));
+}
+
+VirtualMachine& FlexaContext::get_vm() {
+	return vm;
+}
+
+static FlexaCliArgs build_host_args(const std::string& workspace_path, const std::string& libs_path) {
+	FlexaCliArgs args;
+	args.workspace_path = workspace_path;
+	args.libs_path = libs_path;
+	return args;
+}
+
+FlexaHost::FlexaHost(const std::string& workspace_path, const std::string& libs_path)
+	: interpreter(build_host_args(workspace_path, libs_path)) {}
+
+void FlexaHost::register_module(const std::string& lib_name, std::shared_ptr<modules::Module> module, const std::string& declarations) {
+	interpreter.add_native_lib(lib_name, module);
+
+	auto path = lib_name;
+	std::replace(path.begin(), path.end(), '.', '/');
+	interpreter.add_source(path + ".flx", declarations);
+}
+
+std::shared_ptr<const FlexaProgram> FlexaHost::compile(const std::string& main_file, const std::vector<std::string>& source_files) {
+	std::vector<std::string> files = source_files;
+	files.emplace(files.begin(), main_file);
+
+	return std::make_shared<const FlexaProgram>(interpreter.compile(files));
+}
+
+std::shared_ptr<FlexaContext> FlexaHost::create_context(std::shared_ptr<const FlexaProgram> program) {
+	return std::make_shared<FlexaContext>(program);
+}
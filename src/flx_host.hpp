@@ -0,0 +1,80 @@
+#ifndef FLX_HOST_HPP
+#define FLX_HOST_HPP
+
+#include <string>
+#include <vector>
+#include <memory>
+
+#include "flx_interpreter.hpp"
+#include "module.hpp"
+#include "types.hpp"
+#include "vm.hpp"
+
+namespace interpreter {
+
+	/*
+		A vm running a compiled program, its globals live between calls.
+		Creating a context only runs the top level of the program, the parse,
+		analysis and compile steps are shared by all contexts of the program.
+		A context is not thread safe, a host keeps one per thread.
+	*/
+	class FlexaContext {
+	private:
+		std::shared_ptr<const FlexaProgram> program;
+		core::runtime::VirtualMachine vm;
+
+	public:
+		FlexaContext(std::shared_ptr<const FlexaProgram> program);
+
+		// calls a function of the main module, or of name_space, the result is valid until the next call
+		core::RuntimeValue* call(
+			const std::string& identifier,
+			const std::vector<core::RuntimeValue*>& arguments = {},
+			const std::string& name_space = ""
+		);
+
+		// wraps a native bool, int, float, char or string value as an argument
+		template<typename T>
+		core::RuntimeValue* make_value(T value) {
+			return vm.allocate_value(new core::RuntimeValue(value));
+		}
+
+		core::RuntimeValue* make_array(const std::vector<core::RuntimeValue*>& values);
+
+		core::runtime::VirtualMachine& get_vm();
+
+	};
+
+	/*
+		Entry point for embedding Flexa. Native modules are registered before
+		compiling, they are used like the core libraries, with a using statement.
+	*/
+	class FlexaHost {
+	private:
+		FlexaInterpreter interpreter;
+
+	public:
+		FlexaHost(const std::string& workspace_path, const std::string& libs_path = "");
+
+		/*
+			Registers a native module as lib_name, e.g. "app.db". The declarations are
+			the Flexa source of the module, its functions have no body and are
+			dispatched to the vm builtin functions registered by the module, which
+			read their parameters from vm->get_back_scope(<module namespace>).
+		*/
+		void register_module(
+			const std::string& lib_name,
+			std::shared_ptr<core::modules::Module> module,
+			const std::string& declarations
+		);
+
+		// compiles the main file and every module it uses, relative to the workspace
+		std::shared_ptr<const FlexaProgram> compile(const std::string& main_file, const std::vector<std::string>& source_files = {});
+
+		std::shared_ptr<FlexaContext> create_context(std::shared_ptr<const FlexaProgram> program);
+
+	};
+
+}
+
+#endif // !FLX_HOST_HPP
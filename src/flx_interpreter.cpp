@@ -1,14 +1,21 @@
 #include "flx_interpreter.hpp"
 
 #include <filesystem>
+#include <deque>
+#include <unordered_set>
+#include <mutex>
+#include <functional>
 
 #include "lexer.hpp"
 #include "parser.hpp"
 #include "utils.hpp"
-#include "dependency_resolver.hpp"
+#include "thread_pool.hpp"
+#include "output_buffer.hpp"
 #include "compiler.hpp"
 #include "vm.hpp"
 #include "semantic_analysis.hpp"
+#include "constants.hpp"
+#include "md_threads.hpp"
 
 using namespace interpreter;
 using namespace core;
@@ -22,6 +29,10 @@ FlexaInterpreter::FlexaInterpreter(const FlexaCliArgs& args)
 	args(args) {}
 
 core::flx_int FlexaInterpreter::execute() {
+	if (!args.resume_path.empty()) {
+		return resume();
+	}
+
 	if (!args.main_file.empty() || args.source_files.size() > 0) {
 		return interpreter();
 	}
@@ -38,6 +49,11 @@ FlexaSource FlexaInterpreter::load_module(const std::string& source) {
 	if (std::filesystem::exists(project_root + current_file_path)) {
 		current_full_path = project_root + current_file_path;
 	}
+	else if (auto it = sources.find(current_file_path); it != sources.end()) {
+		source_module = FlexaSource{ FlxUtils::get_lib_name(source), it->second };
+		FlxUtils::normalize_source(source_module.source);
+		return source_module;
+	}
 	else if (std::filesystem::exists(libs_root + current_file_path)) {
 		current_full_path = libs_root + current_file_path;
 	}
@@ -50,27 +66,91 @@ FlexaSource FlexaInterpreter::load_module(const std::string& source) {
 	return source_module;
 }
 
-std::vector<FlexaSource> FlexaInterpreter::load_modules(const std::vector<std::string>& source_files) {
-	std::vector<FlexaSource> source_modules;
+std::shared_ptr<ASTModuleNode> FlexaInterpreter::parse_module(const FlexaSource& source) {
+	Lexer lexer(source.name, source.source);
+	parser::Parser parser(source.name, &lexer);
+
+	return parser.parse_module();
+}
+
+void FlexaInterpreter::parse_modules(const std::vector<std::string>& source_files, std::shared_ptr<ASTModuleNode>* main_module,
+	std::map<std::string, std::shared_ptr<ASTModuleNode>>* modules) {
+
+	struct ParsedModule {
+		std::string path;
+		std::shared_ptr<ASTModuleNode> module;
+		std::string error;
+	};
+
+	// deque keeps references stable while other tasks schedule new modules
+	std::deque<ParsedModule> parsed_modules;
+	std::unordered_set<std::string> scheduled_libs;
+	std::mutex mutex;
+	utils::ThreadPool pool;
+
+	std::function<void(const std::string&)> schedule;
+
+	auto load_task = [this, &schedule](ParsedModule& parsed_module) {
+		try {
+			parsed_module.module = parse_module(load_module(parsed_module.path));
+
+			if (!parsed_module.module) {
+				return;
+			}
+
+			// dependencies are discovered as soon as a module is parsed,
+			// so they do not wait for the other modules of the same level
+			for (const auto& statement : parsed_module.module->statements) {
+				if (auto using_node = std::dynamic_pointer_cast<ASTUsingNode>(statement)) {
+					schedule(utils::StringUtils::replace(
+						utils::StringUtils::join(using_node->library, "."),
+						".",
+						std::string{ std::filesystem::path::preferred_separator }
+					) + ".flx");
+				}
+			}
+		}
+		catch (const std::exception& e) {
+			parsed_module.error = e.what();
+		}
+		};
+
+	schedule = [&](const std::string& path) {
+		ParsedModule* parsed_module = nullptr;
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			if (!scheduled_libs.insert(FlxUtils::get_lib_name(path)).second) {
+				return;
+			}
+			parsed_module = &parsed_modules.emplace_back(ParsedModule{ path, nullptr, "" });
+		}
+		pool.submit([parsed_module, &load_task]() { load_task(*parsed_module); });
+		};
 
 	for (const auto& source : source_files) {
-		source_modules.push_back(load_module(source));
+		schedule(source);
 	}
 
-	return source_modules;
-}
+	pool.wait();
 
-void FlexaInterpreter::parse_modules(const std::vector<FlexaSource>& source_modules, std::shared_ptr<ASTModuleNode>* main_module,
-	std::map<std::string, std::shared_ptr<ASTModuleNode>>* modules) {
+	// the given source files are reported in order, then the libraries by name,
+	// so the result does not depend on the thread scheduling
+	const size_t source_files_size = std::min(source_files.size(), parsed_modules.size());
+	std::sort(parsed_modules.begin() + source_files_size, parsed_modules.end(), [](const auto& a, const auto& b) {
+		return a.path < b.path;
+		});
 
-	for (const auto& source : source_modules) {
-		Lexer lexer(source.name, source.source);
-		parser::Parser parser(source.name , &lexer);
+	for (const auto& parsed_module : parsed_modules) {
+		if (!parsed_module.error.empty()) {
+			throw std::runtime_error(parsed_module.error);
+		}
+	}
 
-		std::shared_ptr<ASTModuleNode> module = parser.parse_module();
+	for (const auto& parsed_module : parsed_modules) {
+		const auto& module = parsed_module.module;
 
 		if (!module) {
-			std::cerr << "Failed to parse module: " << source.name << std::endl;
+			std::cerr << "Failed to parse module: " << FlxUtils::get_lib_name(parsed_module.path) << std::endl;
 			continue;
 		}
 
@@ -82,64 +162,129 @@ void FlexaInterpreter::parse_modules(const std::vector<FlexaSource>& source_modu
 	}
 }
 
+void FlexaInterpreter::add_source(const std::string& path, const std::string& source) {
+	sources[std::string{ std::filesystem::path::preferred_separator } + utils::PathUtils::normalize_path_sep(path)] = source;
+}
+
+void FlexaInterpreter::add_native_lib(const std::string& lib_name, std::shared_ptr<modules::Module> module) {
+	auto libs = host_libs ? std::make_shared<modules::NativeLibs>(*host_libs) : std::make_shared<modules::NativeLibs>();
+	(*libs)[lib_name] = module;
+	host_libs = libs;
+}
+
+FlexaProgram FlexaInterpreter::compile(const std::vector<std::string>& source_files) {
+	std::shared_ptr<ASTModuleNode> main_module = nullptr;
+	std::map<std::string, std::shared_ptr<ASTModuleNode>> modules;
+	parse_modules(source_files, &main_module, &modules);
+
+	if (!main_module) {
+		throw std::runtime_error("main module could not be parsed");
+	}
+
+	std::shared_ptr<Scope> semantic_global_scope = std::make_shared<Scope>(main_module->name_space, main_module->name);
+
+	SemanticAnalyser semantic_analyser(semantic_global_scope, main_module, modules, args.program_args);
+	semantic_analyser.host_libs = host_libs;
+	semantic_analyser.start();
+
+	Compiler compiler(main_module, modules);
+	compiler.host_libs = host_libs;
+	compiler.start();
+
+	return FlexaProgram{
+		main_module->name_space,
+		main_module->name,
+		std::move(compiler.vm_debug),
+		std::make_shared<std::vector<BytecodeInstruction>>(std::move(compiler.bytecode_program)),
+		host_libs
+	};
+}
+
 core::flx_int FlexaInterpreter::interpreter() {
-	FlexaSource main_module_src;
-	std::vector<FlexaSource> source_modules;
+	std::vector<std::string> source_files = args.source_files;
+	source_files.emplace(source_files.begin(), args.main_file);
+
 	try {
-		main_module_src = load_module(args.main_file);
-		source_modules = load_modules(args.source_files);
-		source_modules.emplace(source_modules.begin(), main_module_src);
+		auto program = compile(source_files);
+
+		if (args.debug) {
+			BytecodeInstruction::write_bytecode_table(*program.bytecode_program, project_root + "\\" + program.name + ".flxt");
+		}
+
+		// execute
+		VirtualMachine vm(std::make_shared<Scope>(program.name_space, program.name), std::move(program.vm_debug), program.bytecode_program);
+
+		return run_vm(vm);
 	}
 	catch (const std::runtime_error& e) {
+		utils::OutputBuffer::standard_output().flush();
 		std::cerr << e.what() << std::endl;
 		return EXIT_FAILURE;
 	}
 
+	return EXIT_SUCCESS;
+}
+
+core::flx_int FlexaInterpreter::resume() {
 	try {
-		std::shared_ptr<ASTModuleNode> main_module = nullptr;
-		std::map<std::string, std::shared_ptr<ASTModuleNode>> modules;
-		parse_modules(source_modules, &main_module, &modules);
-		size_t libs_size = 0;
-		do {
-			DependencyResolver dependency_resolver(main_module, modules);
-			dependency_resolver.start();
-
-			libs_size = dependency_resolver.lib_names.size();
-
-			if (libs_size > 0) {
-				auto flxlib_modules = load_modules(dependency_resolver.lib_names);
-				parse_modules(flxlib_modules, &main_module, &modules);
-			}
-		} while (libs_size > 0);
+		// the program, its scopes and values all come from the snapshot
+		VirtualMachine vm(std::make_shared<Scope>(Constants::DEFAULT_NAMESPACE, ""), VmDebug(), std::vector<BytecodeInstruction>());
+		vm.load_snapshot(args.resume_path);
+
+		return run_vm(vm);
+	}
+	catch (const std::runtime_error& e) {
+		utils::OutputBuffer::standard_output().flush();
+		std::cerr << e.what() << std::endl;
+		return EXIT_FAILURE;
+	}
+}
 
-		std::shared_ptr<Scope> semantic_global_scope = std::make_shared<Scope>(main_module->name_space, main_module->name);
-		std::shared_ptr<Scope> interpreter_global_scope = std::make_shared<Scope>(main_module->name_space, main_module->name);
+void FlexaInterpreter::end_workers() {
+	auto threads = Constants::CORE_LIBS.at(Constants::CORE_LIB_NAMES[CoreLibs::CL_THREADS]);
+	std::static_pointer_cast<modules::ModuleThreads>(threads)->end_workers();
+}
 
-		SemanticAnalyser semantic_analyser(semantic_global_scope, main_module, modules, args.program_args);
-		semantic_analyser.start();
+core::flx_int FlexaInterpreter::run_vm(VirtualMachine& vm) {
+	if (!args.profile_path.empty()) {
+		vm.profiler = std::make_shared<VmProfiler>(args.profile_path, args.profile_interval);
+		vm.profiler->start();
+	}
 
-		core::flx_int result = 0;
+	if (args.stats) {
+		vm.stats = std::make_shared<VmStats>();
+	}
 
-		// compile
-		Compiler compiler(main_module, modules);
-		compiler.start();
+	vm.gc.stats.track_allocation_sites = args.gc_stats;
 
-		if (args.debug) {
-			BytecodeInstruction::write_bytecode_table(compiler.bytecode_program, project_root + "\\" + main_module->name + ".flxt");
-		}
+	struct WorkersGuard {
+		~WorkersGuard() { end_workers(); }
+	} workers_guard;
 
-		// execute
-		VirtualMachine vm(interpreter_global_scope, compiler.vm_debug, compiler.bytecode_program);
-		vm.run();
+	vm.run();
 
-		result = vm.get_evaluation_stack_top()->get_i();
+	// the reports go to std::cerr after what the program printed
+	utils::OutputBuffer::standard_output().flush();
 
-		return result;
+	if (vm.profiler) {
+		vm.profiler->stop();
+		vm.profiler->write_folded_stacks();
+		vm.profiler->print_summary(std::cerr);
 	}
-	catch (const std::runtime_error& e) {
-		std::cerr << e.what() << std::endl;
-		return EXIT_FAILURE;
+
+	if (vm.stats) {
+		vm.stats->finish();
+		if (args.stats_json_path.empty()) {
+			vm.stats->print_table(std::cerr);
+		}
+		else {
+			vm.stats->write_json(args.stats_json_path);
+		}
 	}
 
-	return EXIT_SUCCESS;
+	if (args.gc_stats) {
+		vm.print_gc_stats(std::cerr);
+	}
+
+	return vm.get_evaluation_stack_top()->get_i();
 }
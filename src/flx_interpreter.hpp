@@ -5,34 +5,69 @@
 #include <vector>
 #include <map>
 #include <memory>
+#include <unordered_map>
 
 #include "ast.hpp"
 #include "flx_utils.hpp"
+#include "vm.hpp"
 
 namespace interpreter {
 
+	// compiled program, ready to be loaded by any number of vms
+	struct FlexaProgram {
+		std::string name_space;
+		std::string name;
+		core::VmDebug vm_debug;
+		std::shared_ptr<const std::vector<core::BytecodeInstruction>> bytecode_program;
+		// native libs the program was compiled against, its vms register them
+		std::shared_ptr<const core::modules::NativeLibs> host_libs;
+	};
+
 	class FlexaInterpreter {
 	private:
 		std::string project_root;
 		std::string libs_root;
 		FlexaCliArgs args;
+		// in memory modules, keyed like the paths looked up under the libs root
+		std::unordered_map<std::string, std::string> sources;
+		// replaced on each registration, so programs compiled before keep theirs
+		std::shared_ptr<const core::modules::NativeLibs> host_libs;
 
 	public:
 		FlexaInterpreter(const FlexaCliArgs& args);
 
 		core::flx_int execute();
 
+		// makes a module available to using statements without a file, e.g. flx/host/db.flx
+		void add_source(const std::string& path, const std::string& source);
+		// makes a native module available as lib_name to the programs compiled next
+		void add_native_lib(const std::string& lib_name, std::shared_ptr<core::modules::Module> module);
+
+		// parses, analyses and compiles the source files, the first one is the main module
+		FlexaProgram compile(const std::vector<std::string>& source_files);
+
+		// ends the workers the program left running, before the statics they use go away
+		static void end_workers();
+
 	private:
 		FlexaSource load_module(const std::string& source);
-		std::vector<FlexaSource> load_modules(const std::vector<std::string>& source_files);
+		std::shared_ptr<core::ASTModuleNode> parse_module(const FlexaSource& source);
 
+		/*
+			Loads and parses the source files and all libraries reached through
+			using statements, independent modules are handled in parallel.
+			The first source file is the main module.
+		*/
 		void parse_modules(
-			const std::vector<FlexaSource>& source_modules,
+			const std::vector<std::string>& source_files,
 			std::shared_ptr<core::ASTModuleNode>* main_module,
 			std::map<std::string, std::shared_ptr<core::ASTModuleNode>>* modules
 		);
 
 		core::flx_int interpreter();
+		// runs a program restored from a heap snapshot, no source is loaded
+		core::flx_int resume();
+		core::flx_int run_vm(core::runtime::VirtualMachine& vm);
 
 	};
 
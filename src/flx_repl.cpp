@@ -8,8 +8,10 @@
 #include "compiler.hpp"
 #include "vm.hpp"
 #include "utils.hpp"
+#include "output_buffer.hpp"
 #include "types.hpp"
 #include "constants.hpp"
+#include "flx_interpreter.hpp"
 
 using namespace interpreter;
 using namespace core;
@@ -17,6 +19,78 @@ using namespace core::parser;
 using namespace core::analysis;
 using namespace core::runtime;
 
+ReplDeclarations::ReplDeclarations(std::shared_ptr<Scope> scope, std::shared_ptr<ASTModuleNode> module)
+	: scope(scope) {
+	for (const auto& statement : module->statements) {
+		if (const auto& decl = std::dynamic_pointer_cast<ASTDeclarationNode>(statement)) {
+			add_variable(decl->identifier);
+		}
+		else if (const auto& udecl = std::dynamic_pointer_cast<ASTUnpackedDeclarationNode>(statement)) {
+			for (const auto& decl : udecl->declarations) {
+				add_variable(decl->identifier);
+			}
+		}
+		else if (const auto& func = std::dynamic_pointer_cast<ASTFunctionDefinitionNode>(statement)) {
+			auto& overloads = functions[func->identifier];
+			overloads.clear();
+			auto range = scope->function_symbol_table.equal_range(func->identifier);
+			for (auto it = range.first; it != range.second; ++it) {
+				overloads.push_back(it->second);
+			}
+		}
+		else if (const auto& str = std::dynamic_pointer_cast<ASTStructDefinitionNode>(statement)) {
+			auto it = scope->struct_symbol_table.find(str->identifier);
+			structs[str->identifier] = it != scope->struct_symbol_table.end() ? it->second : nullptr;
+		}
+		else if (const auto& cls = std::dynamic_pointer_cast<ASTClassDefinitionNode>(statement)) {
+			auto it = scope->class_symbol_table.find(cls->identifier);
+			classes[cls->identifier] = it != scope->class_symbol_table.end() ? it->second : nullptr;
+		}
+	}
+}
+
+ReplDeclarations::~ReplDeclarations() {
+	if (!committed) {
+		rollback();
+	}
+}
+
+void ReplDeclarations::commit() {
+	committed = true;
+}
+
+void ReplDeclarations::add_variable(const std::string& identifier) {
+	auto it = scope->variable_symbol_table.find(identifier);
+	variables[identifier] = it != scope->variable_symbol_table.end() ? it->second : nullptr;
+}
+
+void ReplDeclarations::rollback() {
+	for (const auto& [identifier, variable] : variables) {
+		scope->variable_symbol_table.erase(identifier);
+		if (variable) {
+			scope->variable_symbol_table.emplace(identifier, variable);
+		}
+	}
+	for (const auto& [identifier, structure] : structs) {
+		scope->struct_symbol_table.erase(identifier);
+		if (structure) {
+			scope->struct_symbol_table.emplace(identifier, structure);
+		}
+	}
+	for (const auto& [identifier, cls] : classes) {
+		scope->class_symbol_table.erase(identifier);
+		if (cls) {
+			scope->class_symbol_table.emplace(identifier, cls);
+		}
+	}
+	for (const auto& [identifier, overloads] : functions) {
+		scope->function_symbol_table.erase(identifier);
+		for (const auto& function : overloads) {
+			scope->function_symbol_table.emplace(identifier, function);
+		}
+	}
+}
+
 void FlexaRepl::remove_header(std::string& err) {
 	size_t pos = err.rfind(':');
 	if (pos != std::string::npos) {
@@ -43,6 +117,11 @@ int FlexaRepl::execute(const FlexaCliArgs& args) {
 	std::shared_ptr<Scope> semantic_global_scope = std::make_shared<Scope>(Constants::DEFAULT_NAMESPACE, "REPL");
 	std::shared_ptr<Scope> interpreter_global_scope = std::make_shared<Scope>(Constants::DEFAULT_NAMESPACE, "REPL");
 
+	// compiler and vm live for the whole session, each input is compiled
+	// into a new segment appended to the program and run on the same vm
+	Compiler compiler(nullptr, {});
+	VirtualMachine vm(interpreter_global_scope, VmDebug(), std::vector<BytecodeInstruction>());
+
 	while (true) {
 		std::string input_line;
 		std::string prog_name = "REPL";
@@ -85,7 +164,6 @@ int FlexaRepl::execute(const FlexaCliArgs& args) {
 			}
 
 			source = FlxUtils::load_source(file_path);
-			prog_name = FlxUtils::get_prog_name(file_path);
 			file_load = true;
 		}
 		else if (input_line == "#clear") {
@@ -122,21 +200,20 @@ int FlexaRepl::execute(const FlexaCliArgs& args) {
 				continue;
 			}
 
-			// check if it's all ok using a temp global scope
-			std::shared_ptr<Scope> temp = std::make_shared<Scope>(*semantic_global_scope);
-			SemanticAnalyser temp_semantic_analyser(temp, module, modules, args.program_args);
-			temp_semantic_analyser.start();
-
+			// analyse on the session scope, an input that fails to analyse, compile
+			// or run leaves no declarations behind
+			ReplDeclarations declarations(semantic_global_scope, module);
 			SemanticAnalyser semantic_analyser(semantic_global_scope, module, modules, args.program_args);
 			semantic_analyser.start();
 
 			// compile
-			Compiler compiler(module, modules);
-			compiler.start();
+			compiler.start_segment(module, modules);
 
 			// execute
-			VirtualMachine vm(interpreter_global_scope, compiler.vm_debug, compiler.bytecode_program);
-			vm.run();
+			vm.run_segment(compiler.vm_debug, std::move(compiler.bytecode_program));
+			compiler.bytecode_program.clear();
+			declarations.commit();
+			utils::OutputBuffer::standard_output().flush();
 
 			if (file_load) {
 				std::cout << std::endl << "File loaded successfully." << std::endl;
@@ -145,16 +222,22 @@ int FlexaRepl::execute(const FlexaCliArgs& args) {
 				auto stack_top = vm.get_evaluation_stack_top();
 				// not is undefined and it's an expression
 				if (!stack_top->is_undefined() && source.find(';') == std::string::npos) {
-					std::cout << RuntimeOperations::parse_value_to_string(stack_top) << std::endl;
+					auto& output = utils::OutputBuffer::standard_output();
+					RuntimeOperations::write_value(output, stack_top);
+					output.end_line();
+					output.flush();
 				}
 			}
 		}
 		catch (const std::runtime_error& e) {
+			utils::OutputBuffer::standard_output().flush();
 			std::string err = e.what();
 			remove_header(err);
 			std::cerr << utils::StringUtils::trim(err) << std::endl;
 		}
 	}
 
+	FlexaInterpreter::end_workers();
+
 	return EXIT_SUCCESS;
 }
@@ -2,8 +2,13 @@
 #define FLX_REPL_HPP
 
 #include <string>
+#include <vector>
+#include <map>
+#include <memory>
 
 #include "flx_utils.hpp"
+#include "scope.hpp"
+#include "ast.hpp"
 
 #ifdef linux
 #define clear_screen() std::ignore = system("clear")
@@ -13,6 +18,29 @@
 
 namespace interpreter {
 
+	// global declarations an input is about to make, taken before it is
+	// analysed so a rejected input can be removed from the session scope,
+	// they are rolled back on destruction unless the input was committed
+	class ReplDeclarations {
+	private:
+		std::shared_ptr<core::Scope> scope;
+		bool committed = false;
+		std::map<std::string, std::shared_ptr<core::Variable>> variables;
+		std::map<std::string, std::shared_ptr<core::StructDefinition>> structs;
+		std::map<std::string, std::shared_ptr<core::ClassDefinition>> classes;
+		std::map<std::string, std::vector<std::shared_ptr<core::FunctionDefinition>>> functions;
+
+		void add_variable(const std::string& identifier);
+
+	public:
+		ReplDeclarations(std::shared_ptr<core::Scope> scope, std::shared_ptr<core::ASTModuleNode> module);
+		~ReplDeclarations();
+
+		// keeps the declarations once the input ran
+		void commit();
+		void rollback();
+	};
+
 	class FlexaRepl {
 	public:
 		static void remove_header(std::string& err);
@@ -17,19 +17,35 @@ std::string FlxUtils::load_source(const std::string& path) {
 		std::cout << "Could not load file from \"" << path << "\"." << std::endl;
 	}
 	else {
-		std::string line;
-		while (std::getline(file, line)) {
-			source.append(line + "\n");
+		// reads the whole file at once, text mode may translate line endings
+		// so the buffer is shrunk to what was actually read
+		file.seekg(0, std::ios::end);
+		auto size = file.tellg();
+		file.seekg(0, std::ios::beg);
+
+		if (size > 0) {
+			source.resize(size_t(size));
+			file.read(source.data(), size);
+			source.resize(size_t(file.gcount()));
 		}
 	}
 
-	if ((unsigned char)source[0] == 0xEF &&
+	normalize_source(source);
+
+	return source;
+}
+
+void FlxUtils::normalize_source(std::string& source) {
+	if (!source.empty() && source.back() != '\n') {
+		source += '\n';
+	}
+
+	if (source.size() >= 3 &&
+		(unsigned char)source[0] == 0xEF &&
 		(unsigned char)source[1] == 0xBB &&
 		(unsigned char)source[2] == 0xBF) {
-		source = source.substr(3, source.size());
+		source.erase(0, 3);
 	}
-
-	return source;
 }
 
 std::string FlxUtils::get_lib_name(const std::string& libpath) {
@@ -85,6 +101,39 @@ void FlexaCliArgs::parse_args() {
 			source_files.push_back(args[i]);
 			continue;
 		}
+		if (arg == "-p" || arg == "--profile") {
+			++i;
+			throw_if_not_parameter(i, arg);
+			profile_path = args[i];
+			continue;
+		}
+		if (arg == "--profile-interval") {
+			++i;
+			throw_if_not_parameter(i, arg);
+			profile_interval = std::stoull(args[i]);
+			continue;
+		}
+		if (arg == "--stats") {
+			stats = true;
+			continue;
+		}
+		if (arg == "--stats-json") {
+			++i;
+			throw_if_not_parameter(i, arg);
+			stats = true;
+			stats_json_path = args[i];
+			continue;
+		}
+		if (arg == "--gc-stats") {
+			gc_stats = true;
+			continue;
+		}
+		if (arg == "-r" || arg == "--resume") {
+			++i;
+			throw_if_not_parameter(i, arg);
+			resume_path = args[i];
+			continue;
+		}
 		if (arg == "-l" || arg == "--libs") {
 			++i;
 			throw_if_not_parameter(i, arg);
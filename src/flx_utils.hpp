@@ -18,6 +18,8 @@ namespace interpreter {
 	class FlxUtils {
 	public:
 		static std::string load_source(const std::string& path);
+		// appends the trailing line break the lexer expects and removes the utf-8 bom
+		static void normalize_source(std::string& source);
 		static std::string get_lib_name(const std::string& libpath);
 		static std::string get_prog_name(const std::string& progpath);
 
@@ -29,7 +31,13 @@ namespace interpreter {
 
 	public:
 		bool debug = false;
+		std::string profile_path;
+		size_t profile_interval = 0;
+		bool stats = false;
+		std::string stats_json_path;
+		bool gc_stats = false;
 		std::string libs_path;
+		std::string resume_path;
 		std::string workspace_path;
 		std::string main_file;
 		std::vector<std::string> source_files;
@@ -1,10 +1,42 @@
 #include "gc.hpp"
 
 #include <algorithm>
+#include <chrono>
+#include <iomanip>
 
 using namespace core;
 using namespace core::runtime;
 
+const std::array<int64_t, GCStats::PAUSE_BUCKETS - 1> GCStats::PAUSE_BUCKET_LIMITS = {
+	10000,
+	100000,
+	1000000,
+	10000000,
+	100000000
+};
+
+const std::array<std::string, GCStats::PAUSE_BUCKETS> GCStats::PAUSE_BUCKET_NAMES = {
+	"<10us",
+	"<100us",
+	"<1ms",
+	"<10ms",
+	"<100ms",
+	">=100ms"
+};
+
+void GCStats::record_pause(int64_t pause) {
+	++collections;
+	total_pause += pause;
+	last_pause = pause;
+	max_pause = std::max(max_pause, pause);
+
+	size_t bucket = 0;
+	while (bucket < PAUSE_BUCKET_LIMITS.size() && pause >= PAUSE_BUCKET_LIMITS[bucket]) {
+		++bucket;
+	}
+	++pause_histogram[bucket];
+}
+
 GarbageCollector::GarbageCollector() {}
 
 GarbageCollector::~GarbageCollector() {
@@ -17,6 +49,13 @@ GarbageCollector::~GarbageCollector() {
 
 GCObject* GarbageCollector::allocate(GCObject* obj) {
 	heap.push_back(obj);
+
+	++stats.allocated_objects;
+	stats.allocated_bytes += obj->get_size();
+	if (heap.size() > stats.peak_heap) {
+		stats.peak_heap = heap.size();
+	}
+
 	return obj;
 }
 
@@ -110,60 +149,54 @@ void GarbageCollector::remove_array_root(std::weak_ptr<flx_array> array_root) {
 }
 
 void GarbageCollector::mark() {
-	for (auto it = roots.begin(); it != roots.end();) {
-		if (*it) {
-			mark_object(*it);
-			++it;
-		}
-		else {
-			it = roots.erase(it);
+	// expired roots are dropped in the same pass, erasing them one by one is
+	// quadratic once many short lived roots expire between collections
+	roots.erase(std::remove_if(roots.begin(), roots.end(), [this](GCObject* root) {
+		if (!root) {
+			return true;
 		}
-	}
+		mark_object(root);
+		return false;
+		}), roots.end());
 
-	for (auto it = ptr_roots.begin(); it != ptr_roots.end();) {
-		if (*it) {
-			mark_object(**it);
-			++it;
+	ptr_roots.erase(std::remove_if(ptr_roots.begin(), ptr_roots.end(), [this](RuntimeValue** root) {
+		if (!root) {
+			return true;
 		}
-		else {
-			it = ptr_roots.erase(it);
+		mark_object(*root);
+		return false;
+		}), ptr_roots.end());
+
+	var_roots.erase(std::remove_if(var_roots.begin(), var_roots.end(), [this](const std::weak_ptr<GCObject>& weak_root) {
+		auto root = weak_root.lock();
+		if (!root) {
+			return true;
 		}
-	}
-
-	for (auto it = var_roots.begin(); it != var_roots.end();) {
-		if (auto root = it->lock()) {
-			mark_object(root.get());
-			++it;
+		mark_object(root.get());
+		return false;
+		}), var_roots.end());
+
+	root_containers.erase(std::remove_if(root_containers.begin(), root_containers.end(), [this](const std::weak_ptr<std::vector<RuntimeValue*>>& weak_root) {
+		auto root = weak_root.lock();
+		if (!root) {
+			return true;
 		}
-		else {
-			it = var_roots.erase(it);
+		for (auto item : *root) {
+			mark_object(item);
 		}
-	}
+		return false;
+		}), root_containers.end());
 
-	for (auto it = root_containers.begin(); it != root_containers.end();) {
-		if (auto root = it->lock()) {
-			for (auto item : *root.get()) {
-				mark_object(item);
-			}
-			++it;
+	array_roots.erase(std::remove_if(array_roots.begin(), array_roots.end(), [this](const std::weak_ptr<flx_array>& weak_root) {
+		auto root = weak_root.lock();
+		if (!root) {
+			return true;
 		}
-		else {
-			it = root_containers.erase(it);
+		for (flx_int i = 0; i < root->size(); ++i) {
+			mark_object((*root)[i]);
 		}
-	}
-
-	for (auto it = array_roots.begin(); it != array_roots.end();) {
-		if (auto root = it->lock()) {
-			auto ptr_root = root.get();
-			for (flx_int i = 0; i < ptr_root->size(); ++i) {
-				mark_object((*ptr_root)[i]);
-			}
-			++it;
-		}
-		else {
-			it = array_roots.erase(it);
-		}
-	}
+		return false;
+		}), array_roots.end());
 }
 
 void GarbageCollector::mark_object(GCObject* obj) {
@@ -176,16 +209,23 @@ void GarbageCollector::mark_object(GCObject* obj) {
 }
 
 void GarbageCollector::sweep() {
-	for (auto it = heap.begin(); it != heap.end(); ) {
-		if (!(*it)->marked) {
-			delete* it;
-			it = heap.erase(it);
-		}
-		else {
-			(*it)->marked = false;
-			++it;
+	stats.surviving_objects = 0;
+	stats.surviving_bytes = 0;
+
+	// the survivors are compacted in one pass, a large structure dying at
+	// once would make erasing the dead objects one by one quadratic
+	heap.erase(std::remove_if(heap.begin(), heap.end(), [this](GCObject* obj) {
+		if (!obj->marked) {
+			++stats.freed_objects;
+			stats.freed_bytes += obj->get_size();
+			delete obj;
+			return true;
 		}
-	}
+		++stats.surviving_objects;
+		stats.surviving_bytes += obj->get_size();
+		obj->marked = false;
+		return false;
+		}), heap.end());
 
 	for (auto it = roots.begin(); it != roots.end(); ++it) {
 		(*it)->marked = false;
@@ -228,6 +268,8 @@ void GarbageCollector::maybe_collect() {
 }
 
 void GarbageCollector::collect() {
+	auto start = std::chrono::steady_clock::now();
+
 	mark();
 	sweep();
 
@@ -237,4 +279,50 @@ void GarbageCollector::collect() {
 	else {
 		curr_max_heap = heap.size() * 2;
 	}
+
+	stats.record_pause(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+}
+
+size_t GarbageCollector::get_heap_size() {
+	return heap.size();
+}
+
+void GarbageCollector::print_stats(std::ostream& os, const std::function<std::string(size_t)>& resolve_site) {
+	auto to_ms = [](int64_t ns) {
+		return double(ns) / 1000000.0;
+		};
+
+	os << std::endl << "gc stats:" << std::endl;
+	os << std::fixed << std::setprecision(3);
+	os << "  collections:       " << stats.collections << std::endl;
+	os << "  total pause:       " << to_ms(stats.total_pause) << "ms" << std::endl;
+	os << "  max pause:         " << to_ms(stats.max_pause) << "ms" << std::endl;
+	os << "  mean pause:        " << (stats.collections ? to_ms(stats.total_pause / stats.collections) : 0.0) << "ms" << std::endl;
+	os << "  allocated:         " << stats.allocated_objects << " objects, " << stats.allocated_bytes << " bytes" << std::endl;
+	os << "  freed:             " << stats.freed_objects << " objects, " << stats.freed_bytes << " bytes" << std::endl;
+	os << "  last survivors:    " << stats.surviving_objects << " objects, " << stats.surviving_bytes << " bytes" << std::endl;
+	os << "  heap:              " << heap.size() << " objects (peak " << stats.peak_heap << ")" << std::endl;
+	os << "  heap threshold:    " << curr_max_heap << " (max_heap " << max_heap << ")" << std::endl;
+	os << std::defaultfloat;
+
+	os << "  pause histogram:" << std::endl;
+	for (size_t i = 0; i < GCStats::PAUSE_BUCKETS; ++i) {
+		os << "    " << std::left << std::setw(10) << GCStats::PAUSE_BUCKET_NAMES[i] << std::right
+			<< std::setw(10) << stats.pause_histogram[i] << std::endl;
+	}
+
+	if (stats.allocation_sites.empty()) {
+		return;
+	}
+
+	std::vector<std::pair<size_t, size_t>> sites(stats.allocation_sites.begin(), stats.allocation_sites.end());
+	std::sort(sites.begin(), sites.end(), [](const auto& a, const auto& b) {
+		return a.second > b.second;
+		});
+
+	os << "  top allocation sites:" << std::endl;
+	for (size_t i = 0; i < sites.size() && i < 20; ++i) {
+		os << "    " << std::setw(12) << sites[i].second << "  "
+			<< (resolve_site ? resolve_site(sites[i].first) : "pc " + std::to_string(sites[i].first)) << std::endl;
+	}
 }
@@ -2,6 +2,11 @@
 #define GARBAGE_COLLECTOR_HPP
 
 #include <vector>
+#include <array>
+#include <string>
+#include <unordered_map>
+#include <functional>
+#include <iostream>
 
 #include "gcobject.hpp"
 #include "types.hpp"
@@ -10,6 +15,33 @@ namespace core {
 
 	namespace runtime {
 
+		struct GCStats {
+			static const size_t PAUSE_BUCKETS = 6;
+			static const std::array<int64_t, PAUSE_BUCKETS - 1> PAUSE_BUCKET_LIMITS;
+			static const std::array<std::string, PAUSE_BUCKETS> PAUSE_BUCKET_NAMES;
+
+			size_t collections = 0;
+			// pauses are measured in nanoseconds
+			int64_t total_pause = 0;
+			int64_t max_pause = 0;
+			int64_t last_pause = 0;
+			std::array<size_t, PAUSE_BUCKETS> pause_histogram = { 0 };
+
+			size_t allocated_objects = 0;
+			size_t allocated_bytes = 0;
+			size_t freed_objects = 0;
+			size_t freed_bytes = 0;
+			size_t surviving_objects = 0;
+			size_t surviving_bytes = 0;
+			size_t peak_heap = 0;
+
+			// allocation count by bytecode pc, filled by the vm when enabled
+			bool track_allocation_sites = false;
+			std::unordered_map<size_t, size_t> allocation_sites;
+
+			void record_pause(int64_t pause);
+		};
+
 		class GarbageCollector {
 		private:
 			std::vector<GCObject*> heap;
@@ -23,6 +55,7 @@ namespace core {
 			bool enable = true;
 			size_t max_heap = 0;
 			size_t curr_max_heap = 1024;
+			GCStats stats;
 
 			GarbageCollector();
 			~GarbageCollector();
@@ -50,6 +83,9 @@ namespace core {
 			void maybe_collect();
 			void collect();
 
+			size_t get_heap_size();
+			void print_stats(std::ostream& os, const std::function<std::string(size_t)>& resolve_site = nullptr);
+
 		};
 
 	}
@@ -12,6 +12,11 @@ namespace core {
 			bool marked = false;
 			virtual ~GCObject() = default;
 			virtual std::vector<GCObject*> get_references() = 0;
+
+			// estimated memory held by the object, used by gc telemetry
+			virtual size_t get_size() {
+				return sizeof(GCObject);
+			}
 		};
 
 	}
@@ -0,0 +1,360 @@
+#include "json_tokenizer.hpp"
+
+#include <charconv>
+#include <cstring>
+#include <stdexcept>
+
+using namespace utils;
+
+static constexpr uint64_t ONES = 0x0101010101010101ULL;
+static constexpr uint64_t HIGH_BITS = 0x8080808080808080ULL;
+
+// a high bit set for the first byte of the word below n, n at most 128
+static inline uint64_t has_less(uint64_t word, uint64_t n) {
+	return (word - ONES * n) & ~word & HIGH_BITS;
+}
+
+// the word holds a quote, a backslash or a control character
+static inline bool has_special(uint64_t word) {
+	return has_less(word ^ (ONES * '"'), 1) | has_less(word ^ (ONES * '\\'), 1) | has_less(word, 0x20);
+}
+
+JsonTokenizer::JsonTokenizer(std::string_view document)
+	: document(document) {}
+
+JsonTokenizer::Token JsonTokenizer::next() {
+	Token token;
+
+	while (true) {
+		skip_whitespace();
+
+		if (state == State::AFTER_VALUE) {
+			if (containers.empty()) {
+				if (position < document.size()) {
+					fail("unexpected character after the document");
+				}
+				token.type = TokenType::END;
+				return token;
+			}
+
+			if (position >= document.size()) {
+				fail("unexpected end of the document");
+			}
+			char c = document[position];
+			if (c == ',') {
+				++position;
+				state = containers.back() == '{' ? State::KEY : State::VALUE;
+				continue;
+			}
+			if (c == '}' && containers.back() == '{') {
+				return close_container(TokenType::END_OBJECT);
+			}
+			if (c == ']' && containers.back() == '[') {
+				return close_container(TokenType::END_ARRAY);
+			}
+			fail(std::string("expected ',' or '") + (containers.back() == '{' ? '}' : ']') + "'");
+		}
+
+		if (position >= document.size()) {
+			fail(containers.empty() && state == State::VALUE ? "empty document" : "unexpected end of the document");
+		}
+		char c = document[position];
+
+		if (state == State::KEY || state == State::KEY_OR_END) {
+			if (c == '}' && state == State::KEY_OR_END) {
+				return close_container(TokenType::END_OBJECT);
+			}
+			if (c != '"') {
+				fail("expected a member name");
+			}
+			token.type = TokenType::KEY;
+			token.text = read_string();
+
+			skip_whitespace();
+			if (position >= document.size() || document[position] != ':') {
+				fail("expected ':' after the member name");
+			}
+			++position;
+			state = State::VALUE;
+			return token;
+		}
+
+		if (c == ']' && state == State::VALUE_OR_END) {
+			return close_container(TokenType::END_ARRAY);
+		}
+
+		state = State::AFTER_VALUE;
+		switch (c) {
+		case '{':
+		case '[':
+			if (containers.size() >= MAX_DEPTH) {
+				fail("document nested deeper than " + std::to_string(MAX_DEPTH));
+			}
+			++position;
+			containers.push_back(c);
+			state = c == '{' ? State::KEY_OR_END : State::VALUE_OR_END;
+			token.type = c == '{' ? TokenType::BEGIN_OBJECT : TokenType::BEGIN_ARRAY;
+			return token;
+		case '"':
+			token.type = TokenType::STRING;
+			token.text = read_string();
+			return token;
+		case 't':
+			read_literal("true");
+			token.type = TokenType::BOOL;
+			token.bool_value = true;
+			return token;
+		case 'f':
+			read_literal("false");
+			token.type = TokenType::BOOL;
+			return token;
+		case 'n':
+			read_literal("null");
+			token.type = TokenType::NULL_VALUE;
+			return token;
+		default:
+			if (c == '-' || (c >= '0' && c <= '9')) {
+				return read_number();
+			}
+			fail(std::string("unexpected character '") + c + "'");
+		}
+	}
+}
+
+size_t JsonTokenizer::depth() const {
+	return containers.size();
+}
+
+void JsonTokenizer::skip_whitespace() {
+	while (position < document.size()) {
+		char c = document[position];
+		if (c != ' ' && c != '\n' && c != '\r' && c != '\t') {
+			return;
+		}
+		++position;
+	}
+}
+
+std::string_view JsonTokenizer::read_string() {
+	// skips the opening quote
+	size_t start = ++position;
+	const char* data = document.data();
+	size_t size = document.size();
+
+	while (true) {
+		while (position + 8 <= size) {
+			uint64_t word;
+			memcpy(&word, data + position, 8);
+			if (has_special(word)) {
+				break;
+			}
+			position += 8;
+		}
+		if (position >= size) {
+			fail("unterminated string");
+		}
+
+		char c = data[position];
+		if (c == '"') {
+			return std::string_view(data + start, position++ - start);
+		}
+		if (c == '\\') {
+			break;
+		}
+		if (static_cast<unsigned char>(c) < 0x20) {
+			fail("control character in a string");
+		}
+		++position;
+	}
+
+	// the text with escapes is copied, up to the first escape in one go
+	scratch.assign(data + start, position - start);
+	while (true) {
+		if (position >= size) {
+			fail("unterminated string");
+		}
+		char c = data[position];
+		if (c == '"') {
+			++position;
+			return scratch;
+		}
+		if (c == '\\') {
+			read_escape(scratch);
+			continue;
+		}
+		if (static_cast<unsigned char>(c) < 0x20) {
+			fail("control character in a string");
+		}
+
+		size_t run = position;
+		while (run < size && data[run] != '"' && data[run] != '\\' && static_cast<unsigned char>(data[run]) >= 0x20) {
+			++run;
+		}
+		scratch.append(data + position, run - position);
+		position = run;
+	}
+}
+
+void JsonTokenizer::read_escape(std::string& target) {
+	// skips the backslash
+	if (++position >= document.size()) {
+		fail("unterminated string");
+	}
+
+	char c = document[position++];
+	switch (c) {
+	case '"': target += '"'; return;
+	case '\\': target += '\\'; return;
+	case '/': target += '/'; return;
+	case 'b': target += '\b'; return;
+	case 'f': target += '\f'; return;
+	case 'n': target += '\n'; return;
+	case 'r': target += '\r'; return;
+	case 't': target += '\t'; return;
+	case 'u': break;
+	default:
+		fail(std::string("invalid escape '\\") + c + "'");
+	}
+
+	auto read_hex = [this]() {
+		if (position + 4 > document.size()) {
+			fail("invalid unicode escape");
+		}
+		uint32_t code = 0;
+		auto result = std::from_chars(document.data() + position, document.data() + position + 4, code, 16);
+		if (result.ptr != document.data() + position + 4) {
+			fail("invalid unicode escape");
+		}
+		position += 4;
+		return code;
+		};
+
+	uint32_t code = read_hex();
+	// a high surrogate is followed by the low one of the pair
+	if (code >= 0xD800 && code <= 0xDBFF) {
+		if (document.substr(position, 2) != "\\u") {
+			fail("unpaired surrogate in unicode escape");
+		}
+		position += 2;
+		uint32_t low = read_hex();
+		if (low < 0xDC00 || low > 0xDFFF) {
+			fail("unpaired surrogate in unicode escape");
+		}
+		code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+	}
+	else if (code >= 0xDC00 && code <= 0xDFFF) {
+		fail("unpaired surrogate in unicode escape");
+	}
+
+	if (code < 0x80) {
+		target += char(code);
+	}
+	else if (code < 0x800) {
+		target += char(0xC0 | (code >> 6));
+		target += char(0x80 | (code & 0x3F));
+	}
+	else if (code < 0x10000) {
+		target += char(0xE0 | (code >> 12));
+		target += char(0x80 | ((code >> 6) & 0x3F));
+		target += char(0x80 | (code & 0x3F));
+	}
+	else {
+		target += char(0xF0 | (code >> 18));
+		target += char(0x80 | ((code >> 12) & 0x3F));
+		target += char(0x80 | ((code >> 6) & 0x3F));
+		target += char(0x80 | (code & 0x3F));
+	}
+}
+
+JsonTokenizer::Token JsonTokenizer::read_number() {
+	Token token;
+	const char* data = document.data();
+	size_t size = document.size();
+	size_t start = position;
+
+	auto digits = [&]() {
+		size_t first = position;
+		while (position < size && data[position] >= '0' && data[position] <= '9') {
+			++position;
+		}
+		return position - first;
+		};
+
+	if (data[position] == '-') {
+		++position;
+	}
+	size_t integer_start = position;
+	if (digits() == 0) {
+		fail("invalid number");
+	}
+	if (data[integer_start] == '0' && position - integer_start > 1) {
+		fail("invalid number with a leading zero");
+	}
+
+	bool integral = true;
+	if (position < size && data[position] == '.') {
+		++position;
+		integral = false;
+		if (digits() == 0) {
+			fail("invalid number");
+		}
+	}
+	if (position < size && (data[position] == 'e' || data[position] == 'E')) {
+		++position;
+		integral = false;
+		if (position < size && (data[position] == '+' || data[position] == '-')) {
+			++position;
+		}
+		if (digits() == 0) {
+			fail("invalid number");
+		}
+	}
+
+	// integers out of the range of an int are kept as floats
+	if (integral) {
+		auto result = std::from_chars(data + start, data + position, token.int_value);
+		if (result.ec == std::errc()) {
+			token.type = TokenType::INT;
+			return token;
+		}
+	}
+
+	auto result = std::from_chars(data + start, data + position, token.float_value);
+	if (result.ec == std::errc::result_out_of_range) {
+		fail("number out of range");
+	}
+	token.type = TokenType::FLOAT;
+	return token;
+}
+
+void JsonTokenizer::read_literal(std::string_view literal) {
+	if (document.substr(position, literal.size()) != literal) {
+		fail("invalid literal");
+	}
+	position += literal.size();
+}
+
+JsonTokenizer::Token JsonTokenizer::close_container(TokenType type) {
+	++position;
+	containers.pop_back();
+	state = State::AFTER_VALUE;
+
+	Token token;
+	token.type = type;
+	return token;
+}
+
+void JsonTokenizer::fail(const std::string& message) const {
+	size_t line = 1;
+	size_t column = 1;
+	for (size_t i = 0; i < position && i < document.size(); ++i) {
+		if (document[i] == '\n') {
+			++line;
+			column = 1;
+		}
+		else {
+			++column;
+		}
+	}
+	throw std::runtime_error("invalid JSON at " + std::to_string(line) + ":" + std::to_string(column) + ": " + message);
+}
@@ -0,0 +1,86 @@
+#ifndef JSON_TOKENIZER_HPP
+#define JSON_TOKENIZER_HPP
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstdint>
+
+namespace utils {
+
+	/*
+		Single pass scanner of a JSON document. Each call to next reads one
+		token and checks it against the grammar with a stack of the open
+		containers, so the document is validated as it is read and no tree is
+		built. Strings are scanned eight bytes at a time for the quote, the
+		backslash and control characters, and those without escapes are views
+		into the document.
+	*/
+	class JsonTokenizer {
+	public:
+		enum class TokenType {
+			BEGIN_OBJECT,
+			END_OBJECT,
+			BEGIN_ARRAY,
+			END_ARRAY,
+			KEY,
+			STRING,
+			INT,
+			FLOAT,
+			BOOL,
+			NULL_VALUE,
+			END
+		};
+
+		struct Token {
+			TokenType type = TokenType::END;
+			// text of a key or string, valid until the next token
+			std::string_view text;
+			int64_t int_value = 0;
+			// as wide as the floats of flexa, so no digit is lost
+			long double float_value = 0;
+			bool bool_value = false;
+		};
+
+		static constexpr size_t MAX_DEPTH = 512;
+
+	private:
+		enum class State {
+			VALUE,
+			// right after '[', where ']' may close it
+			VALUE_OR_END,
+			KEY,
+			// right after '{', where '}' may close it
+			KEY_OR_END,
+			AFTER_VALUE
+		};
+
+		std::string_view document;
+		size_t position = 0;
+		State state = State::VALUE;
+		// '{' or '[' of each open container
+		std::vector<char> containers;
+		// unescaped text of the last string with escapes
+		std::string scratch;
+
+	public:
+		JsonTokenizer(std::string_view document);
+
+		// throws std::runtime_error with the position of malformed input
+		Token next();
+
+		size_t depth() const;
+
+	private:
+		void skip_whitespace();
+		std::string_view read_string();
+		void read_escape(std::string& target);
+		Token read_number();
+		void read_literal(std::string_view literal);
+		Token close_container(TokenType type);
+		[[noreturn]] void fail(const std::string& message) const;
+	};
+
+}
+
+#endif // !JSON_TOKENIZER_HPP
@@ -4,18 +4,19 @@
 
 #include <stack>
 #include <stdexcept>
+#include <unordered_map>
 
 using namespace core;
 using namespace core::parser;
 
-Lexer::Lexer(const std::string& name, const std::string& source)
+Lexer::Lexer(const std::string& name, std::string_view source)
 	: source(source), name(name) {
-	tokenize();
+	start();
 }
 
 Lexer::Lexer(
 	const std::string& name,
-	const std::string& source,
+	std::string_view source,
 	size_t start_row,
 	size_t start_col
 )
@@ -23,19 +24,22 @@ Lexer::Lexer(
 	name(name), 
 	current_row(start_row),
 	current_col(start_col) {
-	tokenize();
+	start();
 }
 
 Lexer::~Lexer() = default;
 
-void Lexer::tokenize() {
+void Lexer::start() {
 	++current_col;
-	current_char = source[current_index];
-	if (has_next()) {
-		next_char = source[current_index + 1];
-	}
+	current_char = char_at(current_index);
+	next_char = char_at(current_index + 1);
+}
+
+void Lexer::tokenize_next() {
+	// comments and spaces produce no tokens, so keeps going until something is buffered
+	auto tokens_size = tokens.size();
 
-	while (has_next()) {
+	while (has_next() && tokens.size() == tokens_size) {
 		if (is_space()) {
 			// ignore unuseful characters
 			advance();
@@ -69,7 +73,10 @@ void Lexer::tokenize() {
 		}
 	}
 
-	tokens.push_back(Token(LexTokenType::TK_EOF, "EOF", current_col, current_row));
+	if (tokens.size() == tokens_size) {
+		tokens.push_back(Token(LexTokenType::TK_EOF, "EOF", current_col, current_row));
+		finished = true;
+	}
 }
 
 Token Lexer::process_comment() {
@@ -134,7 +141,7 @@ Token Lexer::process_string() {
 	return Token(LexTokenType::TK_STRING_LITERAL, str, current_row, start_col);
 }
 
-size_t Lexer::find_mlv_closer(const std::string expr) {
+size_t Lexer::find_mlv_closer(std::string_view expr) {
 	size_t level = 0;
 	for (size_t i = 0; i < expr.size(); ++i) {
 		if (level == 0 && expr[i] == '}') {
@@ -195,10 +202,8 @@ void Lexer::process_multiline_string() {
 				tokens.push_back(Token(TK_STRING_TYPE, "string", current_row, start_col));
 				tokens.push_back(Token(TK_LEFT_BRACKET, "(", current_row, start_col));
 				// add tokens from sub_lex to current tokens
-				for (auto t : sub_lex.tokens) {
-					if (t.type != TK_EOF) {
-						tokens.push_back(t);
-					}
+				for (auto t = sub_lex.next_token(); t.type != TK_EOF; t = sub_lex.next_token()) {
+					tokens.push_back(t);
 				}
 				tokens.push_back(Token(TK_RIGHT_BRACKET, ")", current_row, start_col));
 				tokens.push_back(Token(TK_ADDITIVE_OP, "+", current_row, start_col));
@@ -300,7 +305,6 @@ Token Lexer::process_special_number() {
 }
 
 Token Lexer::process_number() {
-	std::string number;
 	LexTokenType type;
 	bool has_dot = false;
 
@@ -312,6 +316,8 @@ Token Lexer::process_number() {
 		return process_special_number();
 	}
 
+	auto start_index = current_index;
+
 	while (has_next() && (std::isdigit(current_char) || current_char == '.')) {
 		if (current_char == '.') {
 			if (has_dot) {
@@ -319,24 +325,23 @@ Token Lexer::process_number() {
 			}
 			has_dot = true;
 		}
-		number += current_char;
 		advance();
 	}
 
 	if (std::tolower(current_char) == 'e') {
 		has_dot = true;
-		number += current_char;
 		advance();
 		if (current_char == '+' || current_char == '-') {
-			number += current_char;
 			advance();
 		}
 		while (has_next() && std::isdigit(current_char)) {
-			number += current_char;
 			advance();
 		}
 	}
 
+	// the literal is sliced from the source, the float suffix is not part of it
+	std::string number(source.substr(start_index, current_index - start_index));
+
 	if (has_dot) {
 		type = TK_FLOAT_LITERAL;
 	}
@@ -351,21 +356,29 @@ Token Lexer::process_number() {
 	return Token(type, number, current_row, start_col);
 }
 
+LexTokenType Lexer::find_keyword(std::string_view identifier) {
+	// built once, the first image of each token type wins as in a linear search
+	static const std::unordered_map<std::string_view, LexTokenType> keywords = []() {
+		std::unordered_map<std::string_view, LexTokenType> keywords;
+		for (size_t i = 0; i < TOKEN_IMAGE.size(); ++i) {
+			keywords.emplace(TOKEN_IMAGE.at((LexTokenType)i), (LexTokenType)i);
+		}
+		return keywords;
+		}();
+
+	auto it = keywords.find(identifier);
+	return it != keywords.end() ? it->second : LexTokenType::TK_ERROR;
+}
+
 Token Lexer::process_identifier() {
-	std::string identifier;
-	LexTokenType type = LexTokenType::TK_ERROR;
+	auto start_index = current_index;
 
 	while (has_next() && (std::isalnum(current_char) || current_char == '_')) {
-		identifier += current_char;
 		advance();
 	}
 
-	for (size_t i = 0; i < TOKEN_IMAGE.size(); ++i) {
-		if (identifier == TOKEN_IMAGE.at((LexTokenType)i)) {
-			type = (LexTokenType)i;
-			break;
-		}
-	}
+	std::string_view identifier = source.substr(start_index, current_index - start_index);
+	LexTokenType type = find_keyword(identifier);
 
 	if (type == LexTokenType::TK_ERROR) {
 		if (identifier == "true" || identifier == "false") {
@@ -376,7 +389,7 @@ Token Lexer::process_identifier() {
 		}
 	}
 
-	return Token(type, identifier, current_row, start_col);
+	return Token(type, std::string(identifier), current_row, start_col);
 }
 
 Token Lexer::process_symbol() {
@@ -591,6 +604,10 @@ Token Lexer::process_symbol() {
 	return Token(type, str_symbol, current_row, start_col);
 }
 
+char Lexer::char_at(size_t index) const {
+	return index < source.size() ? source[index] : '\0';
+}
+
 bool Lexer::has_next() {
 	return current_index < source.length();
 }
@@ -608,13 +625,15 @@ void Lexer::advance() {
 		++current_col;
 	}
 	before_char = current_char;
-	current_char = source[++current_index];
-	if (has_next()) {
-		next_char = source[current_index + 1];
-	}
+	current_char = char_at(++current_index);
+	next_char = char_at(current_index + 1);
 }
 
 Token Lexer::next_token() {
+	while (current_token >= tokens.size() && !finished) {
+		tokenize_next();
+	}
+
 	if (current_token < tokens.size()) {
 		return tokens[current_token++];
 	}
@@ -2,6 +2,7 @@
 #define LEXER_HPP
 
 #include <string>
+#include <string_view>
 #include <vector>
 #include <cstdint>
 
@@ -11,10 +12,14 @@ namespace core {
 
 	namespace parser {
 
+		/*
+			Tokens are produced on demand as the parser consumes them.
+			The source is not copied, so it must outlive the lexer.
+		*/
 		class Lexer {
 		public:
-			Lexer(const std::string& name, const std::string& source);
-			Lexer(const std::string& name, const std::string& source, size_t start_row, size_t start_col);
+			Lexer(const std::string& name, std::string_view source);
+			Lexer(const std::string& name, std::string_view source, size_t start_row, size_t start_col);
 			~Lexer();
 
 			Token next_token();
@@ -22,9 +27,10 @@ namespace core {
 			void set_current_token(size_t token);
 
 		private:
-			std::string source;
+			std::string_view source;
 			std::string name;
 			std::vector<Token> tokens;
+			bool finished = false;
 			char before_char = '\0';
 			char current_char = '\0';
 			char next_char = '\0';
@@ -34,7 +40,9 @@ namespace core {
 			size_t current_col = 0;
 			size_t start_col = 0;
 
-			void tokenize();
+			void start();
+			void tokenize_next();
+			char char_at(size_t index) const;
 			bool has_next();
 			bool is_space();
 			void advance();
@@ -49,7 +57,8 @@ namespace core {
 
 			std::string build_error_message(const std::string error);
 
-			static size_t find_mlv_closer(const std::string expr);
+			static size_t find_mlv_closer(std::string_view expr);
+			static LexTokenType find_keyword(std::string_view identifier);
 		};
 
 	}
@@ -41,7 +41,7 @@ int main(int argc, const char* argv[]) {
 
 	core::Constants::debug = args.debug;
 
-	if (args.workspace_path.empty()) {
+	if (args.workspace_path.empty() && args.resume_path.empty()) {
 		return FlexaRepl::execute(args);
 	}
 
@@ -0,0 +1,93 @@
+#include "md_async.hpp"
+
+#include "vm.hpp"
+#include "vm_scheduler.hpp"
+#include "semantic_analysis.hpp"
+#include "constants.hpp"
+
+using namespace core;
+using namespace core::modules;
+using namespace core::runtime;
+using namespace core::analysis;
+
+static flx_int get_task_id(RuntimeValue* task) {
+	if (task->is_void()) {
+		throw std::runtime_error("task is null");
+	}
+	return task->get_str()[Module::INSTANCE_ID_NAME]->get_value()->get_i();
+}
+
+ModuleAsync::ModuleAsync() {}
+
+ModuleAsync::~ModuleAsync() = default;
+
+void ModuleAsync::register_functions(SemanticAnalyser* visitor) {
+	visitor->builtin_functions["spawn"] = nullptr;
+	visitor->builtin_functions["await"] = nullptr;
+	visitor->builtin_functions["yield"] = nullptr;
+	visitor->builtin_functions["is_done"] = nullptr;
+}
+
+void ModuleAsync::register_functions(VirtualMachine* vm) {
+
+	vm->builtin_functions["spawn"] = [this, vm]() {
+		auto scope = vm->get_back_scope(Constants::STD_NAMESPACE);
+		auto fun_val = std::dynamic_pointer_cast<RuntimeVariable>(scope->find_declared_variable("worker"))->get_value();
+		auto arg_val = std::dynamic_pointer_cast<RuntimeVariable>(scope->find_declared_variable("arg"))->get_value();
+
+		if (!fun_val->is_function()) {
+			throw std::runtime_error("spawn expects a function");
+		}
+
+		if (!vm->scheduler) {
+			vm->scheduler = std::make_shared<VmScheduler>(vm);
+		}
+
+		auto id = vm->scheduler->spawn(fun_val, arg_val);
+
+		auto instance_id_var = std::make_shared<RuntimeVariable>(INSTANCE_ID_NAME, Type::T_INT);
+		instance_id_var->set_value(vm->allocate_value(new RuntimeValue(id)));
+		vm->gc.add_var_root(instance_id_var);
+
+		flx_struct str = flx_struct();
+		str[INSTANCE_ID_NAME] = instance_id_var;
+
+		vm->push_new_constant(new RuntimeValue(str, Constants::STD_NAMESPACE, "Task"));
+
+		};
+
+	vm->builtin_functions["await"] = [this, vm]() {
+		auto scope = vm->get_back_scope(Constants::STD_NAMESPACE);
+		auto val = std::dynamic_pointer_cast<RuntimeVariable>(scope->find_declared_variable("task"))->get_value();
+
+		if (!vm->scheduler) {
+			throw std::runtime_error("task was already awaited");
+		}
+
+		auto result = vm->scheduler->await(get_task_id(val));
+
+		vm->push_constant(result);
+		vm->gc.remove_root(result);
+
+		};
+
+	vm->builtin_functions["yield"] = [this, vm]() {
+		if (vm->scheduler) {
+			vm->scheduler->yield();
+		}
+
+		vm->push_empty_constant(Type::T_UNDEFINED);
+
+		};
+
+	vm->builtin_functions["is_done"] = [this, vm]() {
+		auto scope = vm->get_back_scope(Constants::STD_NAMESPACE);
+		auto val = std::dynamic_pointer_cast<RuntimeVariable>(scope->find_declared_variable("task"))->get_value();
+
+		auto id = get_task_id(val);
+
+		vm->push_new_constant(new RuntimeValue(flx_bool(!vm->scheduler || vm->scheduler->is_done(id))));
+
+		};
+
+}
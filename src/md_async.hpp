@@ -0,0 +1,28 @@
+#ifndef MD_ASYNC_HPP
+#define MD_ASYNC_HPP
+
+#include "module.hpp"
+
+namespace core {
+
+	namespace modules {
+
+		/*
+			Tasks of flx.core.async are run by the scheduler of the vm, see
+			vm_scheduler.hpp. They share the heap and globals of the program and
+			only switch at yield, await or a blocking call of a core library.
+		*/
+		class ModuleAsync : public Module {
+		public:
+			ModuleAsync();
+			~ModuleAsync();
+
+			void register_functions(analysis::SemanticAnalyser* visitor) override;
+			void register_functions(runtime::VirtualMachine* vm) override;
+		};
+
+	}
+
+}
+
+#endif // !MD_ASYNC_HPP
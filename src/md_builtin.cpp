@@ -13,6 +13,7 @@
 #include "constants.hpp"
 #include "visitor.hpp"
 #include "utils.hpp"
+#include "output_buffer.hpp"
 
 using namespace core;
 using namespace core::modules;
@@ -86,6 +87,12 @@ void ModuleBuiltin::register_functions(SemanticAnalyser* visitor) {
 	);
 	visitor->builtin_functions[Constants::BUILTIN_FUNCTION_NAMES[BuiltinFuncs::BF_SYSTEM]] = nullptr;
 
+	func_scope->declare_function(
+		Constants::BUILTIN_FUNCTION_NAMES[BuiltinFuncs::BF_FLUSH],
+		func_decls[BuiltinFuncs::BF_FLUSH]
+	);
+	visitor->builtin_functions[Constants::BUILTIN_FUNCTION_NAMES[BuiltinFuncs::BF_FLUSH]] = nullptr;
+
 }
 
 void ModuleBuiltin::register_functions(VirtualMachine* vm) {
@@ -106,8 +113,9 @@ void ModuleBuiltin::register_functions(VirtualMachine* vm) {
 			auto var = std::dynamic_pointer_cast<RuntimeVariable>(scope->find_declared_variable("args"));
 			auto args = var->get_value()->get_arr();
 
+			auto& output = OutputBuffer::standard_output();
 			for (flx_int i = 0; i < args.size(); ++i) {
-				std::cout << RuntimeOperations::parse_value_to_string(args[i], true);
+				RuntimeOperations::write_value(output, args[i], true);
 			}
 		}
 
@@ -125,8 +133,9 @@ void ModuleBuiltin::register_functions(VirtualMachine* vm) {
 			auto var = std::dynamic_pointer_cast<RuntimeVariable>(scope->find_declared_variable("args"));
 			auto args = var->get_value()->get_arr();
 
+			auto& output = OutputBuffer::standard_output();
 			for (flx_int i = 0; i < args.size(); ++i) {
-				std::cout << RuntimeOperations::parse_value_to_string(args[i]);
+				RuntimeOperations::write_value(output, args[i]);
 			}
 		}
 
@@ -140,7 +149,7 @@ void ModuleBuiltin::register_functions(VirtualMachine* vm) {
 	);
 	vm->builtin_functions[Constants::BUILTIN_FUNCTION_NAMES[BuiltinFuncs::BF_PRINTLN]] = [this, vm]() {
 		vm->builtin_functions[Constants::BUILTIN_FUNCTION_NAMES[BuiltinFuncs::BF_PRINT]]();
-		std::cout << std::endl;
+		OutputBuffer::standard_output().end_line();
 		};
 
 	func_scope->declare_function(
@@ -149,6 +158,7 @@ void ModuleBuiltin::register_functions(VirtualMachine* vm) {
 	);
 	vm->builtin_functions[Constants::BUILTIN_FUNCTION_NAMES[BuiltinFuncs::BF_READ]] = [this, vm]() {
 		vm->builtin_functions[Constants::BUILTIN_FUNCTION_NAMES[BuiltinFuncs::BF_PRINT]]();
+		OutputBuffer::standard_output().flush();
 		std::string line;
 		std::getline(std::cin, line);
 		vm->push_new_constant(new RuntimeValue(flx_string(std::move(line))));
@@ -159,6 +169,7 @@ void ModuleBuiltin::register_functions(VirtualMachine* vm) {
 		func_decls[BuiltinFuncs::BF_READCH]
 	);
 	vm->builtin_functions[Constants::BUILTIN_FUNCTION_NAMES[BuiltinFuncs::BF_READCH]] = [this, vm]() {
+		OutputBuffer::standard_output().flush();
 		while (!_kbhit());
 		char ch = _getch();
 		vm->push_new_constant(new RuntimeValue(flx_char(ch)));
@@ -199,7 +210,9 @@ void ModuleBuiltin::register_functions(VirtualMachine* vm) {
 		auto var = std::dynamic_pointer_cast<RuntimeVariable>(scope->find_declared_variable("ms"));
 		auto ms = var->get_value()->get_i();
 
-		std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+		vm->run_blocking([ms]() {
+			std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+			});
 
 		vm->push_empty_constant(Type::T_UNDEFINED);
 
@@ -214,6 +227,8 @@ void ModuleBuiltin::register_functions(VirtualMachine* vm) {
 		auto var = std::dynamic_pointer_cast<RuntimeVariable>(scope->find_declared_variable("cmd"));
 		auto cmd = var->get_value()->get_s();
 
+		// the command writes to the same stdout
+		OutputBuffer::standard_output().flush();
 		int rc = system(cmd.c_str());
 
 		flx_int res = rc;
@@ -250,6 +265,17 @@ void ModuleBuiltin::register_functions(VirtualMachine* vm) {
 
 		};
 
+	func_scope->declare_function(
+		Constants::BUILTIN_FUNCTION_NAMES[BuiltinFuncs::BF_FLUSH],
+		func_decls[BuiltinFuncs::BF_FLUSH]
+	);
+	vm->builtin_functions[Constants::BUILTIN_FUNCTION_NAMES[BuiltinFuncs::BF_FLUSH]] = [this, vm]() {
+		OutputBuffer::standard_output().flush();
+
+		vm->push_empty_constant(Type::T_UNDEFINED);
+
+		};
+
 }
 
 void ModuleBuiltin::build_decls() {
@@ -470,4 +496,12 @@ void ModuleBuiltin::build_decls() {
 		)
 	);
 
+	parameters = std::vector<std::shared_ptr<TypeDefinition>>();
+	func_decls[BuiltinFuncs::BF_FLUSH] = std::make_shared<FunctionDefinition>(
+		Constants::BUILTIN_FUNCTION_NAMES[BuiltinFuncs::BF_FLUSH],
+		Type::T_VOID, parameters, std::make_shared<ASTBlockNode>(
+			std::vector<std::shared_ptr<ASTNode>>{}, 0, 0
+		)
+	);
+
 }
@@ -17,6 +17,7 @@
 #include "vm.hpp"
 #include "semantic_analysis.hpp"
 #include "constants.hpp"
+#include "output_buffer.hpp"
 
 using namespace core::modules;
 using namespace core::runtime;
@@ -73,10 +74,17 @@ void ModuleConsole::register_functions(VirtualMachine* vm) {
 
 #ifdef linux
 
-		std::cout << "\033[0;" << (30 + vals[1]->get_i()) << ";" << (40 + vals[0]->get_i()) << "m";
+		auto& output = utils::OutputBuffer::standard_output();
+		output.write(std::string_view("\033[0;"));
+		output.write_int(30 + vals[1]->get_i());
+		output.write(';');
+		output.write_int(40 + vals[0]->get_i());
+		output.write('m');
 
 #elif defined(_WIN32)
 
+		// the attribute applies to what is written after it
+		utils::OutputBuffer::standard_output().flush();
 		HANDLE hConsole = GetStdHandle(STD_OUTPUT_HANDLE);
 		SetConsoleTextAttribute(hConsole, static_cast<WORD>(vals[0]->get_i()) * 0x10 | static_cast<WORD>(vals[1]->get_i()));
 
@@ -95,10 +103,16 @@ void ModuleConsole::register_functions(VirtualMachine* vm) {
 
 #ifdef linux
 
-		std::cout << "\033[" << (vals[1]->get_i() + 1) << ";" << (vals[0]->get_i() + 1) << "H";
+		auto& output = utils::OutputBuffer::standard_output();
+		output.write(std::string_view("\033["));
+		output.write_int(vals[1]->get_i() + 1);
+		output.write(';');
+		output.write_int(vals[0]->get_i() + 1);
+		output.write('H');
 
 #elif defined(_WIN32)
 
+		utils::OutputBuffer::standard_output().flush();
 		COORD pos = { static_cast<SHORT>(vals[0]->get_i()), static_cast<SHORT>(vals[1]->get_i()) };
 		HANDLE output = GetStdHandle(STD_OUTPUT_HANDLE);
 		SetConsoleCursorPosition(output, pos);
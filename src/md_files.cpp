@@ -1,19 +1,434 @@
 #include "md_files.hpp"
 
 #include <filesystem>
+#include <string_view>
+#include <cstring>
+
+#ifdef linux
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#elif defined(_WIN32)
+
+#include <windows.h>
+
+#endif // linux
 
 #include "vm.hpp"
+#include "vm_scheduler.hpp"
 #include "semantic_analysis.hpp"
 #include "constants.hpp"
 
+using namespace core;
 using namespace core::modules;
 using namespace core::runtime;
 using namespace core::analysis;
 
+static VmScheduler* get_scheduler(VirtualMachine* vm) {
+	if (!vm->scheduler) {
+		vm->scheduler = std::make_shared<VmScheduler>(vm);
+	}
+	return vm->scheduler.get();
+}
+
+ModuleFiles::FileMapping::FileMapping(const std::string& path) {
+#ifdef linux
+
+	int fd = ::open(path.c_str(), O_RDONLY);
+	if (fd < 0) {
+		throw std::runtime_error("cannot open '" + path + "' to map");
+	}
+
+	struct stat file_stat;
+	if (fstat(fd, &file_stat) < 0) {
+		::close(fd);
+		throw std::runtime_error("cannot read the size of '" + path + "'");
+	}
+	size = size_t(file_stat.st_size);
+
+	// an empty file cannot be mapped, its views are empty
+	if (size > 0) {
+		void* address = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (address == MAP_FAILED) {
+			::close(fd);
+			throw std::runtime_error("cannot map '" + path + "'");
+		}
+		madvise(address, size, MADV_SEQUENTIAL);
+		data = static_cast<const char*>(address);
+	}
+
+	// the mapping keeps its own reference to the file
+	::close(fd);
+
+#elif defined(_WIN32)
+
+	file_handle = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file_handle == INVALID_HANDLE_VALUE) {
+		throw std::runtime_error("cannot open '" + path + "' to map");
+	}
+
+	LARGE_INTEGER file_size;
+	if (!GetFileSizeEx(file_handle, &file_size)) {
+		CloseHandle(file_handle);
+		throw std::runtime_error("cannot read the size of '" + path + "'");
+	}
+	size = size_t(file_size.QuadPart);
+
+	if (size > 0) {
+		mapping_handle = CreateFileMappingA(file_handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (mapping_handle) {
+			data = static_cast<const char*>(MapViewOfFile(mapping_handle, FILE_MAP_READ, 0, 0, 0));
+		}
+		if (!data) {
+			if (mapping_handle) {
+				CloseHandle(mapping_handle);
+			}
+			CloseHandle(file_handle);
+			throw std::runtime_error("cannot map '" + path + "'");
+		}
+	}
+
+#endif // linux
+}
+
+ModuleFiles::FileMapping::~FileMapping() {
+#ifdef linux
+
+	if (data) {
+		munmap(const_cast<char*>(data), size);
+	}
+
+#elif defined(_WIN32)
+
+	if (data) {
+		UnmapViewOfFile(data);
+	}
+	if (mapping_handle) {
+		CloseHandle(mapping_handle);
+	}
+	CloseHandle(file_handle);
+
+#endif // linux
+}
+
+ModuleFiles::OpenFile::~OpenFile() {
+	if (file) {
+		if (writer) {
+			try {
+				flush();
+			}
+			catch (...) {}
+		}
+		std::fclose(file);
+	}
+}
+
+bool ModuleFiles::OpenFile::fill() {
+	begin = 0;
+	end = std::fread(buffer.data(), 1, buffer.size(), file);
+	return end > 0;
+}
+
+bool ModuleFiles::OpenFile::read_line(std::string& line) {
+	line.clear();
+	bool read_any = false;
+
+	while (begin < end || fill()) {
+		read_any = true;
+
+		auto start = buffer.data() + begin;
+		auto line_break = static_cast<const char*>(memchr(start, '\n', end - begin));
+
+		if (line_break) {
+			line.append(start, line_break - start);
+			begin = line_break - buffer.data() + 1;
+			return true;
+		}
+
+		// the line goes on in the next block
+		line.append(start, end - begin);
+		begin = end;
+	}
+
+	return read_any;
+}
+
+void ModuleFiles::OpenFile::read_chunk(std::string& chunk, size_t size) {
+	chunk.clear();
+
+	while (chunk.size() < size && (begin < end || fill())) {
+		auto count = std::min(size - chunk.size(), end - begin);
+		chunk.append(buffer.data() + begin, count);
+		begin += count;
+	}
+}
+
+void ModuleFiles::OpenFile::write(std::string_view data) {
+	if (end + data.size() > buffer.size()) {
+		flush();
+	}
+
+	// larger than the buffer, it goes straight to the file
+	if (data.size() > buffer.size()) {
+		if (std::fwrite(data.data(), 1, data.size(), file) != data.size()) {
+			throw std::runtime_error("cannot write to the file");
+		}
+		return;
+	}
+
+	std::copy(data.begin(), data.end(), buffer.begin() + end);
+	end += data.size();
+
+	if (flush_policy == 2 || (flush_policy == 1 && data.find('\n') != std::string_view::npos)) {
+		flush();
+	}
+}
+
+void ModuleFiles::OpenFile::flush() {
+	if (end > 0 && std::fwrite(buffer.data(), 1, end, file) != end) {
+		end = 0;
+		throw std::runtime_error("cannot write to the file");
+	}
+	end = 0;
+}
+
 ModuleFiles::ModuleFiles() {}
 
 ModuleFiles::~ModuleFiles() = default;
 
+RuntimeValue* ModuleFiles::build_file(VirtualMachine* vm, RuntimeValue* path, RuntimeValue* mode, std::shared_ptr<OpenFile> file) {
+	flx_int id;
+	{
+		std::lock_guard<std::mutex> lock(files_mutex);
+		id = next_file_id++;
+		files[id] = file;
+	}
+
+	auto path_var = std::make_shared<RuntimeVariable>("path", Type::T_STRING);
+	path_var->set_value(vm->allocate_value(new RuntimeValue(path)));
+	vm->gc.add_var_root(path_var);
+
+	auto mode_var = std::make_shared<RuntimeVariable>("mode", Type::T_INT);
+	mode_var->set_value(vm->allocate_value(new RuntimeValue(mode)));
+	vm->gc.add_var_root(mode_var);
+
+	auto instance_id_var = std::make_shared<RuntimeVariable>(INSTANCE_ID_NAME, Type::T_INT);
+	instance_id_var->set_value(vm->allocate_value(new RuntimeValue(id)));
+	vm->gc.add_var_root(instance_id_var);
+
+	flx_struct str = flx_struct();
+	str["path"] = path_var;
+	str["mode"] = mode_var;
+	str[INSTANCE_ID_NAME] = instance_id_var;
+
+	return vm->allocate_value(new RuntimeValue(str, Constants::STD_NAMESPACE, "File"));
+}
+
+std::shared_ptr<ModuleFiles::OpenFile> ModuleFiles::find_file(RuntimeValue* handle, const std::string& operation) {
+	if (handle->is_void()) {
+		throw std::runtime_error("Cannot " + operation + " a null");
+	}
+
+	std::lock_guard<std::mutex> lock(files_mutex);
+	auto it = files.find(handle->get_raw_str()->at(INSTANCE_ID_NAME)->get_value()->get_i());
+	if (it == files.end()) {
+		throw std::runtime_error("Cannot " + operation + " a closed file");
+	}
+	return it->second;
+}
+
+std::shared_ptr<ModuleFiles::OpenFile> ModuleFiles::find_stream(RuntimeValue* handle, const std::string& operation) {
+	auto file = find_file(handle, operation);
+	if (!file->stream) {
+		throw std::runtime_error("Cannot " + operation + " a file opened by open_reader or open_writer");
+	}
+	return file;
+}
+
+std::shared_ptr<ModuleFiles::OpenFile> ModuleFiles::find_streamed_file(RuntimeValue* handle, const std::string& operation, bool writer) {
+	auto file = find_file(handle, operation);
+	if (file->stream || file->writer != writer) {
+		throw std::runtime_error("Cannot " + operation + " a file not opened by " + (writer ? "open_writer" : "open_reader"));
+	}
+	return file;
+}
+
+ModuleFiles::MappedView ModuleFiles::find_view(RuntimeValue* handle) {
+	if (handle->is_void()) {
+		throw std::runtime_error("view is null");
+	}
+
+	std::lock_guard<std::mutex> lock(views_mutex);
+	auto it = views.find(handle->get_raw_str()->at(INSTANCE_ID_NAME)->get_value()->get_i());
+	if (it == views.end()) {
+		throw std::runtime_error("view is closed");
+	}
+	return it->second;
+}
+
+RuntimeValue* ModuleFiles::build_view(VirtualMachine* vm, MappedView view) {
+	flx_int id;
+	{
+		std::lock_guard<std::mutex> lock(views_mutex);
+		id = next_view_id++;
+		views[id] = view;
+	}
+
+	auto instance_id_var = std::make_shared<RuntimeVariable>(INSTANCE_ID_NAME, Type::T_INT);
+	instance_id_var->set_value(vm->allocate_value(new RuntimeValue(id)));
+	vm->gc.add_var_root(instance_id_var);
+
+	auto size_var = std::make_shared<RuntimeVariable>("size", Type::T_INT);
+	size_var->set_value(vm->allocate_value(new RuntimeValue(flx_int(view.size))));
+	vm->gc.add_var_root(size_var);
+
+	flx_struct str = flx_struct();
+	str[INSTANCE_ID_NAME] = instance_id_var;
+	str["size"] = size_var;
+
+	return vm->allocate_value(new RuntimeValue(str, Constants::STD_NAMESPACE, "MappedView"));
+}
+
+// clips a range of a view, only the offset must be inside it
+static std::string_view view_range(const char* data, size_t size, flx_int offset, flx_int length) {
+	if (offset < 0 || size_t(offset) > size) {
+		throw std::runtime_error("offset " + std::to_string(offset) + " is out of the view of size " + std::to_string(size));
+	}
+	if (length < 0) {
+		throw std::runtime_error("length cannot be negative");
+	}
+	return std::string_view(data + offset, std::min(size_t(length), size - size_t(offset)));
+}
+
+RuntimeValue* ModuleFiles::build_task(VirtualMachine* vm, flx_int id) {
+	auto instance_id_var = std::make_shared<RuntimeVariable>(INSTANCE_ID_NAME, Type::T_INT);
+	instance_id_var->set_value(vm->allocate_value(new RuntimeValue(id)));
+	vm->gc.add_var_root(instance_id_var);
+
+	flx_struct str = flx_struct();
+	str[INSTANCE_ID_NAME] = instance_id_var;
+
+	return vm->allocate_value(new RuntimeValue(str, Constants::STD_NAMESPACE, "Task"));
+}
+
+utils::WalkFilter ModuleFiles::read_walk_filter(RuntimeValue* filter) {
+	utils::WalkFilter walk_filter;
+	if (filter->is_void()) {
+		return walk_filter;
+	}
+	auto filter_str = filter->get_raw_str();
+
+	auto field = [&filter_str](const std::string& name) -> RuntimeValue* {
+		auto it = filter_str->find(name);
+		if (it == filter_str->end() || it->second->get_value()->is_void()) {
+			return nullptr;
+		}
+		return it->second->get_value();
+		};
+
+	if (auto value = field("pattern")) {
+		walk_filter.pattern = value->get_s();
+	}
+	if (auto value = field("extensions")) {
+		auto extensions = value->get_arr();
+		for (flx_int i = 0; i < extensions.size(); ++i) {
+			if (extensions[i] && !extensions[i]->is_void()) {
+				walk_filter.extensions.push_back(extensions[i]->get_s());
+			}
+		}
+	}
+	if (auto value = field("min_size")) {
+		walk_filter.min_size = value->get_i();
+	}
+	if (auto value = field("max_size")) {
+		walk_filter.max_size = value->get_i();
+	}
+	if (auto value = field("modified_after")) {
+		walk_filter.modified_after = value->get_i();
+	}
+	if (auto value = field("modified_before")) {
+		walk_filter.modified_before = value->get_i();
+	}
+	if (auto value = field("max_depth")) {
+		walk_filter.max_depth = value->get_i();
+	}
+	if (auto value = field("include_dirs")) {
+		walk_filter.include_dirs = value->get_b();
+	}
+	if (auto value = field("follow_links")) {
+		walk_filter.follow_links = value->get_b();
+	}
+
+	return walk_filter;
+}
+
+RuntimeValue* ModuleFiles::build_dir_entries(VirtualMachine* vm, const std::vector<utils::WalkEntry>& entries) {
+	// the entries are not reachable until the array is built, so nothing is collected meanwhile
+	auto gc_enable = vm->gc.enable;
+	vm->gc.enable = false;
+
+	auto flx_arr = flx_array(entries.size());
+	for (size_t i = 0; i < entries.size(); ++i) {
+		const auto& entry = entries[i];
+
+		auto path_var = std::make_shared<RuntimeVariable>("path", Type::T_STRING);
+		path_var->set_value(vm->allocate_value(new RuntimeValue(flx_string(entry.path))));
+		vm->gc.add_var_root(path_var);
+
+		auto name_var = std::make_shared<RuntimeVariable>("name", Type::T_STRING);
+		name_var->set_value(vm->allocate_value(new RuntimeValue(flx_string(entry.name))));
+		vm->gc.add_var_root(name_var);
+
+		auto is_dir_var = std::make_shared<RuntimeVariable>("is_dir", Type::T_BOOL);
+		is_dir_var->set_value(vm->allocate_value(new RuntimeValue(flx_bool(entry.is_dir))));
+		vm->gc.add_var_root(is_dir_var);
+
+		auto size_var = std::make_shared<RuntimeVariable>("size", Type::T_INT);
+		size_var->set_value(vm->allocate_value(new RuntimeValue(flx_int(entry.size))));
+		vm->gc.add_var_root(size_var);
+
+		auto modified_var = std::make_shared<RuntimeVariable>("modified", Type::T_INT);
+		modified_var->set_value(vm->allocate_value(new RuntimeValue(flx_int(entry.modified))));
+		vm->gc.add_var_root(modified_var);
+
+		flx_struct entry_str;
+		entry_str["path"] = path_var;
+		entry_str["name"] = name_var;
+		entry_str["is_dir"] = is_dir_var;
+		entry_str["size"] = size_var;
+		entry_str["modified"] = modified_var;
+
+		flx_arr[i] = vm->allocate_value(new RuntimeValue(entry_str, Constants::STD_NAMESPACE, "DirEntry"));
+	}
+
+	auto entries_value = vm->allocate_value(new RuntimeValue(
+		flx_arr,
+		Type::T_STRUCT,
+		std::vector<size_t>{entries.size()},
+		Constants::STD_NAMESPACE,
+		"DirEntry"
+	));
+	vm->gc.enable = gc_enable;
+
+	return entries_value;
+}
+
+std::shared_ptr<utils::DirWalker> ModuleFiles::find_walk(RuntimeValue* handle) {
+	if (handle->is_void()) {
+		throw std::runtime_error("walk is null");
+	}
+
+	std::lock_guard<std::mutex> lock(walks_mutex);
+	auto it = walks.find(handle->get_raw_str()->at(INSTANCE_ID_NAME)->get_value()->get_i());
+	if (it == walks.end()) {
+		throw std::runtime_error("walk is closed");
+	}
+	return it->second;
+}
+
 void ModuleFiles::register_functions(SemanticAnalyser* visitor) {
 	visitor->builtin_functions["open"] = nullptr;
 	visitor->builtin_functions["read"] = nullptr;
@@ -24,6 +439,13 @@ void ModuleFiles::register_functions(SemanticAnalyser* visitor) {
 	visitor->builtin_functions["is_open"] = nullptr;
 	visitor->builtin_functions["close"] = nullptr;
 
+	visitor->builtin_functions["open_reader"] = nullptr;
+	visitor->builtin_functions["open_writer"] = nullptr;
+	visitor->builtin_functions["read_lines"] = nullptr;
+	visitor->builtin_functions["read_chunk"] = nullptr;
+	visitor->builtin_functions["is_eof"] = nullptr;
+	visitor->builtin_functions["flush_file"] = nullptr;
+
 	visitor->builtin_functions["is_file"] = nullptr;
 	visitor->builtin_functions["is_dir"] = nullptr;
 
@@ -32,6 +454,24 @@ void ModuleFiles::register_functions(SemanticAnalyser* visitor) {
 
 	visitor->builtin_functions["path_exists"] = nullptr;
 	visitor->builtin_functions["delete_path"] = nullptr;
+
+	visitor->builtin_functions["walk_dir"] = nullptr;
+	visitor->builtin_functions["open_walk"] = nullptr;
+	visitor->builtin_functions["next_entries"] = nullptr;
+	visitor->builtin_functions["close_walk"] = nullptr;
+
+	visitor->builtin_functions["read_file_async"] = nullptr;
+	visitor->builtin_functions["write_file_async"] = nullptr;
+	visitor->builtin_functions["list_dir_async"] = nullptr;
+	visitor->builtin_functions["delete_path_async"] = nullptr;
+
+	visitor->builtin_functions["map_file"] = nullptr;
+	visitor->builtin_functions["map_slice"] = nullptr;
+	visitor->builtin_functions["map_read"] = nullptr;
+	visitor->builtin_functions["map_byte"] = nullptr;
+	visitor->builtin_functions["map_find"] = nullptr;
+	visitor->builtin_functions["map_count"] = nullptr;
+	visitor->builtin_functions["unmap"] = nullptr;
 }
 
 void ModuleFiles::register_functions(VirtualMachine* vm) {
@@ -43,39 +483,64 @@ void ModuleFiles::register_functions(VirtualMachine* vm) {
 			std::dynamic_pointer_cast<RuntimeVariable>(scope->find_declared_variable("mode"))->get_value()
 		};
 
-		auto path_var = std::make_shared<RuntimeVariable>("path", Type::T_STRING);
-		path_var->set_value(vm->allocate_value(new RuntimeValue(vals[0])));
-		vm->gc.add_var_root(path_var);
+		auto file = std::make_shared<OpenFile>();
+		std::ios_base::openmode mode = std::ios_base::openmode(vals[1]->get_i());
+		file->stream = std::make_unique<std::fstream>(vals[0]->get_s(), mode);
 
-		auto mode_var = std::make_shared<RuntimeVariable>("mode", Type::T_INT);
-		mode_var->set_value(vm->allocate_value(new RuntimeValue(vals[1])));
-		vm->gc.add_var_root(mode_var);
+		vm->push_constant(build_file(vm, vals[0], vals[1], file));
 
-		flx_struct str = flx_struct();
-		str["path"] = path_var;
-		str["mode"] = mode_var;
+		};
 
-		auto parmode = vals[1]->get_i();
+	vm->builtin_functions["open_reader"] = [this, vm]() {
+		auto scope = vm->get_back_scope(Constants::STD_NAMESPACE);
+		auto path = std::dynamic_pointer_cast<RuntimeVariable>(scope->find_declared_variable("path"))->get_value();
+		auto buffer_size = std::dynamic_pointer_cast<RuntimeVariable>(scope->find_declared_variable("buffer_size"))->get_value()->get_i();
 
-		std::fstream* fs = nullptr;
-		try {
-			std::ios_base::openmode mode = std::ios_base::openmode(parmode);
-			fs = new std::fstream(vals[0]->get_s(), mode);
+		if (buffer_size <= 0) {
+			throw std::runtime_error("buffer size must be greater than zero");
+		}
 
-			auto instance_id_var = std::make_shared<RuntimeVariable>(INSTANCE_ID_NAME, Type::T_INT);
-			instance_id_var->set_value(vm->allocate_value(new RuntimeValue((flx_int)fs)));
-			vm->gc.add_var_root(instance_id_var);
+		auto file = std::make_shared<OpenFile>();
+		file->file = std::fopen(path->get_s().c_str(), "rb");
+		if (!file->file) {
+			throw std::runtime_error("cannot open '" + path->get_s() + "' to read");
+		}
+		// our buffer is the only one, each fill is a single read call
+		std::setvbuf(file->file, nullptr, _IONBF, 0);
+		file->buffer.resize(size_t(buffer_size));
 
-			str[INSTANCE_ID_NAME] = instance_id_var;
+		auto mode = vm->allocate_value(new RuntimeValue(flx_int(std::ios_base::in | std::ios_base::binary)));
+		vm->push_constant(build_file(vm, path, mode, file));
 
-			// initialize file struct values
-			RuntimeValue* flxfile = vm->allocate_value(new RuntimeValue(str, Constants::STD_NAMESPACE, "File"));
+		};
 
-			vm->push_constant(flxfile);
+	vm->builtin_functions["open_writer"] = [this, vm]() {
+		auto scope = vm->get_back_scope(Constants::STD_NAMESPACE);
+		auto path = std::dynamic_pointer_cast<RuntimeVariable>(scope->find_declared_variable("path"))->get_value();
+		auto buffer_size = std::dynamic_pointer_cast<RuntimeVariable>(scope->find_declared_variable("buffer_size"))->get_value()->get_i();
+		auto flush_policy = std::dynamic_pointer_cast<RuntimeVariable>(scope->find_declared_variable("flush_policy"))->get_value()->get_i();
+		auto append = std::dynamic_pointer_cast<RuntimeVariable>(scope->find_declared_variable("append"))->get_value()->get_b();
+
+		if (buffer_size <= 0) {
+			throw std::runtime_error("buffer size must be greater than zero");
 		}
-		catch (const std::runtime_error& ex) {
-			throw std::runtime_error(ex.what());
+		if (flush_policy < 0 || flush_policy > 2) {
+			throw std::runtime_error("flush policy must be 0 (when full), 1 (each line) or 2 (each write)");
+		}
+
+		auto file = std::make_shared<OpenFile>();
+		file->file = std::fopen(path->get_s().c_str(), append ? "ab" : "wb");
+		if (!file->file) {
+			throw std::runtime_error("cannot open '" + path->get_s() + "' to write");
 		}
+		std::setvbuf(file->file, nullptr, _IONBF, 0);
+		file->buffer.resize(size_t(buffer_size));
+		file->writer = true;
+		file->flush_policy = flush_policy;
+
+		auto mode = vm->allocate_value(new RuntimeValue(flx_int(std::ios_base::out | std::ios_base::binary
+			| (append ? std::ios_base::app : std::ios_base::trunc))));
+		vm->push_constant(build_file(vm, path, mode, file));
 
 		};
 
@@ -83,56 +548,134 @@ void ModuleFiles::register_functions(VirtualMachine* vm) {
 		auto scope = vm->get_back_scope(Constants::STD_NAMESPACE);
 		auto val = std::dynamic_pointer_cast<RuntimeVariable>(scope->find_declared_variable("file"))->get_value();
 
-		if (val->is_void()) {
-			throw std::runtime_error("Cannot read from a null");
-		}
+		// the file stays alive off the turn even if another task closes it
+		auto file = find_stream(val, "read from");
+
+		std::stringstream ss;
+		vm->run_blocking([file, &ss]() {
+			std::lock_guard<std::mutex> lock(file->mutex);
+			auto fs = file->stream.get();
+			fs->seekg(0);
+
+			std::string line;
+			while (std::getline(*fs, line)) {
+				ss << line << std::endl;
+			}
+			});
 
 		auto rval = vm->allocate_value(new RuntimeValue(Type::T_STRING));
+		rval->set(ss.str());
 
-		std::fstream* fs = ((std::fstream*)val->get_str()[INSTANCE_ID_NAME]->get_value()->get_i());
+		vm->push_constant(rval);
 
-		fs->seekg(0);
+		};
+
+	vm->builtin_functions["read_line"] = [this, vm]() {
+		auto scope = vm->get_back_scope(Constants::STD_NAMESPACE);
+		auto val = std::dynamic_pointer_cast<RuntimeVariable>(scope->find_declared_variable("file"))->get_value();
+
+		auto file = find_file(val, "read line from");
 
-		std::stringstream ss;
 		std::string line;
-		while (std::getline(*fs, line)) {
-			ss << line << std::endl;
+		std::unique_lock<std::mutex> lock(file->mutex);
+		if (file->stream) {
+			std::getline(*file->stream, line);
+		}
+		else if (file->writer) {
+			throw std::runtime_error("Cannot read line from a file opened by open_writer");
+		}
+		else if (file->begin < file->end) {
+			file->read_line(line);
+		}
+		else {
+			// the lock is not held while waiting for the turn
+			lock.unlock();
+			vm->run_blocking([&file, &line]() {
+				std::lock_guard<std::mutex> lock(file->mutex);
+				file->read_line(line);
+				});
 		}
-		rval->set(ss.str());
 
-		vm->push_constant(rval);
+		vm->push_new_constant(new RuntimeValue(flx_string(std::move(line))));
 
 		};
 
-	vm->builtin_functions["read_line"] = [this, vm]() {
+	vm->builtin_functions["read_lines"] = [this, vm]() {
 		auto scope = vm->get_back_scope(Constants::STD_NAMESPACE);
 		auto val = std::dynamic_pointer_cast<RuntimeVariable>(scope->find_declared_variable("file"))->get_value();
+		auto max_lines = std::dynamic_pointer_cast<RuntimeVariable>(scope->find_declared_variable("max_lines"))->get_value()->get_i();
 
-		if (val->is_void()) {
-			throw std::runtime_error("Cannot read line from a null");
+		auto file = find_streamed_file(val, "read lines from", false);
+
+		// a batch of lines per call, an empty batch at the end of the file
+		std::vector<std::string> lines;
+		vm->run_blocking([&]() {
+			std::lock_guard<std::mutex> lock(file->mutex);
+			std::string line;
+			while (flx_int(lines.size()) < max_lines && file->read_line(line)) {
+				lines.push_back(std::move(line));
+			}
+			});
+
+		flx_array values = flx_array(lines.size());
+		for (size_t i = 0; i < lines.size(); ++i) {
+			values[i] = vm->allocate_value(new RuntimeValue(flx_string(std::move(lines[i]))));
 		}
 
-		auto rval = vm->allocate_value(new RuntimeValue(Type::T_STRING));
+		vm->push_new_constant(new RuntimeValue(values, Type::T_STRING, std::vector<size_t>{ size_t(values.size()) }));
 
-		std::fstream* fs = ((std::fstream*)val->get_str()[INSTANCE_ID_NAME]->get_value()->get_i());
+		};
 
-		std::string line;
-		std::getline(*fs, line);
-		rval->set(line);
+	vm->builtin_functions["read_chunk"] = [this, vm]() {
+		auto scope = vm->get_back_scope(Constants::STD_NAMESPACE);
+		auto val = std::dynamic_pointer_cast<RuntimeVariable>(scope->find_declared_variable("file"))->get_value();
+		auto size = std::dynamic_pointer_cast<RuntimeVariable>(scope->find_declared_variable("size"))->get_value()->get_i();
 
-		vm->push_constant(rval);
+		if (size < 0) {
+			throw std::runtime_error("chunk size cannot be negative");
+		}
+
+		auto file = find_streamed_file(val, "read chunk from", false);
+
+		std::string chunk;
+		vm->run_blocking([&]() {
+			std::lock_guard<std::mutex> lock(file->mutex);
+			file->read_chunk(chunk, size_t(size));
+			});
+
+		vm->push_new_constant(new RuntimeValue(flx_string(std::move(chunk))));
 
 		};
 
-	vm->builtin_functions["read_all_bytes"] = [this, vm]() {
+	vm->builtin_functions["is_eof"] = [this, vm]() {
 		auto scope = vm->get_back_scope(Constants::STD_NAMESPACE);
 		auto val = std::dynamic_pointer_cast<RuntimeVariable>(scope->find_declared_variable("file"))->get_value();
 
-		if (val->is_void()) {
-			throw std::runtime_error("Cannot read bytes from a null");
+		auto file = find_file(val, "check is_eof on");
+
+		bool eof;
+		std::lock_guard<std::mutex> lock(file->mutex);
+		if (file->stream) {
+			eof = file->stream->peek() == std::char_traits<char>::eof();
+		}
+		else if (file->writer) {
+			eof = true;
+		}
+		else {
+			eof = file->begin == file->end && !file->fill();
 		}
 
-		std::fstream* fs = ((std::fstream*)val->get_str()[INSTANCE_ID_NAME]->get_value()->get_i());
+		vm->push_new_constant(new RuntimeValue(flx_bool(eof)));
+
+		};
+
+	vm->builtin_functions["read_all_bytes"] = [this, vm]() {
+		auto scope = vm->get_back_scope(Constants::STD_NAMESPACE);
+		auto val = std::dynamic_pointer_cast<RuntimeVariable>(scope->find_declared_variable("file"))->get_value();
+
+		auto file = find_stream(val, "read bytes from");
+		std::lock_guard<std::mutex> lock(file->mutex);
+		auto fs = file->stream.get();
 
 		fs->seekg(0);
 
@@ -170,13 +713,50 @@ void ModuleFiles::register_functions(VirtualMachine* vm) {
 			std::dynamic_pointer_cast<RuntimeVariable>(scope->find_declared_variable("data"))->get_value()
 		};
 
-		RuntimeValue* cpfile = vals[0];
-		if (cpfile->is_void()) {
-			throw std::runtime_error("Cannot write to a null");
+		auto file = find_file(vals[0], "write to");
+
+		std::unique_lock<std::mutex> lock(file->mutex);
+		if (file->stream) {
+			*file->stream << vals[1]->get_s();
+		}
+		else if (!file->writer) {
+			throw std::runtime_error("Cannot write to a file opened by open_reader");
+		}
+		else {
+			const auto& data = vals[1]->get_s();
+			bool flushes = file->end + data.size() > file->buffer.size() || file->flush_policy != 0;
+			if (flushes) {
+				lock.unlock();
+				vm->run_blocking([&file, &data]() {
+					std::lock_guard<std::mutex> lock(file->mutex);
+					file->write(data);
+					});
+			}
+			else {
+				file->write(data);
+			}
 		}
 
-		std::fstream* fs = ((std::fstream*)cpfile->get_str()[INSTANCE_ID_NAME]->get_value()->get_i());
-		*fs << vals[1]->get_s();
+		vm->push_empty_constant(Type::T_UNDEFINED);
+
+		};
+
+	vm->builtin_functions["flush_file"] = [this, vm]() {
+		auto scope = vm->get_back_scope(Constants::STD_NAMESPACE);
+		auto val = std::dynamic_pointer_cast<RuntimeVariable>(scope->find_declared_variable("file"))->get_value();
+
+		auto file = find_file(val, "flush");
+
+		if (file->stream) {
+			std::lock_guard<std::mutex> lock(file->mutex);
+			file->stream->flush();
+		}
+		else if (file->writer) {
+			vm->run_blocking([&file]() {
+				std::lock_guard<std::mutex> lock(file->mutex);
+				file->flush();
+				});
+		}
 
 		vm->push_empty_constant(Type::T_UNDEFINED);
 
@@ -189,12 +769,9 @@ void ModuleFiles::register_functions(VirtualMachine* vm) {
 			std::dynamic_pointer_cast<RuntimeVariable>(scope->find_declared_variable("bytes"))->get_value()
 		};
 
-		RuntimeValue* cpfile = vals[0];
-		if (cpfile->is_void()) {
-			throw std::runtime_error("Cannot write to a null");
-		}
-
-		std::fstream* fs = ((std::fstream*)cpfile->get_str()[INSTANCE_ID_NAME]->get_value()->get_i());
+		auto file = find_stream(vals[0], "write to");
+		std::lock_guard<std::mutex> lock(file->mutex);
+		auto fs = file->stream.get();
 
 		auto arr = vals[1]->get_arr();
 
@@ -206,7 +783,9 @@ void ModuleFiles::register_functions(VirtualMachine* vm) {
 			buffer[i] = arr[i]->get_c();
 		}
 
-		fs->write(buffer, sizeof(buffer));
+		fs->write(buffer, buffer_size);
+
+		delete[] buffer;
 
 		vm->push_empty_constant(Type::T_UNDEFINED);
 
@@ -219,9 +798,18 @@ void ModuleFiles::register_functions(VirtualMachine* vm) {
 		if (val->is_void()) {
 			throw std::runtime_error("Cannot check is_open on a null");
 		}
-		auto rval = vm->allocate_value(new RuntimeValue(Type::T_BOOL));
-		rval->set(flx_bool(((std::fstream*)val->get_str()[INSTANCE_ID_NAME]->get_value()->get_i())->is_open()));
-		vm->push_constant(rval);
+
+		bool is_open = false;
+		{
+			std::lock_guard<std::mutex> lock(files_mutex);
+			auto it = files.find(val->get_raw_str()->at(INSTANCE_ID_NAME)->get_value()->get_i());
+			if (it != files.end()) {
+				std::lock_guard<std::mutex> file_lock(it->second->mutex);
+				is_open = it->second->stream ? it->second->stream->is_open() : it->second->file != nullptr;
+			}
+		}
+
+		vm->push_new_constant(new RuntimeValue(flx_bool(is_open)));
 
 		};
 
@@ -230,10 +818,29 @@ void ModuleFiles::register_functions(VirtualMachine* vm) {
 		auto val = std::dynamic_pointer_cast<RuntimeVariable>(scope->find_declared_variable("file"))->get_value();
 
 		auto instance_id = val->get_raw_str()->at(INSTANCE_ID_NAME);
-		if (auto rawfile = (std::fstream*)instance_id->get_value()->get_i()) {
-			rawfile->close();
-			delete rawfile;
-			instance_id->get_value()->set(flx_int(0));
+
+		std::shared_ptr<OpenFile> file;
+		{
+			std::lock_guard<std::mutex> lock(files_mutex);
+			auto it = files.find(instance_id->get_value()->get_i());
+			if (it != files.end()) {
+				file = std::move(it->second);
+				files.erase(it);
+			}
+		}
+		instance_id->get_value()->set(flx_int(0));
+
+		// a writer flushes its pending bytes here, so a failed write is raised
+		if (file) {
+			vm->run_blocking([&file]() {
+				{
+					std::lock_guard<std::mutex> lock(file->mutex);
+					if (file->writer) {
+						file->flush();
+					}
+				}
+				file.reset();
+				});
 		}
 
 		vm->push_empty_constant(Type::T_UNDEFINED);
@@ -319,4 +926,280 @@ void ModuleFiles::register_functions(VirtualMachine* vm) {
 
 		};
 
+	// the tree is walked by the threads of a DirWalker while other tasks run,
+	// only the values of the entries are built on the turn of the vm
+
+	vm->builtin_functions["walk_dir"] = [this, vm]() {
+		auto scope = vm->get_back_scope(Constants::STD_NAMESPACE);
+		auto path = std::dynamic_pointer_cast<RuntimeVariable>(scope->find_declared_variable("path"))->get_value()->get_s();
+		auto filter = read_walk_filter(std::dynamic_pointer_cast<RuntimeVariable>(scope->find_declared_variable("filter"))->get_value());
+
+		std::vector<utils::WalkEntry> entries;
+		vm->run_blocking([&]() {
+			utils::DirWalker walker(path, filter);
+			for (auto batch = walker.next(SIZE_MAX); !batch.empty(); batch = walker.next(SIZE_MAX)) {
+				entries.insert(entries.end(), std::make_move_iterator(batch.begin()), std::make_move_iterator(batch.end()));
+			}
+			});
+
+		vm->push_constant(build_dir_entries(vm, entries));
+
+		};
+
+	vm->builtin_functions["open_walk"] = [this, vm]() {
+		auto scope = vm->get_back_scope(Constants::STD_NAMESPACE);
+		auto path = std::dynamic_pointer_cast<RuntimeVariable>(scope->find_declared_variable("path"))->get_value()->get_s();
+		auto filter = read_walk_filter(std::dynamic_pointer_cast<RuntimeVariable>(scope->find_declared_variable("filter"))->get_value());
+
+		auto walker = std::make_shared<utils::DirWalker>(path, filter);
+
+		flx_int id;
+		{
+			std::lock_guard<std::mutex> lock(walks_mutex);
+			id = next_walk_id++;
+			walks[id] = walker;
+		}
+
+		auto instance_id_var = std::make_shared<RuntimeVariable>(INSTANCE_ID_NAME, Type::T_INT);
+		instance_id_var->set_value(vm->allocate_value(new RuntimeValue(id)));
+		vm->gc.add_var_root(instance_id_var);
+
+		flx_struct str = flx_struct();
+		str[INSTANCE_ID_NAME] = instance_id_var;
+
+		vm->push_new_constant(new RuntimeValue(str, Constants::STD_NAMESPACE, "DirWalk"));
+
+		};
+
+	vm->builtin_functions["next_entries"] = [this, vm]() {
+		auto scope = vm->get_back_scope(Constants::STD_NAMESPACE);
+		auto walker = find_walk(std::dynamic_pointer_cast<RuntimeVariable>(scope->find_declared_variable("walk"))->get_value());
+		auto max = std::dynamic_pointer_cast<RuntimeVariable>(scope->find_declared_variable("max"))->get_value()->get_i();
+
+		if (max <= 0) {
+			throw std::runtime_error("max must be greater than zero");
+		}
+
+		std::vector<utils::WalkEntry> entries;
+		vm->run_blocking([&]() { entries = walker->next(size_t(max)); });
+
+		vm->push_constant(build_dir_entries(vm, entries));
+
+		};
+
+	vm->builtin_functions["close_walk"] = [this, vm]() {
+		auto scope = vm->get_back_scope(Constants::STD_NAMESPACE);
+		auto val = std::dynamic_pointer_cast<RuntimeVariable>(scope->find_declared_variable("walk"))->get_value();
+
+		std::shared_ptr<utils::DirWalker> walker;
+		if (!val->is_void()) {
+			std::lock_guard<std::mutex> lock(walks_mutex);
+			auto it = walks.find(val->get_raw_str()->at(INSTANCE_ID_NAME)->get_value()->get_i());
+			if (it != walks.end()) {
+				walker = std::move(it->second);
+				walks.erase(it);
+			}
+		}
+
+		// stopping the walkers waits for the directories being read
+		if (walker) {
+			vm->run_blocking([&walker]() { walker.reset(); });
+		}
+
+		vm->push_empty_constant(Type::T_UNDEFINED);
+
+		};
+
+	// the async operations return a Task completed outside the vm, the
+	// running task goes on and awaits it when it needs the result
+
+	vm->builtin_functions["read_file_async"] = [this, vm]() {
+		auto scope = vm->get_back_scope(Constants::STD_NAMESPACE);
+		auto path = std::dynamic_pointer_cast<RuntimeVariable>(scope->find_declared_variable("path"))->get_value()->get_s();
+
+		auto scheduler = get_scheduler(vm);
+		auto id = scheduler->begin_operation();
+
+		scheduler->get_file_io()->read_file(path, [vm, scheduler, id](AsyncFileIo::Result result) {
+			auto data = std::make_shared<std::string>(std::move(result.data));
+			scheduler->complete_operation(id, [vm, data]() {
+				return vm->allocate_value(new RuntimeValue(flx_string(std::move(*data))));
+				}, result.error);
+			});
+
+		vm->push_constant(build_task(vm, id));
+
+		};
+
+	vm->builtin_functions["write_file_async"] = [this, vm]() {
+		auto scope = vm->get_back_scope(Constants::STD_NAMESPACE);
+		auto path = std::dynamic_pointer_cast<RuntimeVariable>(scope->find_declared_variable("path"))->get_value()->get_s();
+		auto data = std::dynamic_pointer_cast<RuntimeVariable>(scope->find_declared_variable("data"))->get_value()->get_s();
+		auto append = std::dynamic_pointer_cast<RuntimeVariable>(scope->find_declared_variable("append"))->get_value()->get_b();
+
+		auto scheduler = get_scheduler(vm);
+		auto id = scheduler->begin_operation();
+
+		scheduler->get_file_io()->write_file(path, std::move(data), append, [vm, scheduler, id](AsyncFileIo::Result result) {
+			scheduler->complete_operation(id, [vm]() {
+				return vm->allocate_value(new RuntimeValue(Type::T_UNDEFINED));
+				}, result.error);
+			});
+
+		vm->push_constant(build_task(vm, id));
+
+		};
+
+	vm->builtin_functions["list_dir_async"] = [this, vm]() {
+		auto scope = vm->get_back_scope(Constants::STD_NAMESPACE);
+		auto path = std::dynamic_pointer_cast<RuntimeVariable>(scope->find_declared_variable("path"))->get_value()->get_s();
+
+		auto scheduler = get_scheduler(vm);
+		auto id = scheduler->begin_operation();
+
+		scheduler->get_file_io()->list_dir(path, [vm, scheduler, id](AsyncFileIo::Result result) {
+			auto files = std::make_shared<std::vector<std::string>>(std::move(result.entries));
+			scheduler->complete_operation(id, [vm, files]() {
+				flx_array values = flx_array(files->size());
+				for (size_t i = 0; i < files->size(); ++i) {
+					values[i] = vm->allocate_value(new RuntimeValue(flx_string((*files)[i])));
+				}
+				return vm->allocate_value(new RuntimeValue(values, Type::T_STRING, std::vector<size_t>{size_t(values.size())}));
+				}, result.error);
+			});
+
+		vm->push_constant(build_task(vm, id));
+
+		};
+
+	vm->builtin_functions["delete_path_async"] = [this, vm]() {
+		auto scope = vm->get_back_scope(Constants::STD_NAMESPACE);
+		auto path = std::dynamic_pointer_cast<RuntimeVariable>(scope->find_declared_variable("path"))->get_value()->get_s();
+
+		auto scheduler = get_scheduler(vm);
+		auto id = scheduler->begin_operation();
+
+		scheduler->get_file_io()->delete_path(path, [vm, scheduler, id](AsyncFileIo::Result result) {
+			scheduler->complete_operation(id, [vm]() {
+				return vm->allocate_value(new RuntimeValue(Type::T_UNDEFINED));
+				}, result.error);
+			});
+
+		vm->push_constant(build_task(vm, id));
+
+		};
+
+	vm->builtin_functions["map_file"] = [this, vm]() {
+		auto scope = vm->get_back_scope(Constants::STD_NAMESPACE);
+		auto val = std::dynamic_pointer_cast<RuntimeVariable>(scope->find_declared_variable("path"))->get_value();
+
+		auto mapping = std::make_shared<FileMapping>(val->get_s());
+
+		vm->push_constant(build_view(vm, MappedView{ mapping, 0, mapping->size }));
+
+		};
+
+	vm->builtin_functions["map_slice"] = [this, vm]() {
+		auto scope = vm->get_back_scope(Constants::STD_NAMESPACE);
+		auto view = find_view(std::dynamic_pointer_cast<RuntimeVariable>(scope->find_declared_variable("view"))->get_value());
+		auto offset = std::dynamic_pointer_cast<RuntimeVariable>(scope->find_declared_variable("offset"))->get_value()->get_i();
+		auto length = std::dynamic_pointer_cast<RuntimeVariable>(scope->find_declared_variable("length"))->get_value()->get_i();
+
+		// the slice shares the mapping, nothing is copied
+		auto range = view_range(view.mapping->data + view.offset, view.size, offset, length);
+
+		vm->push_constant(build_view(vm, MappedView{ view.mapping, view.offset + size_t(offset), range.size() }));
+
+		};
+
+	vm->builtin_functions["map_read"] = [this, vm]() {
+		auto scope = vm->get_back_scope(Constants::STD_NAMESPACE);
+		auto view = find_view(std::dynamic_pointer_cast<RuntimeVariable>(scope->find_declared_variable("view"))->get_value());
+		auto offset = std::dynamic_pointer_cast<RuntimeVariable>(scope->find_declared_variable("offset"))->get_value()->get_i();
+		auto length = std::dynamic_pointer_cast<RuntimeVariable>(scope->find_declared_variable("length"))->get_value()->get_i();
+
+		auto range = view_range(view.mapping->data + view.offset, view.size, offset, length);
+
+		vm->push_new_constant(new RuntimeValue(flx_string(range)));
+
+		};
+
+	vm->builtin_functions["map_byte"] = [this, vm]() {
+		auto scope = vm->get_back_scope(Constants::STD_NAMESPACE);
+		auto view = find_view(std::dynamic_pointer_cast<RuntimeVariable>(scope->find_declared_variable("view"))->get_value());
+		auto offset = std::dynamic_pointer_cast<RuntimeVariable>(scope->find_declared_variable("offset"))->get_value()->get_i();
+
+		if (offset < 0 || size_t(offset) >= view.size) {
+			throw std::runtime_error("offset " + std::to_string(offset) + " is out of the view of size " + std::to_string(view.size));
+		}
+
+		vm->push_new_constant(new RuntimeValue(flx_char(view.mapping->data[view.offset + offset])));
+
+		};
+
+	vm->builtin_functions["map_find"] = [this, vm]() {
+		auto scope = vm->get_back_scope(Constants::STD_NAMESPACE);
+		auto view = find_view(std::dynamic_pointer_cast<RuntimeVariable>(scope->find_declared_variable("view"))->get_value());
+		auto pattern = std::dynamic_pointer_cast<RuntimeVariable>(scope->find_declared_variable("pattern"))->get_value()->get_s();
+		auto offset = std::dynamic_pointer_cast<RuntimeVariable>(scope->find_declared_variable("offset"))->get_value()->get_i();
+
+		auto content = std::string_view(view.mapping->data + view.offset, view.size);
+		view_range(content.data(), content.size(), offset, 0);
+
+		// scanning may fault pages in, other tasks run meanwhile
+		size_t position = std::string_view::npos;
+		vm->run_blocking([&]() {
+			position = content.find(pattern, size_t(offset));
+			});
+
+		vm->push_new_constant(new RuntimeValue(flx_int(position == std::string_view::npos ? -1 : flx_int(position))));
+
+		};
+
+	vm->builtin_functions["map_count"] = [this, vm]() {
+		auto scope = vm->get_back_scope(Constants::STD_NAMESPACE);
+		auto view = find_view(std::dynamic_pointer_cast<RuntimeVariable>(scope->find_declared_variable("view"))->get_value());
+		auto pattern = std::dynamic_pointer_cast<RuntimeVariable>(scope->find_declared_variable("pattern"))->get_value()->get_s();
+
+		if (pattern.empty()) {
+			throw std::runtime_error("pattern cannot be empty");
+		}
+
+		auto content = std::string_view(view.mapping->data + view.offset, view.size);
+
+		flx_int count = 0;
+		vm->run_blocking([&]() {
+			if (pattern.size() == 1) {
+				// memchr is vectorized by the c library
+				auto current = content.data();
+				auto end = current + content.size();
+				while (auto found = static_cast<const char*>(memchr(current, pattern[0], end - current))) {
+					++count;
+					current = found + 1;
+				}
+				return;
+			}
+			for (auto position = content.find(pattern); position != std::string_view::npos;
+				position = content.find(pattern, position + pattern.size())) {
+				++count;
+			}
+			});
+
+		vm->push_new_constant(new RuntimeValue(count));
+
+		};
+
+	vm->builtin_functions["unmap"] = [this, vm]() {
+		auto scope = vm->get_back_scope(Constants::STD_NAMESPACE);
+		auto val = std::dynamic_pointer_cast<RuntimeVariable>(scope->find_declared_variable("view"))->get_value();
+
+		if (!val->is_void()) {
+			std::lock_guard<std::mutex> lock(views_mutex);
+			views.erase(val->get_raw_str()->at(INSTANCE_ID_NAME)->get_value()->get_i());
+		}
+
+		vm->push_empty_constant(Type::T_UNDEFINED);
+
+		};
+
 }
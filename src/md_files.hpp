@@ -3,20 +3,108 @@
 
 #include <fstream>
 #include <sstream>
+#include <cstdio>
+#include <string_view>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
 
 #include "module.hpp"
+#include "types.hpp"
+#include "dir_walker.hpp"
 
 namespace core {
 
 	namespace modules {
 
 		class ModuleFiles : public Module {
+		private:
+			/*
+				A file opened by open keeps its std::fstream. Files opened by open_reader
+				or open_writer are unbuffered c files streamed through our own buffer,
+				so a line costs a scan of the buffer instead of a stream call per char.
+			*/
+			struct OpenFile {
+				std::unique_ptr<std::fstream> stream;
+				std::FILE* file = nullptr;
+				std::vector<char> buffer;
+				// unread bytes of a reader are [begin, end), pending bytes of a writer [0, end)
+				size_t begin = 0;
+				size_t end = 0;
+				bool writer = false;
+				flx_int flush_policy = 0;
+				// the module is shared by the vms of the threads, it guards the fields above
+				std::mutex mutex;
+
+				// flushes a writer at best, close reports the errors
+				~OpenFile();
+
+				// refills the buffer of a reader, false at the end of the file
+				bool fill();
+				// false at the end of the file, the line has no line break
+				bool read_line(std::string& line);
+				void read_chunk(std::string& chunk, size_t size);
+				void write(std::string_view data);
+				void flush();
+			};
+
+			// read only mapping of a whole file, unmapped with its last view
+			struct FileMapping {
+				const char* data = nullptr;
+				size_t size = 0;
+#ifdef _WIN32
+				void* file_handle = nullptr;
+				void* mapping_handle = nullptr;
+#endif // _WIN32
+
+				FileMapping(const std::string& path);
+				~FileMapping();
+			};
+
+			// range of a mapping seen by a MappedView value
+			struct MappedView {
+				std::shared_ptr<FileMapping> mapping;
+				size_t offset;
+				size_t size;
+			};
+
+			std::mutex files_mutex;
+			flx_int next_file_id = 1;
+			std::unordered_map<flx_int, std::shared_ptr<OpenFile>> files;
+
+			std::mutex views_mutex;
+			flx_int next_view_id = 1;
+			std::unordered_map<flx_int, MappedView> views;
+
+			std::mutex walks_mutex;
+			flx_int next_walk_id = 1;
+			std::unordered_map<flx_int, std::shared_ptr<utils::DirWalker>> walks;
+
 		public:
 			ModuleFiles();
 			~ModuleFiles();
 
 			void register_functions(analysis::SemanticAnalyser* visitor) override;
 			void register_functions(runtime::VirtualMachine* vm) override;
+
+		private:
+			RuntimeValue* build_file(runtime::VirtualMachine* vm, RuntimeValue* path, RuntimeValue* mode, std::shared_ptr<OpenFile> file);
+			std::shared_ptr<OpenFile> find_file(RuntimeValue* handle, const std::string& operation);
+			// a file opened by open, it has an fstream
+			std::shared_ptr<OpenFile> find_stream(RuntimeValue* handle, const std::string& operation);
+			std::shared_ptr<OpenFile> find_streamed_file(RuntimeValue* handle, const std::string& operation, bool writer);
+
+			MappedView find_view(RuntimeValue* handle);
+			RuntimeValue* build_view(runtime::VirtualMachine* vm, MappedView view);
+
+			// a null filter or null fields keep the defaults
+			static utils::WalkFilter read_walk_filter(RuntimeValue* filter);
+			RuntimeValue* build_dir_entries(runtime::VirtualMachine* vm, const std::vector<utils::WalkEntry>& entries);
+			std::shared_ptr<utils::DirWalker> find_walk(RuntimeValue* handle);
+
+			// the Task of flx.core.async awaiting an operation of the scheduler
+			RuntimeValue* build_task(runtime::VirtualMachine* vm, flx_int id);
 		};
 
 	}
@@ -19,6 +19,8 @@ void ModuleGC::register_functions(SemanticAnalyser* visitor) {
 	visitor->builtin_functions["gc_maybe_collect"] = nullptr;
 	visitor->builtin_functions["gc_get_max_heap"] = nullptr;
 	visitor->builtin_functions["gc_set_max_heap"] = nullptr;
+	visitor->builtin_functions["gc_stats"] = nullptr;
+	visitor->builtin_functions["gc_save_snapshot"] = nullptr;
 }
 
 void ModuleGC::register_functions(VirtualMachine* vm) {
@@ -69,4 +71,59 @@ void ModuleGC::register_functions(VirtualMachine* vm) {
 
 		};
 
+	vm->builtin_functions["gc_stats"] = [this, vm]() {
+		const auto& stats = vm->gc.stats;
+
+		flx_struct str = flx_struct();
+
+		auto declare_field = [vm, &str](const std::string& identifier, RuntimeValue* value, TypeDefinition type) {
+			auto var = std::make_shared<RuntimeVariable>(identifier, type);
+			var->set_value(vm->allocate_value(value));
+			vm->gc.add_var_root(var);
+			str[identifier] = var;
+			};
+
+		auto declare_int_field = [&declare_field](const std::string& identifier, flx_int value) {
+			declare_field(identifier, new RuntimeValue(value), Type::T_INT);
+			};
+
+		declare_int_field("collections", flx_int(stats.collections));
+		declare_int_field("total_pause_ns", flx_int(stats.total_pause));
+		declare_int_field("max_pause_ns", flx_int(stats.max_pause));
+		declare_int_field("last_pause_ns", flx_int(stats.last_pause));
+		declare_int_field("allocated_objects", flx_int(stats.allocated_objects));
+		declare_int_field("allocated_bytes", flx_int(stats.allocated_bytes));
+		declare_int_field("freed_objects", flx_int(stats.freed_objects));
+		declare_int_field("freed_bytes", flx_int(stats.freed_bytes));
+		declare_int_field("surviving_objects", flx_int(stats.surviving_objects));
+		declare_int_field("surviving_bytes", flx_int(stats.surviving_bytes));
+		declare_int_field("heap_objects", flx_int(vm->gc.get_heap_size()));
+		declare_int_field("peak_heap_objects", flx_int(stats.peak_heap));
+		declare_int_field("max_heap", flx_int(vm->gc.max_heap));
+
+		flx_array histogram = flx_array(GCStats::PAUSE_BUCKETS);
+		for (size_t i = 0; i < GCStats::PAUSE_BUCKETS; ++i) {
+			histogram[i] = vm->allocate_value(new RuntimeValue(flx_int(stats.pause_histogram[i])));
+		}
+		declare_field(
+			"pause_histogram",
+			new RuntimeValue(histogram, Type::T_INT, std::vector<size_t>{ GCStats::PAUSE_BUCKETS }),
+			TypeDefinition(Type::T_INT, std::vector<size_t>{ 0 })
+		);
+
+		vm->push_new_constant(new RuntimeValue(str, Constants::STD_NAMESPACE, "GCStats"));
+
+		};
+
+	vm->builtin_functions["gc_save_snapshot"] = [this, vm]() {
+		auto scope = vm->get_back_scope(Constants::STD_NAMESPACE);
+		auto val = std::dynamic_pointer_cast<RuntimeVariable>(scope->find_declared_variable("path"))->get_value();
+
+		// saved by the vm after this call, a resumed program sees true instead
+		vm->snapshot_path = val->get_s();
+
+		vm->push_new_constant(new RuntimeValue(flx_bool(false)));
+
+		};
+
 }
@@ -1,11 +1,21 @@
 #include "md_http.hpp"
 
+#include <fstream>
+#include <iostream>
+#include <algorithm>
+#include <cstdlib>
+
 #ifdef linux
 
 #include <sys/socket.h>
 #include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
 #include <arpa/inet.h>
+#include <poll.h>
+#include <fcntl.h>
 #include <unistd.h>
+#include <cerrno>
 #include <cstring>
 
 #elif defined(_WIN32)
@@ -17,292 +27,1405 @@
 #endif // linux
 
 #include "vm.hpp"
+#include "vm_scheduler.hpp"
 #include "semantic_analysis.hpp"
 #include "utils.hpp"
 #include "constants.hpp"
 
+using namespace core;
 using namespace core::modules;
 using namespace core::runtime;
 using namespace core::analysis;
 
-ModuleHTTP::ModuleHTTP() {}
+static constexpr size_t RECEIVE_SIZE = 65536;
 
-ModuleHTTP::~ModuleHTTP() = default;
+// limits of the requests read by the server
+static constexpr size_t MAX_REQUEST_LINE_SIZE = 65536;
+static constexpr size_t MAX_REQUEST_HEADERS = 100;
+static constexpr size_t MAX_REQUEST_BODY_SIZE = 64 << 20;
 
-void ModuleHTTP::register_functions(SemanticAnalyser* visitor) {
-	visitor->builtin_functions["request"] = nullptr;
+static VmScheduler* get_scheduler(VirtualMachine* vm) {
+	if (!vm->scheduler) {
+		vm->scheduler = std::make_shared<VmScheduler>(vm);
+	}
+	return vm->scheduler.get();
 }
 
-void ModuleHTTP::register_functions(VirtualMachine* vm) {
+// nothing is collected while it lives, the previous state is restored even when building fails
+struct GcPause {
+	GarbageCollector& gc;
+	bool enable;
 
-	vm->builtin_functions["request"] = [this, vm]() {
-		auto scope = vm->get_back_scope(Constants::STD_NAMESPACE);
-		auto val = std::dynamic_pointer_cast<RuntimeVariable>(scope->find_declared_variable("req"))->get_value();
+	GcPause(GarbageCollector& gc) : gc(gc), enable(gc.enable) {
+		gc.enable = false;
+	}
+
+	~GcPause() {
+		gc.enable = enable;
+	}
+};
+
+static void close_socket(ModuleHTTP::socket_t sock) {
+#ifdef linux
+	close(sock);
+#elif defined(_WIN32)
+	closesocket(sock);
+#endif // linux
+}
+
+static bool is_timeout_error() {
+#ifdef linux
+	return errno == EAGAIN || errno == EWOULDBLOCK;
+#elif defined(_WIN32)
+	return WSAGetLastError() == WSAETIMEDOUT;
+#endif // linux
+}
+
+static void set_timeout(ModuleHTTP::socket_t sock, flx_int timeout) {
+	// zero waits forever, a pooled connection can come from a request with a timeout
+#ifdef linux
+	timeval tv{};
+	tv.tv_sec = timeout / 1000;
+	tv.tv_usec = (timeout % 1000) * 1000;
+	setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+	setsockopt(sock, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+#elif defined(_WIN32)
+	DWORD tv = DWORD(timeout);
+	setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, reinterpret_cast<const char*>(&tv), sizeof(tv));
+	setsockopt(sock, SOL_SOCKET, SO_SNDTIMEO, reinterpret_cast<const char*>(&tv), sizeof(tv));
+#endif // linux
+}
 
-		RuntimeValue* config_value = val;
-		if (config_value->is_void()) {
-			throw std::runtime_error("'req' is null");
+static bool connect_socket(ModuleHTTP::socket_t sock, const addrinfo* address, flx_int timeout) {
+	if (timeout <= 0) {
+		return connect(sock, address->ai_addr, int(address->ai_addrlen)) == 0;
+	}
+
+	// a non blocking connect is the only one that can be given up on
+#ifdef linux
+	int flags = fcntl(sock, F_GETFL, 0);
+	fcntl(sock, F_SETFL, flags | O_NONBLOCK);
+
+	bool connected = connect(sock, address->ai_addr, address->ai_addrlen) == 0;
+	if (!connected && errno == EINPROGRESS) {
+		pollfd pfd{ sock, POLLOUT, 0 };
+		if (poll(&pfd, 1, int(timeout)) > 0) {
+			int error = 0;
+			socklen_t length = sizeof(error);
+			getsockopt(sock, SOL_SOCKET, SO_ERROR, &error, &length);
+			connected = error == 0;
 		}
-		flx_struct config_str = config_value->get_str();
-		std::string hostname = config_str["hostname"]->get_value()->get_s();
-		std::string path = config_str["path"]->get_value()->get_s();
-		std::string method = config_str["method"]->get_value()->get_s();
-		std::string port = "80";
-		std::string headers = "";
-		std::string parameters = "";
-		std::string data = config_str["data"]->get_value()->get_s();
+	}
 
-		// check mandatory parameters
-		if (hostname.empty()) {
-			throw std::runtime_error("Hostname must be informed.");
+	fcntl(sock, F_SETFL, flags);
+#elif defined(_WIN32)
+	u_long non_blocking = 1;
+	ioctlsocket(sock, FIONBIO, &non_blocking);
+
+	bool connected = connect(sock, address->ai_addr, int(address->ai_addrlen)) == 0;
+	if (!connected && WSAGetLastError() == WSAEWOULDBLOCK) {
+		WSAPOLLFD pfd{ sock, POLLOUT, 0 };
+		if (WSAPoll(&pfd, 1, int(timeout)) > 0) {
+			int error = 0;
+			int length = sizeof(error);
+			getsockopt(sock, SOL_SOCKET, SO_ERROR, reinterpret_cast<char*>(&error), &length);
+			connected = error == 0;
 		}
-		else if (method.empty()) {
-			throw std::runtime_error("Method must be informed.");
+	}
+
+	non_blocking = 0;
+	ioctlsocket(sock, FIONBIO, &non_blocking);
+#endif // linux
+
+	return connected;
+}
+
+static const std::string* find_header(const std::vector<std::pair<std::string, std::string>>& headers, const std::string& name) {
+	for (const auto& header : headers) {
+		if (utils::StringUtils::tolower(header.first) == name) {
+			return &header.second;
 		}
+	}
+	return nullptr;
+}
+
+static std::string get_status_description(flx_int status) {
+	switch (status) {
+	case 100: return "Continue";
+	case 101: return "Switching Protocols";
+	case 200: return "OK";
+	case 201: return "Created";
+	case 202: return "Accepted";
+	case 204: return "No Content";
+	case 206: return "Partial Content";
+	case 301: return "Moved Permanently";
+	case 302: return "Found";
+	case 303: return "See Other";
+	case 304: return "Not Modified";
+	case 307: return "Temporary Redirect";
+	case 308: return "Permanent Redirect";
+	case 400: return "Bad Request";
+	case 401: return "Unauthorized";
+	case 403: return "Forbidden";
+	case 404: return "Not Found";
+	case 405: return "Method Not Allowed";
+	case 408: return "Request Timeout";
+	case 409: return "Conflict";
+	case 411: return "Length Required";
+	case 413: return "Content Too Large";
+	case 415: return "Unsupported Media Type";
+	case 429: return "Too Many Requests";
+	case 431: return "Request Header Fields Too Large";
+	case 500: return "Internal Server Error";
+	case 501: return "Not Implemented";
+	case 502: return "Bad Gateway";
+	case 503: return "Service Unavailable";
+	case 504: return "Gateway Timeout";
+	case 505: return "HTTP Version Not Supported";
+	default: return "";
+	}
+}
 
-		// check if has path
-		if (path.empty()) {
-			path = "/";
+// answers the server writes itself, their body is the status description
+static std::string build_status_response(flx_int status, bool keep_alive) {
+	auto description = get_status_description(status);
+	return "HTTP/1.1 " + std::to_string(status) + " " + description + "\r\n"
+		+ "Content-Type: text/plain\r\n"
+		+ "Content-Length: " + std::to_string(description.size()) + "\r\n"
+		+ (keep_alive ? "" : "Connection: close\r\n")
+		+ "\r\n" + description;
+}
+
+static std::string url_decode(const std::string& text, bool plus_as_space) {
+	std::string decoded;
+	decoded.reserve(text.size());
+	for (size_t i = 0; i < text.size(); ++i) {
+		if (text[i] == '%' && i + 2 < text.size() && isxdigit(text[i + 1]) && isxdigit(text[i + 2])) {
+			decoded += char(std::stoi(text.substr(i + 1, 2), nullptr, 16));
+			i += 2;
+		}
+		else if (text[i] == '+' && plus_as_space) {
+			decoded += ' ';
 		}
+		else {
+			decoded += text[i];
+		}
+	}
+	return decoded;
+}
 
-		// get port
-		auto param_port = config_str["port"]->get_value()->get_i();
-		if (param_port != 0) {
-			port = std::to_string(param_port);
+// digits only, false for anything else or a size past max
+static bool parse_size(const std::string& text, int base, size_t max, size_t& size) {
+	size = 0;
+	if (text.empty()) {
+		return false;
+	}
+	for (auto c : text) {
+		size_t digit;
+		if (c >= '0' && c <= '9') {
+			digit = size_t(c - '0');
 		}
+		else if (base == 16 && isxdigit(c)) {
+			digit = size_t(tolower(c) - 'a' + 10);
+		}
+		else {
+			return false;
+		}
+		if (size > (max - digit) / size_t(base)) {
+			return false;
+		}
+		size = size * size_t(base) + digit;
+	}
+	return true;
+}
 
-		// build parameters
-		flx_struct str_parameters = config_str["parameters"]->get_value()->get_str();
-		for (const auto& parameter : str_parameters) {
-			if (parameters.empty()) {
-				parameters = "?";
-			}
-			else {
-				parameters += "&";
-			}
-			parameters += parameter.first + "=" + parameter.second->get_value()->get_s();
+ModuleHTTP::Connection::Connection(socket_t sock, const std::string& pool_key)
+	: sock(sock), pool_key(pool_key) {}
+
+ModuleHTTP::Connection::~Connection() {
+	close_socket(sock);
+}
+
+bool ModuleHTTP::Connection::receive() {
+	// drops what was consumed before growing the buffer
+	if (begin > 0) {
+		buffer.erase(0, begin);
+		begin = 0;
+	}
+
+	auto size = buffer.size();
+	buffer.resize(size + RECEIVE_SIZE);
+	auto received = recv(sock, buffer.data() + size, int(RECEIVE_SIZE), 0);
+	buffer.resize(size + std::max(received, decltype(received)(0)));
+
+	if (received < 0) {
+		if (is_timeout_error()) {
+			throw std::runtime_error("request timed out");
 		}
+		throw std::runtime_error("connection failed while receiving");
+	}
+
+	return received > 0;
+}
 
-		// build headers
-		flx_struct str_headers = config_str["headers"]->get_value()->get_str();
-		for (const auto& header : str_headers) {
-			headers += header.first + ": " + header.second->get_value()->get_s() + "\r\n";
+void ModuleHTTP::Connection::send_all(const std::string& data) {
+	size_t sent = 0;
+	while (sent < data.size()) {
+#ifdef linux
+		auto count = send(sock, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+#elif defined(_WIN32)
+		auto count = send(sock, data.data() + sent, int(data.size() - sent), 0);
+#endif // linux
+		if (count <= 0) {
+			if (count < 0 && is_timeout_error()) {
+				throw std::runtime_error("request timed out");
+			}
+			throw std::runtime_error("connection failed while sending");
 		}
+		sent += size_t(count);
+	}
+}
 
+bool ModuleHTTP::Connection::is_stale() {
+	// an idle connection has nothing to read, unless the server closed it
 #ifdef linux
+	pollfd pfd{ sock, POLLIN, 0 };
+	return poll(&pfd, 1, 0) != 0;
+#elif defined(_WIN32)
+	WSAPOLLFD pfd{ sock, POLLRDNORM, 0 };
+	return WSAPoll(&pfd, 1, 0) != 0;
+#endif // linux
+}
 
-		int sock;
-		struct addrinfo hints;
-		struct addrinfo* result = nullptr;
+std::string ModuleHTTP::Response::read_body(size_t max_size, std::string* raw) {
+	std::string body;
+	auto& conn = *connection;
+
+	// waits for bytes only while it has none to return
+	auto available = [&]() {
+		while (conn.begin == conn.buffer.size()) {
+			if (!body.empty()) {
+				return false;
+			}
+			if (!conn.receive()) {
+				if (until_close) {
+					done = true;
+					return false;
+				}
+				throw std::runtime_error("connection closed in the middle of the response");
+			}
+		}
+		return true;
+		};
 
-		// set hints to DNS resolution
-		memset(&hints, 0, sizeof(hints));
-		hints.ai_family = AF_INET; // IPv4
-		hints.ai_socktype = SOCK_STREAM;
-		hints.ai_protocol = IPPROTO_TCP;
+	auto take = [&](std::string& out, size_t size) {
+		out.append(conn.buffer, conn.begin, size);
+		if (raw) {
+			raw->append(conn.buffer, conn.begin, size);
+		}
+		conn.begin += size;
+		};
 
-		// resolve DNS
-		if (getaddrinfo(hostname.c_str(), port.c_str(), &hints, &result) != 0) {
-			throw std::runtime_error("Failed to resolve hostname.");
+	auto read_line = [&]() {
+		size_t line_end;
+		while ((line_end = conn.buffer.find("\r\n", conn.begin)) == std::string::npos) {
+			if (!conn.receive()) {
+				throw std::runtime_error("connection closed in the middle of the response");
+			}
 		}
+		std::string line;
+		take(line, line_end - conn.begin);
+		std::string line_break;
+		take(line_break, 2);
+		return line;
+		};
 
-		// create socket
-		sock = socket(result->ai_family, result->ai_socktype, result->ai_protocol);
-		if (sock < 0) {
-			freeaddrinfo(result);
-			throw std::runtime_error("Socket creation failed.");
+	while (!done && body.size() < max_size) {
+		if (chunked && remaining == 0) {
+			auto line = read_line();
+			char* size_end = nullptr;
+			remaining = size_t(std::strtoull(line.c_str(), &size_end, 16));
+			if (size_end == line.c_str()) {
+				throw std::runtime_error("invalid chunk size '" + line + "'");
+			}
+			if (remaining == 0) {
+				// trailers end with an empty line
+				while (!read_line().empty()) {}
+				done = true;
+			}
+			continue;
 		}
 
-		// connect to server
-		if (connect(sock, result->ai_addr, result->ai_addrlen) < 0) {
-			close(sock);
-			freeaddrinfo(result);
-			throw std::runtime_error("Connection failed.");
+		if (!until_close && remaining == 0) {
+			done = true;
+			break;
 		}
 
-#elif defined(_WIN32)
+		if (!available()) {
+			break;
+		}
 
-		WSADATA wsa;
-		SOCKET sock;
-		struct addrinfo* result = NULL;
-		struct addrinfo hints;
+		auto size = std::min(max_size - body.size(), conn.buffer.size() - conn.begin);
+		if (!until_close) {
+			size = std::min(size, remaining);
+			remaining -= size;
+		}
+		take(body, size);
 
-		if (WSAStartup(MAKEWORD(2, 2), &wsa) != 0) {
-			throw std::runtime_error("Failed. Error Code: " + WSAGetLastError());
+		if (chunked && remaining == 0) {
+			read_line();
 		}
+	}
 
-		// set hints to DNS resolution
-		ZeroMemory(&hints, sizeof(hints));
-		hints.ai_family = AF_INET; // IPv4
-		hints.ai_socktype = SOCK_STREAM;
-		hints.ai_protocol = IPPROTO_TCP;
+	return body;
+}
+
+ModuleHTTP::ModuleHTTP() {
+#ifdef _WIN32
+	WSADATA wsa;
+	WSAStartup(MAKEWORD(2, 2), &wsa);
+#endif // _WIN32
+}
 
-		// resolve DNS
-		if (getaddrinfo(hostname.c_str(), port.c_str(), &hints, &result) != 0) {
-			WSACleanup();
-			throw std::runtime_error("Failed to resolve hostname.");
+ModuleHTTP::~ModuleHTTP() {
+	streams.clear();
+	idle_connections.clear();
+#ifdef _WIN32
+	WSACleanup();
+#endif // _WIN32
+}
+
+std::unique_ptr<ModuleHTTP::Connection> ModuleHTTP::acquire(const std::string& hostname, const std::string& port, flx_int timeout, bool& reused) {
+	auto pool_key = hostname + ":" + port;
+
+	{
+		std::lock_guard<std::mutex> lock(pool_mutex);
+		auto& idle = idle_connections[pool_key];
+		while (!idle.empty()) {
+			auto connection = std::move(idle.back());
+			idle.pop_back();
+			if (!connection->is_stale()) {
+				set_timeout(connection->sock, timeout);
+				reused = true;
+				return connection;
+			}
 		}
+	}
+
+	addrinfo hints{};
+	addrinfo* result = nullptr;
 
-		// create socket
-		sock = socket(result->ai_family, result->ai_socktype, result->ai_protocol);
+	// IPv4 and IPv6, the first address accepting the connection is used
+	hints.ai_family = AF_UNSPEC;
+	hints.ai_socktype = SOCK_STREAM;
+	hints.ai_protocol = IPPROTO_TCP;
+
+	if (getaddrinfo(hostname.c_str(), port.c_str(), &hints, &result) != 0) {
+		throw std::runtime_error("Failed to resolve hostname.");
+	}
+
+	std::unique_ptr<Connection> connection;
+	for (auto address = result; address && !connection; address = address->ai_next) {
+		auto sock = socket(address->ai_family, address->ai_socktype, address->ai_protocol);
+#ifdef linux
+		if (sock < 0) {
+#elif defined(_WIN32)
 		if (sock == INVALID_SOCKET) {
-			freeaddrinfo(result);
-			WSACleanup();
-			throw std::runtime_error("Socket creation failed. Error: " + WSAGetLastError());
+#endif // linux
+			continue;
 		}
 
-		// connect to server
-		if (connect(sock, result->ai_addr, (int)result->ai_addrlen) == SOCKET_ERROR) {
-			closesocket(sock);
-			freeaddrinfo(result);
-			WSACleanup();
-			throw std::runtime_error("Connection failed. Error: " + WSAGetLastError());
+		if (!connect_socket(sock, address, timeout)) {
+			close_socket(sock);
+			continue;
 		}
 
-#endif // linux
+		// requests are sent whole, nothing is gained by delaying them
+		int no_delay = 1;
+		setsockopt(sock, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<const char*>(&no_delay), sizeof(no_delay));
+		set_timeout(sock, timeout);
+
+		connection = std::make_unique<Connection>(sock, pool_key);
+	}
+
+	freeaddrinfo(result);
+
+	if (!connection) {
+		throw std::runtime_error("Connection failed.");
+	}
+
+	reused = false;
+	return connection;
+}
+
+void ModuleHTTP::release(std::unique_ptr<Connection> connection) {
+	std::lock_guard<std::mutex> lock(pool_mutex);
+	auto& idle = idle_connections[connection->pool_key];
+	if (idle.size() < MAX_IDLE_PER_HOST) {
+		connection->buffer.clear();
+		connection->begin = 0;
+		idle.push_back(std::move(connection));
+	}
+}
+
+void ModuleHTTP::finish(Response& response) {
+	if (!response.connection) {
+		return;
+	}
+
+	// a connection with unread bytes cannot be reused
+	if (response.done && response.keep_alive && response.connection->begin == response.connection->buffer.size()) {
+		release(std::move(response.connection));
+	}
+	response.connection.reset();
+}
+
+ModuleHTTP::Request ModuleHTTP::parse_request(RuntimeValue* req) {
+	if (req->is_void()) {
+		throw std::runtime_error("'req' is null");
+	}
+	flx_struct config_str = req->get_str();
+
+	Request request;
+	request.hostname = config_str["hostname"]->get_value()->get_s();
+	request.method = config_str["method"]->get_value()->get_s();
+	request.port = "80";
+	std::string path = config_str["path"]->get_value()->get_s();
+	std::string headers = "";
+	std::string parameters = "";
+	std::string data = config_str["data"]->get_value()->get_s();
+
+	// check mandatory parameters
+	if (request.hostname.empty()) {
+		throw std::runtime_error("Hostname must be informed.");
+	}
+	else if (request.method.empty()) {
+		throw std::runtime_error("Method must be informed.");
+	}
+
+	// IPv6 literals can be informed between brackets, as in urls
+	if (request.hostname.front() == '[' && request.hostname.back() == ']') {
+		request.hostname = request.hostname.substr(1, request.hostname.size() - 2);
+	}
+
+	// check if has path
+	if (path.empty()) {
+		path = "/";
+	}
+
+	// get port
+	auto param_port = config_str["port"]->get_value()->get_i();
+	if (param_port != 0) {
+		request.port = std::to_string(param_port);
+	}
 
-		// prepare HTTP request
-		std::string request = method + " " + path + parameters + " HTTP/1.1\r\n";
-		request += "Host: " + hostname + "\r\n";
+	// optional fields, older declarations of the struct do not have them
+	auto timeout_it = config_str.find("timeout");
+	if (timeout_it != config_str.end() && !timeout_it->second->get_value()->is_void()) {
+		request.timeout = timeout_it->second->get_value()->get_i();
+	}
+	auto keep_alive_it = config_str.find("keep_alive");
+	if (keep_alive_it != config_str.end() && !keep_alive_it->second->get_value()->is_void()) {
+		request.keep_alive = keep_alive_it->second->get_value()->get_b();
+	}
 
-		// adds headers to request
-		if (!headers.empty()) {
-			request += headers;
+	// build parameters
+	flx_struct str_parameters = config_str["parameters"]->get_value()->get_str();
+	for (const auto& parameter : str_parameters) {
+		if (parameters.empty()) {
+			parameters = "?";
 		}
 		else {
-			request += "\r\n";
+			parameters += "&";
+		}
+		parameters += parameter.first + "=" + parameter.second->get_value()->get_s();
+	}
+
+	// build headers
+	flx_struct str_headers = config_str["headers"]->get_value()->get_str();
+	for (const auto& header : str_headers) {
+		headers += header.first + ": " + header.second->get_value()->get_s() + "\r\n";
+		if (utils::StringUtils::tolower(header.first) == "connection"
+			&& utils::StringUtils::tolower(header.second->get_value()->get_s()) == "close") {
+			request.keep_alive = false;
+		}
+	}
+
+	// prepare HTTP request
+	auto host = request.hostname.find(':') != std::string::npos ? "[" + request.hostname + "]" : request.hostname;
+	if (request.port != "80") {
+		host += ":" + request.port;
+	}
+
+	request.message = request.method + " " + path + parameters + " HTTP/1.1\r\n";
+	request.message += "Host: " + host + "\r\n";
+	request.message += headers;
+	if (!request.keep_alive && headers.find("\r\nConnection:") == std::string::npos) {
+		request.message += "Connection: close\r\n";
+	}
+
+	// adds body to request
+	if (!data.empty()) {
+		request.message += "Content-Length: " + std::to_string(data.length()) + "\r\n";
+	}
+	request.message += "\r\n";
+	request.message += data;
+
+	return request;
+}
+
+std::shared_ptr<ModuleHTTP::Response> ModuleHTTP::send_request(const Request& request) {
+	auto response = std::make_shared<Response>();
+
+	for (size_t attempt = 0; ; ++attempt) {
+		response->connection = acquire(request.hostname, request.port, request.timeout, response->reused);
+		auto& conn = *response->connection;
+
+		// a pooled connection closed by the server is only noticed once used,
+		// the request is then sent again on a new one
+		bool closed = false;
+		try {
+			conn.send_all(request.message);
+		}
+		catch (const std::runtime_error&) {
+			if (!response->reused || attempt > 0) {
+				throw;
+			}
+			closed = true;
+		}
+
+		size_t head_end = std::string::npos;
+		while (!closed) {
+			head_end = conn.buffer.find("\r\n\r\n", conn.begin);
+			if (head_end == std::string::npos) {
+				closed = !conn.receive();
+				continue;
+			}
+
+			response->head = conn.buffer.substr(conn.begin, head_end + 4 - conn.begin);
+			conn.begin = head_end + 4;
+
+			// interim responses precede the final one
+			if (response->head.compare(0, 10, "HTTP/1.1 1") == 0 && response->head.compare(0, 12, "HTTP/1.1 101") != 0) {
+				continue;
+			}
+			break;
+		}
+
+		if (!closed) {
+			break;
+		}
+		if (!response->reused || attempt > 0 || !conn.buffer.empty()) {
+			throw std::runtime_error("connection closed before the response");
 		}
+	}
+
+	auto lines = utils::StringUtils::split(response->head.substr(0, response->head.size() - 4), "\r\n");
+	response->status_line = lines[0];
+	for (size_t i = 1; i < lines.size(); ++i) {
+		auto colon = lines[i].find(':');
+		if (colon == std::string::npos) {
+			continue;
+		}
+		response->headers.emplace_back(lines[i].substr(0, colon), utils::StringUtils::trim(lines[i].substr(colon + 1)));
+	}
+
+	auto status = utils::StringUtils::split(response->status_line, ' ');
+	if (status.size() < 2) {
+		throw std::runtime_error("invalid response '" + response->status_line + "'");
+	}
+	auto status_code = std::stoll(status[1]);
+
+	auto connection = find_header(response->headers, "connection");
+	auto connection_value = connection ? utils::StringUtils::tolower(*connection) : "";
+	if (status[0] == "HTTP/1.0") {
+		response->keep_alive = connection_value == "keep-alive";
+	}
+	else {
+		response->keep_alive = connection_value != "close";
+	}
+	if (!request.keep_alive) {
+		response->keep_alive = false;
+	}
+
+	auto transfer_encoding = find_header(response->headers, "transfer-encoding");
+	auto content_length = find_header(response->headers, "content-length");
+
+	if (request.method == "HEAD" || status_code == 204 || status_code == 304 || (status_code >= 100 && status_code < 200)) {
+		response->done = true;
+	}
+	else if (transfer_encoding && utils::StringUtils::contains(utils::StringUtils::tolower(*transfer_encoding), "chunked")) {
+		response->chunked = true;
+	}
+	else if (content_length) {
+		response->remaining = size_t(std::stoull(*content_length));
+		response->done = response->remaining == 0;
+	}
+	else {
+		// the body ends when the server closes the connection
+		response->until_close = true;
+		response->keep_alive = false;
+	}
+
+	return response;
+}
+
+RuntimeValue* ModuleHTTP::build_entries(VirtualMachine* vm, const std::vector<std::pair<std::string, std::string>>& entries) {
+	auto flx_arr = flx_array(entries.size());
+	for (size_t i = 0; i < entries.size(); ++i) {
+		const auto& entry = entries[i];
+		// create entry struct
+		auto key_var = std::make_shared<RuntimeVariable>("key", Type::T_STRING);
+		key_var->set_value(vm->allocate_value(new RuntimeValue(flx_string(entry.first))));
+		vm->gc.add_var_root(key_var);
+
+		auto value_var = std::make_shared<RuntimeVariable>("value", Type::T_STRING);
+		value_var->set_value(vm->allocate_value(new RuntimeValue(flx_string(entry.second))));
+		vm->gc.add_var_root(value_var);
+
+		flx_struct entry_str;
+		entry_str["key"] = key_var;
+		entry_str["value"] = value_var;
+
+		// create entry value
+		auto entry_value = vm->allocate_value(new RuntimeValue(
+			entry_str,
+			Constants::DEFAULT_NAMESPACE,
+			Constants::BUILTIN_STRUCT_NAMES[BuiltinStructs::BS_ENTRY]
+		));
+
+		// push entry to entries array
+		flx_arr[i] = entry_value;
+	}
+	auto entries_value = vm->allocate_value(new RuntimeValue(
+		flx_arr,
+		Type::T_STRUCT,
+		std::vector<size_t>{entries.size()},
+		Constants::DEFAULT_NAMESPACE,
+		Constants::BUILTIN_STRUCT_NAMES[BuiltinStructs::BS_ENTRY]
+	));
+
+	return entries_value;
+}
+
+RuntimeValue* ModuleHTTP::build_response(VirtualMachine* vm, const Response& response, const std::string& body, const std::string& raw) {
+	// the headers are not reachable until the struct is built, so nothing is collected meanwhile
+	GcPause gc_pause(vm->gc);
+
+	auto headers_value = build_entries(vm, response.headers);
+
+	// create response struct
+	auto version_end = response.status_line.find(' ');
+	auto status_end = response.status_line.find(' ', version_end + 1);
+	auto status_description = status_end == std::string::npos ? "" : response.status_line.substr(status_end + 1);
+
+	auto http_version_var = std::make_shared<RuntimeVariable>("http_version", Type::T_STRING);
+	http_version_var->set_value(vm->allocate_value(new RuntimeValue(flx_string(response.status_line.substr(0, version_end)))));
+	vm->gc.add_var_root(http_version_var);
+
+	auto status_var = std::make_shared<RuntimeVariable>("status", Type::T_INT);
+	status_var->set_value(vm->allocate_value(new RuntimeValue(flx_int(stoll(response.status_line.substr(version_end + 1, status_end - version_end - 1))))));
+	vm->gc.add_var_root(status_var);
+
+	auto status_description_var = std::make_shared<RuntimeVariable>("status_description", Type::T_STRING);
+	status_description_var->set_value(vm->allocate_value(new RuntimeValue(flx_string(status_description))));
+	vm->gc.add_var_root(status_description_var);
+
+	auto headers_var = std::make_shared<RuntimeVariable>("headers",
+		TypeDefinition(Type::T_STRUCT,
+			std::vector<size_t>{response.headers.size()},
+			Constants::DEFAULT_NAMESPACE,
+			Constants::BUILTIN_STRUCT_NAMES[BuiltinStructs::BS_ENTRY]
+		)
+	);
+	headers_var->set_value(headers_value);
+	vm->gc.add_var_root(headers_var);
+
+	auto data_var = std::make_shared<RuntimeVariable>("data", Type::T_STRING);
+	data_var->set_value(vm->allocate_value(new RuntimeValue(flx_string(body))));
+	vm->gc.add_var_root(data_var);
+
+	auto raw_var = std::make_shared<RuntimeVariable>("raw", Type::T_STRING);
+	raw_var->set_value(vm->allocate_value(new RuntimeValue(flx_string(raw))));
+	vm->gc.add_var_root(raw_var);
+
+	flx_struct res_str;
+	res_str["http_version"] = http_version_var;
+	res_str["status"] = status_var;
+	res_str["status_description"] = status_description_var;
+	res_str["headers"] = headers_var;
+	res_str["data"] = data_var;
+	res_str["raw"] = raw_var;
+
+	return vm->allocate_value(new RuntimeValue(res_str, Constants::STD_NAMESPACE, "HttpResponse"));
+}
+
+std::shared_ptr<ModuleHTTP::Response> ModuleHTTP::find_stream(RuntimeValue* handle) {
+	if (handle->is_void()) {
+		throw std::runtime_error("'stream' is null");
+	}
+
+	std::lock_guard<std::mutex> lock(streams_mutex);
+	auto it = streams.find(handle->get_raw_str()->at(INSTANCE_ID_NAME)->get_value()->get_i());
+	if (it == streams.end()) {
+		throw std::runtime_error("the response stream is closed");
+	}
+	return it->second;
+}
+
+std::shared_ptr<ModuleHTTP::Server> ModuleHTTP::find_server(RuntimeValue* handle) {
+	if (handle->is_void()) {
+		throw std::runtime_error("'server' is null");
+	}
+
+	std::lock_guard<std::mutex> lock(servers_mutex);
+	auto it = servers.find(handle->get_raw_str()->at(INSTANCE_ID_NAME)->get_value()->get_i());
+	if (it == servers.end()) {
+		throw std::runtime_error("the server is stopped");
+	}
+	return it->second;
+}
+
+int ModuleHTTP::read_request(VirtualMachine* vm, Server& server, std::shared_ptr<AsyncSocket> connection,
+	IncomingRequest& request, flx_int idle_timeout) {
+	std::string line;
+	bool received;
+
+	// only a connection waiting for its next request is closed by http_stop,
+	// empty lines may precede a request
+	server.idle_connections.insert(connection);
+	try {
+		do {
+			received = connection->read_line(vm, line, AsyncSocket::get_deadline(idle_timeout), MAX_REQUEST_LINE_SIZE);
+		} while (received && line.empty());
+	}
+	catch (...) {
+		server.idle_connections.erase(connection);
+		throw;
+	}
+	server.idle_connections.erase(connection);
+
+	if (!received) {
+		return 0;
+	}
+
+	// the rest of the request has the same time to arrive
+	auto deadline = AsyncSocket::get_deadline(idle_timeout);
+
+	auto method_end = line.find(' ');
+	auto target_end = method_end == std::string::npos ? std::string::npos : line.find(' ', method_end + 1);
+	if (target_end == std::string::npos || method_end == 0 || target_end == method_end + 1) {
+		return 400;
+	}
+	request.method = line.substr(0, method_end);
+	auto target = line.substr(method_end + 1, target_end - method_end - 1);
+	request.version = line.substr(target_end + 1);
+	if (request.version != "HTTP/1.1" && request.version != "HTTP/1.0") {
+		return request.version.compare(0, 5, "HTTP/") == 0 ? 505 : 400;
+	}
+
+	// proxies send the absolute form of the target
+	auto scheme_end = target.find("://");
+	if (target.front() != '/' && scheme_end != std::string::npos) {
+		auto path_start = target.find('/', scheme_end + 3);
+		target = path_start == std::string::npos ? "/" : target.substr(path_start);
+	}
+	auto query_start = target.find('?');
+	request.path = url_decode(target.substr(0, query_start), false);
+	if (query_start != std::string::npos) {
+		request.query = target.substr(query_start + 1);
+	}
 
-		// adds body to request
-		if (!data.empty()) {
-			request += "Content-Length: " + std::to_string(data.length()) + "\r\n";
-			request += "\r\n";
-			request += data;
+	while (true) {
+		if (!connection->read_line(vm, line, deadline, MAX_REQUEST_LINE_SIZE)) {
+			return 400;
+		}
+		if (line.empty()) {
+			break;
+		}
+		if (request.headers.size() >= MAX_REQUEST_HEADERS) {
+			return 431;
+		}
+
+		// folded lines are obsolete and rejected
+		auto colon = line.find(':');
+		if (colon == std::string::npos || colon == 0 || isspace(line.front()) || isspace(line[colon - 1])) {
+			return 400;
+		}
+		request.headers.emplace_back(utils::StringUtils::tolower(line.substr(0, colon)), utils::StringUtils::trim(line.substr(colon + 1)));
+	}
+
+	auto connection_header = find_header(request.headers, "connection");
+	auto connection_value = connection_header ? utils::StringUtils::tolower(*connection_header) : "";
+	if (request.version == "HTTP/1.0") {
+		request.keep_alive = utils::StringUtils::contains(connection_value, "keep-alive");
+	}
+	else {
+		request.keep_alive = !utils::StringUtils::contains(connection_value, "close");
+	}
+
+	auto transfer_encoding = find_header(request.headers, "transfer-encoding");
+	auto content_length = find_header(request.headers, "content-length");
+	auto expect = find_header(request.headers, "expect");
+
+	size_t length = 0;
+	if (transfer_encoding) {
+		if (!utils::StringUtils::contains(utils::StringUtils::tolower(*transfer_encoding), "chunked")) {
+			return 501;
+		}
+	}
+	else if (content_length && !parse_size(*content_length, 10, MAX_REQUEST_BODY_SIZE, length)) {
+		return utils::StringUtils::trim(*content_length).find_first_not_of("0123456789") == std::string::npos ? 413 : 400;
+	}
+
+	// the client waits for this before sending the body
+	if (expect && utils::StringUtils::tolower(*expect) == "100-continue" && request.version == "HTTP/1.1"
+		&& (transfer_encoding || length > 0)) {
+		connection->write(vm, "HTTP/1.1 100 Continue\r\n\r\n", deadline);
+	}
+
+	if (!transfer_encoding) {
+		request.body = length > 0 ? connection->read_exact(vm, length, deadline) : "";
+		return 200;
+	}
+
+	while (true) {
+		size_t chunk_size;
+		if (!connection->read_line(vm, line, deadline, MAX_REQUEST_LINE_SIZE)
+			|| !parse_size(utils::StringUtils::trim(line.substr(0, line.find(';'))), 16, MAX_REQUEST_BODY_SIZE, chunk_size)) {
+			return 400;
+		}
+
+		// the trailers are read and ignored
+		if (chunk_size == 0) {
+			while (connection->read_line(vm, line, deadline, MAX_REQUEST_LINE_SIZE) && !line.empty()) {}
+			return 200;
+		}
+
+		if (request.body.size() + chunk_size > MAX_REQUEST_BODY_SIZE) {
+			return 413;
+		}
+		request.body += connection->read_exact(vm, chunk_size, deadline);
+
+		if (!connection->read_line(vm, line, deadline, MAX_REQUEST_LINE_SIZE) || !line.empty()) {
+			return 400;
+		}
+	}
+}
+
+RuntimeValue* ModuleHTTP::build_request(VirtualMachine* vm, const Server& server, const IncomingRequest& request) {
+	// the entries are not reachable until the struct is built, so nothing is collected meanwhile
+	GcPause gc_pause(vm->gc);
+
+	std::vector<std::pair<std::string, std::string>> parameters;
+	for (const auto& parameter : utils::StringUtils::split(request.query, '&')) {
+		if (parameter.empty()) {
+			continue;
+		}
+		auto equal = parameter.find('=');
+		parameters.emplace_back(url_decode(parameter.substr(0, equal), true),
+			equal == std::string::npos ? "" : url_decode(parameter.substr(equal + 1), true));
+	}
+
+	// the port of the Host header is the one of the server
+	auto host = find_header(request.headers, "host");
+	std::string hostname = host ? *host : "";
+	auto port_start = hostname.rfind(':');
+	if (port_start != std::string::npos && hostname.find(']', port_start) == std::string::npos) {
+		hostname = hostname.substr(0, port_start);
+	}
+
+	auto hostname_var = std::make_shared<RuntimeVariable>("hostname", Type::T_STRING);
+	hostname_var->set_value(vm->allocate_value(new RuntimeValue(flx_string(hostname))));
+	vm->gc.add_var_root(hostname_var);
+
+	auto path_var = std::make_shared<RuntimeVariable>("path", Type::T_STRING);
+	path_var->set_value(vm->allocate_value(new RuntimeValue(flx_string(request.path))));
+	vm->gc.add_var_root(path_var);
+
+	auto method_var = std::make_shared<RuntimeVariable>("method", Type::T_STRING);
+	method_var->set_value(vm->allocate_value(new RuntimeValue(flx_string(request.method))));
+	vm->gc.add_var_root(method_var);
+
+	auto port_var = std::make_shared<RuntimeVariable>("port", Type::T_INT);
+	port_var->set_value(vm->allocate_value(new RuntimeValue(server.port)));
+	vm->gc.add_var_root(port_var);
+
+	auto parameters_var = std::make_shared<RuntimeVariable>("parameters", Type::T_ANY);
+	parameters_var->set_value(build_entries(vm, parameters));
+	vm->gc.add_var_root(parameters_var);
+
+	auto headers_var = std::make_shared<RuntimeVariable>("headers", Type::T_ANY);
+	headers_var->set_value(build_entries(vm, request.headers));
+	vm->gc.add_var_root(headers_var);
+
+	auto data_var = std::make_shared<RuntimeVariable>("data", Type::T_STRING);
+	data_var->set_value(vm->allocate_value(new RuntimeValue(flx_string(request.body))));
+	vm->gc.add_var_root(data_var);
+
+	auto timeout_var = std::make_shared<RuntimeVariable>("timeout", Type::T_INT);
+	timeout_var->set_value(vm->allocate_value(new RuntimeValue(flx_int(0))));
+	vm->gc.add_var_root(timeout_var);
+
+	auto keep_alive_var = std::make_shared<RuntimeVariable>("keep_alive", Type::T_BOOL);
+	keep_alive_var->set_value(vm->allocate_value(new RuntimeValue(flx_bool(request.keep_alive))));
+	vm->gc.add_var_root(keep_alive_var);
+
+	flx_struct req_str;
+	req_str["hostname"] = hostname_var;
+	req_str["path"] = path_var;
+	req_str["method"] = method_var;
+	req_str["port"] = port_var;
+	req_str["parameters"] = parameters_var;
+	req_str["headers"] = headers_var;
+	req_str["data"] = data_var;
+	req_str["timeout"] = timeout_var;
+	req_str["keep_alive"] = keep_alive_var;
+
+	return vm->allocate_value(new RuntimeValue(req_str, Constants::STD_NAMESPACE, "HttpRequest"));
+}
+
+std::string ModuleHTTP::serialize_response(RuntimeValue* res, IncomingRequest& request) {
+	if (res->is_void() || !res->is_struct()) {
+		throw std::runtime_error("the handler of '" + request.path + "' returned no HttpResponse");
+	}
+	auto res_str = res->get_raw_str();
+
+	// omitted fields are null
+	auto field = [&res_str](const std::string& name) -> RuntimeValue* {
+		auto it = res_str->find(name);
+		if (it == res_str->end() || it->second->get_value()->is_void()) {
+			return nullptr;
+		}
+		return it->second->get_value();
+		};
+
+	auto status_value = field("status");
+	flx_int status = status_value ? status_value->get_i() : 200;
+	if (status < 100 || status > 999) {
+		throw std::runtime_error("invalid status " + std::to_string(status));
+	}
+	auto description_value = field("status_description");
+	std::string description = description_value ? description_value->get_s() : "";
+	if (description.empty()) {
+		description = get_status_description(status);
+	}
+	auto data_value = field("data");
+
+	std::string head = "HTTP/1.1 " + std::to_string(status) + " " + description + "\r\n";
+
+	// the length and the connection are the ones of the server
+	if (auto headers_value = field("headers")) {
+		auto headers = headers_value->get_arr();
+		for (flx_int i = 0; i < headers.size(); ++i) {
+			if (!headers[i] || headers[i]->is_void()) {
+				continue;
+			}
+			auto header = headers[i]->get_raw_str();
+			auto key = header->at("key")->get_value()->get_s();
+			auto value = header->at("value")->get_value()->get_s();
+
+			auto name = utils::StringUtils::tolower(key);
+			if (name == "content-length" || name == "transfer-encoding") {
+				continue;
+			}
+			if (name == "connection") {
+				if (utils::StringUtils::contains(utils::StringUtils::tolower(value), "close")) {
+					request.keep_alive = false;
+				}
+				continue;
+			}
+			head += key + ": " + value + "\r\n";
+		}
+	}
+
+	bool has_body = !(status < 200 || status == 204 || status == 304);
+	if (has_body) {
+		head += "Content-Length: " + std::to_string(data_value ? data_value->get_raw_s()->size() : 0) + "\r\n";
+	}
+	if (!request.keep_alive) {
+		head += "Connection: close\r\n";
+	}
+	else if (request.version == "HTTP/1.0") {
+		head += "Connection: keep-alive\r\n";
+	}
+	head += "\r\n";
+
+	if (has_body && data_value && request.method != "HEAD") {
+		head += *data_value->get_raw_s();
+	}
+
+	return head;
+}
+
+void ModuleHTTP::serve_connection(VirtualMachine* vm, std::shared_ptr<Server> server,
+	std::shared_ptr<AsyncSocket> connection, flx_int idle_timeout) {
+	while (!server->stopping) {
+		IncomingRequest request;
+		auto status = read_request(vm, *server, connection, request, idle_timeout);
+		if (status == 0) {
+			break;
+		}
+
+		auto deadline = AsyncSocket::get_deadline(idle_timeout);
+
+		// what follows a malformed request cannot be trusted
+		if (status != 200) {
+			connection->write(vm, build_status_response(status, false), deadline);
+			break;
+		}
+
+		// a GET route answers HEAD requests too
+		const Route* route = nullptr;
+		bool path_found = false;
+		for (const auto& candidate : server->routes) {
+			if (candidate.prefix ? request.path.compare(0, candidate.path.size(), candidate.path) != 0 : request.path != candidate.path) {
+				continue;
+			}
+			path_found = true;
+			if (candidate.method == "*" || candidate.method == request.method
+				|| (candidate.method == "GET" && request.method == "HEAD")) {
+				route = &candidate;
+				break;
+			}
+		}
+
+		std::string response;
+		if (!route) {
+			response = build_status_response(path_found ? 405 : 404, request.keep_alive);
 		}
 		else {
-			request += "\r\n";
+			// the handler may add routes, which moves them
+			auto handler = route->handler;
+
+			// a failing handler only fails its request, the connection goes on
+			try {
+				auto req = build_request(vm, *server, request);
+				auto res = vm->call("", "", handler.first, handler.second, { req });
+				response = serialize_response(res, request);
+			}
+			catch (const std::exception& ex) {
+				std::cerr << "http_serve: " << ex.what() << std::endl;
+				response = build_status_response(500, request.keep_alive);
+			}
+		}
+
+		connection->write(vm, response, deadline);
+
+		if (!request.keep_alive) {
+			break;
 		}
+	}
+}
 
-		// send HTTP request
-		send(sock, request.c_str(), static_cast<int>(request.length()), 0);
+void ModuleHTTP::register_functions(SemanticAnalyser* visitor) {
+	visitor->builtin_functions["request"] = nullptr;
+	visitor->builtin_functions["request_to_file"] = nullptr;
+	visitor->builtin_functions["request_stream"] = nullptr;
+	visitor->builtin_functions["read_body"] = nullptr;
+	visitor->builtin_functions["close_stream"] = nullptr;
+	visitor->builtin_functions["http_server"] = nullptr;
+	visitor->builtin_functions["http_route"] = nullptr;
+	visitor->builtin_functions["http_serve"] = nullptr;
+	visitor->builtin_functions["http_stop"] = nullptr;
+}
 
-		// receive responce
-		char buffer[8192];
-		int bytes_received = recv(sock, buffer, sizeof(buffer), 0);
+void ModuleHTTP::register_functions(VirtualMachine* vm) {
 
-#ifdef linux
+	vm->builtin_functions["request"] = [this, vm]() {
+		auto scope = vm->get_back_scope(Constants::STD_NAMESPACE);
+		auto val = std::dynamic_pointer_cast<RuntimeVariable>(scope->find_declared_variable("req"))->get_value();
 
-		close(sock);
+		auto request = parse_request(val);
 
-#elif defined(_WIN32)
+		// the connection does not use the vm, other tasks run meanwhile
+		std::shared_ptr<Response> response;
+		std::string body;
+		std::string raw;
+		vm->run_blocking([&]() {
+			response = send_request(request);
+			raw = response->head;
+			while (!response->done) {
+				body += response->read_body(std::string::npos, &raw);
+			}
+			finish(*response);
+			});
 
-		closesocket(sock);
-		freeaddrinfo(result);
-		WSACleanup();
+		vm->push_constant(build_response(vm, *response, body, raw));
 
-#endif // linux
+		};
 
-		std::string raw_response(buffer, bytes_received);
-		std::vector<std::string> response_lines = utils::StringUtils::split(raw_response, "\r\n");
-		bool is_body = false;
-		std::string res_body;
+	vm->builtin_functions["request_to_file"] = [this, vm]() {
+		auto scope = vm->get_back_scope(Constants::STD_NAMESPACE);
+		auto val = std::dynamic_pointer_cast<RuntimeVariable>(scope->find_declared_variable("req"))->get_value();
+		auto path = std::dynamic_pointer_cast<RuntimeVariable>(scope->find_declared_variable("path"))->get_value()->get_s();
 
-		// dictionary temporary vector
-		std::vector<std::pair<flx_string, flx_string>> res_headers;
+		auto request = parse_request(val);
 
-		for (size_t i = 1; i < response_lines.size(); ++i) {
-			auto& line = response_lines[i];
-			if (is_body) {
-				res_body += line;
+		// the body goes to the file as it arrives, it is never held whole
+		std::shared_ptr<Response> response;
+		vm->run_blocking([&]() {
+			std::ofstream file(path, std::ios::binary | std::ios::trunc);
+			if (!file.is_open()) {
+				throw std::runtime_error("cannot open '" + path + "' to write");
 			}
-			else {
-				if (line == "") {
-					is_body = true;
-					continue;
+
+			response = send_request(request);
+			while (!response->done) {
+				auto chunk = response->read_body(RECEIVE_SIZE);
+				file.write(chunk.data(), chunk.size());
+			}
+			finish(*response);
+
+			if (!file) {
+				throw std::runtime_error("cannot write to '" + path + "'");
+			}
+			});
+
+		vm->push_constant(build_response(vm, *response, "", response->head));
+
+		};
+
+	vm->builtin_functions["request_stream"] = [this, vm]() {
+		auto scope = vm->get_back_scope(Constants::STD_NAMESPACE);
+		auto val = std::dynamic_pointer_cast<RuntimeVariable>(scope->find_declared_variable("req"))->get_value();
+
+		auto request = parse_request(val);
+
+		std::shared_ptr<Response> response;
+		vm->run_blocking([&]() {
+			response = send_request(request);
+			if (response->done) {
+				finish(*response);
+			}
+			});
+
+		flx_int id;
+		{
+			std::lock_guard<std::mutex> lock(streams_mutex);
+			id = next_stream_id++;
+			streams[id] = response;
+		}
+
+		auto instance_id_var = std::make_shared<RuntimeVariable>(INSTANCE_ID_NAME, Type::T_INT);
+		instance_id_var->set_value(vm->allocate_value(new RuntimeValue(id)));
+		vm->gc.add_var_root(instance_id_var);
+
+		auto response_var = std::make_shared<RuntimeVariable>("response",
+			TypeDefinition(Type::T_STRUCT, std::vector<size_t>(), Constants::STD_NAMESPACE, "HttpResponse"));
+		response_var->set_value(build_response(vm, *response, "", response->head));
+		vm->gc.add_var_root(response_var);
+
+		flx_struct str = flx_struct();
+		str["response"] = response_var;
+		str[INSTANCE_ID_NAME] = instance_id_var;
+
+		vm->push_new_constant(new RuntimeValue(str, Constants::STD_NAMESPACE, "HttpStream"));
+
+		};
+
+	vm->builtin_functions["read_body"] = [this, vm]() {
+		auto scope = vm->get_back_scope(Constants::STD_NAMESPACE);
+		auto val = std::dynamic_pointer_cast<RuntimeVariable>(scope->find_declared_variable("stream"))->get_value();
+		auto size = std::dynamic_pointer_cast<RuntimeVariable>(scope->find_declared_variable("size"))->get_value()->get_i();
+
+		if (size <= 0) {
+			throw std::runtime_error("size must be greater than zero");
+		}
+
+		auto response = find_stream(val);
+
+		// an empty string once the whole body was read
+		std::string chunk;
+		vm->run_blocking([&]() {
+			if (!response->done) {
+				chunk = response->read_body(size_t(size));
+			}
+			if (response->done) {
+				finish(*response);
+			}
+			});
+
+		vm->push_new_constant(new RuntimeValue(flx_string(std::move(chunk))));
+
+		};
+
+	vm->builtin_functions["close_stream"] = [this, vm]() {
+		auto scope = vm->get_back_scope(Constants::STD_NAMESPACE);
+		auto val = std::dynamic_pointer_cast<RuntimeVariable>(scope->find_declared_variable("stream"))->get_value();
+
+		if (val->is_void()) {
+			throw std::runtime_error("'stream' is null");
+		}
+
+		// a connection left in the middle of a body is closed, not pooled
+		{
+			std::lock_guard<std::mutex> lock(streams_mutex);
+			auto it = streams.find(val->get_raw_str()->at(INSTANCE_ID_NAME)->get_value()->get_i());
+			if (it != streams.end()) {
+				finish(*it->second);
+				streams.erase(it);
+			}
+		}
+
+		vm->push_empty_constant(Type::T_UNDEFINED);
+
+		};
+
+	vm->builtin_functions["http_server"] = [this, vm]() {
+		auto scope = vm->get_back_scope(Constants::STD_NAMESPACE);
+		auto host = std::dynamic_pointer_cast<RuntimeVariable>(scope->find_declared_variable("host"))->get_value()->get_s();
+		auto port = std::dynamic_pointer_cast<RuntimeVariable>(scope->find_declared_variable("port"))->get_value()->get_i();
+
+		// port zero is chosen by the system and read back from the server
+		auto server = std::make_shared<Server>();
+		server->listener = AsyncSocket::listen(host, port, 0);
+		server->port = server->listener->get_local_address().second;
+
+		flx_int id;
+		{
+			std::lock_guard<std::mutex> lock(servers_mutex);
+			id = next_server_id++;
+			servers[id] = server;
+		}
+
+		auto port_var = std::make_shared<RuntimeVariable>("port", Type::T_INT);
+		port_var->set_value(vm->allocate_value(new RuntimeValue(server->port)));
+		vm->gc.add_var_root(port_var);
+
+		auto instance_id_var = std::make_shared<RuntimeVariable>(INSTANCE_ID_NAME, Type::T_INT);
+		instance_id_var->set_value(vm->allocate_value(new RuntimeValue(id)));
+		vm->gc.add_var_root(instance_id_var);
+
+		flx_struct str = flx_struct();
+		str["port"] = port_var;
+		str[INSTANCE_ID_NAME] = instance_id_var;
+
+		vm->push_new_constant(new RuntimeValue(str, Constants::STD_NAMESPACE, "HttpServer"));
+
+		};
+
+	vm->builtin_functions["http_route"] = [this, vm]() {
+		auto scope = vm->get_back_scope(Constants::STD_NAMESPACE);
+		auto val = std::dynamic_pointer_cast<RuntimeVariable>(scope->find_declared_variable("server"))->get_value();
+		auto method = std::dynamic_pointer_cast<RuntimeVariable>(scope->find_declared_variable("method"))->get_value()->get_s();
+		auto path = std::dynamic_pointer_cast<RuntimeVariable>(scope->find_declared_variable("path"))->get_value()->get_s();
+		auto handler = std::dynamic_pointer_cast<RuntimeVariable>(scope->find_declared_variable("handler"))->get_value();
+
+		if (!handler->is_function()) {
+			throw std::runtime_error("http_route expects a function");
+		}
+		if (method.empty()) {
+			throw std::runtime_error("Method must be informed.");
+		}
+
+		// routes are tried in the order they were added, method "*" matches any
+		Route route;
+		std::transform(method.begin(), method.end(), std::back_inserter(route.method), ::toupper);
+		route.prefix = !path.empty() && path.back() == '*';
+		route.path = route.prefix ? path.substr(0, path.size() - 1) : path;
+		route.handler = handler->get_fun();
+
+		find_server(val)->routes.push_back(std::move(route));
+
+		vm->push_empty_constant(Type::T_UNDEFINED);
+
+		};
+
+	vm->builtin_functions["http_serve"] = [this, vm]() {
+		auto scope = vm->get_back_scope(Constants::STD_NAMESPACE);
+		auto val = std::dynamic_pointer_cast<RuntimeVariable>(scope->find_declared_variable("server"))->get_value();
+		auto max_workers = std::dynamic_pointer_cast<RuntimeVariable>(scope->find_declared_variable("max_workers"))->get_value()->get_i();
+		auto idle_timeout = std::dynamic_pointer_cast<RuntimeVariable>(scope->find_declared_variable("idle_timeout"))->get_value()->get_i();
+
+		auto server = find_server(val);
+		if (server->serving) {
+			throw std::runtime_error("the server is already serving");
+		}
+		server->serving = true;
+
+		auto scheduler = get_scheduler(vm);
+
+		auto finish = [vm, scheduler](flx_int worker) {
+			try {
+				vm->gc.remove_root(scheduler->await(worker));
+			}
+			catch (const std::runtime_error& ex) {
+				std::cerr << "http_serve: " << ex.what() << std::endl;
+			}
+			};
+
+		// a new connection waits in the backlog while max_workers are serving
+		std::vector<flx_int> workers;
+		while (true) {
+			workers.erase(std::remove_if(workers.begin(), workers.end(), [&](flx_int worker) {
+				if (!scheduler->is_done(worker)) {
+					return false;
 				}
+				finish(worker);
+				return true;
+				}), workers.end());
 
-				auto header = utils::StringUtils::split(line, ": ");
-				res_headers.push_back(std::make_pair(header[0], header[1]));
+			// the first worker to finish makes room for the next connection
+			if (max_workers > 0 && flx_int(workers.size()) >= max_workers) {
+				auto done = scheduler->await_any(workers);
+				finish(done);
+				workers.erase(std::find(workers.begin(), workers.end(), done));
+				continue;
+			}
 
+			auto connection = server->listener->accept(vm, AsyncSocket::time_point::max());
+			if (!connection) {
+				break;
 			}
+
+			// a connection that fails or stays idle is only closed, the server goes on
+			workers.push_back(scheduler->spawn_native([this, vm, server, connection, idle_timeout]() mutable {
+				try {
+					serve_connection(vm, std::move(server), std::move(connection), idle_timeout);
+				}
+				catch (const std::runtime_error&) {}
+				}));
 		}
 
-		auto flx_arr = flx_array(res_headers.size());
-		for (size_t i = 0; i < res_headers.size(); ++i) {
-			const auto& header = res_headers[i];
-			// create header struct
-			auto key_var = std::make_shared<RuntimeVariable>("key", Type::T_STRING);
-			key_var->set_value(vm->allocate_value(new RuntimeValue(flx_string(header.first))));
-			vm->gc.add_var_root(key_var);
-
-			auto value_var = std::make_shared<RuntimeVariable>("value", Type::T_STRING);
-			value_var->set_value(vm->allocate_value(new RuntimeValue(flx_string(header.second))));
-			vm->gc.add_var_root(value_var);
-
-			flx_struct header_str;
-			header_str["key"] = key_var;
-			header_str["value"] = value_var;
-
-			// create header value
-			auto header_value = vm->allocate_value(new RuntimeValue(
-				header_str,
-				Constants::DEFAULT_NAMESPACE,
-				Constants::BUILTIN_STRUCT_NAMES[BuiltinStructs::BS_ENTRY]
-			));
-
-			// push header to headers array
-			flx_arr[i] = header_value;
-		}
-		auto headers_value = vm->allocate_value(new RuntimeValue(
-			flx_arr,
-			Type::T_STRUCT,
-			std::vector<size_t>{res_headers.size()},
-			Constants::DEFAULT_NAMESPACE,
-			Constants::BUILTIN_STRUCT_NAMES[BuiltinStructs::BS_ENTRY]
-		));
+		for (auto worker : workers) {
+			finish(worker);
+		}
+		server->serving = false;
+
+		vm->push_empty_constant(Type::T_UNDEFINED);
+
+		};
+
+	vm->builtin_functions["http_stop"] = [this, vm]() {
+		auto scope = vm->get_back_scope(Constants::STD_NAMESPACE);
+		auto val = std::dynamic_pointer_cast<RuntimeVariable>(scope->find_declared_variable("server"))->get_value();
+
+		if (val->is_void()) {
+			throw std::runtime_error("'server' is null");
+		}
+
+		std::shared_ptr<Server> server;
+		{
+			std::lock_guard<std::mutex> lock(servers_mutex);
+			auto it = servers.find(val->get_raw_str()->at(INSTANCE_ID_NAME)->get_value()->get_i());
+			if (it != servers.end()) {
+				server = std::move(it->second);
+				servers.erase(it);
+			}
+		}
+
+		// requests being handled are answered, then their connections close
+		if (server) {
+			server->stopping = true;
+			server->listener->close(vm);
+			auto idle_connections = std::move(server->idle_connections);
+			for (const auto& connection : idle_connections) {
+				connection->close(vm);
+			}
+		}
 
-		// create response struct
-		auto status = utils::StringUtils::split(response_lines[0], ' ');
-
-		auto http_version_var = std::make_shared<RuntimeVariable>("http_version", Type::T_STRING);
-		http_version_var->set_value(vm->allocate_value(new RuntimeValue(flx_string(status[0]))));
-		vm->gc.add_var_root(http_version_var);
-
-		auto status_var = std::make_shared<RuntimeVariable>("status", Type::T_INT);
-		status_var->set_value(vm->allocate_value(new RuntimeValue(flx_int(stoll(status[1])))));
-		vm->gc.add_var_root(status_var);
-
-		auto status_description_var = std::make_shared<RuntimeVariable>("status_description", Type::T_STRING);
-		status_description_var->set_value(vm->allocate_value(new RuntimeValue(flx_string(status[2]))));
-		vm->gc.add_var_root(status_description_var);
-
-		auto headers_var = std::make_shared<RuntimeVariable>("headers",
-			TypeDefinition(Type::T_STRUCT,
-				std::vector<size_t>{res_headers.size()},
-				Constants::DEFAULT_NAMESPACE,
-				Constants::BUILTIN_STRUCT_NAMES[BuiltinStructs::BS_ENTRY]
-			)
-		);
-		headers_var->set_value(headers_value);
-		vm->gc.add_var_root(headers_var);
-
-		auto data_var = std::make_shared<RuntimeVariable>("data", Type::T_STRING);
-		data_var->set_value(vm->allocate_value(new RuntimeValue(flx_string(res_body))));
-		vm->gc.add_var_root(data_var);
-
-		auto raw_var = std::make_shared<RuntimeVariable>("raw", Type::T_STRING);
-		raw_var->set_value(vm->allocate_value(new RuntimeValue(flx_string(raw_response))));
-		vm->gc.add_var_root(raw_var);
-
-		flx_struct res_str;
-		res_str["http_version"] = http_version_var;
-		res_str["status"] = status_var;
-		res_str["status_description"] = status_description_var;
-		res_str["headers"] = headers_var;
-		res_str["data"] = data_var;
-		res_str["raw"] = raw_var;
-
-		vm->push_new_constant(new RuntimeValue(res_str, Constants::STD_NAMESPACE, "HttpResponse"));
+		vm->push_empty_constant(Type::T_UNDEFINED);
 
 		};
 
@@ -1,19 +1,163 @@
 #ifndef MD_HTTP_HPP
 #define MD_HTTP_HPP
 
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <unordered_set>
+#include <memory>
+#include <mutex>
+
 #include "module.hpp"
+#include "async_socket.hpp"
+#include "types.hpp"
+
+#ifdef _WIN32
+#include <winsock2.h>
+#endif // _WIN32
 
 namespace core {
 
 	namespace modules {
 
+		/*
+			HTTP/1.1 client. Connections are kept alive in a pool per host and port,
+			and responses are read until their Content-Length or the last chunk of a
+			chunked body, so a connection can be reused by the next request. Bodies
+			can be read whole, streamed in chunks through a handle or written to a
+			file as they arrive.
+
+			HTTP/1.1 server. Each connection is served by its own task on the event
+			loop of the scheduler, at most max_workers at once since every task holds
+			a native thread, and its requests are dispatched through a route table to
+			Flexa functions taking an HttpRequest and returning an HttpResponse.
+		*/
 		class ModuleHTTP : public Module {
 		public:
+#ifdef _WIN32
+			typedef SOCKET socket_t;
+#else
+			typedef int socket_t;
+#endif // _WIN32
+
+		private:
+			struct Connection {
+				socket_t sock;
+				std::string pool_key;
+				// bytes received past the ones consumed so far
+				std::string buffer;
+				size_t begin = 0;
+
+				Connection(socket_t sock, const std::string& pool_key);
+				~Connection();
+
+				// reads more bytes into the buffer, false once the peer closed
+				bool receive();
+				void send_all(const std::string& data);
+				bool is_stale();
+			};
+
+			struct Request {
+				std::string hostname;
+				std::string port;
+				std::string method;
+				std::string message;
+				// milliseconds to connect, send or wait for bytes, 0 waits forever
+				flx_int timeout = 0;
+				bool keep_alive = true;
+			};
+
+			struct Response {
+				std::unique_ptr<Connection> connection;
+				bool reused = false;
+
+				std::string status_line;
+				std::vector<std::pair<std::string, std::string>> headers;
+				std::string head;
+
+				bool chunked = false;
+				bool until_close = false;
+				bool keep_alive = true;
+				size_t remaining = 0;
+				bool done = false;
+
+				// next part of the body, at most max_size bytes, empty at the end
+				std::string read_body(size_t max_size, std::string* raw = nullptr);
+			};
+
+			struct Route {
+				std::string method;
+				std::string path;
+				// the path ended with '*', every path starting with the rest matches
+				bool prefix = false;
+				flx_function handler;
+			};
+
+			struct Server {
+				std::shared_ptr<runtime::AsyncSocket> listener;
+				flx_int port = 0;
+				std::vector<Route> routes;
+				// connections waiting for their next request, closed when the server stops
+				std::unordered_set<std::shared_ptr<runtime::AsyncSocket>> idle_connections;
+				bool serving = false;
+				bool stopping = false;
+			};
+
+			struct IncomingRequest {
+				std::string method;
+				std::string path;
+				std::string query;
+				std::string version;
+				std::vector<std::pair<std::string, std::string>> headers;
+				std::string body;
+				bool keep_alive = true;
+			};
+
+			static constexpr size_t MAX_IDLE_PER_HOST = 8;
+
+			std::mutex pool_mutex;
+			std::unordered_map<std::string, std::vector<std::unique_ptr<Connection>>> idle_connections;
+
+			std::mutex streams_mutex;
+			flx_int next_stream_id = 1;
+			std::unordered_map<flx_int, std::shared_ptr<Response>> streams;
+
+			std::mutex servers_mutex;
+			flx_int next_server_id = 1;
+			std::unordered_map<flx_int, std::shared_ptr<Server>> servers;
+
+		public:
 			ModuleHTTP();
 			~ModuleHTTP();
 
 			void register_functions(analysis::SemanticAnalyser* visitor) override;
 			void register_functions(runtime::VirtualMachine* vm) override;
+
+		private:
+			std::unique_ptr<Connection> acquire(const std::string& hostname, const std::string& port, flx_int timeout, bool& reused);
+			void release(std::unique_ptr<Connection> connection);
+			// read on the vm turn, so the request can be sent while other tasks run
+			Request parse_request(RuntimeValue* req);
+			// sends the request and reads the response head, the body is left to read
+			std::shared_ptr<Response> send_request(const Request& request);
+			void finish(Response& response);
+
+			RuntimeValue* build_entries(runtime::VirtualMachine* vm, const std::vector<std::pair<std::string, std::string>>& entries);
+			RuntimeValue* build_response(runtime::VirtualMachine* vm, const Response& response, const std::string& body, const std::string& raw);
+			std::shared_ptr<Response> find_stream(RuntimeValue* handle);
+
+			std::shared_ptr<Server> find_server(RuntimeValue* handle);
+			// serves the requests of a connection until it is closed, idle for too long
+			// or the server stops
+			void serve_connection(runtime::VirtualMachine* vm, std::shared_ptr<Server> server,
+				std::shared_ptr<runtime::AsyncSocket> connection, flx_int idle_timeout);
+			// the status to answer with, 0 once the peer closed before a request
+			int read_request(runtime::VirtualMachine* vm, Server& server, std::shared_ptr<runtime::AsyncSocket> connection,
+				IncomingRequest& request, flx_int idle_timeout);
+			RuntimeValue* build_request(runtime::VirtualMachine* vm, const Server& server, const IncomingRequest& request);
+			// the status line, headers and body of what the handler returned, a
+			// "Connection: close" header of the handler ends the keep alive
+			std::string serialize_response(RuntimeValue* res, IncomingRequest& request);
 		};
 
 	}
@@ -0,0 +1,400 @@
+#include "md_json.hpp"
+
+#include <charconv>
+#include <cmath>
+#include <cstring>
+
+#include "vm.hpp"
+#include "semantic_analysis.hpp"
+#include "constants.hpp"
+
+using namespace core;
+using namespace core::modules;
+using namespace core::runtime;
+using namespace core::analysis;
+
+using utils::JsonTokenizer;
+
+ModuleJSON::Reader::Reader(std::string document, size_t max_depth)
+	: document(std::move(document)), tokenizer(this->document), max_depth(max_depth) {}
+
+ModuleJSON::ModuleJSON() {}
+
+ModuleJSON::~ModuleJSON() = default;
+
+RuntimeValue* ModuleJSON::build_value(VirtualMachine* vm, JsonTokenizer& tokenizer, const JsonTokenizer::Token& token) {
+	switch (token.type) {
+	case JsonTokenizer::TokenType::BEGIN_OBJECT: {
+		flx_struct str;
+		for (auto member = tokenizer.next(); member.type != JsonTokenizer::TokenType::END_OBJECT; member = tokenizer.next()) {
+			// the key is a view the value token replaces
+			std::string key(member.text);
+
+			auto var = std::make_shared<RuntimeVariable>(key, Type::T_ANY);
+			var->set_value(build_value(vm, tokenizer, tokenizer.next()));
+			vm->gc.add_var_root(var);
+
+			// a repeated member keeps the last value
+			str[std::move(key)] = var;
+		}
+		return vm->allocate_value(new RuntimeValue(std::move(str), Constants::STD_NAMESPACE, "JsonObject"));
+	}
+	case JsonTokenizer::TokenType::BEGIN_ARRAY: {
+		std::vector<RuntimeValue*> items;
+		for (auto item = tokenizer.next(); item.type != JsonTokenizer::TokenType::END_ARRAY; item = tokenizer.next()) {
+			items.push_back(build_value(vm, tokenizer, item));
+		}
+
+		flx_array arr = flx_array(items.size());
+		for (size_t i = 0; i < items.size(); ++i) {
+			arr[i] = items[i];
+		}
+		return vm->allocate_value(new RuntimeValue(std::move(arr), Type::T_ANY, std::vector<size_t>{ items.size() }));
+	}
+	case JsonTokenizer::TokenType::STRING:
+		return vm->allocate_value(new RuntimeValue(flx_string(token.text)));
+	case JsonTokenizer::TokenType::INT:
+		return vm->allocate_value(new RuntimeValue(flx_int(token.int_value)));
+	case JsonTokenizer::TokenType::FLOAT:
+		return vm->allocate_value(new RuntimeValue(flx_float(token.float_value)));
+	case JsonTokenizer::TokenType::BOOL:
+		return vm->allocate_value(new RuntimeValue(flx_bool(token.bool_value)));
+	case JsonTokenizer::TokenType::NULL_VALUE:
+		return vm->allocate_value(new RuntimeValue(Type::T_VOID));
+	default:
+		throw std::runtime_error("invalid JSON: unexpected token");
+	}
+}
+
+RuntimeValue* ModuleJSON::build_event(VirtualMachine* vm, const std::string& kind, const std::string* key, RuntimeValue* value) {
+	auto kind_var = std::make_shared<RuntimeVariable>("kind", Type::T_STRING);
+	kind_var->set_value(vm->allocate_value(new RuntimeValue(flx_string(kind))));
+	vm->gc.add_var_root(kind_var);
+
+	auto key_var = std::make_shared<RuntimeVariable>("key", Type::T_STRING);
+	key_var->set_value(vm->allocate_value(key ? new RuntimeValue(flx_string(*key)) : new RuntimeValue(Type::T_VOID)));
+	vm->gc.add_var_root(key_var);
+
+	auto value_var = std::make_shared<RuntimeVariable>("value", Type::T_ANY);
+	value_var->set_value(value ? value : vm->allocate_value(new RuntimeValue(Type::T_VOID)));
+	vm->gc.add_var_root(value_var);
+
+	flx_struct str;
+	str["kind"] = kind_var;
+	str["key"] = key_var;
+	str["value"] = value_var;
+
+	return vm->allocate_value(new RuntimeValue(str, Constants::STD_NAMESPACE, "JsonEvent"));
+}
+
+std::shared_ptr<ModuleJSON::Reader> ModuleJSON::find_reader(RuntimeValue* handle) {
+	if (handle->is_void()) {
+		throw std::runtime_error("reader is null");
+	}
+
+	std::lock_guard<std::mutex> lock(readers_mutex);
+	auto it = readers.find(handle->get_raw_str()->at(INSTANCE_ID_NAME)->get_value()->get_i());
+	if (it == readers.end()) {
+		throw std::runtime_error("reader is closed");
+	}
+	return it->second;
+}
+
+void ModuleJSON::write_value(utils::OutputSink& sink, const RuntimeValue* value, flx_int indent, size_t level, WritingValues& writing) {
+	if (!value || value->is_void() || value->is_undefined()) {
+		sink.write(std::string_view("null"));
+		return;
+	}
+
+	bool container = value->is_array() || value->is_struct() || value->is_class();
+	if (container && !writing.insert(value).second) {
+		throw std::runtime_error("cannot serialize a cyclic value to JSON");
+	}
+
+	if (value->is_array()) {
+		auto arr = value->get_raw_arr();
+		sink.write('[');
+		for (flx_int i = 0; arr && i < arr->size(); ++i) {
+			if (i > 0) {
+				sink.write(',');
+			}
+			write_line(sink, indent, level + 1);
+			write_value(sink, (*arr)[i], indent, level + 1, writing);
+		}
+		if (arr && arr->size() > 0) {
+			write_line(sink, indent, level);
+		}
+		sink.write(']');
+	}
+	else if (value->is_struct() || value->is_class()) {
+		bool first = true;
+		auto write_member = [&](const std::string& key, const RuntimeValue* member) {
+			if (!first) {
+				sink.write(',');
+			}
+			first = false;
+			write_line(sink, indent, level + 1);
+			write_string(sink, key);
+			sink.write(std::string_view(indent > 0 ? ": " : ":"));
+			write_value(sink, member, indent, level + 1, writing);
+			};
+
+		sink.write('{');
+		if (value->is_struct()) {
+			if (auto str = value->get_raw_str()) {
+				for (const auto& [key, var] : *str) {
+					write_member(key, var->get_value());
+				}
+			}
+		}
+		else if (auto cls = value->get_raw_cls()) {
+			for (const auto& [key, var] : cls->variable_symbol_table) {
+				write_member(key, std::dynamic_pointer_cast<RuntimeVariable>(var)->get_value());
+			}
+		}
+		if (!first) {
+			write_line(sink, indent, level);
+		}
+		sink.write('}');
+	}
+	else {
+		switch (value->type) {
+		case Type::T_BOOL:
+			sink.write(std::string_view(value->get_b() ? "true" : "false"));
+			break;
+		case Type::T_INT:
+			sink.write_int(value->get_i());
+			break;
+		case Type::T_FLOAT: {
+			flx_float number = value->get_f();
+			// JSON has no infinities nor nan
+			if (!std::isfinite(number)) {
+				sink.write(std::string_view("null"));
+				break;
+			}
+			// the shortest digits reading back as the same long double
+			char digits[64];
+			auto end = std::to_chars(digits, digits + sizeof(digits), number).ptr;
+			sink.write(std::string_view(digits, end - digits));
+			// keeps the number a float when read back
+			if (!memchr(digits, '.', end - digits) && !memchr(digits, 'e', end - digits)) {
+				sink.write(std::string_view(".0"));
+			}
+			break;
+		}
+		case Type::T_CHAR: {
+			char c = value->get_c();
+			write_string(sink, std::string_view(&c, 1));
+			break;
+		}
+		case Type::T_STRING:
+			write_string(sink, value->get_raw_s() ? std::string_view(*value->get_raw_s()) : std::string_view());
+			break;
+		default:
+			throw std::runtime_error("cannot serialize a value of type " + TypeDefinition::buid_type_str(*value) + " to JSON");
+		}
+	}
+
+	if (container) {
+		writing.erase(value);
+	}
+}
+
+void ModuleJSON::write_string(utils::OutputSink& sink, std::string_view str) {
+	static const char* HEX_DIGITS = "0123456789abcdef";
+
+	sink.write('"');
+	size_t run_start = 0;
+	for (size_t i = 0; i < str.size(); ++i) {
+		auto c = static_cast<unsigned char>(str[i]);
+		if (c >= 0x20 && c != '"' && c != '\\') {
+			continue;
+		}
+
+		// the characters without escapes are written in runs
+		sink.write(str.substr(run_start, i - run_start));
+		run_start = i + 1;
+
+		switch (c) {
+		case '"': sink.write(std::string_view("\\\"")); break;
+		case '\\': sink.write(std::string_view("\\\\")); break;
+		case '\b': sink.write(std::string_view("\\b")); break;
+		case '\f': sink.write(std::string_view("\\f")); break;
+		case '\n': sink.write(std::string_view("\\n")); break;
+		case '\r': sink.write(std::string_view("\\r")); break;
+		case '\t': sink.write(std::string_view("\\t")); break;
+		default: {
+			char escape[] = { '\\', 'u', '0', '0', HEX_DIGITS[c >> 4], HEX_DIGITS[c & 0xF] };
+			sink.write(std::string_view(escape, sizeof(escape)));
+		}
+		}
+	}
+	sink.write(str.substr(run_start));
+	sink.write('"');
+}
+
+void ModuleJSON::write_line(utils::OutputSink& sink, flx_int indent, size_t level) {
+	if (indent <= 0) {
+		return;
+	}
+	sink.write('\n');
+	for (size_t i = 0; i < size_t(indent) * level; ++i) {
+		sink.write(' ');
+	}
+}
+
+void ModuleJSON::register_functions(SemanticAnalyser* visitor) {
+	visitor->builtin_functions["json_parse"] = nullptr;
+	visitor->builtin_functions["json_stringify"] = nullptr;
+	visitor->builtin_functions["json_reader"] = nullptr;
+	visitor->builtin_functions["json_next"] = nullptr;
+	visitor->builtin_functions["json_close"] = nullptr;
+}
+
+void ModuleJSON::register_functions(VirtualMachine* vm) {
+
+	vm->builtin_functions["json_parse"] = [this, vm]() {
+		auto scope = vm->get_back_scope(Constants::STD_NAMESPACE);
+		auto text = std::dynamic_pointer_cast<RuntimeVariable>(scope->find_declared_variable("text"))->get_value();
+
+		std::string_view document = text->get_raw_s() ? std::string_view(*text->get_raw_s()) : std::string_view();
+		JsonTokenizer tokenizer(document);
+
+		// the values are not reachable until the document is built, so nothing is collected meanwhile
+		auto gc_enable = vm->gc.enable;
+		vm->gc.enable = false;
+
+		RuntimeValue* value;
+		try {
+			value = build_value(vm, tokenizer, tokenizer.next());
+			if (tokenizer.next().type != JsonTokenizer::TokenType::END) {
+				throw std::runtime_error("invalid JSON: unexpected content after the document");
+			}
+		}
+		catch (...) {
+			vm->gc.enable = gc_enable;
+			throw;
+		}
+		vm->gc.enable = gc_enable;
+
+		vm->push_constant(value);
+
+		};
+
+	vm->builtin_functions["json_stringify"] = [this, vm]() {
+		auto scope = vm->get_back_scope(Constants::STD_NAMESPACE);
+		auto value = std::dynamic_pointer_cast<RuntimeVariable>(scope->find_declared_variable("value"))->get_value();
+		auto indent = std::dynamic_pointer_cast<RuntimeVariable>(scope->find_declared_variable("indent"))->get_value()->get_i();
+
+		std::string json;
+		utils::StringSink sink(json);
+		WritingValues writing;
+		write_value(sink, value, indent, 0, writing);
+
+		vm->push_new_constant(new RuntimeValue(flx_string(std::move(json))));
+
+		};
+
+	vm->builtin_functions["json_reader"] = [this, vm]() {
+		auto scope = vm->get_back_scope(Constants::STD_NAMESPACE);
+		auto text = std::dynamic_pointer_cast<RuntimeVariable>(scope->find_declared_variable("text"))->get_value()->get_s();
+		auto max_depth = std::dynamic_pointer_cast<RuntimeVariable>(scope->find_declared_variable("max_depth"))->get_value()->get_i();
+
+		if (max_depth < 0) {
+			throw std::runtime_error("max_depth cannot be negative");
+		}
+
+		auto reader = std::make_shared<Reader>(std::move(text), size_t(max_depth));
+
+		flx_int id;
+		{
+			std::lock_guard<std::mutex> lock(readers_mutex);
+			id = next_reader_id++;
+			readers[id] = reader;
+		}
+
+		auto instance_id_var = std::make_shared<RuntimeVariable>(INSTANCE_ID_NAME, Type::T_INT);
+		instance_id_var->set_value(vm->allocate_value(new RuntimeValue(id)));
+		vm->gc.add_var_root(instance_id_var);
+
+		flx_struct str = flx_struct();
+		str[INSTANCE_ID_NAME] = instance_id_var;
+
+		vm->push_new_constant(new RuntimeValue(str, Constants::STD_NAMESPACE, "JsonReader"));
+
+		};
+
+	// containers up to the depth of the reader are events, deeper ones are
+	// built whole and come as a single value
+
+	vm->builtin_functions["json_next"] = [this, vm]() {
+		auto scope = vm->get_back_scope(Constants::STD_NAMESPACE);
+		auto reader = find_reader(std::dynamic_pointer_cast<RuntimeVariable>(scope->find_declared_variable("reader"))->get_value());
+		auto& tokenizer = reader->tokenizer;
+
+		auto gc_enable = vm->gc.enable;
+		vm->gc.enable = false;
+
+		RuntimeValue* event;
+		try {
+			auto token = tokenizer.next();
+
+			std::string key;
+			bool has_key = token.type == JsonTokenizer::TokenType::KEY;
+			if (has_key) {
+				key = token.text;
+				token = tokenizer.next();
+			}
+
+			std::string kind = "value";
+			RuntimeValue* value = nullptr;
+			switch (token.type) {
+			case JsonTokenizer::TokenType::BEGIN_OBJECT:
+			case JsonTokenizer::TokenType::BEGIN_ARRAY:
+				if (tokenizer.depth() > reader->max_depth) {
+					value = build_value(vm, tokenizer, token);
+				}
+				else {
+					kind = token.type == JsonTokenizer::TokenType::BEGIN_OBJECT ? "begin_object" : "begin_array";
+				}
+				break;
+			case JsonTokenizer::TokenType::END_OBJECT:
+				kind = "end_object";
+				break;
+			case JsonTokenizer::TokenType::END_ARRAY:
+				kind = "end_array";
+				break;
+			case JsonTokenizer::TokenType::END:
+				kind = "end";
+				break;
+			default:
+				value = build_value(vm, tokenizer, token);
+				break;
+			}
+
+			event = build_event(vm, kind, has_key ? &key : nullptr, value);
+		}
+		catch (...) {
+			vm->gc.enable = gc_enable;
+			throw;
+		}
+		vm->gc.enable = gc_enable;
+
+		vm->push_constant(event);
+
+		};
+
+	vm->builtin_functions["json_close"] = [this, vm]() {
+		auto scope = vm->get_back_scope(Constants::STD_NAMESPACE);
+		auto val = std::dynamic_pointer_cast<RuntimeVariable>(scope->find_declared_variable("reader"))->get_value();
+
+		if (!val->is_void()) {
+			std::lock_guard<std::mutex> lock(readers_mutex);
+			readers.erase(val->get_raw_str()->at(INSTANCE_ID_NAME)->get_value()->get_i());
+		}
+
+		vm->push_empty_constant(Type::T_UNDEFINED);
+
+		};
+
+}
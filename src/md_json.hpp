@@ -0,0 +1,65 @@
+#ifndef MD_JSON_HPP
+#define MD_JSON_HPP
+
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <memory>
+#include <mutex>
+
+#include "module.hpp"
+#include "types.hpp"
+#include "json_tokenizer.hpp"
+#include "output_buffer.hpp"
+
+namespace core {
+
+	namespace modules {
+
+		/*
+			Native JSON engine. Documents are read by a single pass tokenizer and
+			built straight into values of the vm: objects become JsonObject structs
+			with a field per member, arrays any[] arrays. A reader streams a
+			document as events instead, building only the containers deeper than
+			its depth, and values are serialized into one string without
+			intermediate ones.
+		*/
+		class ModuleJSON : public Module {
+		private:
+			struct Reader {
+				std::string document;
+				utils::JsonTokenizer tokenizer;
+				size_t max_depth;
+
+				Reader(std::string document, size_t max_depth);
+			};
+
+			typedef std::unordered_set<const RuntimeValue*> WritingValues;
+
+			std::mutex readers_mutex;
+			flx_int next_reader_id = 1;
+			std::unordered_map<flx_int, std::shared_ptr<Reader>> readers;
+
+		public:
+			ModuleJSON();
+			~ModuleJSON();
+
+			void register_functions(analysis::SemanticAnalyser* visitor) override;
+			void register_functions(runtime::VirtualMachine* vm) override;
+
+		private:
+			// builds the value starting with token, the whole container for a begin token
+			static RuntimeValue* build_value(runtime::VirtualMachine* vm, utils::JsonTokenizer& tokenizer, const utils::JsonTokenizer::Token& token);
+			static RuntimeValue* build_event(runtime::VirtualMachine* vm, const std::string& kind, const std::string* key, RuntimeValue* value);
+			std::shared_ptr<Reader> find_reader(RuntimeValue* handle);
+
+			static void write_value(utils::OutputSink& sink, const RuntimeValue* value, flx_int indent, size_t level, WritingValues& writing);
+			static void write_string(utils::OutputSink& sink, std::string_view str);
+			static void write_line(utils::OutputSink& sink, flx_int indent, size_t level);
+		};
+
+	}
+
+}
+
+#endif // !MD_JSON_HPP
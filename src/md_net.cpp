@@ -0,0 +1,305 @@
+#include "md_net.hpp"
+
+#include <iostream>
+#include <algorithm>
+
+#ifdef _WIN32
+#include <winsock2.h>
+#endif // _WIN32
+
+#include "vm.hpp"
+#include "vm_scheduler.hpp"
+#include "semantic_analysis.hpp"
+#include "constants.hpp"
+
+using namespace core;
+using namespace core::modules;
+using namespace core::runtime;
+using namespace core::analysis;
+
+static constexpr size_t MAX_LINE_SIZE = 1 << 20;
+
+static VmScheduler* get_scheduler(VirtualMachine* vm) {
+	if (!vm->scheduler) {
+		vm->scheduler = std::make_shared<VmScheduler>(vm);
+	}
+	return vm->scheduler.get();
+}
+
+ModuleNet::ModuleNet() {
+#ifdef _WIN32
+	WSADATA wsa;
+	WSAStartup(MAKEWORD(2, 2), &wsa);
+#endif // _WIN32
+}
+
+ModuleNet::~ModuleNet() {
+	sockets.clear();
+#ifdef _WIN32
+	WSACleanup();
+#endif // _WIN32
+}
+
+RuntimeValue* ModuleNet::build_socket(VirtualMachine* vm, std::shared_ptr<AsyncSocket> socket, const std::pair<std::string, flx_int>& address) {
+	flx_int id;
+	{
+		std::lock_guard<std::mutex> lock(sockets_mutex);
+		id = next_socket_id++;
+		sockets[id] = std::move(socket);
+	}
+
+	auto address_var = std::make_shared<RuntimeVariable>("address", Type::T_STRING);
+	address_var->set_value(vm->allocate_value(new RuntimeValue(flx_string(address.first))));
+	vm->gc.add_var_root(address_var);
+
+	auto port_var = std::make_shared<RuntimeVariable>("port", Type::T_INT);
+	port_var->set_value(vm->allocate_value(new RuntimeValue(address.second)));
+	vm->gc.add_var_root(port_var);
+
+	auto instance_id_var = std::make_shared<RuntimeVariable>(INSTANCE_ID_NAME, Type::T_INT);
+	instance_id_var->set_value(vm->allocate_value(new RuntimeValue(id)));
+	vm->gc.add_var_root(instance_id_var);
+
+	flx_struct str = flx_struct();
+	str["address"] = address_var;
+	str["port"] = port_var;
+	str[INSTANCE_ID_NAME] = instance_id_var;
+
+	return vm->allocate_value(new RuntimeValue(str, Constants::STD_NAMESPACE, "Socket"));
+}
+
+std::shared_ptr<AsyncSocket> ModuleNet::find_socket(RuntimeValue* handle) {
+	if (handle->is_void()) {
+		throw std::runtime_error("socket is null");
+	}
+
+	std::lock_guard<std::mutex> lock(sockets_mutex);
+	auto it = sockets.find(handle->get_raw_str()->at(INSTANCE_ID_NAME)->get_value()->get_i());
+	if (it == sockets.end()) {
+		throw std::runtime_error("socket is closed");
+	}
+	return it->second;
+}
+
+void ModuleNet::register_functions(SemanticAnalyser* visitor) {
+	visitor->builtin_functions["net_listen"] = nullptr;
+	visitor->builtin_functions["net_accept"] = nullptr;
+	visitor->builtin_functions["net_connect"] = nullptr;
+	visitor->builtin_functions["net_read"] = nullptr;
+	visitor->builtin_functions["net_read_line"] = nullptr;
+	visitor->builtin_functions["net_write"] = nullptr;
+	visitor->builtin_functions["net_close"] = nullptr;
+	visitor->builtin_functions["net_sleep"] = nullptr;
+	visitor->builtin_functions["net_serve"] = nullptr;
+}
+
+void ModuleNet::register_functions(VirtualMachine* vm) {
+
+	vm->builtin_functions["net_listen"] = [this, vm]() {
+		auto scope = vm->get_back_scope(Constants::STD_NAMESPACE);
+		auto host = std::dynamic_pointer_cast<RuntimeVariable>(scope->find_declared_variable("host"))->get_value()->get_s();
+		auto port = std::dynamic_pointer_cast<RuntimeVariable>(scope->find_declared_variable("port"))->get_value()->get_i();
+		auto backlog = std::dynamic_pointer_cast<RuntimeVariable>(scope->find_declared_variable("backlog"))->get_value()->get_i();
+
+		// the port is the one given by the system when it was zero
+		auto listener = AsyncSocket::listen(host, port, backlog);
+		auto address = listener->get_local_address();
+
+		vm->push_constant(build_socket(vm, std::move(listener), address));
+
+		};
+
+	vm->builtin_functions["net_accept"] = [this, vm]() {
+		auto scope = vm->get_back_scope(Constants::STD_NAMESPACE);
+		auto val = std::dynamic_pointer_cast<RuntimeVariable>(scope->find_declared_variable("listener"))->get_value();
+		auto timeout = std::dynamic_pointer_cast<RuntimeVariable>(scope->find_declared_variable("timeout"))->get_value()->get_i();
+
+		auto connection = find_socket(val)->accept(vm, AsyncSocket::get_deadline(timeout));
+		if (!connection) {
+			throw std::runtime_error("socket was closed");
+		}
+		auto address = connection->get_peer_address();
+
+		vm->push_constant(build_socket(vm, std::move(connection), address));
+
+		};
+
+	vm->builtin_functions["net_connect"] = [this, vm]() {
+		auto scope = vm->get_back_scope(Constants::STD_NAMESPACE);
+		auto host = std::dynamic_pointer_cast<RuntimeVariable>(scope->find_declared_variable("host"))->get_value()->get_s();
+		auto port = std::dynamic_pointer_cast<RuntimeVariable>(scope->find_declared_variable("port"))->get_value()->get_i();
+		auto timeout = std::dynamic_pointer_cast<RuntimeVariable>(scope->find_declared_variable("timeout"))->get_value()->get_i();
+
+		auto connection = AsyncSocket::connect(vm, host, port, AsyncSocket::get_deadline(timeout));
+
+		vm->push_constant(build_socket(vm, std::move(connection), { host, port }));
+
+		};
+
+	vm->builtin_functions["net_read"] = [this, vm]() {
+		auto scope = vm->get_back_scope(Constants::STD_NAMESPACE);
+		auto val = std::dynamic_pointer_cast<RuntimeVariable>(scope->find_declared_variable("socket"))->get_value();
+		auto size = std::dynamic_pointer_cast<RuntimeVariable>(scope->find_declared_variable("size"))->get_value()->get_i();
+		auto timeout = std::dynamic_pointer_cast<RuntimeVariable>(scope->find_declared_variable("timeout"))->get_value()->get_i();
+
+		if (size <= 0) {
+			throw std::runtime_error("size must be greater than zero");
+		}
+
+		// an empty string once the peer closed
+		auto data = find_socket(val)->read(vm, size_t(size), AsyncSocket::get_deadline(timeout));
+
+		vm->push_new_constant(new RuntimeValue(flx_string(std::move(data))));
+
+		};
+
+	vm->builtin_functions["net_read_line"] = [this, vm]() {
+		auto scope = vm->get_back_scope(Constants::STD_NAMESPACE);
+		auto val = std::dynamic_pointer_cast<RuntimeVariable>(scope->find_declared_variable("socket"))->get_value();
+		auto timeout = std::dynamic_pointer_cast<RuntimeVariable>(scope->find_declared_variable("timeout"))->get_value()->get_i();
+
+		// null once the peer closed and nothing is left
+		std::string line;
+		if (find_socket(val)->read_line(vm, line, AsyncSocket::get_deadline(timeout), MAX_LINE_SIZE)) {
+			vm->push_new_constant(new RuntimeValue(flx_string(std::move(line))));
+		}
+		else {
+			vm->push_empty_constant(Type::T_VOID);
+		}
+
+		};
+
+	vm->builtin_functions["net_write"] = [this, vm]() {
+		auto scope = vm->get_back_scope(Constants::STD_NAMESPACE);
+		auto val = std::dynamic_pointer_cast<RuntimeVariable>(scope->find_declared_variable("socket"))->get_value();
+		auto data = std::dynamic_pointer_cast<RuntimeVariable>(scope->find_declared_variable("data"))->get_value();
+		auto timeout = std::dynamic_pointer_cast<RuntimeVariable>(scope->find_declared_variable("timeout"))->get_value()->get_i();
+
+		find_socket(val)->write(vm, *data->get_raw_s(), AsyncSocket::get_deadline(timeout));
+
+		vm->push_empty_constant(Type::T_UNDEFINED);
+
+		};
+
+	vm->builtin_functions["net_close"] = [this, vm]() {
+		auto scope = vm->get_back_scope(Constants::STD_NAMESPACE);
+		auto val = std::dynamic_pointer_cast<RuntimeVariable>(scope->find_declared_variable("socket"))->get_value();
+
+		if (val->is_void()) {
+			throw std::runtime_error("socket is null");
+		}
+
+		std::shared_ptr<AsyncSocket> socket;
+		{
+			std::lock_guard<std::mutex> lock(sockets_mutex);
+			auto it = sockets.find(val->get_raw_str()->at(INSTANCE_ID_NAME)->get_value()->get_i());
+			if (it != sockets.end()) {
+				socket = std::move(it->second);
+				sockets.erase(it);
+			}
+		}
+
+		if (socket) {
+			socket->close(vm);
+		}
+
+		vm->push_empty_constant(Type::T_UNDEFINED);
+
+		};
+
+	vm->builtin_functions["net_sleep"] = [this, vm]() {
+		auto scope = vm->get_back_scope(Constants::STD_NAMESPACE);
+		auto ms = std::dynamic_pointer_cast<RuntimeVariable>(scope->find_declared_variable("ms"))->get_value()->get_i();
+
+		// a timer of the event loop, the thread of the task sleeps until it fires
+		if (ms > 0) {
+			get_scheduler(vm)->wait_io(EventLoop::NO_SOCKET, 0, ms);
+		}
+		else {
+			get_scheduler(vm)->yield();
+		}
+
+		vm->push_empty_constant(Type::T_UNDEFINED);
+
+		};
+
+	vm->builtin_functions["net_serve"] = [this, vm]() {
+		auto scope = vm->get_back_scope(Constants::STD_NAMESPACE);
+		auto val = std::dynamic_pointer_cast<RuntimeVariable>(scope->find_declared_variable("listener"))->get_value();
+		auto handler = std::dynamic_pointer_cast<RuntimeVariable>(scope->find_declared_variable("handler"))->get_value();
+		auto max_connections = std::dynamic_pointer_cast<RuntimeVariable>(scope->find_declared_variable("max_connections"))->get_value()->get_i();
+
+		if (!handler->is_function()) {
+			throw std::runtime_error("net_serve expects a function");
+		}
+
+		auto listener = find_socket(val);
+		auto scheduler = get_scheduler(vm);
+
+		auto function = handler->get_fun();
+
+		auto finish = [vm, scheduler](flx_int handler_task) {
+			vm->gc.remove_root(scheduler->await(handler_task));
+			};
+
+		std::vector<flx_int> handlers;
+		while (true) {
+			handlers.erase(std::remove_if(handlers.begin(), handlers.end(), [&](flx_int handler_task) {
+				if (!scheduler->is_done(handler_task)) {
+					return false;
+				}
+				finish(handler_task);
+				return true;
+				}), handlers.end());
+
+			// the first handler to return makes room for the next connection
+			if (max_connections > 0 && flx_int(handlers.size()) >= max_connections) {
+				auto done = scheduler->await_any(handlers);
+				finish(done);
+				handlers.erase(std::find(handlers.begin(), handlers.end(), done));
+				continue;
+			}
+
+			// the server stops once a handler closes the listener
+			auto connection = listener->accept(vm, AsyncSocket::time_point::max());
+			if (!connection) {
+				break;
+			}
+			auto address = connection->get_peer_address();
+			auto connection_value = build_socket(vm, std::move(connection), address);
+			vm->gc.add_root(connection_value);
+
+			auto socket_id = connection_value->get_raw_str()->at(INSTANCE_ID_NAME)->get_value()->get_i();
+			handlers.push_back(scheduler->spawn_native([this, vm, function, connection_value, socket_id]() {
+				// the connection is closed as soon as its handler returned, even a cancelled one
+				struct ConnectionGuard {
+					ModuleNet* module;
+					VirtualMachine* vm;
+					RuntimeValue* value;
+					flx_int id;
+					~ConnectionGuard() {
+						vm->gc.remove_root(value);
+						std::lock_guard<std::mutex> lock(module->sockets_mutex);
+						module->sockets.erase(id);
+					}
+				} guard{ this, vm, connection_value, socket_id };
+
+				// a failing handler only loses its connection, the server goes on
+				try {
+					vm->call("", "", function.first, function.second, { connection_value });
+				}
+				catch (const std::runtime_error& ex) {
+					std::cerr << "net_serve: " << ex.what() << std::endl;
+				}
+				}));
+		}
+
+		for (auto handler_task : handlers) {
+			finish(handler_task);
+		}
+
+		vm->push_empty_constant(Type::T_UNDEFINED);
+
+		};
+
+}
@@ -0,0 +1,45 @@
+#ifndef MD_NET_HPP
+#define MD_NET_HPP
+
+#include <string>
+#include <unordered_map>
+#include <memory>
+#include <mutex>
+
+#include "module.hpp"
+#include "async_socket.hpp"
+#include "types.hpp"
+
+namespace core {
+
+	namespace modules {
+
+		/*
+			Non blocking TCP sockets. A read, write, accept or connect that cannot
+			complete suspends only the task calling it until the event loop of the
+			scheduler sees the socket ready, so one program can serve many
+			connections, each one handled by its own task and so its own thread.
+		*/
+		class ModuleNet : public Module {
+		private:
+			std::mutex sockets_mutex;
+			flx_int next_socket_id = 1;
+			std::unordered_map<flx_int, std::shared_ptr<runtime::AsyncSocket>> sockets;
+
+		public:
+			ModuleNet();
+			~ModuleNet();
+
+			void register_functions(analysis::SemanticAnalyser* visitor) override;
+			void register_functions(runtime::VirtualMachine* vm) override;
+
+		private:
+			RuntimeValue* build_socket(runtime::VirtualMachine* vm, std::shared_ptr<runtime::AsyncSocket> socket, const std::pair<std::string, flx_int>& address);
+			std::shared_ptr<runtime::AsyncSocket> find_socket(RuntimeValue* handle);
+		};
+
+	}
+
+}
+
+#endif // !MD_NET_HPP
@@ -0,0 +1,265 @@
+#include "md_threads.hpp"
+
+#include <sstream>
+
+#include "vm.hpp"
+#include "vm_snapshot.hpp"
+#include "semantic_analysis.hpp"
+#include "constants.hpp"
+
+using namespace core;
+using namespace core::modules;
+using namespace core::runtime;
+using namespace core::analysis;
+
+static std::string write_message(RuntimeValue* value) {
+	std::ostringstream stream;
+	VmSnapshotWriter writer(stream);
+	writer.write_value(value);
+	return stream.str();
+}
+
+static RuntimeValue* read_message_value(VirtualMachine* vm, VmSnapshotReader& reader) {
+	// the value is not rooted until it is pushed, so nothing is collected meanwhile
+	auto gc_enable = vm->gc.enable;
+	vm->gc.enable = false;
+	auto value = reader.read_value();
+	vm->gc.enable = gc_enable;
+	return value;
+}
+
+static RuntimeValue* read_message(VirtualMachine* vm, const std::string& message) {
+	std::istringstream stream(message);
+	VmSnapshotReader reader(stream, vm);
+	return read_message_value(vm, reader);
+}
+
+static RuntimeValue* build_handle(VirtualMachine* vm, const std::string& type_name, flx_int id) {
+	auto instance_id_var = std::make_shared<RuntimeVariable>(Module::INSTANCE_ID_NAME, Type::T_INT);
+	instance_id_var->set_value(vm->allocate_value(new RuntimeValue(id)));
+	vm->gc.add_var_root(instance_id_var);
+
+	flx_struct str = flx_struct();
+	str[Module::INSTANCE_ID_NAME] = instance_id_var;
+
+	return vm->allocate_value(new RuntimeValue(str, Constants::STD_NAMESPACE, type_name));
+}
+
+static flx_int get_handle_id(RuntimeValue* handle) {
+	if (handle->is_void()) {
+		throw std::runtime_error("handle is null");
+	}
+	return handle->get_str()[Module::INSTANCE_ID_NAME]->get_value()->get_i();
+}
+
+ModuleThreads::ModuleThreads() {}
+
+ModuleThreads::~ModuleThreads() {
+	// only left to a host that did not end them, the program ends them before
+	end_workers();
+}
+
+void ModuleThreads::end_workers() {
+	std::unordered_map<flx_int, std::shared_ptr<Channel>> ended_channels;
+	std::unordered_map<flx_int, std::shared_ptr<Worker>> ended_workers;
+	{
+		std::lock_guard<std::mutex> lock(registry_mutex);
+		ending = true;
+		ended_channels.swap(channels);
+		ended_workers.swap(workers);
+	}
+
+	for (auto& [id, channel] : ended_channels) {
+		{
+			std::lock_guard<std::mutex> lock(channel->mutex);
+			channel->closed = true;
+			channel->cancelled = true;
+		}
+		channel->message_ready.notify_all();
+	}
+
+	for (auto& [id, worker] : ended_workers) {
+		if (worker->thread.joinable()) {
+			worker->thread.join();
+		}
+	}
+}
+
+std::shared_ptr<ModuleThreads::Channel> ModuleThreads::find_channel(RuntimeValue* handle) {
+	std::lock_guard<std::mutex> lock(registry_mutex);
+	auto it = channels.find(get_handle_id(handle));
+	if (it == channels.end()) {
+		throw std::runtime_error("invalid channel");
+	}
+	return it->second;
+}
+
+void ModuleThreads::register_functions(SemanticAnalyser* visitor) {
+	visitor->builtin_functions["thread_start"] = nullptr;
+	visitor->builtin_functions["thread_join"] = nullptr;
+	visitor->builtin_functions["thread_count"] = nullptr;
+
+	visitor->builtin_functions["channel_create"] = nullptr;
+	visitor->builtin_functions["channel_send"] = nullptr;
+	visitor->builtin_functions["channel_receive"] = nullptr;
+	visitor->builtin_functions["channel_close"] = nullptr;
+}
+
+void ModuleThreads::register_functions(VirtualMachine* vm) {
+
+	vm->builtin_functions["thread_start"] = [this, vm]() {
+		auto scope = vm->get_back_scope(Constants::STD_NAMESPACE);
+		auto fun_val = std::dynamic_pointer_cast<RuntimeVariable>(scope->find_declared_variable("worker"))->get_value();
+		auto arg_val = std::dynamic_pointer_cast<RuntimeVariable>(scope->find_declared_variable("arg"))->get_value();
+
+		if (!fun_val->is_function()) {
+			throw std::runtime_error("thread_start expects a function");
+		}
+
+		// written together, so an argument referencing a global stays shared with it
+		std::ostringstream stream;
+		VmSnapshotWriter writer(stream);
+		vm->write_state(writer);
+		writer.write_value(arg_val);
+
+		auto worker = std::make_shared<Worker>();
+
+		// started under the lock, so end_workers either refuses the worker or joins it
+		flx_int id;
+		{
+			std::lock_guard<std::mutex> lock(registry_mutex);
+			if (ending) {
+				throw std::runtime_error("threads cannot be started once the program has ended");
+			}
+
+			worker->thread = std::thread([worker, state = stream.str(), fun = fun_val->get_fun(),
+				vm_debug = vm->get_vm_debug(), instructions = vm->get_instructions(), host_libs = vm->host_libs]() mutable {
+				try {
+					VirtualMachine worker_vm(std::make_shared<Scope>(Constants::DEFAULT_NAMESPACE, ""), std::move(vm_debug), std::move(instructions));
+					worker_vm.host_libs = host_libs;
+
+					std::istringstream state_stream(state);
+					VmSnapshotReader reader(state_stream, &worker_vm);
+					worker_vm.read_state(reader);
+					auto arg = read_message_value(&worker_vm, reader);
+
+					worker->result = write_message(worker_vm.call("", "", fun.first, fun.second, { arg }));
+				}
+				catch (const std::exception& ex) {
+					worker->error = ex.what();
+				}
+				});
+
+			id = next_id++;
+			workers[id] = worker;
+		}
+
+		vm->push_constant(build_handle(vm, "Thread", id));
+
+		};
+
+	vm->builtin_functions["thread_join"] = [this, vm]() {
+		auto scope = vm->get_back_scope(Constants::STD_NAMESPACE);
+		auto val = std::dynamic_pointer_cast<RuntimeVariable>(scope->find_declared_variable("thread"))->get_value();
+
+		std::shared_ptr<Worker> worker;
+		{
+			std::lock_guard<std::mutex> lock(registry_mutex);
+			auto it = workers.find(get_handle_id(val));
+			if (it == workers.end()) {
+				throw std::runtime_error("thread was already joined");
+			}
+			worker = it->second;
+			workers.erase(it);
+		}
+
+		worker->thread.join();
+
+		if (!worker->error.empty()) {
+			throw std::runtime_error("thread failed: " + worker->error);
+		}
+
+		vm->push_constant(read_message(vm, worker->result));
+
+		};
+
+	vm->builtin_functions["thread_count"] = [this, vm]() {
+		vm->push_new_constant(new RuntimeValue(flx_int(std::thread::hardware_concurrency())));
+
+		};
+
+	vm->builtin_functions["channel_create"] = [this, vm]() {
+		flx_int id;
+		{
+			std::lock_guard<std::mutex> lock(registry_mutex);
+			if (ending) {
+				throw std::runtime_error("channels cannot be created once the program has ended");
+			}
+			id = next_id++;
+			channels[id] = std::make_shared<Channel>();
+		}
+
+		vm->push_constant(build_handle(vm, "Channel", id));
+
+		};
+
+	vm->builtin_functions["channel_send"] = [this, vm]() {
+		auto scope = vm->get_back_scope(Constants::STD_NAMESPACE);
+		auto channel = find_channel(std::dynamic_pointer_cast<RuntimeVariable>(scope->find_declared_variable("channel"))->get_value());
+		auto val = std::dynamic_pointer_cast<RuntimeVariable>(scope->find_declared_variable("value"))->get_value();
+
+		auto message = write_message(val);
+		{
+			std::lock_guard<std::mutex> lock(channel->mutex);
+			if (channel->closed) {
+				throw std::runtime_error("channel is closed");
+			}
+			channel->messages.push_back(std::move(message));
+		}
+		channel->message_ready.notify_one();
+
+		vm->push_empty_constant(Type::T_UNDEFINED);
+
+		};
+
+	vm->builtin_functions["channel_receive"] = [this, vm]() {
+		auto scope = vm->get_back_scope(Constants::STD_NAMESPACE);
+		auto channel = find_channel(std::dynamic_pointer_cast<RuntimeVariable>(scope->find_declared_variable("channel"))->get_value());
+
+		std::string message;
+		{
+			std::unique_lock<std::mutex> lock(channel->mutex);
+			channel->message_ready.wait(lock, [&channel]() { return !channel->messages.empty() || channel->closed; });
+
+			if (channel->cancelled) {
+				throw std::runtime_error("channel was cancelled, the program has ended");
+			}
+
+			// a closed channel still delivers its pending messages, then null
+			if (channel->messages.empty()) {
+				vm->push_empty_constant(Type::T_VOID);
+				return;
+			}
+			message = std::move(channel->messages.front());
+			channel->messages.pop_front();
+		}
+
+		vm->push_constant(read_message(vm, message));
+
+		};
+
+	vm->builtin_functions["channel_close"] = [this, vm]() {
+		auto scope = vm->get_back_scope(Constants::STD_NAMESPACE);
+		auto channel = find_channel(std::dynamic_pointer_cast<RuntimeVariable>(scope->find_declared_variable("channel"))->get_value());
+
+		{
+			std::lock_guard<std::mutex> lock(channel->mutex);
+			channel->closed = true;
+		}
+		channel->message_ready.notify_all();
+
+		vm->push_empty_constant(Type::T_UNDEFINED);
+
+		};
+
+}
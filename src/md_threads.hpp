@@ -0,0 +1,70 @@
+#ifndef MD_THREADS_HPP
+#define MD_THREADS_HPP
+
+#include <string>
+#include <deque>
+#include <unordered_map>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+#include "module.hpp"
+#include "types.hpp"
+
+namespace core {
+
+	namespace modules {
+
+		/*
+			Workers run a function on their own thread and vm, started from a copy
+			of the heap of the vm that created them, so no runtime value is ever
+			shared between threads. Values sent through channels, worker arguments
+			and results are serialized by the sender and read into the receiver heap.
+		*/
+		class ModuleThreads : public Module {
+		private:
+			struct Channel {
+				std::mutex mutex;
+				std::condition_variable message_ready;
+				std::deque<std::string> messages;
+				bool closed = false;
+				// set when the program ends, a waiting receiver then fails
+				bool cancelled = false;
+			};
+
+			struct Worker {
+				std::thread thread;
+				std::string result;
+				std::string error;
+			};
+
+			std::mutex registry_mutex;
+			flx_int next_id = 1;
+			bool ending = false;
+			std::unordered_map<flx_int, std::shared_ptr<Channel>> channels;
+			std::unordered_map<flx_int, std::shared_ptr<Worker>> workers;
+
+		public:
+			ModuleThreads();
+			~ModuleThreads();
+
+			/*
+				Cancels the channel waits of the workers the program did not join and
+				waits for them, called when the program ends so no worker outlives it.
+				No worker can be started afterwards.
+			*/
+			void end_workers();
+
+			void register_functions(analysis::SemanticAnalyser* visitor) override;
+			void register_functions(runtime::VirtualMachine* vm) override;
+
+		private:
+			std::shared_ptr<Channel> find_channel(RuntimeValue* handle);
+		};
+
+	}
+
+}
+
+#endif // !MD_THREADS_HPP
@@ -2,6 +2,8 @@
 #define MODULE_HPP
 
 #include <string>
+#include <memory>
+#include <unordered_map>
 
 namespace core {
 
@@ -28,6 +30,9 @@ namespace core {
 			virtual void register_functions(runtime::VirtualMachine* vm) = 0;
 		};
 
+		// native modules an embedding host registers, keyed by lib name
+		typedef std::unordered_map<std::string, std::shared_ptr<Module>> NativeLibs;
+
 	}
 
 }
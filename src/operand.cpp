@@ -48,6 +48,7 @@ Operand::Operand(const std::vector<Operand>& value)
 	: value(Operand::to_byte_operand(value)), type(OperandType::OT_VECTOR) {
 	size = sizeof(uint64_t);
 	for (const auto& op : value) {
+		size += sizeof(uint8_t);
 		size += sizeof(uint64_t);
 		size += op.size;
 	}
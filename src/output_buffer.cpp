@@ -0,0 +1,148 @@
+#include "output_buffer.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+
+#ifdef linux
+#include <unistd.h>
+#elif defined(_WIN32)
+#include <io.h>
+#endif // linux
+
+using namespace utils;
+
+void OutputSink::write_int(int64_t value) {
+	char digits[20];
+	auto end = std::to_chars(digits, digits + sizeof(digits), value).ptr;
+	write(std::string_view(digits, end - digits));
+}
+
+void OutputSink::write_float(long double value) {
+	char digits[64];
+	std::string large;
+	char* start = digits;
+	auto count = snprintf(digits, sizeof(digits), "%Lf", value);
+	if (count < 0) {
+		return;
+	}
+	// only huge values do not fit
+	if (size_t(count) >= sizeof(digits)) {
+		large.resize(size_t(count) + 1);
+		snprintf(large.data(), large.size(), "%Lf", value);
+		start = large.data();
+	}
+
+	auto end = start + count;
+	// inf and nan have no point to keep
+	if (memchr(start, '.', count)) {
+		while (end[-1] == '0') {
+			--end;
+		}
+		// keeps one zero after the point
+		if (end[-1] == '.') {
+			++end;
+		}
+	}
+	write(std::string_view(start, end - start));
+}
+
+StringSink::StringSink(std::string& target)
+	: target(target) {}
+
+void StringSink::write(std::string_view data) {
+	target.append(data);
+}
+
+void StringSink::write(char value) {
+	target.push_back(value);
+}
+
+OutputBuffer::OutputBuffer(int fd)
+	: fd(fd), buffer(new char[CAPACITY]) {
+#ifdef linux
+	line_buffered = isatty(fd);
+#elif defined(_WIN32)
+	line_buffered = _isatty(fd);
+#endif // linux
+}
+
+OutputBuffer::~OutputBuffer() {
+	flush();
+}
+
+OutputBuffer& OutputBuffer::standard_output() {
+	static OutputBuffer output(1);
+	return output;
+}
+
+void OutputBuffer::write(std::string_view data) {
+	std::lock_guard<std::mutex> lock(mutex);
+
+	if (size + data.size() > CAPACITY) {
+		flush_unlocked();
+		// a large block is not copied through the buffer
+		if (data.size() >= CAPACITY) {
+			write_fd(data.data(), data.size());
+			return;
+		}
+	}
+	memcpy(buffer.get() + size, data.data(), data.size());
+	size += data.size();
+}
+
+void OutputBuffer::write(char value) {
+	std::lock_guard<std::mutex> lock(mutex);
+
+	if (size == CAPACITY) {
+		flush_unlocked();
+	}
+	buffer[size++] = value;
+}
+
+void OutputBuffer::end_line() {
+	std::lock_guard<std::mutex> lock(mutex);
+
+	if (size == CAPACITY) {
+		flush_unlocked();
+	}
+	buffer[size++] = '\n';
+	if (line_buffered) {
+		flush_unlocked();
+	}
+}
+
+void OutputBuffer::flush() {
+	std::lock_guard<std::mutex> lock(mutex);
+	flush_unlocked();
+}
+
+bool OutputBuffer::is_line_buffered() const {
+	return line_buffered;
+}
+
+void OutputBuffer::flush_unlocked() {
+	write_fd(buffer.get(), size);
+	size = 0;
+}
+
+void OutputBuffer::write_fd(const char* data, size_t count) {
+	while (count > 0) {
+#ifdef linux
+		auto written = ::write(fd, data, count);
+		if (written < 0 && errno == EINTR) {
+			continue;
+		}
+#elif defined(_WIN32)
+		auto written = _write(fd, data, static_cast<unsigned int>(count));
+#endif // linux
+		// a closed stream drops the output like std::cout would
+		if (written <= 0) {
+			return;
+		}
+		data += written;
+		count -= size_t(written);
+	}
+}
@@ -0,0 +1,74 @@
+#ifndef OUTPUT_BUFFER_HPP
+#define OUTPUT_BUFFER_HPP
+
+#include <string>
+#include <string_view>
+#include <memory>
+#include <mutex>
+#include <cstdint>
+
+namespace utils {
+
+	// destination of written text, the formatting helpers go through write
+	class OutputSink {
+	public:
+		virtual ~OutputSink() = default;
+
+		virtual void write(std::string_view data) = 0;
+		virtual void write(char value) = 0;
+
+		void write_int(int64_t value);
+		// fixed notation without trailing zeros, as std::to_string trimmed
+		void write_float(long double value);
+	};
+
+	// appends to a string
+	class StringSink : public OutputSink {
+	private:
+		std::string& target;
+
+	public:
+		StringSink(std::string& target);
+
+		void write(std::string_view data) override;
+		void write(char value) override;
+	};
+
+	/*
+		Buffered writer of a standard stream going straight to its file
+		descriptor. The buffer is written when full, at each line on a
+		terminal, on flush and at exit. Other writers of the same stream must
+		flush it first to keep the order.
+	*/
+	class OutputBuffer : public OutputSink {
+	private:
+		static constexpr size_t CAPACITY = 1 << 16;
+
+		int fd;
+		bool line_buffered;
+		std::unique_ptr<char[]> buffer;
+		size_t size = 0;
+		std::mutex mutex;
+
+	public:
+		OutputBuffer(int fd);
+		~OutputBuffer();
+
+		static OutputBuffer& standard_output();
+
+		void write(std::string_view data) override;
+		void write(char value) override;
+		// flushed right away on a terminal
+		void end_line();
+		void flush();
+
+		bool is_line_buffered() const;
+
+	private:
+		void flush_unlocked();
+		void write_fd(const char* data, size_t count);
+	};
+
+}
+
+#endif // !OUTPUT_BUFFER_HPP
@@ -10,7 +10,7 @@ using namespace core;
 using namespace core::parser;
 
 Parser::Parser(const std::string& name, Lexer* lexer)
-	: lexer(lexer), name(name) {
+	: lexer(lexer), node_allocator(std::make_shared<ASTArena>()), name(name) {
 	current_token = lexer->next_token();
 	next_token = lexer->next_token();
 }
@@ -31,7 +31,7 @@ std::shared_ptr<ASTModuleNode> Parser::parse_module() {
 		consume_token();
 	}
 
-	return std::make_shared<ASTModuleNode>(name, name_space, statements);
+	return make_node<ASTModuleNode>(name, name_space, statements);
 }
 
 std::shared_ptr<ASTUsingNode> Parser::parse_using_statement() {
@@ -49,7 +49,7 @@ std::shared_ptr<ASTUsingNode> Parser::parse_using_statement() {
 
 	consume_token(TK_SEMICOLON);
 
-	return std::make_shared<ASTUsingNode>(library, row, col);
+	return make_node<ASTUsingNode>(library, row, col);
 }
 
 std::shared_ptr<ASTNode> Parser::parse_module_statement() {
@@ -138,9 +138,9 @@ std::shared_ptr<ASTNamespaceManagerNode> Parser::parse_namespace_manager_stateme
 	switch (type)
 	{
 	case TK_INCLUDE:
-		return std::make_shared<ASTIncludeNamespaceNode>(name_space, row, col);
+		return make_node<ASTIncludeNamespaceNode>(name_space, row, col);
 	case TK_EXCLUDE:
-		return std::make_shared<ASTExcludeNamespaceNode>(name_space, row, col);
+		return make_node<ASTExcludeNamespaceNode>(name_space, row, col);
 	default:
 		throw std::runtime_error(build_error_message("invalid token '" + Token::token_image(type) + "'"));
 	}
@@ -167,7 +167,7 @@ std::shared_ptr<ASTReturnNode> Parser::parse_return_statement() {
 
 	check_consume_semicolon();
 
-	return std::make_shared<ASTReturnNode>(expr, row, col);
+	return make_node<ASTReturnNode>(expr, row, col);
 }
 
 std::shared_ptr<ASTExitNode> Parser::parse_exit_statement() {
@@ -183,7 +183,7 @@ std::shared_ptr<ASTExitNode> Parser::parse_exit_statement() {
 
 	check_consume_semicolon();
 
-	return std::make_shared<ASTExitNode>(expr, row, col);
+	return make_node<ASTExitNode>(expr, row, col);
 }
 
 std::shared_ptr<ASTEnumNode> Parser::parse_enum_statement() {
@@ -205,7 +205,7 @@ std::shared_ptr<ASTEnumNode> Parser::parse_enum_statement() {
 
 	consume_token(TK_RIGHT_CURLY);
 
-	return std::make_shared<ASTEnumNode>(identifiers, row, col);
+	return make_node<ASTEnumNode>(identifiers, row, col);
 }
 
 std::shared_ptr<ASTBlockNode> Parser::parse_block() {
@@ -224,7 +224,7 @@ std::shared_ptr<ASTBlockNode> Parser::parse_block() {
 	}
 
 	if (current_token.type == TK_RIGHT_CURLY) {
-		return std::make_shared<ASTBlockNode>(statements, row, col);
+		return make_node<ASTBlockNode>(statements, row, col);
 	}
 	throw std::runtime_error(build_error_message("reached end of file while parsing"));
 }
@@ -243,7 +243,7 @@ std::shared_ptr<ASTBlockNode> Parser::parse_struct_block() {
 	}
 
 	if (current_token.type == TK_RIGHT_CURLY) {
-		return std::make_shared<ASTBlockNode>(statements, row, col);
+		return make_node<ASTBlockNode>(statements, row, col);
 	}
 	throw std::runtime_error(build_error_message("mismatched scopes: reached end of file while parsing"));
 }
@@ -265,7 +265,7 @@ std::shared_ptr<ASTContinueNode> Parser::parse_continue_statement() {
 
 	check_consume_semicolon();
 
-	return std::make_shared<ASTContinueNode>(row, col);
+	return make_node<ASTContinueNode>(row, col);
 }
 
 std::shared_ptr<ASTBreakNode> Parser::parse_break_statement() {
@@ -274,7 +274,7 @@ std::shared_ptr<ASTBreakNode> Parser::parse_break_statement() {
 
 	check_consume_semicolon();
 
-	return std::make_shared<ASTBreakNode>(row, col);
+	return make_node<ASTBreakNode>(row, col);
 }
 
 std::shared_ptr<ASTSwitchNode> Parser::parse_switch_statement() {
@@ -340,7 +340,7 @@ std::shared_ptr<ASTSwitchNode> Parser::parse_switch_statement() {
 		default_block = statements.size();
 	}
 
-	return std::make_shared<ASTSwitchNode>(condition, statements, case_blocks, default_block, row, col);
+	return make_node<ASTSwitchNode>(condition, statements, case_blocks, default_block, row, col);
 }
 
 std::shared_ptr<ASTElseIfNode> Parser::parse_else_if_statement() {
@@ -356,7 +356,7 @@ std::shared_ptr<ASTElseIfNode> Parser::parse_else_if_statement() {
 	consume_token(TK_LEFT_CURLY);
 	if_block = parse_block();
 
-	return std::make_shared<ASTElseIfNode>(condition, if_block, row, col);
+	return make_node<ASTElseIfNode>(condition, if_block, row, col);
 }
 
 std::shared_ptr<ASTIfNode> Parser::parse_if_statement() {
@@ -395,7 +395,7 @@ std::shared_ptr<ASTIfNode> Parser::parse_if_statement() {
 		}
 	}
 
-	return std::make_shared<ASTIfNode>(condition, if_block, else_ifs, else_block, row, col);
+	return make_node<ASTIfNode>(condition, if_block, else_ifs, else_block, row, col);
 }
 
 std::shared_ptr<ASTTryCatchNode> Parser::parse_try_catch_statement() {
@@ -413,7 +413,7 @@ std::shared_ptr<ASTTryCatchNode> Parser::parse_try_catch_statement() {
 	consume_token(TK_LEFT_BRACKET);
 	consume_token();
 	if (current_token.type == TK_ELLIPSIS) {
-		decl = std::make_shared<ASTEllipsisNode>(row, col);
+		decl = make_node<ASTEllipsisNode>(row, col);
 	}
 	else {
 		consume_semicolon.push(false);
@@ -426,7 +426,7 @@ std::shared_ptr<ASTTryCatchNode> Parser::parse_try_catch_statement() {
 	catch_block = parse_block();
 	check_current_token(TK_RIGHT_CURLY);
 
-	return std::make_shared<ASTTryCatchNode>(decl, try_block, catch_block, row, col);
+	return make_node<ASTTryCatchNode>(decl, try_block, catch_block, row, col);
 }
 
 std::shared_ptr<ASTThrowNode> Parser::parse_throw_statement() {
@@ -438,7 +438,7 @@ std::shared_ptr<ASTThrowNode> Parser::parse_throw_statement() {
 	expr = parse_expression();
 	check_consume_semicolon();
 
-	return std::make_shared<ASTThrowNode>(expr, row, col);
+	return make_node<ASTThrowNode>(expr, row, col);
 }
 
 std::shared_ptr<ASTForNode> Parser::parse_for_statement() {
@@ -469,7 +469,7 @@ std::shared_ptr<ASTForNode> Parser::parse_for_statement() {
 
 	block = parse_block();
 
-	return std::make_shared<ASTForNode>(expressions, block, row, col);
+	return make_node<ASTForNode>(expressions, block, row, col);
 }
 
 std::shared_ptr<ASTNode> Parser::parse_foreach_collection() {
@@ -511,7 +511,7 @@ std::shared_ptr<ASTForEachNode> Parser::parse_foreach_statement() {
 	consume_token(TK_LEFT_CURLY);
 	block = parse_block();
 
-	return std::make_shared<ASTForEachNode>(itdecl, collection, block, row, col);
+	return make_node<ASTForEachNode>(itdecl, collection, block, row, col);
 }
 
 std::shared_ptr<ASTWhileNode> Parser::parse_while_statement() {
@@ -527,7 +527,7 @@ std::shared_ptr<ASTWhileNode> Parser::parse_while_statement() {
 	consume_token(TK_LEFT_CURLY);
 	block = parse_block();
 
-	return std::make_shared<ASTWhileNode>(condition, block, row, col);
+	return make_node<ASTWhileNode>(condition, block, row, col);
 }
 
 std::shared_ptr<ASTDoWhileNode> Parser::parse_do_while_statement() {
@@ -547,7 +547,7 @@ std::shared_ptr<ASTDoWhileNode> Parser::parse_do_while_statement() {
 	check_consume_semicolon();
 	consume_semicolon.pop();
 
-	return std::make_shared<ASTDoWhileNode>(condition, block, row, col);
+	return make_node<ASTDoWhileNode>(condition, block, row, col);
 }
 
 TypeDefinition Parser::parse_type_definition(Type default_type) {
@@ -607,7 +607,7 @@ std::shared_ptr<ASTLambdaFunctionNode> Parser::parse_function_expression() {
 	size_t row = current_token.row;
 	size_t col = current_token.col;
 	consume_token();
-	return std::make_shared<ASTLambdaFunctionNode>(
+	return make_node<ASTLambdaFunctionNode>(
 		parse_function_definition("lambda@" + utils::FlexaUUID::generate()), row, col
 	);
 }
@@ -672,7 +672,7 @@ std::shared_ptr<ASTFunctionDefinitionNode> Parser::parse_function_definition(con
 		}
 	}
 
-	return std::make_shared<ASTFunctionDefinitionNode>(identifier, parameters, type_def.type,
+	return make_node<ASTFunctionDefinitionNode>(identifier, parameters, type_def.type,
 		type_def.type_name_space, type_def.type_name, type_def.expr_dim, block, row, col);
 }
 
@@ -695,7 +695,7 @@ std::shared_ptr<ASTStructDefinitionNode> Parser::parse_struct_definition() {
 
 	consume_token(TK_RIGHT_CURLY);
 
-	return std::make_shared<ASTStructDefinitionNode>(identifier, variables, row, col);
+	return make_node<ASTStructDefinitionNode>(identifier, variables, row, col);
 }
 
 std::shared_ptr<VariableDefinition> Parser::parse_struct_var_def() {
@@ -734,7 +734,7 @@ std::shared_ptr<ASTExprNode> Parser::parse_assignment_expression() {
 		std::string current_token_value = current_token.value;
 		consume_token();
 		auto rhs = parse_ternary_expression();
-		lhs = std::make_shared<ASTBinaryExprNode>(current_token_value, lhs, rhs, row, col);
+		lhs = make_node<ASTBinaryExprNode>(current_token_value, lhs, rhs, row, col);
 	}
 
 	return lhs;
@@ -754,7 +754,7 @@ std::shared_ptr<ASTExprNode> Parser::parse_ternary_expression() {
 		consume_token(TK_COLON);
 		consume_token();
 		value_if_false = parse_ternary_expression();
-		return std::make_shared<ASTTernaryNode>(expr, value_if_true, value_if_false, row, col);
+		return make_node<ASTTernaryNode>(expr, value_if_true, value_if_false, row, col);
 	}
 
 	return expr;
@@ -770,7 +770,7 @@ std::shared_ptr<ASTExprNode> Parser::parse_in_expression() {
 		std::string current_token_value = current_token.value;
 		consume_token();
 		auto rhs = parse_logical_or_expression();
-		return std::make_shared<ASTBinaryExprNode>(current_token_value, lhs, rhs, row, col);
+		return make_node<ASTBinaryExprNode>(current_token_value, lhs, rhs, row, col);
 	}
 
 	return lhs;
@@ -786,7 +786,7 @@ std::shared_ptr<ASTExprNode> Parser::parse_logical_or_expression() {
 		std::string current_token_value = current_token.value;
 		consume_token();
 		auto rhs = parse_logical_and_expression();
-		lhs = std::make_shared<ASTBinaryExprNode>(current_token_value, lhs, rhs, row, col);
+		lhs = make_node<ASTBinaryExprNode>(current_token_value, lhs, rhs, row, col);
 	}
 
 	return lhs;
@@ -802,7 +802,7 @@ std::shared_ptr<ASTExprNode> Parser::parse_logical_and_expression() {
 		std::string current_token_value = current_token.value;
 		consume_token();
 		auto rhs = parse_bitwise_or_expression();
-		lhs = std::make_shared<ASTBinaryExprNode>(current_token_value, lhs, rhs, row, col);
+		lhs = make_node<ASTBinaryExprNode>(current_token_value, lhs, rhs, row, col);
 	}
 
 	return lhs;
@@ -818,7 +818,7 @@ std::shared_ptr<ASTExprNode> Parser::parse_bitwise_or_expression() {
 		std::string current_token_value = current_token.value;
 		consume_token();
 		auto rhs = parse_bitwise_xor_expression();
-		lhs = std::make_shared<ASTBinaryExprNode>(current_token_value, lhs, rhs, row, col);
+		lhs = make_node<ASTBinaryExprNode>(current_token_value, lhs, rhs, row, col);
 	}
 
 	return lhs;
@@ -834,7 +834,7 @@ std::shared_ptr<ASTExprNode> Parser::parse_bitwise_xor_expression() {
 		std::string current_token_value = current_token.value;
 		consume_token();
 		auto rhs = parse_bitwise_and_expression();
-		lhs = std::make_shared<ASTBinaryExprNode>(current_token_value, lhs, rhs, row, col);
+		lhs = make_node<ASTBinaryExprNode>(current_token_value, lhs, rhs, row, col);
 	}
 
 	return lhs;
@@ -850,7 +850,7 @@ std::shared_ptr<ASTExprNode> Parser::parse_bitwise_and_expression() {
 		std::string current_token_value = current_token.value;
 		consume_token();
 		auto rhs = parse_equality_expression();
-		lhs = std::make_shared<ASTBinaryExprNode>(current_token_value, lhs, rhs, row, col);
+		lhs = make_node<ASTBinaryExprNode>(current_token_value, lhs, rhs, row, col);
 	}
 
 	return lhs;
@@ -866,7 +866,7 @@ std::shared_ptr<ASTExprNode> Parser::parse_equality_expression() {
 		std::string current_token_value = current_token.value;
 		consume_token();
 		auto rhs = parse_relational_expression();
-		lhs = std::make_shared<ASTBinaryExprNode>(current_token_value, lhs, rhs, row, col);
+		lhs = make_node<ASTBinaryExprNode>(current_token_value, lhs, rhs, row, col);
 	}
 
 	return lhs;
@@ -882,7 +882,7 @@ std::shared_ptr<ASTExprNode> Parser::parse_relational_expression() {
 		std::string current_token_value = current_token.value;
 		consume_token();
 		auto rhs = parse_spaceship_expression();
-		lhs = std::make_shared<ASTBinaryExprNode>(current_token_value, lhs, rhs, row, col);
+		lhs = make_node<ASTBinaryExprNode>(current_token_value, lhs, rhs, row, col);
 	}
 
 	return lhs;
@@ -898,7 +898,7 @@ std::shared_ptr<ASTExprNode> Parser::parse_spaceship_expression() {
 		std::string current_token_value = current_token.value;
 		consume_token();
 		auto rhs = parse_bitwise_shift_expression();
-		lhs = std::make_shared<ASTBinaryExprNode>(current_token_value, lhs, rhs, row, col);
+		lhs = make_node<ASTBinaryExprNode>(current_token_value, lhs, rhs, row, col);
 	}
 
 	return lhs;
@@ -914,7 +914,7 @@ std::shared_ptr<ASTExprNode> Parser::parse_bitwise_shift_expression() {
 		std::string current_token_value = current_token.value;
 		consume_token();
 		auto rhs = parse_additive_expression();
-		lhs = std::make_shared<ASTBinaryExprNode>(current_token_value, lhs, rhs, row, col);
+		lhs = make_node<ASTBinaryExprNode>(current_token_value, lhs, rhs, row, col);
 	}
 
 	return lhs;
@@ -930,7 +930,7 @@ std::shared_ptr<ASTExprNode> Parser::parse_additive_expression() {
 		std::string current_token_value = current_token.value;
 		consume_token();
 		auto rhs = parse_multiplicative_expression();
-		lhs = std::make_shared<ASTBinaryExprNode>(current_token_value, lhs, rhs, row, col);
+		lhs = make_node<ASTBinaryExprNode>(current_token_value, lhs, rhs, row, col);
 	}
 
 	return lhs;
@@ -946,7 +946,7 @@ std::shared_ptr<ASTExprNode> Parser::parse_multiplicative_expression() {
 		std::string current_token_value = current_token.value;
 		consume_token();
 		auto rhs = parse_exponentiation();
-		lhs = std::make_shared<ASTBinaryExprNode>(current_token_value, lhs, rhs, row, col);
+		lhs = make_node<ASTBinaryExprNode>(current_token_value, lhs, rhs, row, col);
 	}
 
 	return lhs;
@@ -962,7 +962,7 @@ std::shared_ptr<ASTExprNode> Parser::parse_exponentiation() {
 		std::string current_token_value = current_token.value;
 		consume_token();
 		auto rhs = parse_primary_expression();
-		lhs = std::make_shared<ASTBinaryExprNode>(current_token_value, lhs, rhs, row, col);
+		lhs = make_node<ASTBinaryExprNode>(current_token_value, lhs, rhs, row, col);
 	}
 
 	return lhs;
@@ -976,15 +976,15 @@ std::shared_ptr<ASTExprNode> Parser::parse_primary_expression() {
 
 		// literal cases
 	case TK_BOOL_LITERAL:
-		return std::make_shared<ASTLiteralNode<flx_bool>>(parse_bool_literal(), row, col);
+		return make_node<ASTLiteralNode<flx_bool>>(parse_bool_literal(), row, col);
 	case TK_INT_LITERAL:
-		return std::make_shared<ASTLiteralNode<flx_int>>(parse_int_literal(), row, col);
+		return make_node<ASTLiteralNode<flx_int>>(parse_int_literal(), row, col);
 	case TK_FLOAT_LITERAL:
-		return std::make_shared<ASTLiteralNode<flx_float>>(parse_float_literal(), row, col);
+		return make_node<ASTLiteralNode<flx_float>>(parse_float_literal(), row, col);
 	case TK_CHAR_LITERAL:
-		return std::make_shared<ASTLiteralNode<flx_char>>(parse_char_literal(), row, col);
+		return make_node<ASTLiteralNode<flx_char>>(parse_char_literal(), row, col);
 	case TK_STRING_LITERAL:
-		return std::make_shared<ASTLiteralNode<flx_string>>(parse_string_literal(), row, col);
+		return make_node<ASTLiteralNode<flx_string>>(parse_string_literal(), row, col);
 
 	case TK_LEFT_CURLY:
 		return parse_array_constructor_node();
@@ -998,7 +998,7 @@ std::shared_ptr<ASTExprNode> Parser::parse_primary_expression() {
 		return parse_type_parse_node();
 
 	case TK_NULL:
-		return std::make_shared<ASTNullNode>(row, col);
+		return make_node<ASTNullNode>(row, col);
 
 	case TK_THIS:
 		return parse_this_node();
@@ -1031,7 +1031,7 @@ std::shared_ptr<ASTExprNode> Parser::parse_primary_expression() {
 	case TK_NOT: {
 		std::string current_token_value = current_token.value;
 		consume_token();
-		return std::make_shared<ASTUnaryExprNode>(current_token_value, parse_exponentiation(), row, col);
+		return make_node<ASTUnaryExprNode>(current_token_value, parse_exponentiation(), row, col);
 	}
 
 	default:
@@ -1052,7 +1052,7 @@ std::shared_ptr<ASTExprNode> Parser::parse_identifier_expression() {
 	case TK_INCREMENT_OP: {
 		consume_token();
 		std::string op = current_token.value;
-		return std::make_shared<ASTUnaryExprNode>(op, identifier, identifier->row, identifier->col);
+		return make_node<ASTUnaryExprNode>(op, identifier, identifier->row, identifier->col);
 	}
 	default:
 		return identifier;
@@ -1100,7 +1100,7 @@ std::shared_ptr<ASTFunctionCallNode> Parser::parse_function_call_tail() {
 		expression_call = parse_function_call_tail();
 	}
 
-	return std::make_shared<ASTFunctionCallNode>(
+	return make_node<ASTFunctionCallNode>(
 		name_space, identifier_vector, parameters, expression_identifier_vector, expression_call, row, col
 	);
 }
@@ -1121,7 +1121,7 @@ std::shared_ptr<ASTUnaryExprNode> Parser::parse_increment_expression(std::shared
 
 	check_consume_semicolon();
 
-	return std::make_shared<ASTUnaryExprNode>(op, identifier, identifier->row, identifier->col);
+	return make_node<ASTUnaryExprNode>(op, identifier, identifier->row, identifier->col);
 }
 
 std::shared_ptr<ASTIdentifierNode> Parser::parse_identifier_node() {
@@ -1138,7 +1138,7 @@ std::shared_ptr<ASTIdentifierNode> Parser::parse_identifier_node() {
 
 	identifier_vector = parse_identifier_vector();
 
-	return std::make_shared<ASTIdentifierNode>(identifier_vector, name_space, row, col);
+	return make_node<ASTIdentifierNode>(identifier_vector, name_space, row, col);
 }
 
 std::vector<std::shared_ptr<ASTExprNode>> Parser::parse_dimension_vector() {
@@ -1207,7 +1207,7 @@ std::shared_ptr<ASTExprNode> Parser::parse_function_expression_assignment_tail()
 
 	consume_token();
 	if (current_token.type == TK_INCREMENT_OP) {
-		expr = std::make_shared<ASTLiteralNode<flx_int>>(1, current_token.row, current_token.col);
+		expr = make_node<ASTLiteralNode<flx_int>>(1, current_token.row, current_token.col);
 
 	}
 	else {
@@ -1246,7 +1246,7 @@ std::shared_ptr<ASTDeclarationNode> Parser::parse_declaration_statement() {
 
 	check_consume_semicolon();
 
-	return std::make_shared<ASTDeclarationNode>(identifier, type_def.type, type_def.expr_dim,
+	return make_node<ASTDeclarationNode>(identifier, type_def.type, type_def.expr_dim,
 		type_def.type_name_space, type_def.type_name, expr, is_const, is_constexpr, row, col);
 }
 
@@ -1260,7 +1260,7 @@ std::shared_ptr<ASTDeclarationNode> Parser::parse_param_declaration_statement()
 
 	type_def = parse_type_definition();
 
-	return std::make_shared<ASTDeclarationNode>(identifier, type_def.type, type_def.expr_dim,
+	return make_node<ASTDeclarationNode>(identifier, type_def.type, type_def.expr_dim,
 		type_def.type_name_space, type_def.type_name, nullptr, false, false, row, col);
 }
 
@@ -1302,7 +1302,7 @@ std::shared_ptr<ASTStatementNode> Parser::parse_unpacked_declaration_statement()
 
 		check_consume_semicolon();
 
-		return std::make_shared<ASTUnpackedDeclarationNode>(type_def.type, type_def.expr_dim,
+		return make_node<ASTUnpackedDeclarationNode>(type_def.type, type_def.expr_dim,
 			type_def.type_name_space, type_def.type_name, declarations, expr, row, col);
 	}
 	else {
@@ -1337,7 +1337,7 @@ std::shared_ptr<ASTStatementNode> Parser::parse_param_statement() {
 
 		check_consume_semicolon();
 
-		return std::make_shared<ASTUnpackedDeclarationNode>(type_def.type, type_def.expr_dim,
+		return make_node<ASTUnpackedDeclarationNode>(type_def.type, type_def.expr_dim,
 			type_def.type_name_space, type_def.type_name, declarations, nullptr, row, col);
 	}
 	else {
@@ -1365,7 +1365,7 @@ std::shared_ptr<VariableDefinition> Parser::parse_formal_param() {
 	auto type_def = parse_type_definition();
 
 	if (is_rest) {
-		auto ndim = std::make_shared<ASTLiteralNode<flx_int>>(0, row, col);
+		auto ndim = make_node<ASTLiteralNode<flx_int>>(0, row, col);
 		type_def.expr_dim.insert(type_def.expr_dim.begin(), ndim);
 	}
 
@@ -1424,7 +1424,7 @@ std::shared_ptr<ASTTypeNode> Parser::parse_type_node() {
 	auto type = parse_type();
 	auto dim = parse_dimension_vector();
 
-	return std::make_shared<ASTTypeNode>(TypeDefinition(type, dim), row, col);
+	return make_node<ASTTypeNode>(TypeDefinition(type, dim), row, col);
 }
 
 std::shared_ptr<ASTCallOperatorNode> Parser::parse_call_operator_node() {
@@ -1456,17 +1456,17 @@ std::shared_ptr<ASTCallOperatorNode> Parser::parse_call_operator_node() {
 	switch (type)
 	{
 	case TK_TYPEOF:
-		return std::make_shared<ASTTypeOfNode>(expr, row, col);
+		return make_node<ASTTypeOfNode>(expr, row, col);
 	case TK_TYPEID:
-		return std::make_shared<ASTTypeIdNode>(expr, row, col);
+		return make_node<ASTTypeIdNode>(expr, row, col);
 	case TK_REFID:
-		return std::make_shared<ASTRefIdNode>(expr, row, col);
+		return make_node<ASTRefIdNode>(expr, row, col);
 	case TK_IS_STRUCT:
-		return std::make_shared<ASTIsStructNode>(expr, row, col);
+		return make_node<ASTIsStructNode>(expr, row, col);
 	case TK_IS_ARRAY:
-		return std::make_shared<ASTIsArrayNode>(expr, row, col);
+		return make_node<ASTIsArrayNode>(expr, row, col);
 	case TK_IS_ANY:
-		return std::make_shared<ASTIsAnyNode>(expr, row, col);
+		return make_node<ASTIsAnyNode>(expr, row, col);
 	default:
 		throw std::runtime_error(build_error_message("invalid token '" + Token::token_image(type) + "'"));
 	}
@@ -1492,7 +1492,7 @@ std::shared_ptr<ASTArrayConstructorNode> Parser::parse_array_constructor_node()
 		consume_token(TK_RIGHT_CURLY);
 	}
 
-	return std::make_shared<ASTArrayConstructorNode>(values, row, col);
+	return make_node<ASTArrayConstructorNode>(values, row, col);
 }
 
 std::shared_ptr<ASTStructConstructorNode> Parser::parse_struct_constructor_node(std::shared_ptr<ASTIdentifierNode> idnode) {
@@ -1522,7 +1522,7 @@ std::shared_ptr<ASTStructConstructorNode> Parser::parse_struct_constructor_node(
 
 	check_current_token(TK_RIGHT_CURLY);
 
-	return std::make_shared<ASTStructConstructorNode>(name_space, type_name, values, row, col);
+	return make_node<ASTStructConstructorNode>(name_space, type_name, values, row, col);
 }
 
 flx_bool Parser::parse_bool_literal() {
@@ -1655,14 +1655,14 @@ std::shared_ptr<ASTTypeCastNode> Parser::parse_type_parse_node() {
 
 	consume_token(TK_RIGHT_BRACKET);
 
-	return std::make_shared<ASTTypeCastNode>(type, expr, row, col);
+	return make_node<ASTTypeCastNode>(type, expr, row, col);
 }
 
 std::shared_ptr<ASTThisNode> Parser::parse_this_node() {
 	size_t row = current_token.row;
 	size_t col = current_token.col;
 
-	return std::make_shared<ASTThisNode>(parse_identifier_vector(), row, col);
+	return make_node<ASTThisNode>(parse_identifier_vector(), row, col);
 }
 
 std::shared_ptr<ASTClassDefinitionNode> Parser::parse_class_definition() {
@@ -1684,7 +1684,7 @@ std::shared_ptr<ASTClassDefinitionNode> Parser::parse_class_definition() {
 			auto decl = parse_declaration_statement();
 			consume_semicolon.pop();
 			if (!decl->expr) {
-				decl->expr = std::make_shared<ASTNullNode>(decl->row, decl->col);
+				decl->expr = make_node<ASTNullNode>(decl->row, decl->col);
 			}
 			declarations.push_back(decl);
 		}
@@ -1724,16 +1724,16 @@ std::shared_ptr<ASTClassDefinitionNode> Parser::parse_class_definition() {
 
 	// default constructor
 	if (!has_constructor) {
-		auto default_constr = std::make_shared<ASTFunctionDefinitionNode>(
+		auto default_constr = make_node<ASTFunctionDefinitionNode>(
 			"init", std::vector<std::shared_ptr<TypeDefinition>>(),
 			Type::T_VOID, "", "", std::vector<std::shared_ptr<ASTExprNode>>(),
-			std::make_shared<ASTBlockNode>(std::vector<std::shared_ptr<ASTNode>>(), row, col),
+			make_node<ASTBlockNode>(std::vector<std::shared_ptr<ASTNode>>(), row, col),
 			row, col);
 		default_constr->is_class_function = true;
 		functions.insert(functions.begin(), default_constr);
 	}
 
-	return std::make_shared<ASTClassDefinitionNode>(identifier, declarations, functions, row, col);
+	return make_node<ASTClassDefinitionNode>(identifier, declarations, functions, row, col);
 }
 
 bool Parser::check_check_consume_semicolon() {
@@ -7,6 +7,7 @@
 #include <memory>
 
 #include "ast.hpp"
+#include "ast_arena.hpp"
 #include "lexer.hpp"
 #include "debuginfo.hpp"
 
@@ -21,6 +22,13 @@ namespace core {
 			Token next_token;
 			Type current_array_type = Type::T_UNDEFINED;
 			std::stack<bool> consume_semicolon;
+			// nodes of the module are allocated contiguously
+			ASTArenaAllocator<ASTNode> node_allocator;
+
+			template <typename T, typename... Args>
+			std::shared_ptr<T> make_node(Args&&... args) {
+				return std::allocate_shared<T>(node_allocator, std::forward<Args>(args)...);
+			}
 
 		public:
 			std::string name;
@@ -25,7 +25,7 @@ void SemanticAnalyser::start() {
 	current_module_stack.top()->accept(this);
 }
 
-void SemanticAnalyser::visit(std::shared_ptr<ASTModuleNode> astnode) {
+void SemanticAnalyser::visit(const std::shared_ptr<ASTModuleNode>& astnode) {
 	module_level++;
 	for (const auto& statement : astnode->statements) {
 		try {
@@ -59,11 +59,11 @@ void SemanticAnalyser::visit(std::shared_ptr<ASTModuleNode> astnode) {
 	}
 }
 
-void SemanticAnalyser::visit(std::shared_ptr<ASTUsingNode> astnode) {
+void SemanticAnalyser::visit(const std::shared_ptr<ASTUsingNode>& astnode) {
 	std::string libname = utils::StringUtils::join(astnode->library, ".");
 
-	if (Constants::CORE_LIBS.find(libname) != Constants::CORE_LIBS.end()) {
-		Constants::CORE_LIBS.find(libname)->second->register_functions(this);
+	if (auto native_lib = Constants::find_native_lib(libname, host_libs.get())) {
+		native_lib->register_functions(this);
 	}
 
 	if (modules.find(libname) == modules.end()) {
@@ -89,7 +89,7 @@ void SemanticAnalyser::visit(std::shared_ptr<ASTUsingNode> astnode) {
 	}
 }
 
-void SemanticAnalyser::visit(std::shared_ptr<ASTIncludeNamespaceNode> astnode) {
+void SemanticAnalyser::visit(const std::shared_ptr<ASTIncludeNamespaceNode>& astnode) {
 	const auto& prg_name = current_module_stack.top()->name;
 
 	validate_namespace(astnode->name_space);
@@ -102,7 +102,7 @@ void SemanticAnalyser::visit(std::shared_ptr<ASTIncludeNamespaceNode> astnode) {
 	}
 }
 
-void SemanticAnalyser::visit(std::shared_ptr<ASTExcludeNamespaceNode> astnode) {
+void SemanticAnalyser::visit(const std::shared_ptr<ASTExcludeNamespaceNode>& astnode) {
 	const auto& module_name = current_module_stack.top()->name;
 
 	validate_namespace(astnode->name_space);
@@ -113,7 +113,7 @@ void SemanticAnalyser::visit(std::shared_ptr<ASTExcludeNamespaceNode> astnode) {
 	module_included_name_spaces[module_name].erase(module_included_name_spaces[module_name].begin() + pos);
 }
 
-void SemanticAnalyser::visit(std::shared_ptr<ASTEnumNode> astnode) {
+void SemanticAnalyser::visit(const std::shared_ptr<ASTEnumNode>& astnode) {
 	const auto& module_name_space = current_module_stack.top()->name_space;
 
 	for (size_t i = 0; i < astnode->identifiers.size(); ++i) {
@@ -124,7 +124,7 @@ void SemanticAnalyser::visit(std::shared_ptr<ASTEnumNode> astnode) {
 	}
 }
 
-void SemanticAnalyser::visit(std::shared_ptr<ASTDeclarationNode> astnode) {
+void SemanticAnalyser::visit(const std::shared_ptr<ASTDeclarationNode>& astnode) {
 	const auto& current_module = current_module_stack.top();
 	
 	auto astnode_dim = evaluate_dimension_vector(astnode->expr_dim);
@@ -187,7 +187,7 @@ void SemanticAnalyser::visit(std::shared_ptr<ASTDeclarationNode> astnode) {
 	current_scope->declare_variable(astnode->identifier, new_var);
 }
 
-void SemanticAnalyser::visit(std::shared_ptr<ASTUnpackedDeclarationNode> astnode) {
+void SemanticAnalyser::visit(const std::shared_ptr<ASTUnpackedDeclarationNode>& astnode) {
 	std::shared_ptr<ASTIdentifierNode> var = nullptr;
 	determine_object_type(astnode);
 
@@ -217,7 +217,7 @@ void SemanticAnalyser::visit(std::shared_ptr<ASTUnpackedDeclarationNode> astnode
 	}
 }
 
-void SemanticAnalyser::visit(std::shared_ptr<ASTReturnNode> astnode) {
+void SemanticAnalyser::visit(const std::shared_ptr<ASTReturnNode>& astnode) {
 	auto return_expr = SemanticValue();
 
 	if (astnode->expr) {
@@ -239,7 +239,7 @@ void SemanticAnalyser::visit(std::shared_ptr<ASTReturnNode> astnode) {
 	}
 }
 
-void SemanticAnalyser::visit(std::shared_ptr<ASTFunctionCallNode> astnode) {
+void SemanticAnalyser::visit(const std::shared_ptr<ASTFunctionCallNode>& astnode) {
 	const auto& current_module = current_module_stack.top();
 	const auto& normalized_name_space = normalize_name_space(astnode->access_name_space, current_module->name_space);
 	bool strict = true;
@@ -350,7 +350,7 @@ void SemanticAnalyser::visit(std::shared_ptr<ASTFunctionCallNode> astnode) {
 
 }
 
-void SemanticAnalyser::visit(std::shared_ptr<ASTFunctionDefinitionNode> astnode) {
+void SemanticAnalyser::visit(const std::shared_ptr<ASTFunctionDefinitionNode>& astnode) {
 	const auto& current_module = current_module_stack.top();
 	std::shared_ptr<FunctionDefinition> decl_function = nullptr;
 	determine_object_type(astnode);
@@ -421,7 +421,8 @@ void SemanticAnalyser::visit(std::shared_ptr<ASTFunctionDefinitionNode> astnode)
 						Constants::CORE_LIB_NAMES.begin(),
 						Constants::CORE_LIB_NAMES.end(),
 						current_module->name
-					) != Constants::CORE_LIB_NAMES.end())) {
+					) != Constants::CORE_LIB_NAMES.end())
+				&& !(host_libs && host_libs->find(current_module->name) != host_libs->end())) {
 				declared_functions.push_back(std::make_tuple(decl_function, astnode->row, astnode->col));
 			}
 		}
@@ -429,7 +430,7 @@ void SemanticAnalyser::visit(std::shared_ptr<ASTFunctionDefinitionNode> astnode)
 
 }
 
-void SemanticAnalyser::visit(std::shared_ptr<ASTLambdaFunctionNode> astnode) {
+void SemanticAnalyser::visit(const std::shared_ptr<ASTLambdaFunctionNode>& astnode) {
 	auto fun = std::dynamic_pointer_cast<ASTFunctionDefinitionNode>(astnode->fun);
 
 	auto tempfun = std::make_shared<FunctionDefinition>(fun->identifier,
@@ -443,7 +444,7 @@ void SemanticAnalyser::visit(std::shared_ptr<ASTLambdaFunctionNode> astnode) {
 	current_expression = SemanticValue(TypeDefinition(Type::T_FUNCTION, evaluate_dimension_vector(fun->expr_dim), fun->type_name_space, fun->type_name));
 }
 
-void SemanticAnalyser::visit(std::shared_ptr<ASTBlockNode> astnode) {
+void SemanticAnalyser::visit(const std::shared_ptr<ASTBlockNode>& astnode) {
 	const auto& current_module = current_module_stack.top();
 
 	push_scope(std::make_shared<Scope>(current_module->name_space, current_module->name));
@@ -470,7 +471,7 @@ void SemanticAnalyser::visit(std::shared_ptr<ASTBlockNode> astnode) {
 	pop_scope(current_module->name_space, current_module->name);
 }
 
-void SemanticAnalyser::visit(std::shared_ptr<ASTExitNode> astnode) {
+void SemanticAnalyser::visit(const std::shared_ptr<ASTExitNode>& astnode) {
 	astnode->exit_code->accept(this);
 
 	if (current_expression.is_undefined()) {
@@ -482,19 +483,19 @@ void SemanticAnalyser::visit(std::shared_ptr<ASTExitNode> astnode) {
 	}
 }
 
-void SemanticAnalyser::visit(std::shared_ptr<ASTContinueNode>) {
+void SemanticAnalyser::visit(const std::shared_ptr<ASTContinueNode>&) {
 	if (!is_loop) {
 		throw std::runtime_error("continue must be inside a loop");
 	}
 }
 
-void SemanticAnalyser::visit(std::shared_ptr<ASTBreakNode>) {
+void SemanticAnalyser::visit(const std::shared_ptr<ASTBreakNode>&) {
 	if (!is_loop && !is_switch) {
 		throw std::runtime_error("break must be inside a loop or switch");
 	}
 }
 
-void SemanticAnalyser::visit(std::shared_ptr<ASTSwitchNode> astnode) {
+void SemanticAnalyser::visit(const std::shared_ptr<ASTSwitchNode>& astnode) {
 	const auto& current_module = current_module_stack.top();
 
 	is_switch = true;
@@ -555,7 +556,7 @@ void SemanticAnalyser::visit(std::shared_ptr<ASTSwitchNode> astnode) {
 	is_switch = false;
 }
 
-void SemanticAnalyser::visit(std::shared_ptr<ASTElseIfNode> astnode) {
+void SemanticAnalyser::visit(const std::shared_ptr<ASTElseIfNode>& astnode) {
 	astnode->condition->accept(this);
 
 	if (current_expression.is_undefined()) {
@@ -569,7 +570,7 @@ void SemanticAnalyser::visit(std::shared_ptr<ASTElseIfNode> astnode) {
 	astnode->block->accept(this);
 }
 
-void SemanticAnalyser::visit(std::shared_ptr<ASTIfNode> astnode) {
+void SemanticAnalyser::visit(const std::shared_ptr<ASTIfNode>& astnode) {
 	astnode->condition->accept(this);
 
 	if (current_expression.is_undefined()) {
@@ -591,7 +592,7 @@ void SemanticAnalyser::visit(std::shared_ptr<ASTIfNode> astnode) {
 	}
 }
 
-void SemanticAnalyser::visit(std::shared_ptr<ASTForNode> astnode) {
+void SemanticAnalyser::visit(const std::shared_ptr<ASTForNode>& astnode) {
 	const auto& current_module = current_module_stack.top();
 
 	is_loop = true;
@@ -621,7 +622,7 @@ void SemanticAnalyser::visit(std::shared_ptr<ASTForNode> astnode) {
 	is_loop = false;
 }
 
-void SemanticAnalyser::visit(std::shared_ptr<ASTForEachNode> astnode) {
+void SemanticAnalyser::visit(const std::shared_ptr<ASTForEachNode>& astnode) {
 	const auto& current_module = current_module_stack.top();
 
 	is_loop = true;
@@ -739,7 +740,7 @@ void SemanticAnalyser::visit(std::shared_ptr<ASTForEachNode> astnode) {
 	is_loop = false;
 }
 
-void SemanticAnalyser::visit(std::shared_ptr<ASTTryCatchNode> astnode) {
+void SemanticAnalyser::visit(const std::shared_ptr<ASTTryCatchNode>& astnode) {
 	const auto& current_module = current_module_stack.top();
 
 	astnode->try_block->accept(this);
@@ -784,7 +785,7 @@ void SemanticAnalyser::visit(std::shared_ptr<ASTTryCatchNode> astnode) {
 	pop_scope(current_module->name_space, current_module->name);
 }
 
-void SemanticAnalyser::visit(std::shared_ptr<ASTThrowNode> astnode) {
+void SemanticAnalyser::visit(const std::shared_ptr<ASTThrowNode>& astnode) {
 	astnode->error->accept(this);
 
 	if (!((current_expression.is_struct()
@@ -800,9 +801,9 @@ void SemanticAnalyser::visit(std::shared_ptr<ASTThrowNode> astnode) {
 	}
 }
 
-void SemanticAnalyser::visit(std::shared_ptr<ASTEllipsisNode>) {}
+void SemanticAnalyser::visit(const std::shared_ptr<ASTEllipsisNode>&) {}
 
-void SemanticAnalyser::visit(std::shared_ptr<ASTWhileNode> astnode) {
+void SemanticAnalyser::visit(const std::shared_ptr<ASTWhileNode>& astnode) {
 	is_loop = true;
 	astnode->condition->accept(this);
 
@@ -818,7 +819,7 @@ void SemanticAnalyser::visit(std::shared_ptr<ASTWhileNode> astnode) {
 	is_loop = false;
 }
 
-void SemanticAnalyser::visit(std::shared_ptr<ASTDoWhileNode> astnode) {
+void SemanticAnalyser::visit(const std::shared_ptr<ASTDoWhileNode>& astnode) {
 	is_loop = true;
 	astnode->condition->accept(this);
 
@@ -834,7 +835,7 @@ void SemanticAnalyser::visit(std::shared_ptr<ASTDoWhileNode> astnode) {
 	is_loop = false;
 }
 
-void SemanticAnalyser::visit(std::shared_ptr<ASTStructDefinitionNode> astnode) {
+void SemanticAnalyser::visit(const std::shared_ptr<ASTStructDefinitionNode>& astnode) {
 	const auto& current_module = current_module_stack.top();
 
 	std::shared_ptr<Scope> current_scope = get_back_scope(current_module->name_space);
@@ -856,46 +857,46 @@ void SemanticAnalyser::visit(std::shared_ptr<ASTStructDefinitionNode> astnode) {
 	}
 }
 
-void SemanticAnalyser::visit(std::shared_ptr<ASTValueNode> astnode) {
+void SemanticAnalyser::visit(const std::shared_ptr<ASTValueNode>& astnode) {
 	current_expression = *dynamic_cast<SemanticValue*>(astnode->value);
 }
 
-void SemanticAnalyser::visit(std::shared_ptr<ASTLiteralNode<flx_bool>> astnode) {
+void SemanticAnalyser::visit(const std::shared_ptr<ASTLiteralNode<flx_bool>>& astnode) {
 	current_expression = SemanticValue();
 	current_expression.type = Type::T_BOOL;
 	current_expression.is_constexpr = true;
 	current_expression.set_b(astnode->value);
 }
 
-void SemanticAnalyser::visit(std::shared_ptr<ASTLiteralNode<flx_int>> astnode) {
+void SemanticAnalyser::visit(const std::shared_ptr<ASTLiteralNode<flx_int>>& astnode) {
 	current_expression = SemanticValue();
 	current_expression.type = Type::T_INT;
 	current_expression.is_constexpr = true;
 	current_expression.set_i(astnode->value);
 }
 
-void SemanticAnalyser::visit(std::shared_ptr<ASTLiteralNode<flx_float>> astnode) {
+void SemanticAnalyser::visit(const std::shared_ptr<ASTLiteralNode<flx_float>>& astnode) {
 	current_expression = SemanticValue();
 	current_expression.type = Type::T_FLOAT;
 	current_expression.is_constexpr = true;
 	current_expression.set_f(astnode->value);
 }
 
-void SemanticAnalyser::visit(std::shared_ptr<ASTLiteralNode<flx_char>> astnode) {
+void SemanticAnalyser::visit(const std::shared_ptr<ASTLiteralNode<flx_char>>& astnode) {
 	current_expression = SemanticValue();
 	current_expression.type = Type::T_CHAR;
 	current_expression.is_constexpr = true;
 	current_expression.set_c(astnode->value);
 }
 
-void SemanticAnalyser::visit(std::shared_ptr<ASTLiteralNode<flx_string>> astnode) {
+void SemanticAnalyser::visit(const std::shared_ptr<ASTLiteralNode<flx_string>>& astnode) {
 	current_expression = SemanticValue();
 	current_expression.type = Type::T_STRING;
 	current_expression.is_constexpr = true;
 	current_expression.set_s(astnode->value);
 }
 
-void SemanticAnalyser::visit(std::shared_ptr<ASTArrayConstructorNode> astnode) {
+void SemanticAnalyser::visit(const std::shared_ptr<ASTArrayConstructorNode>& astnode) {
 	flx_int arr_size = 0;
 
 	// clean array type on start
@@ -971,7 +972,7 @@ void SemanticAnalyser::visit(std::shared_ptr<ASTArrayConstructorNode> astnode) {
 	}
 }
 
-void SemanticAnalyser::visit(std::shared_ptr<ASTStructConstructorNode> astnode) {
+void SemanticAnalyser::visit(const std::shared_ptr<ASTStructConstructorNode>& astnode) {
 	const auto& current_module = current_module_stack.top();
 	const auto& normalized_name_space = normalize_name_space(astnode->type_name_space, current_module->name_space);
 
@@ -1005,7 +1006,7 @@ void SemanticAnalyser::visit(std::shared_ptr<ASTStructConstructorNode> astnode)
 
 }
 
-void SemanticAnalyser::visit(std::shared_ptr<ASTIdentifierNode> astnode) {
+void SemanticAnalyser::visit(const std::shared_ptr<ASTIdentifierNode>& astnode) {
 	const auto& current_module = current_module_stack.top();
 	const auto& normalized_name_space = normalize_name_space(astnode->access_name_space, current_module->name_space);
 	auto identifier = astnode->identifier;
@@ -1074,7 +1075,7 @@ void SemanticAnalyser::visit(std::shared_ptr<ASTIdentifierNode> astnode) {
 
 }
 
-void SemanticAnalyser::visit(std::shared_ptr<ASTBinaryExprNode> astnode) {
+void SemanticAnalyser::visit(const std::shared_ptr<ASTBinaryExprNode>& astnode) {
 	if (Token::is_assignment_op(astnode->op)) {
 		is_assignment = true;
 	}
@@ -1181,7 +1182,7 @@ void SemanticAnalyser::visit(std::shared_ptr<ASTBinaryExprNode> astnode) {
 
 }
 
-void SemanticAnalyser::visit(std::shared_ptr<ASTUnaryExprNode> astnode) {
+void SemanticAnalyser::visit(const std::shared_ptr<ASTUnaryExprNode>& astnode) {
 	astnode->expr->accept(this);
 
 	if (current_expression.is_undefined()) {
@@ -1220,7 +1221,7 @@ void SemanticAnalyser::visit(std::shared_ptr<ASTUnaryExprNode> astnode) {
 	}
 }
 
-void SemanticAnalyser::visit(std::shared_ptr<ASTTernaryNode> astnode) {
+void SemanticAnalyser::visit(const std::shared_ptr<ASTTernaryNode>& astnode) {
 	astnode->condition->accept(this);
 
 	if (current_expression.is_undefined()) {
@@ -1240,7 +1241,7 @@ void SemanticAnalyser::visit(std::shared_ptr<ASTTernaryNode> astnode) {
 	}
 }
 
-void SemanticAnalyser::visit(std::shared_ptr<ASTTypeCastNode> astnode) {
+void SemanticAnalyser::visit(const std::shared_ptr<ASTTypeCastNode>& astnode) {
 	astnode->expr->accept(this);
 
 	if (current_expression.is_undefined()) {
@@ -1256,16 +1257,16 @@ void SemanticAnalyser::visit(std::shared_ptr<ASTTypeCastNode> astnode) {
 	current_expression = SemanticValue(TypeDefinition(astnode->type));
 }
 
-void SemanticAnalyser::visit(std::shared_ptr<ASTTypeNode> astnode) {
+void SemanticAnalyser::visit(const std::shared_ptr<ASTTypeNode>& astnode) {
 	current_expression = SemanticValue(TypeDefinition(astnode->type), 0, true);
 
 }
 
-void SemanticAnalyser::visit(std::shared_ptr<ASTNullNode>) {
+void SemanticAnalyser::visit(const std::shared_ptr<ASTNullNode>&) {
 	current_expression = SemanticValue(TypeDefinition(Type::T_VOID));
 }
 
-void SemanticAnalyser::visit(std::shared_ptr<ASTThisNode> astnode) {
+void SemanticAnalyser::visit(const std::shared_ptr<ASTThisNode>& astnode) {
 	current_expression = SemanticValue(TypeDefinition(
 		Type::T_STRUCT,
 		Constants::DEFAULT_NAMESPACE,
@@ -1275,7 +1276,7 @@ void SemanticAnalyser::visit(std::shared_ptr<ASTThisNode> astnode) {
 	current_expression = *access_value(std::make_shared<SemanticValue>(current_expression), astnode->access_vector);
 }
 
-void SemanticAnalyser::visit(std::shared_ptr<ASTTypeOfNode> astnode) {
+void SemanticAnalyser::visit(const std::shared_ptr<ASTTypeOfNode>& astnode) {
 	astnode->expr->accept(this);
 
 	if (current_expression.is_undefined()) {
@@ -1285,7 +1286,7 @@ void SemanticAnalyser::visit(std::shared_ptr<ASTTypeOfNode> astnode) {
 	current_expression = SemanticValue(TypeDefinition(Type::T_STRING));
 }
 
-void SemanticAnalyser::visit(std::shared_ptr<ASTTypeIdNode> astnode) {
+void SemanticAnalyser::visit(const std::shared_ptr<ASTTypeIdNode>& astnode) {
 	astnode->expr->accept(this);
 
 	if (current_expression.is_undefined()) {
@@ -1295,7 +1296,7 @@ void SemanticAnalyser::visit(std::shared_ptr<ASTTypeIdNode> astnode) {
 	current_expression = SemanticValue(TypeDefinition(Type::T_INT));
 }
 
-void SemanticAnalyser::visit(std::shared_ptr<ASTRefIdNode> astnode) {
+void SemanticAnalyser::visit(const std::shared_ptr<ASTRefIdNode>& astnode) {
 	astnode->expr->accept(this);
 
 	if (current_expression.is_undefined()) {
@@ -1305,7 +1306,7 @@ void SemanticAnalyser::visit(std::shared_ptr<ASTRefIdNode> astnode) {
 	current_expression = SemanticValue(TypeDefinition(Type::T_INT));
 }
 
-void SemanticAnalyser::visit(std::shared_ptr<ASTIsStructNode> astnode) {
+void SemanticAnalyser::visit(const std::shared_ptr<ASTIsStructNode>& astnode) {
 	astnode->expr->accept(this);
 
 	if (current_expression.is_undefined()) {
@@ -1315,7 +1316,7 @@ void SemanticAnalyser::visit(std::shared_ptr<ASTIsStructNode> astnode) {
 	current_expression = SemanticValue(TypeDefinition(Type::T_BOOL));
 }
 
-void SemanticAnalyser::visit(std::shared_ptr<ASTIsArrayNode> astnode) {
+void SemanticAnalyser::visit(const std::shared_ptr<ASTIsArrayNode>& astnode) {
 	astnode->expr->accept(this);
 
 	if (current_expression.is_undefined()) {
@@ -1325,7 +1326,7 @@ void SemanticAnalyser::visit(std::shared_ptr<ASTIsArrayNode> astnode) {
 	current_expression = SemanticValue(TypeDefinition(Type::T_BOOL));
 }
 
-void SemanticAnalyser::visit(std::shared_ptr<ASTIsAnyNode> astnode) {
+void SemanticAnalyser::visit(const std::shared_ptr<ASTIsAnyNode>& astnode) {
 	astnode->expr->accept(this);
 
 	if (current_expression.is_undefined()) {
@@ -1335,7 +1336,7 @@ void SemanticAnalyser::visit(std::shared_ptr<ASTIsAnyNode> astnode) {
 	current_expression = SemanticValue(TypeDefinition(Type::T_BOOL));
 }
 
-void SemanticAnalyser::visit(std::shared_ptr<ASTInstructionNode>) {}
+void SemanticAnalyser::visit(const std::shared_ptr<ASTInstructionNode>&) {}
 
 void SemanticAnalyser::declare_function_parameter(std::shared_ptr<Scope> scope, const VariableDefinition& param) {
 	if (auto expr = param.get_expr_default()) {
@@ -1604,7 +1605,7 @@ bool SemanticAnalyser::returns(std::shared_ptr<ASTNode> astnode) {
 	return false;
 }
 
-void SemanticAnalyser::visit(std::shared_ptr<ASTClassDefinitionNode> astnode) {
+void SemanticAnalyser::visit(const std::shared_ptr<ASTClassDefinitionNode>& astnode) {
 	const auto& current_module = current_module_stack.top();
 
 	std::shared_ptr<Scope> current_scope = get_back_scope(current_module->name_space);
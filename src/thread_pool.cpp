@@ -0,0 +1,76 @@
+#include "thread_pool.hpp"
+
+using namespace utils;
+
+ThreadPool::ThreadPool(size_t size) {
+	if (size == 0) {
+		size = std::thread::hardware_concurrency();
+	}
+	if (size == 0) {
+		size = 1;
+	}
+
+	for (size_t i = 0; i < size; ++i) {
+		workers.emplace_back(&ThreadPool::worker_loop, this);
+	}
+}
+
+ThreadPool::~ThreadPool() {
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopping = true;
+	}
+	task_available.notify_all();
+
+	for (auto& worker : workers) {
+		if (worker.joinable()) {
+			worker.join();
+		}
+	}
+}
+
+void ThreadPool::worker_loop() {
+	while (true) {
+		std::function<void()> task;
+
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			task_available.wait(lock, [this]() { return stopping || !tasks.empty(); });
+
+			if (tasks.empty()) {
+				return;
+			}
+
+			task = std::move(tasks.front());
+			tasks.pop();
+			++active_tasks;
+		}
+
+		task();
+
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			--active_tasks;
+			if (tasks.empty() && active_tasks == 0) {
+				idle.notify_all();
+			}
+		}
+	}
+}
+
+void ThreadPool::submit(std::function<void()> task) {
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		tasks.push(std::move(task));
+	}
+	task_available.notify_one();
+}
+
+void ThreadPool::wait() {
+	std::unique_lock<std::mutex> lock(mutex);
+	idle.wait(lock, [this]() { return tasks.empty() && active_tasks == 0; });
+}
+
+size_t ThreadPool::size() const {
+	return workers.size();
+}
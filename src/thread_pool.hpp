@@ -0,0 +1,41 @@
+#ifndef THREAD_POOL_HPP
+#define THREAD_POOL_HPP
+
+#include <vector>
+#include <queue>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+namespace utils {
+
+	class ThreadPool {
+	private:
+		std::vector<std::thread> workers;
+		std::queue<std::function<void()>> tasks;
+		std::mutex mutex;
+		std::condition_variable task_available;
+		std::condition_variable idle;
+		size_t active_tasks = 0;
+		bool stopping = false;
+
+		void worker_loop();
+
+	public:
+		// a size of 0 uses the hardware concurrency
+		ThreadPool(size_t size = 0);
+		~ThreadPool();
+
+		// tasks may submit other tasks, exceptions must be handled by the task
+		void submit(std::function<void()> task);
+
+		// blocks until the queue is empty and no task is running
+		void wait();
+
+		size_t size() const;
+	};
+
+}
+
+#endif // !THREAD_POOL_HPP
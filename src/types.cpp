@@ -1,6 +1,7 @@
 #include "types.hpp"
 
 #include <cmath>
+#include <charconv>
 
 #include "utils.hpp"
 #include "exception_helper.hpp"
@@ -534,12 +535,12 @@ RuntimeValue::RuntimeValue(flx_string rawv)
 
 RuntimeValue::RuntimeValue(flx_array rawv, Type array_type, std::vector<size_t> dim, std::string type_name_space, std::string type_name)
 	: Value(TypeDefinition(array_type, dim, type_name_space, type_name)) {
-	set(rawv, array_type, dim, type_name_space, type_name);
+	set(std::move(rawv), array_type, dim, type_name_space, type_name);
 }
 
 RuntimeValue::RuntimeValue(flx_struct rawv, std::string type_name_space, std::string type_name)
 	: Value(TypeDefinition(Type::T_STRUCT, type_name_space, type_name)) {
-	set(rawv, type_name_space, type_name);
+	set(std::move(rawv), type_name_space, type_name);
 }
 
 RuntimeValue::RuntimeValue(flx_class rawv, std::string type_name_space, std::string type_name)
@@ -604,7 +605,7 @@ void RuntimeValue::set(flx_string s) {
 
 void RuntimeValue::set(flx_array arr, Type array_type, std::vector<size_t> dim, std::string type_name_space, std::string type_name) {
 	unset();
-	this->arr = std::make_shared<flx_array>(arr);
+	this->arr = std::make_shared<flx_array>(std::move(arr));
 	type = array_type;
 	this->dim = dim;
 	this->type_name = type_name;
@@ -613,7 +614,7 @@ void RuntimeValue::set(flx_array arr, Type array_type, std::vector<size_t> dim,
 
 void RuntimeValue::set(flx_struct str, std::string type_name_space, std::string type_name) {
 	unset();
-	this->str = std::make_shared<flx_struct>(str);
+	this->str = std::make_shared<flx_struct>(std::move(str));
 	type = Type::T_STRUCT;
 	this->type_name = type_name;
 	this->type_name_space = type_name_space;
@@ -773,6 +774,26 @@ flx_function* RuntimeValue::get_raw_fun() {
 	return fun;
 }
 
+const flx_string* RuntimeValue::get_raw_s() const {
+	return s;
+}
+
+std::shared_ptr<const flx_array> RuntimeValue::get_raw_arr() const {
+	return arr;
+}
+
+std::shared_ptr<const flx_struct> RuntimeValue::get_raw_str() const {
+	return str;
+}
+
+std::shared_ptr<const flx_class> RuntimeValue::get_raw_cls() const {
+	return cls;
+}
+
+const flx_function* RuntimeValue::get_raw_fun() const {
+	return fun;
+}
+
 void RuntimeValue::unset() {
 	access_identifier = "";
 	access_index = 0;
@@ -883,6 +904,40 @@ std::vector<runtime::GCObject*> RuntimeValue::get_references() {
 	return references;
 }
 
+size_t RuntimeValue::get_size() {
+	size_t size = sizeof(RuntimeValue);
+
+	if (b) {
+		size += sizeof(flx_bool);
+	}
+	else if (i) {
+		size += sizeof(flx_int);
+	}
+	else if (f) {
+		size += sizeof(flx_float);
+	}
+	else if (c) {
+		size += sizeof(flx_char);
+	}
+	else if (s) {
+		size += sizeof(flx_string) + s->capacity();
+	}
+	else if (arr) {
+		size += sizeof(flx_array) + arr->size() * sizeof(RuntimeValue*);
+	}
+	else if (str) {
+		size += sizeof(flx_struct) + str->size() * (sizeof(flx_struct::value_type) + sizeof(RuntimeVariable));
+	}
+	else if (cls) {
+		size += sizeof(flx_class) + cls->variable_symbol_table.size() * sizeof(RuntimeVariable);
+	}
+	else if (fun) {
+		size += sizeof(flx_function);
+	}
+
+	return size;
+}
+
 RuntimeVariable::RuntimeVariable(const std::string& identifier, TypeDefinition v)
 	: Variable(identifier, v) {
 }
@@ -1138,98 +1193,92 @@ flx_bool RuntimeOperations::equals_value(const RuntimeValue* lval, const Runtime
 
 std::string RuntimeOperations::parse_value_to_string(
 	const RuntimeValue* value,
-	bool print_complex_types,
-	std::vector<uintptr_t> printed
+	bool print_complex_types
+) {
+	std::string str;
+	utils::StringSink sink(str);
+	write_value(sink, value, print_complex_types);
+	return str;
+}
+
+void RuntimeOperations::write_value(
+	utils::OutputSink& sink,
+	const RuntimeValue* value,
+	bool print_complex_types
 ) {
+	WritingValues writing;
+	write_value(sink, value, print_complex_types, writing);
+}
+
+void RuntimeOperations::write_value(utils::OutputSink& sink, const RuntimeValue* value, bool print_complex_types, WritingValues& writing) {
 	if (!value) {
-		return "null";
+		sink.write(std::string_view("null"));
+		return;
 	}
 
-	std::string str = "";
-
 	if (value->is_array()) {
-		std::stringstream s;
-		s << TypeDefinition::buid_type_str(*value) << "<array@0x" << std::hex << reinterpret_cast<uintptr_t>(value) << ">";
-		str = s.str();
+		sink.write(std::string_view(TypeDefinition::buid_type_str(*value)));
+		write_address(sink, "array", value);
 
 		if (print_complex_types) {
-			if (std::find(printed.begin(), printed.end(), reinterpret_cast<uintptr_t>(value)) != printed.end()) {
-				str += "{...}";
-			}
-			else {
-				printed.push_back(reinterpret_cast<uintptr_t>(value));
-				str += RuntimeOperations::parse_array_to_string(value, print_complex_types, printed);
-			}
+			write_array(sink, value, print_complex_types, writing);
 		}
 
-		return str;
+		return;
 	}
 
 	switch (value->type) {
 	case Type::T_VOID:
-		str = "null";
+		sink.write(std::string_view("null"));
 		break;
 	case Type::T_BOOL:
-		str = ((value->get_b()) ? "true" : "false");
+		sink.write(std::string_view(value->get_b() ? "true" : "false"));
 		break;
 	case Type::T_INT:
-		str = std::to_string(value->get_i());
+		sink.write_int(value->get_i());
 		break;
 	case Type::T_FLOAT:
-		str = std::to_string(value->get_f());
-		str.erase(str.find_last_not_of('0') + 1, std::string::npos);
-		if (!str.empty() && str.back() == '.') {
-			str += "0";
-		}
+		sink.write_float(value->get_f());
 		break;
 	case Type::T_CHAR:
-		str = flx_string(std::string{ value->get_c() });
+		sink.write(value->get_c());
 		break;
 	case Type::T_STRING:
-		str = value->get_s();
-		break;
-	case Type::T_CLASS: {
-		std::stringstream s = std::stringstream();
-		if (!value->type_name_space.empty()) {
-			s << value->type_name_space << "::";
-		}
-		s << value->type_name << "<class@0x" << std::hex << reinterpret_cast<uintptr_t>(value) << ">";
-		str = s.str();
-
-		if (print_complex_types) {
-			if (std::find(printed.begin(), printed.end(), reinterpret_cast<uintptr_t>(value)) != printed.end()) {
-				str += "{...}";
-			}
-			else {
-				printed.push_back(reinterpret_cast<uintptr_t>(value));
-				str += RuntimeOperations::parse_class_to_string(value, print_complex_types, printed);
-			}
+		if (auto str = value->get_raw_s()) {
+			sink.write(std::string_view(*str));
 		}
-
 		break;
-	}
-	case Type::T_STRUCT: {
-		std::stringstream s = std::stringstream();
+	case Type::T_CLASS:
+	case Type::T_STRUCT:
 		if (!value->type_name_space.empty()) {
-			s << value->type_name_space << "::";
+			sink.write(std::string_view(value->type_name_space));
+			sink.write(std::string_view("::"));
 		}
-		s << value->type_name << "<struct@0x" << std::hex << reinterpret_cast<uintptr_t>(value) << ">";
-		str = s.str();
+		sink.write(std::string_view(value->type_name));
 
-		if (print_complex_types) {
-			if (std::find(printed.begin(), printed.end(), reinterpret_cast<uintptr_t>(value)) != printed.end()) {
-				str += "{...}";
+		if (value->type == Type::T_CLASS) {
+			write_address(sink, "class", value);
+			if (print_complex_types) {
+				write_class(sink, value, print_complex_types, writing);
 			}
-			else {
-				printed.push_back(reinterpret_cast<uintptr_t>(value));
-				str += RuntimeOperations::parse_struct_to_string(value, print_complex_types, printed);
+		}
+		else {
+			write_address(sink, "struct", value);
+			if (print_complex_types) {
+				write_struct(sink, value, print_complex_types, writing);
 			}
 		}
-
 		break;
-	}
 	case Type::T_FUNCTION: {
-		str = value->get_fun().first + (value->get_fun().first.empty() ? "" : "::") + value->get_fun().second + "(...)";
+		auto fun = value->get_raw_fun();
+		if (fun && !fun->first.empty()) {
+			sink.write(std::string_view(fun->first));
+			sink.write(std::string_view("::"));
+		}
+		if (fun) {
+			sink.write(std::string_view(fun->second));
+		}
+		sink.write(std::string_view("(...)"));
 		break;
 	}
 	case Type::T_UNDEFINED:
@@ -1237,94 +1286,102 @@ std::string RuntimeOperations::parse_value_to_string(
 	default:
 		throw std::runtime_error("can't determine value type on parsing");
 	}
-	return str;
 }
 
-std::string RuntimeOperations::parse_array_to_string(
-	const RuntimeValue* value,
-	bool print_complex_types,
-	std::vector<uintptr_t> printed
-) {
-	auto arr_value = value->get_arr();
-	std::stringstream s = std::stringstream();
-	s << "{";
-	for (auto i = 0; i < arr_value.size(); ++i) {
-		bool isc = arr_value[i] && arr_value[i]->is_char();
-		bool iss = arr_value[i] && arr_value[i]->is_string();
-
-		if (isc) s << "'";
-		else if (iss) s << '"';
-
-		s << parse_value_to_string(arr_value[i], print_complex_types, printed);
-
-		if (isc) s << "'";
-		else if (iss) s << '"';
+void RuntimeOperations::write_member(utils::OutputSink& sink, const TypeDefinition* type, const RuntimeValue* value, bool print_complex_types, WritingValues& writing) {
+	char quote = 0;
+	if (type && type->is_char()) {
+		quote = '\'';
+	}
+	else if (type && type->is_string()) {
+		quote = '"';
+	}
 
-		if (i < arr_value.size() - 1) {
-			s << ",";
-		}
+	if (quote) {
+		sink.write(quote);
+	}
+	write_value(sink, value, print_complex_types, writing);
+	if (quote) {
+		sink.write(quote);
 	}
-	s << "}";
-	return s.str();
 }
 
-std::string RuntimeOperations::parse_class_to_string(
-	const RuntimeValue* value,
-	bool print_complex_types,
-	std::vector<uintptr_t> printed
-) {
-	auto cls_value = value->get_cls();
-	std::stringstream s = std::stringstream();
-	s << "{";
-	for (auto const& [key, val] : cls_value.variable_symbol_table) {
-		bool isc = val && val->is_char();
-		bool iss = val && val->is_string();
-
-		s << key << ":";
+void RuntimeOperations::write_array(utils::OutputSink& sink, const RuntimeValue* value, bool print_complex_types, WritingValues& writing) {
+	// only the values being written are kept, a value shared by two members is written twice
+	if (!writing.insert(value).second) {
+		sink.write(std::string_view("{...}"));
+		return;
+	}
 
-		if (isc) s << "'";
-		else if (iss) s << '"';
+	sink.write('{');
+	if (auto arr_value = value->get_raw_arr()) {
+		for (flx_int i = 0; i < arr_value->size(); ++i) {
+			auto item = (*arr_value)[i];
+			write_member(sink, item, item, print_complex_types, writing);
 
-		s << parse_value_to_string(std::dynamic_pointer_cast<RuntimeVariable>(val)->get_value(), print_complex_types, printed);
+			if (i < arr_value->size() - 1) {
+				sink.write(',');
+			}
+		}
+	}
+	sink.write('}');
 
-		if (isc) s << "'";
-		else if (iss) s << '"';
+	writing.erase(value);
+}
 
-		s << ";";
+void RuntimeOperations::write_class(utils::OutputSink& sink, const RuntimeValue* value, bool print_complex_types, WritingValues& writing) {
+	if (!writing.insert(value).second) {
+		sink.write(std::string_view("{...}"));
+		return;
 	}
-	for (auto const& [key, val] : cls_value.function_symbol_table) {
-		s << ExceptionHelper::buid_signature(val->identifier, val->parameters) << ";";
+
+	sink.write('{');
+	if (auto cls_value = value->get_raw_cls()) {
+		for (auto const& [key, val] : cls_value->variable_symbol_table) {
+			sink.write(std::string_view(key));
+			sink.write(':');
+			write_member(sink, val.get(), std::dynamic_pointer_cast<RuntimeVariable>(val)->get_value(), print_complex_types, writing);
+			sink.write(';');
+		}
+		for (auto const& [key, val] : cls_value->function_symbol_table) {
+			sink.write(std::string_view(ExceptionHelper::buid_signature(val->identifier, val->parameters)));
+			sink.write(';');
+		}
 	}
-	s << "}";
-	return s.str();
-}
+	sink.write('}');
 
-std::string RuntimeOperations::parse_struct_to_string(
-	const RuntimeValue* value,
-	bool print_complex_types,
-	std::vector<uintptr_t> printed
-) {
-	auto str_value = value->get_str();
-	std::stringstream s = std::stringstream();
-	s << "{";
-	for (auto const& [key, val] : str_value) {
-		bool isc = val && val->is_char();
-		bool iss = val && val->is_string();
+	writing.erase(value);
+}
 
-		s << key << ":";
+void RuntimeOperations::write_struct(utils::OutputSink& sink, const RuntimeValue* value, bool print_complex_types, WritingValues& writing) {
+	if (!writing.insert(value).second) {
+		sink.write(std::string_view("{...}"));
+		return;
+	}
 
-		if (isc) s << "'";
-		else if (iss) s << '"';
+	sink.write('{');
+	if (auto str_value = value->get_raw_str()) {
+		for (auto const& [key, val] : *str_value) {
+			sink.write(std::string_view(key));
+			sink.write(':');
+			write_member(sink, val.get(), val->get_value(), print_complex_types, writing);
+			sink.write(';');
+		}
+	}
+	sink.write('}');
 
-		s << parse_value_to_string(std::dynamic_pointer_cast<RuntimeVariable>(val)->get_value(), print_complex_types, printed);
+	writing.erase(value);
+}
 
-		if (isc) s << "'";
-		else if (iss) s << '"';
+void RuntimeOperations::write_address(utils::OutputSink& sink, const char* kind, const RuntimeValue* value) {
+	char digits[2 * sizeof(uintptr_t)];
+	auto end = std::to_chars(digits, digits + sizeof(digits), reinterpret_cast<uintptr_t>(value), 16).ptr;
 
-		s << ";";
-	}
-	s << "}";
-	return s.str();
+	sink.write('<');
+	sink.write(std::string_view(kind));
+	sink.write(std::string_view("@0x"));
+	sink.write(std::string_view(digits, end - digits));
+	sink.write('>');
 }
 
 RuntimeValue* RuntimeOperations::do_operation(const std::string& op, RuntimeValue* lval, RuntimeValue* rval) {
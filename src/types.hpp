@@ -5,12 +5,14 @@
 #include <string>
 #include <vector>
 #include <map>
+#include <unordered_set>
 #include <stdexcept>
 #include <functional>
 #include <variant>
 
 #include "gcobject.hpp"
 #include "utils.hpp"
+#include "output_buffer.hpp"
 #include "scope.hpp"
 
 namespace core {
@@ -404,6 +406,12 @@ namespace core {
 		std::shared_ptr<flx_struct> get_raw_str();
 		std::shared_ptr<flx_class> get_raw_cls();
 		flx_function* get_raw_fun();
+		// views for readers of a const value, null when not of that type
+		const flx_string* get_raw_s() const;
+		std::shared_ptr<const flx_array> get_raw_arr() const;
+		std::shared_ptr<const flx_struct> get_raw_str() const;
+		std::shared_ptr<const flx_class> get_raw_cls() const;
+		const flx_function* get_raw_fun() const;
 
 		void set_null();
 
@@ -412,6 +420,7 @@ namespace core {
 		void copy_from(RuntimeValue* value);
 
 		virtual std::vector<GCObject*> get_references() override;
+		virtual size_t get_size() override;
 
 	private:
 		void unset();
@@ -450,23 +459,14 @@ namespace core {
 
 		static std::string parse_value_to_string(
 			const RuntimeValue* value,
-			bool print_complex_types = false,
-			std::vector<uintptr_t> printed = std::vector<uintptr_t>()
+			bool print_complex_types = false
 		);
-		static std::string parse_array_to_string(
+		// writes the text of the value as it is built, the members of complex
+		// values included when print_complex_types is set
+		static void write_value(
+			utils::OutputSink& sink,
 			const RuntimeValue* value,
-			bool print_complex_types,
-			std::vector<uintptr_t> printed
-		);
-		static std::string parse_class_to_string(
-			const RuntimeValue* value,
-			bool print_complex_types,
-			std::vector<uintptr_t> printed
-		);
-		static std::string parse_struct_to_string(
-			const RuntimeValue* value,
-			bool print_complex_types,
-			std::vector<uintptr_t> printed
+			bool print_complex_types = false
 		);
 
 		static RuntimeValue* do_operation(const std::string& op, RuntimeValue* lval, RuntimeValue* rval);
@@ -479,6 +479,18 @@ namespace core {
 
 		static RuntimeValue* normalize_type(std::shared_ptr<TypeDefinition> owner, RuntimeValue* value, bool new_ref = false);
 
+	private:
+		// complex values being written, one reached again inside itself is a cycle
+		typedef std::unordered_set<const RuntimeValue*> WritingValues;
+
+		static void write_value(utils::OutputSink& sink, const RuntimeValue* value, bool print_complex_types, WritingValues& writing);
+		// strings and chars are quoted inside complex values
+		static void write_member(utils::OutputSink& sink, const TypeDefinition* type, const RuntimeValue* value, bool print_complex_types, WritingValues& writing);
+		static void write_array(utils::OutputSink& sink, const RuntimeValue* value, bool print_complex_types, WritingValues& writing);
+		static void write_class(utils::OutputSink& sink, const RuntimeValue* value, bool print_complex_types, WritingValues& writing);
+		static void write_struct(utils::OutputSink& sink, const RuntimeValue* value, bool print_complex_types, WritingValues& writing);
+		static void write_address(utils::OutputSink& sink, const char* kind, const RuntimeValue* value);
+
 	};
 
 }
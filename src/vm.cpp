@@ -6,6 +6,8 @@
 #include "utils.hpp"
 #include "watch.hpp"
 #include "constants.hpp"
+#include "vm_snapshot.hpp"
+#include "vm_scheduler.hpp"
 
 using namespace core;
 using namespace core::runtime;
@@ -15,7 +17,14 @@ VirtualMachine::VirtualMachine(
 	VmDebug vm_debug,
 	std::vector<BytecodeInstruction> instructions
 )
-	: instructions(instructions),
+	: VirtualMachine(global_scope, std::move(vm_debug), std::make_shared<std::vector<BytecodeInstruction>>(std::move(instructions))) {}
+
+VirtualMachine::VirtualMachine(
+	std::shared_ptr<Scope> global_scope,
+	VmDebug vm_debug,
+	std::shared_ptr<const std::vector<BytecodeInstruction>> instructions
+)
+	: instructions(std::move(instructions)),
 	vm_debug(std::move(vm_debug)) {
 	cleanup_type_set();
 
@@ -32,8 +41,21 @@ VirtualMachine::VirtualMachine(
 
 }
 
-void VirtualMachine::run() {
+VirtualMachine::~VirtualMachine() {
+	if (scheduler) {
+		scheduler->cancel_all();
+	}
+}
+
+void VirtualMachine::run(bool full_collect) {
 	while (get_next()) {
+		if (profiler && profiler->sample_requested) {
+			profiler->sample(call_stack, current_pc, vm_debug);
+		}
+		if (stats) {
+			stats->record(current_instruction.opcode);
+		}
+
 		try {
 			decode_operation();
 
@@ -65,8 +87,8 @@ void VirtualMachine::run() {
 				generated_error_msg = get_debug_info(next_pc - 1).build_error_message("RuntimeError", ex.what());
 
 				while (!call_stack.empty()) {
-					generated_error_msg += get_debug_info(call_stack.top()).build_error_tail();
-					call_stack.pop();
+					generated_error_msg += get_debug_info(call_stack.back()).build_error_tail();
+					call_stack.pop_back();
 				}
 			}
 			if (generated_error) {
@@ -75,12 +97,271 @@ void VirtualMachine::run() {
 		}
 	}
 
+	// the program ends once the tasks it started have finished
+	if (scheduler) {
+		scheduler->drain();
+	}
+
 	if (evaluation_stack->empty()) {
 		push_new_constant(new RuntimeValue(flx_int(-1)));
 	}
 
-	gc.collect();
+	if (full_collect) {
+		gc.collect();
+	}
+
+}
+
+void VirtualMachine::run_segment(const VmDebug& segment_debug, std::vector<BytecodeInstruction> segment) {
+	size_t start_pc = instructions->size();
+
+	vm_debug.append(segment_debug, start_pc);
+
+	// workers started by a previous segment still run the program, so it is
+	// only extended in place once nobody else holds it
+	if (instructions.use_count() > 1) {
+		auto program = std::make_shared<std::vector<BytecodeInstruction>>();
+		program->reserve(start_pc + segment.size());
+		program->insert(program->end(), instructions->begin(), instructions->end());
+		instructions = std::move(program);
+	}
+	// every program is allocated mutable, it is only read only while shared
+	auto program = const_cast<std::vector<BytecodeInstruction>*>(instructions.get());
+	program->insert(program->end(), std::make_move_iterator(segment.begin()), std::make_move_iterator(segment.end()));
+
+	// the result of the previous segment is no longer needed
+	evaluation_stack->clear();
+	next_pc = start_pc;
+
+	// a full collection per input would grow with the session, the threshold decides instead
+	run_recoverable([this]() { run(false); });
+	gc.maybe_collect();
+}
+
+RuntimeValue* VirtualMachine::call(const std::string& module_name_space, const std::string& module_name,
+	const std::string& name_space, const std::string& identifier, const std::vector<RuntimeValue*>& arguments) {
+	if (!call_stack.empty()) {
+		throw std::runtime_error("'" + identifier + "' cannot be called while the vm is running");
+	}
+
+	std::vector<std::shared_ptr<TypeDefinition>> signature;
+	auto function_arguments = std::make_shared<std::vector<RuntimeValue*>>(arguments);
+
+	for (auto argument : arguments) {
+		signature.push_back(std::shared_ptr<RuntimeValue>(argument, [](RuntimeValue*) {}));
+	}
+
+	struct RootGuard {
+		GarbageCollector& gc;
+		std::shared_ptr<std::vector<RuntimeValue*>> container;
+		~RootGuard() { gc.remove_root_container(container); }
+	} guard{ gc, function_arguments };
+	gc.add_root_container(function_arguments);
+
+	// the result of the previous call is no longer needed
+	evaluation_stack->clear();
+
+	run_recoverable([&]() {
+		invoke(module_name_space, module_name, name_space, identifier, signature);
+
+		if (scheduler) {
+			scheduler->drain();
+		}
+		});
+
+	if (evaluation_stack->empty()) {
+		push_empty_constant(Type::T_UNDEFINED);
+	}
+
+	return evaluation_stack->back();
+}
+
+void VirtualMachine::invoke(const std::string& module_name_space, const std::string& module_name,
+	const std::string& name_space, const std::string& identifier, const std::vector<std::shared_ptr<TypeDefinition>>& signature) {
+	bool strict = true;
+	auto func_scope = find_declared_function_strict(module_name_space, module_name, name_space, identifier, signature, strict);
+
+	if (!func_scope) {
+		ExceptionHelper::throw_undeclared_function(identifier, signature);
+	}
+
+	auto& declfun = func_scope->find_declared_function(identifier, &signature, strict);
+
+	push_vm_scope(std::make_shared<Scope>(func_scope->module_name_space, func_scope->module_name));
+
+	declare_function_block_parameters(func_scope->module_name_space, declfun->parameters, signature);
+
+	if (declfun->pointer) {
+		call_stack.push_back(declfun->pointer);
+
+		// returns to the end of the program, where the sub run stops
+		return_namespace.push(std::make_pair(func_scope->module_name_space, func_scope->module_name));
+		return_stack.push(instructions->size());
+		return_unwind_stack.push(0);
+		push_deep();
+
+		enter_sub_call(declfun->pointer);
+	}
+	else {
+		builtin_functions[identifier]();
+
+		pop_vm_scope(func_scope->module_name_space, func_scope->module_name);
+	}
+}
+
+void VirtualMachine::swap_execution_state(VmExecutionState& state,
+	std::unordered_map<std::string, std::vector<std::shared_ptr<Scope>>>& task_scopes,
+	std::unordered_map<std::string, std::vector<std::shared_ptr<Scope>>>& task_module_scopes) {
+	std::swap(static_cast<VmExecutionState&>(*this), state);
+	std::swap(scopes, task_scopes);
+	std::swap(module_scopes, task_module_scopes);
+}
+
+void VirtualMachine::run_blocking(const std::function<void()>& operation) {
+	if (scheduler) {
+		scheduler->run_blocking(operation);
+	}
+	else {
+		operation();
+	}
+}
+
+void VirtualMachine::run_recoverable(const std::function<void()>& body) {
+	auto saved_scopes = scopes;
+	auto saved_module_scopes = module_scopes;
+
+	try {
+		body();
+	}
+	catch (...) {
+		scopes = std::move(saved_scopes);
+		module_scopes = std::move(saved_module_scopes);
+		evaluation_stack->clear();
+		call_stack.clear();
+		scope_unwind_stack = decltype(scope_unwind_stack)();
+		return_unwind_stack = decltype(return_unwind_stack)();
+		evaluation_unwind_stack = decltype(evaluation_unwind_stack)();
+		return_namespace = decltype(return_namespace)();
+		while (!iterator_stack.empty()) {
+			gc.remove_root(iterator_stack.top().value);
+			iterator_stack.pop();
+		}
+		iterator_unwind_stack = decltype(iterator_unwind_stack)();
+		class_stack = decltype(class_stack)();
+		value_build_stack = decltype(value_build_stack)();
+		return_stack = decltype(return_stack)();
+		try_stack = decltype(try_stack)();
+		catch_err_stack = decltype(catch_err_stack)();
+		return_from_sub_run = decltype(return_from_sub_run)();
+		use_variable_ref = decltype(use_variable_ref)();
+		check_return_from_sub_run = false;
+		generated_error = false;
+		gc.collect();
+		throw;
+	}
+}
+
+void VirtualMachine::save_snapshot(const std::string& path) {
+	// only the state of the top level of a module is kept, the stacks used
+	// inside blocks, calls and expressions must be empty
+	if (!call_stack.empty() || !return_stack.empty() || !try_stack.empty()
+		|| !scope_unwind_stack.empty() || !evaluation_unwind_stack.empty()
+		|| !iterator_stack.empty() || !class_stack.empty() || !value_build_stack.empty()
+		|| !class_def_build_stack.empty() || !struct_def_build_stack.empty()
+		|| !func_def_build_stack.empty() || evaluation_stack->size() > 1) {
+		throw std::runtime_error("snapshots can only be taken by a statement at the top level of a module");
+	}
+	if (scheduler && scheduler->has_tasks()) {
+		throw std::runtime_error("snapshots cannot be taken while tasks are running");
+	}
+
+	VmSnapshotWriter writer(path);
+
+	writer.write_header();
+	writer.write_instructions(*instructions);
+	vm_debug.write_snapshot(writer);
+	writer.write_size(next_pc);
+
+	write_state(writer);
+}
+
+void VirtualMachine::load_snapshot(const std::string& path) {
+	VmSnapshotReader reader(path, this);
+
+	reader.read_header();
+	instructions = std::make_shared<std::vector<BytecodeInstruction>>(reader.read_instructions());
+	vm_debug.read_snapshot(reader);
+	next_pc = reader.read_size();
+
+	read_state(reader);
 
+	// the call that took the snapshot returns true in the resumed program
+	evaluation_stack->clear();
+	push_new_constant(new RuntimeValue(flx_bool(true)));
+}
+
+void VirtualMachine::write_state(VmSnapshotWriter& writer) {
+	writer.write_size(registered_libs.size());
+	for (const auto& lib : registered_libs) {
+		writer.write_string(lib);
+	}
+
+	writer.write_bool(gc.enable);
+	writer.write_size(gc.max_heap);
+
+	writer.write_scope_map(scopes);
+	writer.write_scope_map(module_scopes);
+	writer.write_scope_map(global_module_scopes);
+
+	writer.write_size(module_included_name_spaces.size());
+	for (const auto& [module_name, name_spaces] : module_included_name_spaces) {
+		writer.write_string(module_name);
+		writer.write_size(name_spaces.size());
+		for (const auto& name_space : name_spaces) {
+			writer.write_string(name_space);
+		}
+	}
+}
+
+void VirtualMachine::read_state(VmSnapshotReader& reader) {
+	auto libs_size = reader.read_size();
+	for (size_t i = 0; i < libs_size; ++i) {
+		registered_libs.push_back(reader.read_string());
+		auto lib = Constants::find_native_lib(registered_libs.back(), host_libs.get());
+		if (!lib) {
+			throw std::runtime_error("snapshot uses unknown library '" + registered_libs.back() + "'");
+		}
+		lib->register_functions(this);
+	}
+
+	// nothing read is rooted before its variable, so collection waits for the whole heap
+	auto gc_enable = reader.read_bool();
+	gc.max_heap = reader.read_size();
+	gc.enable = false;
+
+	scopes = reader.read_scope_map();
+	module_scopes = reader.read_scope_map();
+	global_module_scopes = reader.read_scope_map();
+
+	module_included_name_spaces.clear();
+	auto modules_size = reader.read_size();
+	for (size_t i = 0; i < modules_size; ++i) {
+		auto& name_spaces = module_included_name_spaces[reader.read_string()];
+		name_spaces.resize(reader.read_size());
+		for (auto& name_space : name_spaces) {
+			name_space = reader.read_string();
+		}
+	}
+
+	gc.enable = gc_enable;
+}
+
+std::shared_ptr<const std::vector<BytecodeInstruction>> VirtualMachine::get_instructions() const {
+	return instructions;
+}
+
+const VmDebug& VirtualMachine::get_vm_debug() const {
+	return vm_debug;
 }
 
 void VirtualMachine::decode_operation() {
@@ -116,7 +397,8 @@ void VirtualMachine::decode_operation() {
 
 		// namespace operations
 	case OP_BUILTIN_LIB:
-		Constants::CORE_LIBS.find(current_instruction.operand.get_string_operand())->second->register_functions(this);
+		registered_libs.push_back(current_instruction.operand.get_string_operand());
+		Constants::find_native_lib(registered_libs.back(), host_libs.get())->register_functions(this);
 		break;
 	case OP_INCLUDE_NAMESPACE:
 		handle_include_namespace();
@@ -492,7 +774,7 @@ void VirtualMachine::decode_operation() {
 		// skip operation, do nothing
 		break;
 	case OP_HALT:
-		next_pc = instructions.size();
+		next_pc = instructions->size();
 		break;
 	case OP_TRAP:
 		check_return_from_sub_run = true;
@@ -519,10 +801,10 @@ RuntimeValue* VirtualMachine::get_evaluation_stack_top() {
 bool VirtualMachine::get_next() {
 	previous_pc = current_pc;
 	current_pc = next_pc;
-	if (next_pc >= instructions.size()) {
+	if (next_pc >= instructions->size()) {
 		return false;
 	}
-	current_instruction = instructions[next_pc++];
+	current_instruction = (*instructions)[next_pc++];
 	return true;
 }
 
@@ -531,6 +813,9 @@ void VirtualMachine::cleanup_type_set() {
 }
 
 RuntimeValue* VirtualMachine::allocate_value(RuntimeValue* value) {
+	if (gc.stats.track_allocation_sites) {
+		++gc.stats.allocation_sites[current_pc];
+	}
 	return dynamic_cast<RuntimeValue*>(gc.allocate(value));
 }
 
@@ -748,16 +1033,15 @@ void VirtualMachine::handle_call() {
 
 					declare_function_block_parameters(obj_as_scope->module_name_space, cls_const->parameters, signature);
 
-					vm_debug.debug_info_table[curr_pc] = std::vector<Operand>{
-						vm_debug.debug_info_table[curr_pc][0],
-						vm_debug.debug_info_table[curr_pc][1],
-						Operand(size_t(0)),
-						Operand(vm_debug.index_of_namespace(obj_as_scope->module_name_space)),
-						Operand(identifier),
-						Operand(curr_row),
-						Operand(curr_col)
-					};
-					call_stack.push(curr_pc);
+					{
+						auto& entry = vm_debug.get_debug_entry(curr_pc);
+						entry.ast_type = 0;
+						entry.access_name_space = vm_debug.index_of_namespace(obj_as_scope->module_name_space);
+						entry.identifier = identifier;
+						entry.row = curr_row;
+						entry.col = curr_col;
+					}
+					call_stack.push_back(curr_pc);
 
 					return_namespace.push(std::make_pair(obj_as_scope->module_name_space, obj_as_scope->module_name));
 					return_stack.push(next_pc);
@@ -830,16 +1114,13 @@ void VirtualMachine::handle_call() {
 		as_identifier = "<lambda>";
 	}
 	auto stack_identifier = call_identifier + (as_identifier.empty() ? "" : " as " + as_identifier);
-	vm_debug.debug_info_table[curr_pc] = std::vector<Operand>{
-		vm_debug.debug_info_table[curr_pc][0],
-		vm_debug.debug_info_table[curr_pc][1],
-		Operand(size_t(0)),
-		Operand(vm_debug.index_of_namespace(func_scope->module_name_space)),
-		Operand(stack_identifier),
-		Operand(curr_row),
-		Operand(curr_col)
-	};
-	call_stack.push(curr_pc);
+	auto& entry = vm_debug.get_debug_entry(curr_pc);
+	entry.ast_type = 0;
+	entry.access_name_space = vm_debug.index_of_namespace(func_scope->module_name_space);
+	entry.identifier = stack_identifier;
+	entry.row = curr_row;
+	entry.col = curr_col;
+	call_stack.push_back(curr_pc);
 
 	if (declfun->pointer) {
 		return_namespace.push(std::make_pair(func_scope->module_name_space, func_scope->module_name));
@@ -855,11 +1136,18 @@ void VirtualMachine::handle_call() {
 		builtin_functions[identifier]();
 
 		pop_vm_scope(func_scope->module_name_space, func_scope->module_name);
-		call_stack.pop();
+		call_stack.pop_back();
 	}
 
 	gc.remove_root_container(function_arguments);
 
+	// requested by a builtin, taken once the call is complete
+	if (!snapshot_path.empty()) {
+		auto path = std::move(snapshot_path);
+		snapshot_path.clear();
+		save_snapshot(path);
+	}
+
 }
 
 void VirtualMachine::handle_return() {
@@ -887,7 +1175,7 @@ void VirtualMachine::handle_return() {
 	return_namespace.pop();
 
 	if (!generated_error) {
-		call_stack.pop();
+		call_stack.pop_back();
 	}
 }
 
@@ -1568,7 +1856,7 @@ void VirtualMachine::handle_load_var() {
 	else if (get_inner_most_struct_definition_scope(module_name_space, module_name, name_space, identifier)) {
 		std::vector<size_t> dim;
 
-		while (next_pc + 1 < instructions.size() && instructions[next_pc + 1].opcode == OP_LOAD_SUB_IX) {
+		while (next_pc + 1 < instructions->size() && (*instructions)[next_pc + 1].opcode == OP_LOAD_SUB_IX) {
 			// execute push constant operation
 			get_next();
 			decode_operation();
@@ -1612,24 +1900,21 @@ void VirtualMachine::handle_load_sub_id() {
 		break;
 	}
 	case Type::T_CLASS: {
-		if (instructions[next_pc].opcode == OP_CALL && instructions[next_pc].operand.get_vector_operand()[3].get_string_operand().empty()) {
-			auto aux_next_pc = next_pc;
-			auto oop = instructions[aux_next_pc].operand.get_vector_operand();
-			auto nop = oop;
-			nop[3] = Operand(id);
-			instructions[aux_next_pc].operand = Operand(nop);
-
+		if ((*instructions)[next_pc].opcode == OP_CALL && (*instructions)[next_pc].operand.get_vector_operand()[3].get_string_operand().empty()) {
 			std::shared_ptr<flx_class> obj_as_scope = val->get_raw_cls();
 			class_stack.push(obj_as_scope);
 			push_vm_scope(obj_as_scope);
 
 			get_next();
 
+			// the method is named in the fetched copy, the program is never written
+			auto operands = current_instruction.operand.get_vector_operand();
+			operands[3] = Operand(id);
+			current_instruction.operand = Operand(operands);
+
 			is_from_class = true;
 			decode_operation();
 
-			instructions[aux_next_pc].operand = Operand(oop);
-
 			enter_sub_call(next_pc);
 
 			class_stack.pop();
@@ -1776,6 +2061,7 @@ void VirtualMachine::pop_vm_scope(const std::string& module_name_space, const st
 void VirtualMachine::push_deep() {
 	scope_unwind_stack.push(std::vector<std::pair<std::string, std::string>>());
 	evaluation_unwind_stack.push(0);
+	iterator_unwind_stack.push(iterator_stack.size());
 
 	if (!return_unwind_stack.empty()) {
 		return_unwind_stack.top()++;
@@ -1795,6 +2081,14 @@ void VirtualMachine::pop_deep() {
 	if (!evaluation_unwind_stack.empty()) {
 		evaluation_unwind_stack.pop();
 	}
+	if (!iterator_unwind_stack.empty()) {
+		// a foreach leaves its iterator when the loop ends, breaks or returns
+		while (iterator_stack.size() > iterator_unwind_stack.top()) {
+			gc.remove_root(iterator_stack.top().value);
+			iterator_stack.pop();
+		}
+		iterator_unwind_stack.pop();
+	}
 }
 
 void VirtualMachine::unwind() {
@@ -1860,14 +2154,17 @@ void VirtualMachine::enter_sub_call(size_t new_pointer) {
 	run();
 }
 
+void VirtualMachine::print_gc_stats(std::ostream& os) {
+	gc.print_stats(os, [this](size_t pc) {
+		if (pc >= instructions->size() || !vm_debug.has_debug_entry(pc)) {
+			return "pc " + std::to_string(pc);
+		}
+		auto dbg_info = get_debug_info(pc);
+		return dbg_info.module_name + ":" + std::to_string(dbg_info.row) + ":" + std::to_string(dbg_info.col)
+			+ " (" + OP_NAMES.at((*instructions)[pc].opcode) + ")";
+		});
+}
+
 DebugInfo VirtualMachine::get_debug_info(size_t dbg_pc) {
-	return DebugInfo(
-		vm_debug.get_namespace(vm_debug.debug_info_table[dbg_pc][0].get_int_operand()),
-		vm_debug.get_module(vm_debug.debug_info_table[dbg_pc][1].get_int_operand()),
-		vm_debug.get_ast_type(vm_debug.debug_info_table[dbg_pc][2].get_int_operand()),
-		vm_debug.get_namespace(vm_debug.debug_info_table[dbg_pc][3].get_int_operand()),
-		vm_debug.debug_info_table[dbg_pc][4].get_string_operand(),
-		vm_debug.debug_info_table[dbg_pc][5].get_int_operand(),
-		vm_debug.debug_info_table[dbg_pc][6].get_int_operand()
-	);
+	return vm_debug.get_debug_info(dbg_pc);
 }
@@ -5,6 +5,7 @@
 #include <vector>
 #include <stack>
 #include <map>
+#include <unordered_map>
 #include <functional>
 #include <memory>
 
@@ -15,8 +16,11 @@
 #include "ast.hpp"
 #include "debuginfo.hpp"
 #include "vm_debug.hpp"
+#include "vm_profiler.hpp"
+#include "vm_stats.hpp"
 #include "scope_manager.hpp"
 #include "gc.hpp"
+#include "module.hpp"
 
 namespace core {
 
@@ -27,24 +31,15 @@ namespace core {
 			size_t index = 0;
 		};
 
-		class VirtualMachine : public ScopeManager {
-		public:
-			std::map<std::string, std::function<void()>> builtin_functions;
-			GarbageCollector gc;
-
-			RuntimeValue* allocate_value(RuntimeValue* value);
-			void push_new_constant(RuntimeValue* value);
-			void push_constant(RuntimeValue* value);
-			void push_empty_constant(Type type);
-			void pop_constant();
-			RuntimeValue* get_evaluation_stack_top();
-
-		private:
+		/*
+			Stacks and registers of one thread of execution. The vm runs a single
+			one at a time, a suspended task keeps its own until it is resumed.
+		*/
+		struct VmExecutionState {
 			std::shared_ptr<std::vector<RuntimeValue*>> evaluation_stack;
 			size_t previous_pc = 0;
 			size_t current_pc = 0;
 			size_t next_pc = 0;
-			std::vector<BytecodeInstruction> instructions;
 			BytecodeInstruction current_instruction;
 
 			std::stack<std::vector<std::pair<std::string, std::string>>> scope_unwind_stack;
@@ -53,6 +48,7 @@ namespace core {
 			std::stack<std::pair<std::string, std::string>> return_namespace;
 			
 			std::stack<RuntimeValueIterator> iterator_stack;
+			std::stack<size_t> iterator_unwind_stack;
 			std::stack<std::shared_ptr<Scope>> class_stack;
 			std::stack<std::shared_ptr<ClassDefinition>> class_def_build_stack;
 			std::stack<std::shared_ptr<StructDefinition>> struct_def_build_stack;
@@ -66,7 +62,7 @@ namespace core {
 			TypeDefinition current_expression_array_type;
 
 			std::vector<size_t> set_array_dim;
-			size_t set_default_value_pc;
+			size_t set_default_value_pc = 0;
 			bool set_check_build_array = false;
 			std::stack<TypeDefinition> type_def_stack;
 
@@ -78,8 +74,39 @@ namespace core {
 
 			bool generated_error = false;
 			std::string generated_error_msg;
-			std::stack<size_t> call_stack;
+			std::vector<size_t> call_stack;
+		};
+
+		class VmScheduler;
+
+		class VirtualMachine : public ScopeManager, private VmExecutionState {
+			friend class VmScheduler;
+
+		public:
+			std::map<std::string, std::function<void()>> builtin_functions;
+			GarbageCollector gc;
+			std::shared_ptr<VmProfiler> profiler;
+			std::shared_ptr<VmStats> stats;
+			// created by the first task started, see vm_scheduler.hpp
+			std::shared_ptr<VmScheduler> scheduler;
+			// set by a builtin to save a heap snapshot once its call returns
+			std::string snapshot_path;
+			// native libs of the embedding host, if any, set before the program runs
+			std::shared_ptr<const modules::NativeLibs> host_libs;
+
+			RuntimeValue* allocate_value(RuntimeValue* value);
+			void push_new_constant(RuntimeValue* value);
+			void push_constant(RuntimeValue* value);
+			void push_empty_constant(Type type);
+			void pop_constant();
+			RuntimeValue* get_evaluation_stack_top();
+
+		private:
+			// never written once loaded, so worker vms and host contexts share it
+			std::shared_ptr<const std::vector<BytecodeInstruction>> instructions;
+
 			VmDebug vm_debug;
+			std::vector<std::string> registered_libs;
 
 		private:
 			void push_vm_scope(std::shared_ptr<Scope> scope);
@@ -90,6 +117,20 @@ namespace core {
 			void unwind_scope();
 			void unwind_eval_stack();
 			void enter_sub_call(size_t new_pointer);
+			// runs body, on error the scopes and stacks are reset so the vm can run again
+			void run_recoverable(const std::function<void()>& body);
+			// calls a function on the current stacks and returns once it has returned
+			void invoke(
+				const std::string& module_name_space,
+				const std::string& module_name,
+				const std::string& name_space,
+				const std::string& identifier,
+				const std::vector<std::shared_ptr<TypeDefinition>>& signature
+			);
+			// exchanges the running stacks and scopes with the ones of a suspended task
+			void swap_execution_state(VmExecutionState& state,
+				std::unordered_map<std::string, std::vector<std::shared_ptr<Scope>>>& task_scopes,
+				std::unordered_map<std::string, std::vector<std::shared_ptr<Scope>>>& task_module_scopes);
 
 			bool get_use_variable_ref();
 
@@ -180,10 +221,48 @@ namespace core {
 				VmDebug vm_debug,
 				std::vector<BytecodeInstruction> instructions
 			);
+			VirtualMachine(
+				std::shared_ptr<Scope> global_scope,
+				VmDebug vm_debug,
+				std::shared_ptr<const std::vector<BytecodeInstruction>> instructions
+			);
 			VirtualMachine() = default;
-			~VirtualMachine() = default;
+			~VirtualMachine();
+
+			// a segment skips the full collection at the end, the heap outlives it
+			void run(bool full_collect = true);
+			// appends a segment compiled after the current program and runs it, on
+			// error the scopes are restored so the next segment can still run
+			void run_segment(const VmDebug& segment_debug, std::vector<BytecodeInstruction> segment);
+
+			/*
+				Calls a function from the host once the program has run, the arguments
+				must be allocated by this vm. The returned value stays on the evaluation
+				stack, so it is valid until the next call.
+			*/
+			RuntimeValue* call(
+				const std::string& module_name_space,
+				const std::string& module_name,
+				const std::string& name_space,
+				const std::string& identifier,
+				const std::vector<RuntimeValue*>& arguments
+			);
+
+			// runs an operation that does not use the vm, other tasks run meanwhile
+			void run_blocking(const std::function<void()>& operation);
+
+			void save_snapshot(const std::string& path);
+			// replaces the program and heap, run() then resumes after the call that saved it
+			void load_snapshot(const std::string& path);
+
+			// libraries, scopes and heap, read back by a vm running the same program
+			void write_state(VmSnapshotWriter& writer);
+			void read_state(VmSnapshotReader& reader);
+
+			std::shared_ptr<const std::vector<BytecodeInstruction>> get_instructions() const;
+			const VmDebug& get_vm_debug() const;
 
-			void run();
+			void print_gc_stats(std::ostream& os);
 
 		};
 
@@ -1,39 +1,41 @@
 #include "vm_debug.hpp"
 
+#include "vm_snapshot.hpp"
+
 using namespace core;
 
-void VmDebug::add_module(std::string module_name) {
-	if (std::find(module_names.begin(), module_names.end(), module_name) == module_names.end()) {
+void VmDebug::add_module(const std::string& module_name) {
+	if (module_indexes.emplace(module_name, module_names.size()).second) {
 		module_names.push_back(module_name);
 	}
 }
 
-void VmDebug::add_namespace(std::string namespace_name) {
-	if (std::find(namespace_names.begin(), namespace_names.end(), namespace_name) == namespace_names.end()) {
+void VmDebug::add_namespace(const std::string& namespace_name) {
+	if (namespace_indexes.emplace(namespace_name, namespace_names.size()).second) {
 		namespace_names.push_back(namespace_name);
 	}
 }
 
-size_t VmDebug::index_of_ast_type(std::string ast_type) {
-	auto it = std::find(ast_types.begin(), ast_types.end(), ast_type);
-	if (it != ast_types.end()) {
-		return std::distance(ast_types.begin(), it);
+size_t VmDebug::index_of_ast_type(const std::string& ast_type) {
+	auto it = ast_type_indexes.find(ast_type);
+	if (it != ast_type_indexes.end()) {
+		return it->second;
 	}
 	throw std::runtime_error("invalid type index");
 }
 
-size_t VmDebug::index_of_module(std::string module_name) {
-	auto it = std::find(module_names.begin(), module_names.end(), module_name);
-	if (it != module_names.end()) {
-		return std::distance(module_names.begin(), it);
+size_t VmDebug::index_of_module(const std::string& module_name) {
+	auto it = module_indexes.find(module_name);
+	if (it != module_indexes.end()) {
+		return it->second;
 	}
 	throw std::runtime_error("invalid module index");
 }
 
-size_t VmDebug::index_of_namespace(std::string namespace_name) {
-	auto it = std::find(namespace_names.begin(), namespace_names.end(), namespace_name);
-	if (it != namespace_names.end()) {
-		return std::distance(namespace_names.begin(), it);
+size_t VmDebug::index_of_namespace(const std::string& namespace_name) {
+	auto it = namespace_indexes.find(namespace_name);
+	if (it != namespace_indexes.end()) {
+		return it->second;
 	}
 	throw std::runtime_error("invalid namespace index");
 }
@@ -49,3 +51,112 @@ std::string VmDebug::get_module(size_t index) {
 std::string VmDebug::get_namespace(size_t index) {
 	return namespace_names[index];
 }
+
+void VmDebug::set_debug_entry(size_t pc, DebugEntry entry) {
+	if (pc >= debug_info_table.size()) {
+		debug_info_table.resize(pc + 1);
+	}
+	debug_info_table[pc] = std::move(entry);
+	debug_info_table[pc].populated = true;
+}
+
+bool VmDebug::has_debug_entry(size_t pc) const {
+	return pc < debug_info_table.size() && debug_info_table[pc].populated;
+}
+
+DebugEntry& VmDebug::get_debug_entry(size_t pc) {
+	if (pc >= debug_info_table.size()) {
+		throw std::runtime_error("invalid debug entry");
+	}
+	return debug_info_table[pc];
+}
+
+DebugInfo VmDebug::get_debug_info(size_t pc) {
+	// a gap belongs to the instruction set before it
+	size_t entry_pc = pc;
+	while (entry_pc > 0 && !has_debug_entry(entry_pc)) {
+		--entry_pc;
+	}
+	// it is read while reporting another error, which must not be masked
+	if (!has_debug_entry(entry_pc)) {
+		return DebugInfo("", "", "", "", "");
+	}
+	const auto& entry = get_debug_entry(entry_pc);
+	return DebugInfo(
+		get_namespace(entry.name_space),
+		get_module(entry.module),
+		get_ast_type(entry.ast_type),
+		get_namespace(entry.access_name_space),
+		entry.identifier,
+		entry.row,
+		entry.col
+	);
+}
+
+void VmDebug::append(const VmDebug& other, size_t start_pc) {
+	for (size_t i = module_names.size(); i < other.module_names.size(); ++i) {
+		add_module(other.module_names[i]);
+	}
+	for (size_t i = namespace_names.size(); i < other.namespace_names.size(); ++i) {
+		add_namespace(other.namespace_names[i]);
+	}
+
+	if (other.debug_info_table.size() > debug_info_table.size()) {
+		debug_info_table.resize(other.debug_info_table.size());
+	}
+	for (size_t pc = start_pc; pc < other.debug_info_table.size(); ++pc) {
+		debug_info_table[pc] = other.debug_info_table[pc];
+	}
+}
+
+void VmDebug::write_snapshot(runtime::VmSnapshotWriter& writer) const {
+	auto write_names = [&writer](const std::vector<std::string>& names) {
+		writer.write_size(names.size());
+		for (const auto& name : names) {
+			writer.write_string(name);
+		}
+		};
+
+	write_names(ast_types);
+	write_names(module_names);
+	write_names(namespace_names);
+
+	writer.write_size(debug_info_table.size());
+	for (const auto& entry : debug_info_table) {
+		writer.write_size(entry.name_space);
+		writer.write_size(entry.module);
+		writer.write_size(entry.ast_type);
+		writer.write_size(entry.access_name_space);
+		writer.write_string(entry.identifier);
+		writer.write_size(entry.row);
+		writer.write_size(entry.col);
+		writer.write_bool(entry.populated);
+	}
+}
+
+void VmDebug::read_snapshot(runtime::VmSnapshotReader& reader) {
+	auto read_names = [&reader](std::vector<std::string>& names, std::unordered_map<std::string, size_t>& indexes) {
+		names.resize(reader.read_size());
+		indexes.clear();
+		for (size_t i = 0; i < names.size(); ++i) {
+			names[i] = reader.read_string();
+			indexes.emplace(names[i], i);
+		}
+		};
+
+	read_names(ast_types, ast_type_indexes);
+	read_names(module_names, module_indexes);
+	read_names(namespace_names, namespace_indexes);
+
+	debug_info_table.resize(reader.read_size());
+	for (auto& entry : debug_info_table) {
+		entry.name_space = reader.read_size();
+		entry.module = reader.read_size();
+		entry.ast_type = reader.read_size();
+		entry.access_name_space = reader.read_size();
+		entry.identifier = reader.read_string();
+		entry.row = reader.read_size();
+		entry.col = reader.read_size();
+		entry.populated = reader.read_bool();
+	}
+}
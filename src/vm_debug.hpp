@@ -5,11 +5,31 @@
 #include <string>
 #include <vector>
 #include <array>
+#include <unordered_map>
 
 #include "operand.hpp"
+#include "debuginfo.hpp"
 
 namespace core {
 
+	namespace runtime {
+		class VmSnapshotWriter;
+		class VmSnapshotReader;
+	}
+
+	// debug information of one instruction, names are stored as indexes
+	struct DebugEntry {
+		size_t name_space = 0;
+		size_t module = 0;
+		size_t ast_type = 0;
+		size_t access_name_space = 0;
+		std::string identifier;
+		size_t row = 0;
+		size_t col = 0;
+		// false for the gaps left when a later pc is set first
+		bool populated = false;
+	};
+
 	class VmDebug {
 	private:
 		std::vector<std::string> ast_types = std::vector<std::string>{
@@ -19,20 +39,41 @@ namespace core {
 		};
 		std::vector<std::string> module_names = std::vector<std::string>{ "" };
 		std::vector<std::string> namespace_names = std::vector<std::string>{ "" };
+		std::unordered_map<std::string, size_t> ast_type_indexes = {
+			{ "<expression>", 0 },
+			{ "<statement>", 1 },
+			{ "<program>", 2 }
+		};
+		std::unordered_map<std::string, size_t> module_indexes = { { "", 0 } };
+		std::unordered_map<std::string, size_t> namespace_indexes = { { "", 0 } };
 
-	public:
-		std::map<size_t, std::vector<Operand>> debug_info_table;
+		// indexed by pc, the compiler sets an entry for most instructions
+		std::vector<DebugEntry> debug_info_table;
 
-		void add_module(std::string module_name);
-		void add_namespace(std::string namespace_name);
+	public:
+		void add_module(const std::string& module_name);
+		void add_namespace(const std::string& namespace_name);
 
-		size_t index_of_ast_type(std::string ast_type);
-		size_t index_of_module(std::string module_name);
-		size_t index_of_namespace(std::string namespace_name);
+		size_t index_of_ast_type(const std::string& ast_type);
+		size_t index_of_module(const std::string& module_name);
+		size_t index_of_namespace(const std::string& namespace_name);
 
 		std::string get_ast_type(size_t index);
 		std::string get_module(size_t index);
 		std::string get_namespace(size_t index);
+
+		void set_debug_entry(size_t pc, DebugEntry entry);
+		bool has_debug_entry(size_t pc) const;
+		DebugEntry& get_debug_entry(size_t pc);
+
+		DebugInfo get_debug_info(size_t pc);
+
+		// copies the names and entries added to other from start_pc on, other must
+		// have been built on top of this one, so names keep the same indexes
+		void append(const VmDebug& other, size_t start_pc);
+
+		void write_snapshot(runtime::VmSnapshotWriter& writer) const;
+		void read_snapshot(runtime::VmSnapshotReader& reader);
 	};
 
 }
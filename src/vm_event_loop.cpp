@@ -0,0 +1,247 @@
+#include "vm_event_loop.hpp"
+
+#include <vector>
+#include <algorithm>
+#include <stdexcept>
+
+#ifdef linux
+
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#include <cerrno>
+
+#elif defined(_WIN32)
+
+#include <ws2tcpip.h>
+
+#endif // linux
+
+using namespace core;
+using namespace core::runtime;
+
+#ifdef _WIN32
+// the poller only sees new watches once it wakes up
+static constexpr int POLL_INTERVAL = 50;
+#endif // _WIN32
+
+EventLoop::EventLoop() {
+#ifdef linux
+	epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+	wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	if (epoll_fd < 0 || wake_fd < 0) {
+		throw std::runtime_error("cannot create the event loop");
+	}
+
+	// the watch ids start at one, zero is the wake up
+	epoll_event event{};
+	event.events = EPOLLIN;
+	event.data.u64 = 0;
+	epoll_ctl(epoll_fd, EPOLL_CTL_ADD, wake_fd, &event);
+#endif // linux
+
+	poller = std::thread(&EventLoop::run, this);
+}
+
+EventLoop::~EventLoop() {
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopping = true;
+	}
+	wake();
+	poller.join();
+
+#ifdef linux
+	close(wake_fd);
+	close(epoll_fd);
+#endif // linux
+}
+
+void EventLoop::watch(socket_t sock, uint32_t events, flx_int timeout, Callback callback) {
+	std::lock_guard<std::mutex> lock(mutex);
+
+	if (sock != NO_SOCKET && socket_watches.find(sock) != socket_watches.end()) {
+		throw std::runtime_error("socket is already awaited by another task");
+	}
+
+	auto id = next_watch_id++;
+
+	Watch watch{ sock, events, time_point(), timeout > 0, std::move(callback) };
+
+	if (sock != NO_SOCKET) {
+#ifdef linux
+		epoll_event event{};
+		event.events = uint32_t(EPOLLONESHOT)
+			| (events & READABLE ? uint32_t(EPOLLIN | EPOLLRDHUP) : 0)
+			| (events & WRITABLE ? uint32_t(EPOLLOUT) : 0);
+		event.data.u64 = id;
+		if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, sock, &event) != 0) {
+			throw std::runtime_error("cannot watch the socket");
+		}
+#endif // linux
+		socket_watches[sock] = id;
+	}
+
+	// the poller waits until the next deadline, it may be this one
+	if (watch.has_deadline) {
+		watch.deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout);
+		deadlines.emplace(watch.deadline, id);
+		wake();
+	}
+
+	watches.emplace(id, std::move(watch));
+}
+
+void EventLoop::cancel(socket_t sock) {
+	Callback callback;
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		auto it = socket_watches.find(sock);
+		if (it == socket_watches.end()) {
+			return;
+		}
+		callback = take(it->second);
+	}
+	callback(CANCELLED);
+}
+
+void EventLoop::cancel_all() {
+	std::vector<Callback> callbacks;
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		while (!watches.empty()) {
+			callbacks.push_back(take(watches.begin()->first));
+		}
+	}
+	for (auto& callback : callbacks) {
+		callback(CANCELLED);
+	}
+}
+
+void EventLoop::run() {
+	std::vector<std::pair<Callback, uint32_t>> fired;
+
+	while (true) {
+		int timeout = -1;
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			if (stopping) {
+				return;
+			}
+			if (!deadlines.empty()) {
+				auto wait = std::chrono::ceil<std::chrono::milliseconds>(deadlines.begin()->first - std::chrono::steady_clock::now());
+				timeout = int(std::max(wait.count(), decltype(wait.count())(0)));
+			}
+		}
+
+#ifdef linux
+		epoll_event events[256];
+		int count = epoll_wait(epoll_fd, events, 256, timeout);
+		if (count < 0 && errno != EINTR) {
+			return;
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			for (int i = 0; i < count; ++i) {
+				if (events[i].data.u64 == 0) {
+					eventfd_t value;
+					eventfd_read(wake_fd, &value);
+					continue;
+				}
+
+				// the watch may have been cancelled since the event was queued
+				auto it = watches.find(events[i].data.u64);
+				if (it == watches.end()) {
+					continue;
+				}
+
+				// errors and hang ups are seen by the read or write that follows
+				uint32_t ready = 0;
+				if (events[i].events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR)) {
+					ready |= it->second.events & READABLE;
+				}
+				if (events[i].events & (EPOLLOUT | EPOLLHUP | EPOLLERR)) {
+					ready |= it->second.events & WRITABLE;
+				}
+				fired.emplace_back(take(it->first), ready);
+			}
+#elif defined(_WIN32)
+		std::vector<WSAPOLLFD> fds;
+		std::vector<uint64_t> ids;
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			for (const auto& [id, watch] : watches) {
+				if (watch.sock != NO_SOCKET) {
+					fds.push_back(WSAPOLLFD{ watch.sock,
+						SHORT((watch.events & READABLE ? POLLRDNORM : 0) | (watch.events & WRITABLE ? POLLWRNORM : 0)), 0 });
+					ids.push_back(id);
+				}
+			}
+		}
+
+		timeout = timeout < 0 ? POLL_INTERVAL : std::min(timeout, POLL_INTERVAL);
+		int count = fds.empty() ? (Sleep(DWORD(timeout)), 0) : WSAPoll(fds.data(), ULONG(fds.size()), timeout);
+
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			for (size_t i = 0; count > 0 && i < fds.size(); ++i) {
+				auto it = watches.find(ids[i]);
+				if (!fds[i].revents || it == watches.end()) {
+					continue;
+				}
+
+				uint32_t ready = 0;
+				if (fds[i].revents & (POLLRDNORM | POLLHUP | POLLERR)) {
+					ready |= it->second.events & READABLE;
+				}
+				if (fds[i].revents & (POLLWRNORM | POLLHUP | POLLERR)) {
+					ready |= it->second.events & WRITABLE;
+				}
+				fired.emplace_back(take(it->first), ready);
+			}
+#endif // linux
+
+			auto now = std::chrono::steady_clock::now();
+			while (!deadlines.empty() && deadlines.begin()->first <= now) {
+				fired.emplace_back(take(deadlines.begin()->second), TIMED_OUT);
+			}
+		}
+
+		for (auto& [callback, ready] : fired) {
+			callback(ready);
+		}
+		fired.clear();
+	}
+}
+
+void EventLoop::wake() {
+#ifdef linux
+	eventfd_write(wake_fd, 1);
+#endif // linux
+}
+
+EventLoop::Callback EventLoop::take(uint64_t id) {
+	auto it = watches.find(id);
+	auto watch = std::move(it->second);
+	watches.erase(it);
+
+	if (watch.sock != NO_SOCKET) {
+#ifdef linux
+		epoll_ctl(epoll_fd, EPOLL_CTL_DEL, watch.sock, nullptr);
+#endif // linux
+		socket_watches.erase(watch.sock);
+	}
+
+	if (watch.has_deadline) {
+		auto range = deadlines.equal_range(watch.deadline);
+		for (auto deadline = range.first; deadline != range.second; ++deadline) {
+			if (deadline->second == id) {
+				deadlines.erase(deadline);
+				break;
+			}
+		}
+	}
+
+	return std::move(watch.callback);
+}
@@ -0,0 +1,94 @@
+#ifndef VM_EVENT_LOOP_HPP
+#define VM_EVENT_LOOP_HPP
+
+#include <cstdint>
+#include <map>
+#include <unordered_map>
+#include <chrono>
+#include <functional>
+#include <thread>
+#include <mutex>
+
+#include "types.hpp"
+
+#ifdef _WIN32
+#include <winsock2.h>
+#endif // _WIN32
+
+namespace core {
+
+	namespace runtime {
+
+		/*
+			Waits for sockets and timers on a poller thread of its own, epoll on
+			Linux, and calls back once for each watch, when its socket is ready or
+			its timeout elapsed. Callbacks run on the poller thread, or on the one
+			cancelling the watch, and never with the loop locked.
+		*/
+		class EventLoop {
+		public:
+#ifdef _WIN32
+			typedef SOCKET socket_t;
+			static constexpr socket_t NO_SOCKET = INVALID_SOCKET;
+#else
+			typedef int socket_t;
+			static constexpr socket_t NO_SOCKET = -1;
+#endif // _WIN32
+
+			enum Events : uint32_t {
+				TIMED_OUT = 0,
+				READABLE = 1,
+				WRITABLE = 2,
+				CANCELLED = 4
+			};
+
+			typedef std::function<void(uint32_t)> Callback;
+
+		private:
+			typedef std::chrono::steady_clock::time_point time_point;
+
+			struct Watch {
+				socket_t sock;
+				uint32_t events;
+				time_point deadline;
+				bool has_deadline;
+				Callback callback;
+			};
+
+			std::mutex mutex;
+			uint64_t next_watch_id = 1;
+			std::unordered_map<uint64_t, Watch> watches;
+			std::unordered_map<socket_t, uint64_t> socket_watches;
+			std::multimap<time_point, uint64_t> deadlines;
+			bool stopping = false;
+
+#ifdef linux
+			int epoll_fd;
+			int wake_fd;
+#endif // linux
+
+			std::thread poller;
+
+		public:
+			EventLoop();
+			~EventLoop();
+
+			// a socket is watched by one waiter at a time, timers use NO_SOCKET,
+			// a timeout of zero or less waits for the socket forever
+			void watch(socket_t sock, uint32_t events, flx_int timeout, Callback callback);
+			// the watch of the socket is called back with CANCELLED, before it is closed
+			void cancel(socket_t sock);
+			void cancel_all();
+
+		private:
+			void run();
+			void wake();
+			// removes the watch, the caller calls it back once the loop is unlocked
+			Callback take(uint64_t id);
+		};
+
+	}
+
+}
+
+#endif // !VM_EVENT_LOOP_HPP
@@ -0,0 +1,141 @@
+#include "vm_profiler.hpp"
+
+#include <fstream>
+#include <iomanip>
+#include <algorithm>
+#include <unordered_set>
+#include <chrono>
+
+using namespace core;
+
+VmProfiler::VmProfiler(const std::string& output_path, size_t interval)
+	: output_path(output_path), interval(interval ? interval : DEFAULT_INTERVAL), running(false), sample_requested(false) {}
+
+VmProfiler::~VmProfiler() {
+	stop();
+}
+
+void VmProfiler::ticker_loop() {
+	while (running) {
+		std::this_thread::sleep_for(std::chrono::microseconds(interval));
+		sample_requested = true;
+	}
+}
+
+void VmProfiler::start() {
+	if (!running) {
+		running = true;
+		ticker_thread = std::thread(&VmProfiler::ticker_loop, this);
+	}
+}
+
+void VmProfiler::stop() {
+	if (running) {
+		running = false;
+		if (ticker_thread.joinable()) {
+			ticker_thread.join();
+		}
+	}
+	sample_requested = false;
+}
+
+std::string VmProfiler::build_function_name(const DebugInfo& frame_info, const DebugInfo& location_info) {
+	auto identifier = frame_info.identifier.empty() ? "<program>" : frame_info.identifier;
+	return location_info.module_name + "::" + identifier;
+}
+
+void VmProfiler::sample(const std::vector<size_t>& call_stack, size_t pc, VmDebug& vm_debug) {
+	sample_requested = false;
+
+	// frame i runs the function called at call_stack[i - 1] and is currently
+	// located at call_stack[i], the innermost frame is located at the current pc
+	std::vector<size_t> locations = call_stack;
+	locations.push_back(pc);
+
+	auto get_info = [&vm_debug](size_t dbg_pc) {
+		if (!vm_debug.has_debug_entry(dbg_pc)) {
+			return DebugInfo("", "<unknown>", "", "", "");
+		}
+		return vm_debug.get_debug_info(dbg_pc);
+		};
+
+	std::string stack;
+	std::string function_name;
+	std::unordered_set<std::string> seen_functions;
+	auto frame_info = DebugInfo("", "", "", "", "");
+
+	for (size_t i = 0; i < locations.size(); ++i) {
+		auto location_info = get_info(locations[i]);
+
+		function_name = build_function_name(frame_info, location_info);
+
+		if (!stack.empty()) {
+			stack += ";";
+		}
+		stack += function_name + ":" + std::to_string(location_info.row);
+
+		// recursive calls are accounted only once in total time
+		if (seen_functions.insert(function_name).second) {
+			++total_function_samples[function_name];
+		}
+
+		frame_info = location_info;
+	}
+
+	++self_samples[function_name];
+	++folded_stacks[stack];
+	++total_samples;
+}
+
+void VmProfiler::write_folded_stacks() {
+	std::ofstream file(output_path);
+
+	if (!file) {
+		std::cerr << "Could not write profile to \"" << output_path << "\"." << std::endl;
+		return;
+	}
+
+	for (const auto& [stack, count] : folded_stacks) {
+		file << stack << " " << count << std::endl;
+	}
+}
+
+void VmProfiler::print_summary(std::ostream& os, size_t limit) {
+	std::vector<std::pair<std::string, size_t>> functions(self_samples.begin(), self_samples.end());
+	for (const auto& [function_name, count] : total_function_samples) {
+		if (self_samples.find(function_name) == self_samples.end()) {
+			functions.emplace_back(function_name, 0);
+		}
+	}
+
+	std::sort(functions.begin(), functions.end(), [this](const auto& a, const auto& b) {
+		if (a.second != b.second) {
+			return a.second > b.second;
+		}
+		return total_function_samples[a.first] > total_function_samples[b.first];
+		});
+
+	auto to_ms = [this](size_t samples) {
+		return double(samples * interval) / 1000.0;
+		};
+
+	auto to_percent = [this](size_t samples) {
+		return total_samples ? double(samples) * 100.0 / double(total_samples) : 0.0;
+		};
+
+	os << std::endl << "profile: " << total_samples << " samples every " << interval << "us" << std::endl;
+	os << std::right << std::fixed << std::setprecision(2)
+		<< std::setw(12) << "self(ms)" << std::setw(9) << "self%"
+		<< std::setw(12) << "total(ms)" << std::setw(9) << "total%"
+		<< "  function" << std::endl;
+
+	for (size_t i = 0; i < functions.size() && i < limit; ++i) {
+		const auto& [function_name, self] = functions[i];
+		auto total = total_function_samples[function_name];
+		os << std::setw(12) << to_ms(self) << std::setw(9) << to_percent(self)
+			<< std::setw(12) << to_ms(total) << std::setw(9) << to_percent(total)
+			<< "  " << function_name << std::endl;
+	}
+
+	os << std::defaultfloat;
+}
@@ -0,0 +1,52 @@
+#ifndef VM_PROFILER_HPP
+#define VM_PROFILER_HPP
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <map>
+#include <thread>
+#include <atomic>
+
+#include "vm_debug.hpp"
+
+namespace core {
+
+	class VmProfiler {
+	public:
+		static const size_t DEFAULT_INTERVAL = 1000;
+
+	private:
+		std::string output_path;
+		size_t interval;
+		std::thread ticker_thread;
+		std::atomic<bool> running;
+
+		size_t total_samples = 0;
+		std::map<std::string, size_t> folded_stacks;
+		std::map<std::string, size_t> self_samples;
+		std::map<std::string, size_t> total_function_samples;
+
+		void ticker_loop();
+
+		std::string build_function_name(const DebugInfo& frame_info, const DebugInfo& location_info);
+
+	public:
+		// set by the ticker thread, checked by the vm on each instruction
+		std::atomic<bool> sample_requested;
+
+		VmProfiler(const std::string& output_path, size_t interval = DEFAULT_INTERVAL);
+		~VmProfiler();
+
+		void start();
+		void stop();
+
+		void sample(const std::vector<size_t>& call_stack, size_t pc, VmDebug& vm_debug);
+
+		void write_folded_stacks();
+		void print_summary(std::ostream& os, size_t limit = 30);
+	};
+
+}
+
+#endif // !VM_PROFILER_HPP
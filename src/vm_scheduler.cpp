@@ -0,0 +1,514 @@
+#include "vm_scheduler.hpp"
+
+#include "constants.hpp"
+
+using namespace core;
+using namespace core::runtime;
+
+VmScheduler::VmScheduler(VirtualMachine* vm)
+	: vm(vm), current(&main_task) {
+	main_task.status = TaskStatus::RUNNING;
+}
+
+VmScheduler::~VmScheduler() {
+	// operations still running complete through the scheduler
+	file_io.reset();
+
+	for (auto& [id, task] : tasks) {
+		if (task->thread.joinable()) {
+			task->thread.join();
+		}
+	}
+}
+
+flx_int VmScheduler::spawn(RuntimeValue* function, RuntimeValue* argument) {
+	auto task = std::make_unique<Task>();
+
+	task->function = function->get_fun();
+	task->arguments = std::make_shared<std::vector<RuntimeValue*>>(std::vector<RuntimeValue*>{ argument });
+
+	return start(std::move(task));
+}
+
+flx_int VmScheduler::spawn_native(std::function<void()> body) {
+	auto task = std::make_unique<Task>();
+
+	task->body = std::move(body);
+	task->arguments = std::make_shared<std::vector<RuntimeValue*>>();
+
+	return start(std::move(task));
+}
+
+flx_int VmScheduler::begin_operation() {
+	auto task = std::make_unique<Task>();
+	task->operation = true;
+	task->status = TaskStatus::BLOCKED;
+
+	std::lock_guard<std::mutex> lock(mutex);
+
+	auto id = next_id++;
+	tasks[id] = std::move(task);
+	++blocked;
+
+	return id;
+}
+
+void VmScheduler::complete_operation(flx_int id, std::function<RuntimeValue*()> build_result, const std::string& error) {
+	std::lock_guard<std::mutex> lock(mutex);
+
+	auto task = tasks.at(id).get();
+	task->build_result = std::move(build_result);
+	task->error = error;
+	task->status = TaskStatus::DONE;
+	--blocked;
+
+	if (task->waiter) {
+		// a task awaiting several tasks is woken up by the first one only
+		if (task->waiter->status == TaskStatus::WAITING) {
+			task->waiter->status = TaskStatus::READY;
+			ready.push_back(task->waiter);
+		}
+		task->waiter = nullptr;
+	}
+	if (!current) {
+		dispatch();
+	}
+}
+
+AsyncFileIo* VmScheduler::get_file_io() {
+	std::lock_guard<std::mutex> lock(mutex);
+
+	if (!file_io) {
+		file_io = std::make_unique<AsyncFileIo>();
+	}
+	return file_io.get();
+}
+
+flx_int VmScheduler::start(std::unique_ptr<Task> task) {
+	vm->gc.add_root_container(task->arguments);
+
+	task->state.evaluation_stack = std::make_shared<std::vector<RuntimeValue*>>();
+	vm->gc.add_root_container(task->state.evaluation_stack);
+
+	// the task sees the scopes of the call starting it, except the one of the
+	// flx.core.async builtin itself
+	task->scopes = vm->scopes;
+	task->module_scopes = vm->module_scopes;
+	auto builtin_scope = vm->get_back_scope(Constants::STD_NAMESPACE);
+	task->scopes[builtin_scope->module_name_space].pop_back();
+	task->module_scopes[builtin_scope->module_name].pop_back();
+
+	std::unique_lock<std::mutex> lock(mutex);
+
+	auto id = next_id++;
+	auto raw_task = task.get();
+	tasks[id] = std::move(task);
+	ready.push_back(raw_task);
+
+	raw_task->thread = std::thread(&VmScheduler::run_task, this, raw_task);
+
+	return id;
+}
+
+RuntimeValue* VmScheduler::await(flx_int id) {
+	std::unique_lock<std::mutex> lock(mutex);
+
+	auto it = tasks.find(id);
+	if (it == tasks.end()) {
+		throw std::runtime_error("task was already awaited");
+	}
+	auto task = it->second.get();
+	if (task == current) {
+		throw std::runtime_error("a task cannot await itself");
+	}
+	if (task->waiter) {
+		throw std::runtime_error("task is already awaited by another task");
+	}
+
+	while (task->status != TaskStatus::DONE) {
+		task->waiter = current;
+		current->status = TaskStatus::WAITING;
+
+		try {
+			switch_from(lock);
+		}
+		catch (...) {
+			task->waiter = nullptr;
+			throw;
+		}
+
+		if (deadlocked) {
+			deadlocked = false;
+			task->waiter = nullptr;
+			throw std::runtime_error("deadlock, every task is awaiting another one");
+		}
+	}
+
+	auto finished = std::move(tasks[id]);
+	tasks.erase(id);
+	lock.unlock();
+
+	if (finished->thread.joinable()) {
+		finished->thread.join();
+	}
+
+	if (!finished->error.empty()) {
+		throw std::runtime_error((finished->operation ? "" : "task failed: ") + finished->error);
+	}
+
+	if (finished->build_result) {
+		finished->result = finished->build_result();
+		vm->gc.add_root(finished->result);
+	}
+
+	return finished->result;
+}
+
+flx_int VmScheduler::await_any(const std::vector<flx_int>& ids) {
+	std::unique_lock<std::mutex> lock(mutex);
+
+	std::vector<Task*> awaited;
+	for (auto id : ids) {
+		auto it = tasks.find(id);
+		if (it == tasks.end()) {
+			throw std::runtime_error("task was already awaited");
+		}
+		auto task = it->second.get();
+		if (task == current) {
+			throw std::runtime_error("a task cannot await itself");
+		}
+		if (task->waiter) {
+			throw std::runtime_error("task is already awaited by another task");
+		}
+		awaited.push_back(task);
+	}
+
+	auto release = [this, &awaited]() {
+		for (auto task : awaited) {
+			if (task->waiter == current) {
+				task->waiter = nullptr;
+			}
+		}
+		};
+
+	if (awaited.empty()) {
+		throw std::runtime_error("no task to await");
+	}
+
+	while (true) {
+		for (size_t i = 0; i < awaited.size(); ++i) {
+			if (awaited[i]->status == TaskStatus::DONE) {
+				return ids[i];
+			}
+		}
+
+		for (auto task : awaited) {
+			task->waiter = current;
+		}
+		current->status = TaskStatus::WAITING;
+
+		try {
+			switch_from(lock);
+		}
+		catch (...) {
+			release();
+			throw;
+		}
+		release();
+
+		if (deadlocked) {
+			deadlocked = false;
+			throw std::runtime_error("deadlock, every task is awaiting another one");
+		}
+	}
+}
+
+void VmScheduler::yield() {
+	std::unique_lock<std::mutex> lock(mutex);
+
+	if (ready.empty()) {
+		return;
+	}
+
+	current->status = TaskStatus::READY;
+	ready.push_back(current);
+
+	switch_from(lock);
+}
+
+void VmScheduler::run_blocking(const std::function<void()>& operation) {
+	std::unique_lock<std::mutex> lock(mutex);
+
+	if (tasks.empty()) {
+		lock.unlock();
+		operation();
+		return;
+	}
+
+	auto self = current;
+	vm->swap_execution_state(self->state, self->scopes, self->module_scopes);
+	self->status = TaskStatus::BLOCKED;
+	++blocked;
+	current = nullptr;
+	dispatch();
+	lock.unlock();
+
+	// the vm belongs to the task holding the turn meanwhile
+	std::exception_ptr error;
+	try {
+		operation();
+	}
+	catch (...) {
+		error = std::current_exception();
+	}
+
+	lock.lock();
+	--blocked;
+	self->status = TaskStatus::READY;
+	ready.push_back(self);
+	if (!current) {
+		dispatch();
+	}
+	wait_turn(lock, self);
+	vm->swap_execution_state(self->state, self->scopes, self->module_scopes);
+	lock.unlock();
+
+	if (self->cancelled) {
+		throw TaskCancelled();
+	}
+	if (error) {
+		std::rethrow_exception(error);
+	}
+}
+
+uint32_t VmScheduler::wait_io(EventLoop::socket_t sock, uint32_t events, flx_int timeout) {
+	std::unique_lock<std::mutex> lock(mutex);
+
+	if (current->cancelled) {
+		throw TaskCancelled();
+	}
+
+	if (!event_loop) {
+		event_loop = std::make_unique<EventLoop>();
+	}
+
+	// the callback needs the lock, so it cannot run before the turn is given away
+	auto self = current;
+	uint32_t ready_events = EventLoop::CANCELLED;
+	event_loop->watch(sock, events, timeout, [this, self, &ready_events](uint32_t fired) {
+		std::lock_guard<std::mutex> lock(mutex);
+		ready_events = fired;
+		--blocked;
+		self->status = TaskStatus::READY;
+		ready.push_back(self);
+		if (!current) {
+			dispatch();
+		}
+		});
+
+	self->status = TaskStatus::BLOCKED;
+	++blocked;
+	switch_from(lock);
+
+	return ready_events;
+}
+
+void VmScheduler::cancel_io(EventLoop::socket_t sock) {
+	std::unique_lock<std::mutex> lock(mutex);
+	if (!event_loop) {
+		return;
+	}
+	lock.unlock();
+
+	event_loop->cancel(sock);
+}
+
+bool VmScheduler::is_done(flx_int id) {
+	std::lock_guard<std::mutex> lock(mutex);
+
+	auto it = tasks.find(id);
+	return it == tasks.end() || it->second->status == TaskStatus::DONE;
+}
+
+bool VmScheduler::has_tasks() {
+	std::lock_guard<std::mutex> lock(mutex);
+
+	return !tasks.empty();
+}
+
+void VmScheduler::drain() {
+	while (true) {
+		flx_int id = 0;
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+
+			// a task ending the program with exit does not wait for the others
+			if (current != &main_task || tasks.empty()) {
+				return;
+			}
+
+			// tasks awaited by another task are finished by it
+			for (const auto& [task_id, task] : tasks) {
+				if (!task->waiter) {
+					id = task_id;
+					break;
+				}
+			}
+			if (!id) {
+				throw std::runtime_error("deadlock, every task is awaiting another one");
+			}
+		}
+
+		auto result = await(id);
+		vm->gc.remove_root(result);
+	}
+}
+
+void VmScheduler::cancel_all() {
+	std::unique_lock<std::mutex> lock(mutex);
+
+	auto pending = [this]() {
+		for (const auto& [id, task] : tasks) {
+			if (task->status != TaskStatus::DONE) {
+				return true;
+			}
+		}
+		return false;
+		};
+
+	for (auto& [id, task] : tasks) {
+		task->waiter = nullptr;
+		if (task->status == TaskStatus::DONE) {
+			continue;
+		}
+		task->cancelled = true;
+		if (task->status == TaskStatus::WAITING) {
+			task->status = TaskStatus::READY;
+			ready.push_back(task.get());
+		}
+	}
+
+	// tasks waiting for sockets are woken up to unwind as well
+	if (event_loop) {
+		lock.unlock();
+		event_loop->cancel_all();
+		lock.lock();
+	}
+
+	// the last task to finish finds nothing ready and gives the turn back
+	while (pending()) {
+		main_task.status = TaskStatus::WAITING;
+		switch_from(lock);
+		deadlocked = false;
+	}
+
+	lock.unlock();
+
+	for (auto& [id, task] : tasks) {
+		if (task->thread.joinable()) {
+			task->thread.join();
+		}
+		if (task->result) {
+			vm->gc.remove_root(task->result);
+		}
+	}
+	tasks.clear();
+}
+
+void VmScheduler::run_task(Task* task) {
+	std::unique_lock<std::mutex> lock(mutex);
+	wait_turn(lock, task);
+	lock.unlock();
+
+	if (!task->cancelled) {
+		vm->swap_execution_state(task->state, task->scopes, task->module_scopes);
+
+		try {
+			vm->cleanup_type_set();
+
+			if (task->body) {
+				task->body();
+			}
+			else {
+				std::vector<std::shared_ptr<TypeDefinition>> signature;
+				for (auto argument : *task->arguments) {
+					signature.push_back(std::shared_ptr<RuntimeValue>(argument, [](RuntimeValue*) {}));
+				}
+
+				vm->invoke("", "", task->function.first, task->function.second, signature);
+			}
+
+			if (vm->evaluation_stack->empty()) {
+				vm->push_empty_constant(Type::T_UNDEFINED);
+			}
+			task->result = vm->evaluation_stack->back();
+			vm->gc.add_root(task->result);
+		}
+		catch (const TaskCancelled&) {}
+		catch (const std::exception& ex) {
+			task->error = ex.what();
+		}
+
+		while (!vm->iterator_stack.empty()) {
+			vm->gc.remove_root(vm->iterator_stack.top().value);
+			vm->iterator_stack.pop();
+		}
+
+		// leaves the vm without stacks for the task taking the turn
+		vm->swap_execution_state(task->state, task->scopes, task->module_scopes);
+	}
+
+	vm->gc.remove_root_container(task->state.evaluation_stack);
+	vm->gc.remove_root_container(task->arguments);
+	task->state = VmExecutionState();
+	task->scopes.clear();
+	task->module_scopes.clear();
+
+	lock.lock();
+	task->status = TaskStatus::DONE;
+	if (task->waiter) {
+		// a task awaiting several tasks is woken up by the first one only
+		if (task->waiter->status == TaskStatus::WAITING) {
+			task->waiter->status = TaskStatus::READY;
+			ready.push_back(task->waiter);
+		}
+		task->waiter = nullptr;
+	}
+	current = nullptr;
+	dispatch();
+}
+
+void VmScheduler::switch_from(std::unique_lock<std::mutex>& lock) {
+	auto self = current;
+
+	vm->swap_execution_state(self->state, self->scopes, self->module_scopes);
+	current = nullptr;
+	dispatch();
+
+	wait_turn(lock, self);
+	vm->swap_execution_state(self->state, self->scopes, self->module_scopes);
+
+	if (self->cancelled) {
+		throw TaskCancelled();
+	}
+}
+
+void VmScheduler::wait_turn(std::unique_lock<std::mutex>& lock, Task* task) {
+	task->turn.wait(lock, [this, task]() { return current == task; });
+	task->status = TaskStatus::RUNNING;
+}
+
+void VmScheduler::dispatch() {
+	if (!ready.empty()) {
+		current = ready.front();
+		ready.pop_front();
+	}
+	else if (!blocked && main_task.status == TaskStatus::WAITING) {
+		// nothing can make progress, the program gets the turn back to fail
+		deadlocked = true;
+		current = &main_task;
+	}
+	if (current) {
+		current->turn.notify_one();
+	}
+}
@@ -0,0 +1,139 @@
+#ifndef VM_SCHEDULER_HPP
+#define VM_SCHEDULER_HPP
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <map>
+#include <unordered_map>
+#include <memory>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+#include "vm.hpp"
+#include "vm_event_loop.hpp"
+#include "async_file_io.hpp"
+#include "types.hpp"
+
+namespace core {
+
+	namespace runtime {
+
+		/*
+			Cooperative scheduler of the tasks of a vm. Each task runs a function on
+			its own native thread, used only as a stack that can be suspended in the
+			middle of a call, and only the task holding the turn runs, so the vm is
+			never used concurrently. The turn is given away when a task yields, awaits
+			another task or runs a blocking operation, which runs outside the turn so
+			the waits of several tasks overlap.
+
+			A task is not a vm frame that can be saved and resumed, its native thread
+			lives until the task is done, also while it waits on a socket or a timer.
+			Every task costs a thread stack and a place in the OS scheduler, so a
+			program serving thousands of connections runs thousands of threads, and
+			the latency of a resumed task includes the OS waking its thread.
+		*/
+		class VmScheduler {
+		private:
+			enum class TaskStatus {
+				READY,
+				RUNNING,
+				WAITING,
+				BLOCKED,
+				DONE
+			};
+
+			struct Task {
+				std::thread thread;
+				TaskStatus status = TaskStatus::READY;
+				// only the task given the turn is woken up
+				std::condition_variable turn;
+
+				// stacks and scopes of the task while it is not running
+				VmExecutionState state;
+				std::unordered_map<std::string, std::vector<std::shared_ptr<Scope>>> scopes;
+				std::unordered_map<std::string, std::vector<std::shared_ptr<Scope>>> module_scopes;
+
+				flx_function function;
+				std::shared_ptr<std::vector<RuntimeValue*>> arguments;
+				// run instead of the function by tasks of the native modules
+				std::function<void()> body;
+				// operations have no thread, their result is built by the task awaiting them
+				bool operation = false;
+				std::function<RuntimeValue*()> build_result;
+				RuntimeValue* result = nullptr;
+				std::string error;
+
+				Task* waiter = nullptr;
+				bool cancelled = false;
+			};
+
+			// thrown into a cancelled task when it is resumed, so its stack unwinds
+			struct TaskCancelled {};
+
+			VirtualMachine* vm;
+
+			std::mutex mutex;
+			// the thread running the program, it is never run by the scheduler
+			Task main_task;
+			Task* current;
+			std::deque<Task*> ready;
+			size_t blocked = 0;
+			bool deadlocked = false;
+
+			flx_int next_id = 1;
+			std::map<flx_int, std::unique_ptr<Task>> tasks;
+
+			// created by the first wait, stopped before the tasks are joined
+			std::unique_ptr<EventLoop> event_loop;
+			// created by the first file operation, finishes its operations when destroyed
+			std::unique_ptr<AsyncFileIo> file_io;
+
+		public:
+			VmScheduler(VirtualMachine* vm);
+			~VmScheduler();
+
+			// the task starts once the current one gives the turn away
+			flx_int spawn(RuntimeValue* function, RuntimeValue* argument);
+			// the body may wait for sockets and call functions through the vm
+			flx_int spawn_native(std::function<void()> body);
+			// an operation running outside the vm, awaited as a task until completed
+			flx_int begin_operation();
+			// called from any thread, build_result runs on the turn of the awaiting
+			// task and an empty error is a success
+			void complete_operation(flx_int id, std::function<RuntimeValue*()> build_result, const std::string& error);
+			AsyncFileIo* get_file_io();
+			// the result stays rooted, the caller removes the root once it is reachable
+			RuntimeValue* await(flx_int id);
+			// waits until one of the tasks is done and returns it, it is then awaited with await
+			flx_int await_any(const std::vector<flx_int>& ids);
+			void yield();
+			void run_blocking(const std::function<void()>& operation);
+			// suspends the running task until the socket is ready or the timeout elapsed,
+			// returns the ready events, EventLoop::TIMED_OUT or EventLoop::CANCELLED
+			uint32_t wait_io(EventLoop::socket_t sock, uint32_t events, flx_int timeout);
+			// wakes the task waiting for the socket with EventLoop::CANCELLED
+			void cancel_io(EventLoop::socket_t sock);
+			bool is_done(flx_int id);
+			bool has_tasks();
+
+			// awaits the tasks nobody awaited, called by the program once it ends
+			void drain();
+			// resumes the suspended tasks only to unwind them
+			void cancel_all();
+
+		private:
+			flx_int start(std::unique_ptr<Task> task);
+			void run_task(Task* task);
+			void switch_from(std::unique_lock<std::mutex>& lock);
+			void wait_turn(std::unique_lock<std::mutex>& lock, Task* task);
+			void dispatch();
+		};
+
+	}
+
+}
+
+#endif // !VM_SCHEDULER_HPP
@@ -0,0 +1,693 @@
+#include "vm_snapshot.hpp"
+
+#include <cstring>
+
+#include "vm.hpp"
+#include "constants.hpp"
+
+using namespace core;
+using namespace core::runtime;
+
+static const char SNAPSHOT_MAGIC[8] = { 'F', 'L', 'X', 'S', 'N', 'A', 'P', '\0' };
+static const size_t SNAPSHOT_FORMAT = 1;
+
+// references are written as 0 for null, 1 for a new object and index + 2 for a known one
+static const size_t REF_NULL = 0;
+static const size_t REF_NEW = 1;
+
+enum SnapshotPayload : uint8_t {
+	SP_NONE,
+	SP_BOOL,
+	SP_INT,
+	SP_FLOAT,
+	SP_CHAR,
+	SP_STRING,
+	SP_ARRAY,
+	SP_STRUCT,
+	SP_CLASS,
+	SP_FUNCTION
+};
+
+enum SnapshotParameter : uint8_t {
+	SPR_VARIABLE,
+	SPR_UNPACKED
+};
+
+VmSnapshotWriter::VmSnapshotWriter(const std::string& path)
+	: file_stream(path, std::ios::binary), file(file_stream) {
+	if (!file) {
+		throw std::runtime_error("could not write snapshot to '" + path + "'");
+	}
+}
+
+VmSnapshotWriter::VmSnapshotWriter(std::ostream& stream)
+	: file(stream) {}
+
+bool VmSnapshotWriter::write_ref(SnapshotKind kind, const void* obj) {
+	if (!obj) {
+		write_size(REF_NULL);
+		return false;
+	}
+
+	auto& kind_ids = ids[kind];
+	auto it = kind_ids.find(obj);
+	if (it != kind_ids.end()) {
+		write_size(it->second + 2);
+		return false;
+	}
+
+	kind_ids.emplace(obj, kind_ids.size());
+	write_size(REF_NEW);
+	return true;
+}
+
+void VmSnapshotWriter::write_header() {
+	file.write(SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC));
+	write_size(SNAPSHOT_FORMAT);
+	write_string(Constants::VER);
+	write_size(sizeof(size_t));
+	write_size(sizeof(flx_float));
+}
+
+void VmSnapshotWriter::write_size(size_t value) {
+	file.write(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+void VmSnapshotWriter::write_bool(bool value) {
+	file.put(value ? 1 : 0);
+}
+
+void VmSnapshotWriter::write_int(flx_int value) {
+	file.write(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+void VmSnapshotWriter::write_float(flx_float value) {
+	file.write(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+void VmSnapshotWriter::write_char(flx_char value) {
+	file.put(value);
+}
+
+void VmSnapshotWriter::write_string(const std::string& value) {
+	write_size(value.size());
+	file.write(value.data(), value.size());
+}
+
+void VmSnapshotWriter::write_operand(const Operand& operand) {
+	file.put(char(operand.type));
+
+	if (operand.type == OperandType::OT_VECTOR) {
+		auto operands = operand.get_vector_operand();
+		write_size(operands.size());
+		for (const auto& sub_operand : operands) {
+			write_operand(sub_operand);
+		}
+		return;
+	}
+
+	write_size(operand.value ? operand.size : 0);
+	if (operand.value) {
+		file.write(reinterpret_cast<const char*>(operand.value), operand.size);
+	}
+}
+
+void VmSnapshotWriter::write_instructions(const std::vector<BytecodeInstruction>& instructions) {
+	write_size(instructions.size());
+	for (const auto& instruction : instructions) {
+		write_size(size_t(instruction.opcode));
+		write_operand(instruction.operand);
+	}
+}
+
+void VmSnapshotWriter::write_type_definition(const TypeDefinition& type) {
+	file.put(char(type.type));
+	write_string(type.type_name);
+	write_string(type.type_name_space);
+	write_size(type.dim.size());
+	for (auto dim : type.dim) {
+		write_size(dim);
+	}
+}
+
+void VmSnapshotWriter::write_variable_definition(const VariableDefinition& variable) {
+	// expression defaults are only read by the compiler, the vm runs the compiled
+	// default pc, so a builtin's expression default is written as no default
+	write_type_definition(variable);
+	write_string(variable.identifier);
+	write_size(variable.has_pc_default() ? variable.get_pc_default() : 0);
+	write_bool(variable.is_rest);
+	write_bool(variable.is_const);
+}
+
+void VmSnapshotWriter::write_parameter(const std::shared_ptr<TypeDefinition>& parameter) {
+	if (const auto variable = std::dynamic_pointer_cast<VariableDefinition>(parameter)) {
+		file.put(SPR_VARIABLE);
+		write_variable_definition(*variable);
+	}
+	else if (const auto unpacked = std::dynamic_pointer_cast<UnpackedVariableDefinition>(parameter)) {
+		file.put(SPR_UNPACKED);
+		write_type_definition(*unpacked);
+		write_size(unpacked->variables.size());
+		for (const auto& variable : unpacked->variables) {
+			write_variable_definition(variable);
+		}
+	}
+	else {
+		throw std::runtime_error("cannot snapshot function parameter");
+	}
+}
+
+void VmSnapshotWriter::write_function(const std::shared_ptr<FunctionDefinition>& function) {
+	if (!write_ref(SK_FUNCTION, function.get())) {
+		return;
+	}
+
+	write_type_definition(*function);
+	write_string(function->identifier);
+	write_size(function->pointer);
+	write_size(function->parameters.size());
+	for (const auto& parameter : function->parameters) {
+		write_parameter(parameter);
+	}
+}
+
+void VmSnapshotWriter::write_struct_definition(const std::shared_ptr<StructDefinition>& structure) {
+	if (!write_ref(SK_STRUCT_DEFINITION, structure.get())) {
+		return;
+	}
+
+	write_string(structure->identifier);
+	write_size(structure->variables.size());
+	for (const auto& [identifier, variable] : structure->variables) {
+		write_string(identifier);
+		write_variable_definition(*variable);
+	}
+}
+
+void VmSnapshotWriter::write_class_definition(const std::shared_ptr<ClassDefinition>& cls) {
+	if (!write_ref(SK_CLASS_DEFINITION, cls.get())) {
+		return;
+	}
+
+	write_string(cls->identifier);
+	write_size(cls->variables.size());
+	for (const auto& [identifier, variable] : cls->variables) {
+		write_string(identifier);
+		write_variable_definition(variable);
+	}
+	write_scope(cls->functions_scope);
+}
+
+void VmSnapshotWriter::write_scope_tables(Scope& scope) {
+	write_size(scope.function_symbol_table.size());
+	for (const auto& [identifier, function] : scope.function_symbol_table) {
+		write_string(identifier);
+		write_function(function);
+	}
+
+	write_size(scope.class_symbol_table.size());
+	for (const auto& [identifier, cls] : scope.class_symbol_table) {
+		write_string(identifier);
+		write_class_definition(cls);
+	}
+
+	write_size(scope.struct_symbol_table.size());
+	for (const auto& [identifier, structure] : scope.struct_symbol_table) {
+		write_string(identifier);
+		write_struct_definition(structure);
+	}
+
+	write_size(scope.variable_symbol_table.size());
+	for (const auto& [identifier, variable] : scope.variable_symbol_table) {
+		write_string(identifier);
+		write_variable(variable);
+	}
+}
+
+void VmSnapshotWriter::write_scope(const std::shared_ptr<Scope>& scope) {
+	if (!write_ref(SK_SCOPE, scope.get())) {
+		return;
+	}
+
+	write_string(scope->module_name_space);
+	write_string(scope->module_name);
+	write_bool(scope->is_class);
+	write_scope_tables(*scope);
+}
+
+void VmSnapshotWriter::write_scope_map(const std::unordered_map<std::string, std::vector<std::shared_ptr<Scope>>>& scope_map) {
+	write_size(scope_map.size());
+	for (const auto& [name, scope_list] : scope_map) {
+		write_string(name);
+		write_size(scope_list.size());
+		for (const auto& scope : scope_list) {
+			write_scope(scope);
+		}
+	}
+}
+
+void VmSnapshotWriter::write_variable(const std::shared_ptr<Variable>& variable) {
+	if (!write_ref(SK_VARIABLE, variable.get())) {
+		return;
+	}
+
+	auto runtime_variable = std::dynamic_pointer_cast<RuntimeVariable>(variable);
+	if (!runtime_variable) {
+		throw std::runtime_error("cannot snapshot '" + variable->identifier + "', it is not a runtime variable");
+	}
+
+	write_string(runtime_variable->identifier);
+	write_type_definition(*runtime_variable);
+	write_value(runtime_variable->value);
+}
+
+void VmSnapshotWriter::write_value(RuntimeValue* value) {
+	if (!write_ref(SK_VALUE, value)) {
+		return;
+	}
+
+	write_type_definition(*value);
+	write_bool(value->is_constexpr);
+	write_variable(value->ref.lock());
+	write_value(value->value_ref);
+	write_size(value->access_index);
+	write_string(value->access_identifier);
+
+	if (auto arr = value->get_raw_arr()) {
+		file.put(SP_ARRAY);
+		if (write_ref(SK_ARRAY, arr.get())) {
+			write_size(size_t(arr->size()));
+			for (flx_int i = 0; i < arr->size(); ++i) {
+				write_value((*arr)[i]);
+			}
+		}
+	}
+	else if (auto str = value->get_raw_str()) {
+		file.put(SP_STRUCT);
+		if (write_ref(SK_STRUCT, str.get())) {
+			write_size(str->size());
+			for (const auto& [identifier, variable] : *str) {
+				write_string(identifier);
+				write_variable(variable);
+			}
+		}
+	}
+	else if (auto cls = value->get_raw_cls()) {
+		file.put(SP_CLASS);
+		if (write_ref(SK_CLASS, cls.get())) {
+			write_string(cls->module_name_space);
+			write_string(cls->module_name);
+			write_scope_tables(*cls);
+		}
+	}
+	else if (auto fun = value->get_raw_fun()) {
+		file.put(SP_FUNCTION);
+		write_string(fun->first);
+		write_string(fun->second);
+	}
+	else if (auto b = value->get_raw_b()) {
+		file.put(SP_BOOL);
+		write_bool(*b);
+	}
+	else if (auto i = value->get_raw_i()) {
+		file.put(SP_INT);
+		write_int(*i);
+	}
+	else if (auto f = value->get_raw_f()) {
+		file.put(SP_FLOAT);
+		write_float(*f);
+	}
+	else if (auto c = value->get_raw_c()) {
+		file.put(SP_CHAR);
+		write_char(*c);
+	}
+	else if (auto s = value->get_raw_s()) {
+		file.put(SP_STRING);
+		write_string(*s);
+	}
+	else {
+		file.put(SP_NONE);
+	}
+}
+
+VmSnapshotReader::VmSnapshotReader(const std::string& path, VirtualMachine* vm)
+	: file_stream(path, std::ios::binary), file(file_stream), vm(vm) {
+	if (!file) {
+		throw std::runtime_error("could not read snapshot from '" + path + "'");
+	}
+	file.exceptions(std::ios::failbit | std::ios::badbit);
+}
+
+VmSnapshotReader::VmSnapshotReader(std::istream& stream, VirtualMachine* vm)
+	: file(stream), vm(vm) {
+	file.exceptions(std::ios::failbit | std::ios::badbit);
+}
+
+bool VmSnapshotReader::read_ref(size_t& index) {
+	auto ref = read_size();
+	if (ref == REF_NULL || ref == REF_NEW) {
+		index = 0;
+		return ref == REF_NEW;
+	}
+	index = ref - 2;
+	return false;
+}
+
+void VmSnapshotReader::read_header() {
+	char magic[sizeof(SNAPSHOT_MAGIC)];
+	file.read(magic, sizeof(magic));
+	if (std::memcmp(magic, SNAPSHOT_MAGIC, sizeof(magic)) != 0) {
+		throw std::runtime_error("invalid snapshot file");
+	}
+	if (read_size() != SNAPSHOT_FORMAT || read_string() != Constants::VER
+		|| read_size() != sizeof(size_t) || read_size() != sizeof(flx_float)) {
+		throw std::runtime_error("snapshot was written by another interpreter version or platform");
+	}
+}
+
+size_t VmSnapshotReader::read_size() {
+	size_t value;
+	file.read(reinterpret_cast<char*>(&value), sizeof(value));
+	return value;
+}
+
+bool VmSnapshotReader::read_bool() {
+	return file.get() != 0;
+}
+
+flx_int VmSnapshotReader::read_int() {
+	flx_int value;
+	file.read(reinterpret_cast<char*>(&value), sizeof(value));
+	return value;
+}
+
+flx_float VmSnapshotReader::read_float() {
+	flx_float value;
+	file.read(reinterpret_cast<char*>(&value), sizeof(value));
+	return value;
+}
+
+flx_char VmSnapshotReader::read_char() {
+	return flx_char(file.get());
+}
+
+std::string VmSnapshotReader::read_string() {
+	std::string value(read_size(), '\0');
+	file.read(value.data(), value.size());
+	return value;
+}
+
+Operand VmSnapshotReader::read_operand() {
+	auto type = OperandType(file.get());
+
+	if (type == OperandType::OT_VECTOR) {
+		std::vector<Operand> operands(read_size());
+		for (auto& sub_operand : operands) {
+			sub_operand = read_operand();
+		}
+		return Operand(operands);
+	}
+
+	auto size = read_size();
+	uint8_t* value = nullptr;
+	if (size) {
+		value = new uint8_t[size];
+		file.read(reinterpret_cast<char*>(value), size);
+	}
+
+	Operand operand(value, size);
+	operand.type = type;
+	return operand;
+}
+
+std::vector<BytecodeInstruction> VmSnapshotReader::read_instructions() {
+	std::vector<BytecodeInstruction> instructions(read_size());
+	for (auto& instruction : instructions) {
+		instruction.opcode = OpCode(read_size());
+		instruction.operand = read_operand();
+	}
+	return instructions;
+}
+
+TypeDefinition VmSnapshotReader::read_type_definition() {
+	TypeDefinition type;
+	type.type = Type(file.get());
+	type.type_name = read_string();
+	type.type_name_space = read_string();
+	type.dim.resize(read_size());
+	for (auto& dim : type.dim) {
+		dim = read_size();
+	}
+	return type;
+}
+
+VariableDefinition VmSnapshotReader::read_variable_definition() {
+	auto type = read_type_definition();
+	auto identifier = read_string();
+	auto default_value_pc = read_size();
+	auto is_rest = read_bool();
+	auto is_const = read_bool();
+	return VariableDefinition(identifier, type, default_value_pc, is_rest, is_const);
+}
+
+std::shared_ptr<TypeDefinition> VmSnapshotReader::read_parameter() {
+	auto kind = file.get();
+
+	if (kind == SPR_VARIABLE) {
+		return std::make_shared<VariableDefinition>(read_variable_definition());
+	}
+
+	auto unpacked = std::make_shared<UnpackedVariableDefinition>(read_type_definition(), std::vector<VariableDefinition>());
+	auto size = read_size();
+	for (size_t i = 0; i < size; ++i) {
+		unpacked->variables.push_back(read_variable_definition());
+	}
+	return unpacked;
+}
+
+std::shared_ptr<FunctionDefinition> VmSnapshotReader::read_function() {
+	size_t index;
+	if (!read_ref(index)) {
+		return functions.at(index);
+	}
+
+	auto type = read_type_definition();
+	auto function = std::make_shared<FunctionDefinition>(read_string(), type);
+	functions.push_back(function);
+
+	function->pointer = read_size();
+	auto size = read_size();
+	for (size_t i = 0; i < size; ++i) {
+		function->parameters.push_back(read_parameter());
+	}
+
+	return function;
+}
+
+std::shared_ptr<StructDefinition> VmSnapshotReader::read_struct_definition() {
+	size_t index;
+	if (!read_ref(index)) {
+		return struct_definitions.at(index);
+	}
+
+	auto structure = std::make_shared<StructDefinition>(read_string());
+	struct_definitions.push_back(structure);
+
+	auto size = read_size();
+	for (size_t i = 0; i < size; ++i) {
+		auto identifier = read_string();
+		structure->variables[identifier] = std::make_shared<VariableDefinition>(read_variable_definition());
+	}
+
+	return structure;
+}
+
+std::shared_ptr<ClassDefinition> VmSnapshotReader::read_class_definition() {
+	size_t index;
+	if (!read_ref(index)) {
+		return class_definitions.at(index);
+	}
+
+	auto cls = std::make_shared<ClassDefinition>(read_string());
+	class_definitions.push_back(cls);
+
+	auto size = read_size();
+	for (size_t i = 0; i < size; ++i) {
+		auto identifier = read_string();
+		cls->variables[identifier] = read_variable_definition();
+	}
+	cls->functions_scope = read_scope();
+
+	return cls;
+}
+
+void VmSnapshotReader::read_scope_tables(Scope& scope) {
+	auto size = read_size();
+	for (size_t i = 0; i < size; ++i) {
+		auto identifier = read_string();
+		scope.function_symbol_table.emplace(identifier, read_function());
+	}
+
+	size = read_size();
+	for (size_t i = 0; i < size; ++i) {
+		auto identifier = read_string();
+		scope.class_symbol_table[identifier] = read_class_definition();
+	}
+
+	size = read_size();
+	for (size_t i = 0; i < size; ++i) {
+		auto identifier = read_string();
+		scope.struct_symbol_table[identifier] = read_struct_definition();
+	}
+
+	size = read_size();
+	for (size_t i = 0; i < size; ++i) {
+		auto identifier = read_string();
+		scope.variable_symbol_table[identifier] = read_variable();
+	}
+}
+
+std::shared_ptr<Scope> VmSnapshotReader::read_scope() {
+	size_t index;
+	if (!read_ref(index)) {
+		return index < scopes.size() ? scopes[index] : nullptr;
+	}
+
+	auto module_name_space = read_string();
+	auto module_name = read_string();
+	auto scope = std::make_shared<Scope>(module_name_space, module_name, read_bool());
+	scopes.push_back(scope);
+
+	read_scope_tables(*scope);
+
+	return scope;
+}
+
+std::unordered_map<std::string, std::vector<std::shared_ptr<Scope>>> VmSnapshotReader::read_scope_map() {
+	std::unordered_map<std::string, std::vector<std::shared_ptr<Scope>>> scope_map;
+
+	auto size = read_size();
+	for (size_t i = 0; i < size; ++i) {
+		auto& scope_list = scope_map[read_string()];
+		scope_list.resize(read_size());
+		for (auto& scope : scope_list) {
+			scope = read_scope();
+		}
+	}
+
+	return scope_map;
+}
+
+std::shared_ptr<RuntimeVariable> VmSnapshotReader::read_variable() {
+	size_t index;
+	if (!read_ref(index)) {
+		return index < variables.size() ? variables[index] : nullptr;
+	}
+
+	auto identifier = read_string();
+	auto variable = std::make_shared<RuntimeVariable>(identifier, read_type_definition());
+	variables.push_back(variable);
+
+	variable->value = read_value();
+	vm->gc.add_var_root(variable);
+
+	return variable;
+}
+
+RuntimeValue* VmSnapshotReader::read_value() {
+	size_t index;
+	if (!read_ref(index)) {
+		return index < values.size() ? values[index] : nullptr;
+	}
+
+	auto value = vm->allocate_value(new RuntimeValue());
+	values.push_back(value);
+
+	// setting the payload resets the type and access fields, they are applied last
+	auto type = read_type_definition();
+	auto is_constexpr = read_bool();
+	auto ref = read_variable();
+	auto value_ref = read_value();
+	auto access_index = read_size();
+	auto access_identifier = read_string();
+
+	auto read_shared = [this, value](std::vector<RuntimeValue*>& owners, auto set_payload, auto read_payload) {
+		size_t payload_index;
+		if (read_ref(payload_index)) {
+			set_payload();
+			owners.push_back(value);
+			read_payload();
+		}
+		else {
+			value->copy_from(owners.at(payload_index));
+		}
+		};
+
+	switch (file.get()) {
+	case SP_BOOL:
+		value->set(flx_bool(read_bool()));
+		break;
+	case SP_INT:
+		value->set(read_int());
+		break;
+	case SP_FLOAT:
+		value->set(read_float());
+		break;
+	case SP_CHAR:
+		value->set(read_char());
+		break;
+	case SP_STRING:
+		value->set(read_string());
+		break;
+	case SP_FUNCTION: {
+		auto name_space = read_string();
+		value->set(flx_function(name_space, read_string()));
+		break;
+	}
+	case SP_ARRAY:
+		read_shared(array_owners,
+			[&]() { value->set(flx_array(flx_int(read_size())), type.type, type.dim, type.type_name_space, type.type_name); },
+			[&]() {
+				auto arr = value->get_raw_arr();
+				for (flx_int i = 0; i < arr->size(); ++i) {
+					(*arr)[i] = read_value();
+				}
+			});
+		break;
+	case SP_STRUCT:
+		read_shared(struct_owners,
+			[&]() { value->set(flx_struct(), type.type_name_space, type.type_name); },
+			[&]() {
+				auto str = value->get_raw_str();
+				auto size = read_size();
+				for (size_t i = 0; i < size; ++i) {
+					auto identifier = read_string();
+					(*str)[identifier] = read_variable();
+				}
+			});
+		break;
+	case SP_CLASS:
+		read_shared(class_owners,
+			[&]() {
+				auto module_name_space = read_string();
+				value->set(flx_class(module_name_space, read_string()), type.type_name_space, type.type_name);
+			},
+			[&]() { read_scope_tables(*value->get_raw_cls()); });
+		break;
+	default:
+		break;
+	}
+
+	value->type = type.type;
+	value->type_name = type.type_name;
+	value->type_name_space = type.type_name_space;
+	value->dim = type.dim;
+	value->is_constexpr = is_constexpr;
+	value->ref = ref;
+	value->value_ref = value_ref;
+	value->access_index = access_index;
+	value->access_identifier = access_identifier;
+
+	return value;
+}
@@ -0,0 +1,131 @@
+#ifndef VM_SNAPSHOT_HPP
+#define VM_SNAPSHOT_HPP
+
+#include <string>
+#include <vector>
+#include <array>
+#include <unordered_map>
+#include <fstream>
+#include <memory>
+
+#include "types.hpp"
+#include "scope.hpp"
+#include "bytecode.hpp"
+
+namespace core {
+
+	namespace runtime {
+
+		class VirtualMachine;
+
+		/*
+			Heap snapshots are a binary image of a paused vm: bytecode, debug table,
+			scopes and every value reachable from them. Objects shared by several
+			owners, and cycles, are written once and referenced by index afterwards.
+			Values are written in host byte order, a snapshot is only read back by
+			the same interpreter version on the same platform.
+		*/
+		enum SnapshotKind {
+			SK_VALUE,
+			SK_VARIABLE,
+			SK_ARRAY,
+			SK_STRUCT,
+			SK_CLASS,
+			SK_SCOPE,
+			SK_FUNCTION,
+			SK_STRUCT_DEFINITION,
+			SK_CLASS_DEFINITION,
+			SK_SIZE
+		};
+
+		class VmSnapshotWriter {
+		private:
+			std::ofstream file_stream;
+			std::ostream& file;
+			std::array<std::unordered_map<const void*, size_t>, SK_SIZE> ids;
+
+			// writes the reference to obj, returns true when obj is new and its body must follow
+			bool write_ref(SnapshotKind kind, const void* obj);
+
+		public:
+			VmSnapshotWriter(const std::string& path);
+			// writes to memory, e.g. to hand values over to another vm
+			VmSnapshotWriter(std::ostream& stream);
+
+			void write_header();
+			void write_size(size_t value);
+			void write_bool(bool value);
+			void write_int(flx_int value);
+			void write_float(flx_float value);
+			void write_char(flx_char value);
+			void write_string(const std::string& value);
+
+			void write_operand(const Operand& operand);
+			void write_instructions(const std::vector<BytecodeInstruction>& instructions);
+
+			void write_type_definition(const TypeDefinition& type);
+			void write_variable_definition(const VariableDefinition& variable);
+			void write_parameter(const std::shared_ptr<TypeDefinition>& parameter);
+			void write_function(const std::shared_ptr<FunctionDefinition>& function);
+			void write_struct_definition(const std::shared_ptr<StructDefinition>& structure);
+			void write_class_definition(const std::shared_ptr<ClassDefinition>& cls);
+			void write_scope_tables(Scope& scope);
+			void write_scope(const std::shared_ptr<Scope>& scope);
+			void write_scope_map(const std::unordered_map<std::string, std::vector<std::shared_ptr<Scope>>>& scope_map);
+			void write_variable(const std::shared_ptr<Variable>& variable);
+			void write_value(RuntimeValue* value);
+		};
+
+		class VmSnapshotReader {
+		private:
+			std::ifstream file_stream;
+			std::istream& file;
+			VirtualMachine* vm;
+
+			std::vector<RuntimeValue*> values;
+			std::vector<std::shared_ptr<RuntimeVariable>> variables;
+			// first value read for each shared payload, later owners copy it from there
+			std::vector<RuntimeValue*> array_owners;
+			std::vector<RuntimeValue*> struct_owners;
+			std::vector<RuntimeValue*> class_owners;
+			std::vector<std::shared_ptr<Scope>> scopes;
+			std::vector<std::shared_ptr<FunctionDefinition>> functions;
+			std::vector<std::shared_ptr<StructDefinition>> struct_definitions;
+			std::vector<std::shared_ptr<ClassDefinition>> class_definitions;
+
+			// reads a reference, returns true when a new object body follows, else sets index
+			bool read_ref(size_t& index);
+
+		public:
+			VmSnapshotReader(const std::string& path, VirtualMachine* vm);
+			VmSnapshotReader(std::istream& stream, VirtualMachine* vm);
+
+			void read_header();
+			size_t read_size();
+			bool read_bool();
+			flx_int read_int();
+			flx_float read_float();
+			flx_char read_char();
+			std::string read_string();
+
+			Operand read_operand();
+			std::vector<BytecodeInstruction> read_instructions();
+
+			TypeDefinition read_type_definition();
+			VariableDefinition read_variable_definition();
+			std::shared_ptr<TypeDefinition> read_parameter();
+			std::shared_ptr<FunctionDefinition> read_function();
+			std::shared_ptr<StructDefinition> read_struct_definition();
+			std::shared_ptr<ClassDefinition> read_class_definition();
+			void read_scope_tables(Scope& scope);
+			std::shared_ptr<Scope> read_scope();
+			std::unordered_map<std::string, std::vector<std::shared_ptr<Scope>>> read_scope_map();
+			std::shared_ptr<RuntimeVariable> read_variable();
+			RuntimeValue* read_value();
+		};
+
+	}
+
+}
+
+#endif // !VM_SNAPSHOT_HPP
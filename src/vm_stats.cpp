@@ -0,0 +1,141 @@
+#include "vm_stats.hpp"
+
+#include <fstream>
+#include <iomanip>
+#include <algorithm>
+
+using namespace core;
+
+size_t VmStats::slot_of(OpCode opcode) {
+	return opcode < OpCode::OP_SIZE ? size_t(opcode) : OPCODE_SLOTS - 1;
+}
+
+std::string VmStats::slot_name(size_t slot) {
+	auto it = OP_NAMES.find(slot < OpCode::OP_SIZE ? OpCode(slot) : OpCode::OP_ERROR);
+	return it != OP_NAMES.end() ? it->second : "UNKNOWN";
+}
+
+void VmStats::record(OpCode opcode) {
+	auto now = std::chrono::steady_clock::now();
+	auto slot = slot_of(opcode);
+
+	if (last_slot < OPCODE_SLOTS) {
+		auto delta = std::chrono::duration_cast<std::chrono::nanoseconds>(now - last_time).count();
+		elapsed[last_slot] += delta;
+		total_elapsed += delta;
+		++pair_counts[last_slot * OPCODE_SLOTS + slot];
+	}
+
+	++counts[slot];
+	++total_instructions;
+
+	last_slot = slot;
+	last_time = now;
+}
+
+void VmStats::finish() {
+	if (last_slot < OPCODE_SLOTS) {
+		auto delta = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - last_time).count();
+		elapsed[last_slot] += delta;
+		total_elapsed += delta;
+	}
+	last_slot = OPCODE_SLOTS;
+}
+
+std::vector<size_t> VmStats::sorted_opcodes() {
+	std::vector<size_t> slots;
+	for (size_t i = 0; i < OPCODE_SLOTS; ++i) {
+		if (counts[i]) {
+			slots.push_back(i);
+		}
+	}
+
+	std::sort(slots.begin(), slots.end(), [this](size_t a, size_t b) {
+		return counts[a] > counts[b];
+		});
+
+	return slots;
+}
+
+std::vector<std::pair<size_t, size_t>> VmStats::sorted_pairs() {
+	std::vector<std::pair<size_t, size_t>> pairs;
+	for (size_t i = 0; i < pair_counts.size(); ++i) {
+		if (pair_counts[i]) {
+			pairs.emplace_back(i / OPCODE_SLOTS, i % OPCODE_SLOTS);
+		}
+	}
+
+	std::sort(pairs.begin(), pairs.end(), [this](const auto& a, const auto& b) {
+		return pair_counts[a.first * OPCODE_SLOTS + a.second] > pair_counts[b.first * OPCODE_SLOTS + b.second];
+		});
+
+	return pairs;
+}
+
+void VmStats::print_table(std::ostream& os, size_t top_pairs) {
+	auto to_percent = [](double value, double total) {
+		return total ? value * 100.0 / total : 0.0;
+		};
+
+	os << std::endl << "opcode stats: " << total_instructions << " instructions in "
+		<< double(total_elapsed) / 1000000.0 << "ms" << std::endl;
+	os << std::left << std::setw(24) << "opcode" << std::right
+		<< std::setw(14) << "count" << std::setw(9) << "count%"
+		<< std::setw(14) << "time(us)" << std::setw(9) << "time%"
+		<< std::setw(10) << "ns/op" << std::endl;
+	os << std::fixed << std::setprecision(2);
+
+	for (auto slot : sorted_opcodes()) {
+		os << std::left << std::setw(24) << slot_name(slot) << std::right
+			<< std::setw(14) << counts[slot]
+			<< std::setw(9) << to_percent(double(counts[slot]), double(total_instructions))
+			<< std::setw(14) << double(elapsed[slot]) / 1000.0
+			<< std::setw(9) << to_percent(double(elapsed[slot]), double(total_elapsed))
+			<< std::setw(10) << double(elapsed[slot]) / double(counts[slot]) << std::endl;
+	}
+
+	auto pairs = sorted_pairs();
+
+	os << std::endl << std::left << std::setw(48) << "opcode pair" << std::right << std::setw(14) << "count" << std::endl;
+	for (size_t i = 0; i < pairs.size() && i < top_pairs; ++i) {
+		const auto& [first, second] = pairs[i];
+		os << std::left << std::setw(48) << slot_name(first) + " -> " + slot_name(second) << std::right
+			<< std::setw(14) << pair_counts[first * OPCODE_SLOTS + second] << std::endl;
+	}
+
+	os << std::defaultfloat;
+}
+
+void VmStats::write_json(const std::string& path, size_t top_pairs) {
+	std::ofstream file(path);
+
+	if (!file) {
+		std::cerr << "Could not write opcode stats to \"" << path << "\"." << std::endl;
+		return;
+	}
+
+	file << "{" << std::endl;
+	file << "  \"total_instructions\": " << total_instructions << "," << std::endl;
+	file << "  \"total_ns\": " << total_elapsed << "," << std::endl;
+
+	file << "  \"opcodes\": [";
+	auto slots = sorted_opcodes();
+	for (size_t i = 0; i < slots.size(); ++i) {
+		auto slot = slots[i];
+		file << (i ? "," : "") << std::endl << "    { \"name\": \"" << slot_name(slot)
+			<< "\", \"count\": " << counts[slot] << ", \"ns\": " << elapsed[slot] << " }";
+	}
+	file << std::endl << "  ]," << std::endl;
+
+	file << "  \"pairs\": [";
+	auto pairs = sorted_pairs();
+	for (size_t i = 0; i < pairs.size() && i < top_pairs; ++i) {
+		const auto& [first, second] = pairs[i];
+		file << (i ? "," : "") << std::endl << "    { \"first\": \"" << slot_name(first)
+			<< "\", \"second\": \"" << slot_name(second)
+			<< "\", \"count\": " << pair_counts[first * OPCODE_SLOTS + second] << " }";
+	}
+	file << std::endl << "  ]" << std::endl;
+
+	file << "}" << std::endl;
+}
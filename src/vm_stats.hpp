@@ -0,0 +1,48 @@
+#ifndef VM_STATS_HPP
+#define VM_STATS_HPP
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <array>
+#include <chrono>
+
+#include "vm_constants.hpp"
+
+namespace core {
+
+	class VmStats {
+	public:
+		// OP_ERROR and any unknown opcode are accounted on the last slot
+		static const size_t OPCODE_SLOTS = OpCode::OP_SIZE + 1;
+
+	private:
+		std::array<size_t, OPCODE_SLOTS> counts = { 0 };
+		std::array<int64_t, OPCODE_SLOTS> elapsed = { 0 };
+		std::vector<size_t> pair_counts = std::vector<size_t>(OPCODE_SLOTS * OPCODE_SLOTS);
+
+		size_t last_slot = OPCODE_SLOTS;
+		std::chrono::steady_clock::time_point last_time;
+
+		static size_t slot_of(OpCode opcode);
+		static std::string slot_name(size_t slot);
+
+		std::vector<size_t> sorted_opcodes();
+		std::vector<std::pair<size_t, size_t>> sorted_pairs();
+
+	public:
+		size_t total_instructions = 0;
+		int64_t total_elapsed = 0;
+
+		// called before each instruction is executed, the elapsed time since
+		// the previous call is attributed to the previous opcode
+		void record(OpCode opcode);
+		void finish();
+
+		void print_table(std::ostream& os, size_t top_pairs = 20);
+		void write_json(const std::string& path, size_t top_pairs = 20);
+	};
+
+}
+
+#endif // !VM_STATS_HPP